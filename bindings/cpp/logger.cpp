@@ -1,5 +1,8 @@
 #include "library/logger.hpp"
 
+#include <algorithm>
+#include <array>
+#include <mutex>
 #include <stack>
 #include <stdarg.h>
 #include <iomanip>
@@ -72,6 +75,57 @@ bool log_filter(const int severity, const int level) {
 	return attributes::trace::bit() || severity >= level;
 }
 
+std::atomic<int> log_verbosity{DNET_LOG_DEBUG};
+
+namespace {
+/* numbers of registered loggers by their levels */
+class log_levels {
+public:
+	log_levels() {
+		m_loggers.fill(0);
+	}
+
+	void update(int removed, int added) {
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (removed >= 0)
+			--m_loggers[removed];
+		if (added >= 0)
+			++m_loggers[added];
+
+		auto it = std::find_if(m_loggers.begin(), m_loggers.end(), [] (size_t count) { return count > 0; });
+		log_verbosity = (it == m_loggers.end()) ? DNET_LOG_DEBUG : it - m_loggers.begin();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::array<size_t, DNET_LOG_ERROR + 1> m_loggers;
+};
+
+log_levels &registered_levels() {
+	static log_levels levels;
+	return levels;
+}
+
+int clamp_level(int level) {
+	return std::min<int>(std::max<int>(level, DNET_LOG_DEBUG), DNET_LOG_ERROR);
+}
+} /* namespace */
+
+log_level_registration::log_level_registration(int level)
+: m_level(clamp_level(level)) {
+	registered_levels().update(-1, m_level);
+}
+
+log_level_registration::~log_level_registration() {
+	registered_levels().update(m_level, -1);
+}
+
+void log_level_registration::set(int level) {
+	level = clamp_level(level);
+	registered_levels().update(m_level, level);
+	m_level = level;
+}
+
 static std::unique_ptr<dnet_logger> make_logger(const std::string &path, dnet_log_level level, bool watched) {
 	auto formatter = [&]() {
 		static const std::string pattern = "{timestamp:l} {trace_id:{0:default}0>16}/{thread:d}/{process} "
@@ -118,7 +172,8 @@ static std::unique_ptr<dnet_logger> make_logger(const std::string &path, dnet_lo
 
 	std::unique_ptr<blackhole::root_logger_t> logger(new blackhole::root_logger_t(std::move(handlers)));
 
-	logger->filter([level](const blackhole::record_t &record) {
+	auto registration = std::make_shared<log_level_registration>(level);
+	logger->filter([level, registration](const blackhole::record_t &record) {
 		return log_filter(record.severity(), level);
 	});
 
@@ -49,10 +49,45 @@ void single_bulk_remove_handler::process(const remove_result_entry &entry) {
 		return;
 	}
 
+	if (entry.data().empty()) {
+		// reply for a single key
+		process_key(*cmd, entry);
+		return;
+	}
+
+	// statuses of several keys packed into dnet_bulk_remove_response
+	dnet_bulk_remove_response response;
+	try {
+		deserialize(entry.data(), response);
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(log_, "{}: {}: process: failed to unpack statuses: {}",
+		               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), e.what());
+		last_error_ = -EINVAL;
+		return;
+	}
+
+	for (size_t i = 0; i < response.keys.size(); ++i) {
+		dnet_cmd key_cmd(*cmd);
+		key_cmd.id = response.keys[i];
+		key_cmd.status = response.statuses[i];
+		if (!response.backend_ids.empty())
+			key_cmd.backend_id = response.backend_ids[i];
+		key_cmd.size = 0;
+		key_cmd.flags |= DNET_FLAGS_MORE;
+
+		auto result_data = std::make_shared<ioremap::elliptics::callback_result_data>(entry.address(), &key_cmd);
+		if (key_cmd.status)
+			result_data->error = create_error(key_cmd);
+		ioremap::elliptics::callback_result_entry key_entry(result_data);
+		process_key(key_cmd, callback_cast<remove_result_entry>(key_entry));
+	}
+}
+
+void single_bulk_remove_handler::process_key(const dnet_cmd &cmd, const remove_result_entry &entry) {
 	// mark responded key
 	bool found = false;
-	for (auto it = std::lower_bound(keys_.begin(), keys_.end(), cmd->id); it != keys_.end(); ++it) {
-		if (dnet_id_cmp(&cmd->id, &*it) != 0)
+	for (auto it = std::lower_bound(keys_.begin(), keys_.end(), cmd.id); it != keys_.end(); ++it) {
+		if (dnet_id_cmp(&cmd.id, &*it) != 0)
 			break;
 
 		const auto index = std::distance(keys_.begin(), it);
@@ -67,9 +102,9 @@ void single_bulk_remove_handler::process(const remove_result_entry &entry) {
 
 	if (!found) {
 		DNET_LOG_ERROR(log_, "{}: {}: process: unknown key, status: {}",
-		               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), cmd->status);
+		               dnet_dump_id(&cmd.id), dnet_cmd_string(cmd.cmd), cmd.status);
 	}
-	last_error_ = cmd->status;
+	last_error_ = cmd.status;
 }
 
 void single_bulk_remove_handler::complete(const error_info &error) {
@@ -160,7 +195,8 @@ void bulk_remove_handler::start() {
 
 	for (const auto &pair : remote_ids) {
 		const dnet_addr &address = pair.first;
-		const dnet_bulk_remove_request request(pair.second);
+		dnet_bulk_remove_request request(pair.second);
+		request.status_array = true;
 		const auto packet = serialize(request);
 
 		transport_control control;
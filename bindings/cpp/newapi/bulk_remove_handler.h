@@ -24,6 +24,7 @@ public:
 
 private:
 	void process(const remove_result_entry &entry);
+	void process_key(const dnet_cmd &cmd, const remove_result_entry &entry);
 	void complete(const error_info &error);
 
 private:
@@ -329,6 +329,34 @@ void iterator_result_container::append_old(const ioremap::elliptics::iterator_re
 	append_item(item);
 }
 
+void iterator_result_container::append_container(const iterator_result_entry &result)
+{
+	if (m_sorted)
+		throw_error(-EROFS, "can't append to already sorted container");
+
+	const auto container = result.data();
+	const size_t resp_size = sizeof(::dnet_iterator_response);
+	if (container.size() % resp_size != 0)
+		throw_error(-EINVAL, "invalid container size: %zu", container.size());
+
+	for (size_t offset = 0; offset < container.size(); offset += resp_size) {
+		::dnet_iterator_response response;
+		memcpy(&response, container.data<char>() + offset, resp_size);
+		dnet_convert_iterator_response(&response);
+
+		iterator_container_item item;
+		memset(&item, 0, sizeof(item));
+		item.key = response.key;
+		item.status = response.status;
+		item.record_flags = response.flags;
+		item.user_flags = response.user_flags;
+		item.data_timestamp = response.timestamp;
+		item.data_size = response.size;
+
+		append_item(item);
+	}
+}
+
 void iterator_result_container::append_item(const iterator_container_item &item)
 {
 	int err = dnet_write_ll(m_fd, reinterpret_cast<const char *>(&item), sizeof(item), m_write_position);
@@ -687,7 +687,7 @@ async_write_result session::write(const key &id,
 	};
 
 	try {
-		validate_json(std::string((const char*)json.data(), json.size()));
+		validate_json(static_cast<const char *>(json.data()), json.size());
 	} catch (const std::exception &e) {
 		return on_fail(create_error(-EINVAL, "invalid json: %s", e.what()));
 	}
@@ -745,7 +745,7 @@ async_lookup_result session::write_prepare(const key &id,
 	};
 
 	try {
-		validate_json(std::string((const char*)json.data(), json.size()));
+		validate_json(static_cast<const char *>(json.data()), json.size());
 	} catch (const std::exception &e) {
 		return on_fail(create_error(-EINVAL, "invalid json: %s", e.what()));
 	}
@@ -795,7 +795,7 @@ async_lookup_result session::write_plain(const key &id,
 	transform(id);
 
 	try {
-		validate_json(std::string((const char*)json.data(), json.size()));
+		validate_json(static_cast<const char *>(json.data()), json.size());
 	} catch (const std::exception &e) {
 		async_write_result result(*this);
 		async_result_handler<write_result_entry> handler(result);
@@ -823,7 +823,7 @@ async_lookup_result session::write_commit(const key &id,
 	transform(id);
 
 	try {
-		validate_json(std::string((const char*)json.data(), json.size()));
+		validate_json(static_cast<const char *>(json.data()), json.size());
 	} catch (const std::exception &e) {
 		async_write_result result(*this);
 		async_result_handler<write_result_entry> handler(result);
@@ -853,7 +853,7 @@ async_lookup_result session::update_json(const key &id, const argument_data &jso
 	transform(id);
 
 	try {
-		validate_json(std::string((const char*)json.data(), json.size()));
+		validate_json(static_cast<const char *>(json.data()), json.size());
 	} catch (const std::exception &e) {
 		async_write_result result(*this);
 		async_result_handler<write_result_entry> handler(result);
@@ -965,11 +965,12 @@ private:
 	std::unique_ptr<dnet_access_context> m_context;
 };
 
-async_iterator_result session::start_iterator(const address &addr, uint32_t backend_id,
-                                              uint64_t flags,
-                                              const std::vector<dnet_iterator_range> &key_ranges,
-                                              const std::tuple<dnet_time, dnet_time> &time_range) {
-	trace_scope scope{*this};
+static async_iterator_result start_iterator(const session &sess, const address &addr, uint32_t backend_id,
+                                            uint32_t type, uint64_t flags,
+                                            const std::vector<dnet_iterator_range> &key_ranges,
+                                            const std::tuple<dnet_time, dnet_time> &time_range,
+                                            uint32_t parallelism) {
+	trace_scope scope{sess};
 	if (key_ranges.empty()) {
 		flags &= ~DNET_IFLAGS_KEY_RANGE;
 	} else {
@@ -977,25 +978,44 @@ async_iterator_result session::start_iterator(const address &addr, uint32_t back
 	}
 
 	dnet_iterator_request request{
-		DNET_ITYPE_NETWORK,
+		type,
 		flags,
 		key_ranges,
 		time_range,
 	};
+	request.parallelism = parallelism;
 
 	auto packet = serialize(request);
 
 	transport_control control;
 	control.set_command(DNET_CMD_ITERATOR_NEW);
-	control.set_cflags(get_cflags() | DNET_FLAGS_NEED_ACK | DNET_FLAGS_NOLOCK);
+	control.set_cflags(sess.get_cflags() | DNET_FLAGS_NEED_ACK | DNET_FLAGS_NOLOCK);
 	control.set_data(packet.data(), packet.size());
 
-	async_iterator_result result(*this);
-	auto handler = std::make_shared<iterator_handler>(result, *this, addr, backend_id);
+	async_iterator_result result(sess);
+	auto handler = std::make_shared<iterator_handler>(result, sess, addr, backend_id);
 	handler->start(control, request);
 	return result;
 }
 
+async_iterator_result session::start_iterator(const address &addr, uint32_t backend_id,
+                                              uint64_t flags,
+                                              const std::vector<dnet_iterator_range> &key_ranges,
+                                              const std::tuple<dnet_time, dnet_time> &time_range,
+                                              uint32_t parallelism) {
+	return newapi::start_iterator(*this, addr, backend_id, DNET_ITYPE_NETWORK, flags, key_ranges, time_range,
+	                              parallelism);
+}
+
+async_iterator_result session::start_disk_iterator(const address &addr, uint32_t backend_id,
+                                                   uint64_t flags,
+                                                   const std::vector<dnet_iterator_range> &key_ranges,
+                                                   const std::tuple<dnet_time, dnet_time> &time_range,
+                                                   uint32_t parallelism) {
+	return newapi::start_iterator(*this, addr, backend_id, DNET_ITYPE_DISK, flags, key_ranges, time_range,
+	                              parallelism);
+}
+
 async_iterator_result session::server_send(const std::vector<dnet_raw_id> &keys, uint64_t flags, uint64_t chunk_size,
                                            const int src_group, const std::vector<int> &dst_groups) {
 	std::vector<key> converted_keys;
@@ -1682,12 +1682,20 @@ async_monitor_stat_result session::monitor_stat(const address &addr, uint64_t ca
 
 async_monitor_stat_result session::monitor_stat(const address &addr, uint64_t categories,
                                                 const std::unordered_set<uint32_t> &backends_ids)
+{
+	return monitor_stat(addr, categories, backends_ids, 0);
+}
+
+async_monitor_stat_result session::monitor_stat(const address &addr, uint64_t categories,
+                                                const std::unordered_set<uint32_t> &backends_ids,
+                                                uint64_t since_version)
 {
 	trace_scope scope{*this};
 	dnet_monitor_stat_request request;
 	memset(&request, 0, sizeof(struct dnet_monitor_stat_request));
 	request.categories = categories;
 	request.backends_number = backends_ids.size();
+	request.since_version = since_version;
 	dnet_convert_monitor_stat_request(&request);
 
 	transport_control control;
@@ -194,7 +194,8 @@ std::unique_ptr<dnet_logger> make_logger(const std::string &file, int level, boo
 
 	std::unique_ptr<blackhole::root_logger_t> logger(new blackhole::root_logger_t(std::move(handlers)));
 
-	logger->filter([level](const blackhole::record_t &record) {
+	auto registration = std::make_shared<log_level_registration>(level);
+	logger->filter([level, registration](const blackhole::record_t &record) {
 		return log_filter(record.severity(), level);
 	});
 
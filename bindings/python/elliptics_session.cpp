@@ -70,13 +70,17 @@ enum elliptics_monitor_categories {
 	elliptics_monitor_categories_stats = DNET_MONITOR_STATS,
 	elliptics_monitor_categories_procfs = DNET_MONITOR_PROCFS,
 	elliptics_monitor_categories_top = DNET_MONITOR_TOP,
+	elliptics_monitor_categories_latency = DNET_MONITOR_LATENCY,
+	elliptics_monitor_categories_samples = DNET_MONITOR_SAMPLES,
 	elliptics_monitor_categories_all = DNET_MONITOR_CACHE |
 	                                   DNET_MONITOR_IO |
 	                                   DNET_MONITOR_COMMANDS |
 	                                   DNET_MONITOR_BACKEND |
 	                                   DNET_MONITOR_STATS |
 	                                   DNET_MONITOR_PROCFS |
-	                                   DNET_MONITOR_TOP
+	                                   DNET_MONITOR_TOP |
+	                                   DNET_MONITOR_LATENCY |
+	                                   DNET_MONITOR_SAMPLES
 };
 
 struct write_cas_converter {
@@ -785,7 +789,8 @@ public:
 	python_iterator_result start_iterator(const std::string &host, int port, int family, uint32_t backend_id,
 	                                      uint64_t flags,
 	                                      const bp::api::object &key_ranges,
-	                                      const bp::api::object &time_range) {
+	                                      const bp::api::object &time_range,
+	                                      uint32_t parallelism) {
 		auto std_key_ranges = convert_to_vector<dnet_iterator_range>(key_ranges);
 		auto std_time_range = [&] () {
 			if (time_range.ptr() == Py_None) {
@@ -800,7 +805,7 @@ public:
 
 		return create_result(
 			newapi::session{*this}.start_iterator(address(host, port, family), backend_id, flags,
-			                                      std_key_ranges, std_time_range)
+			                                      std_key_ranges, std_time_range, parallelism)
 		);
 	}
 
@@ -916,7 +921,9 @@ void init_elliptics_session() {
 		"backend\n    Category for backend statistics\n"
 		"stats\n    Category for in-process runtime statistics\n"
 		"procfs\n    Category for system statistics about process\n"
-		"top\n    Category for statistics of top keys ordered by generated traffic\n")
+		"top\n    Category for statistics of top keys ordered by generated traffic\n"
+		"latency\n    Category for histograms of commands latencies\n"
+		"samples\n    Category for timings of sampled requests split by stages\n")
 		.value("all", elliptics_monitor_categories_all)
 		.value("cache", elliptics_monitor_categories_cache)
 		.value("io", elliptics_monitor_categories_io)
@@ -925,6 +932,8 @@ void init_elliptics_session() {
 		.value("stats", elliptics_monitor_categories_stats)
 		.value("procfs", elliptics_monitor_categories_procfs)
 		.value("top", elliptics_monitor_categories_top)
+		.value("latency", elliptics_monitor_categories_latency)
+		.value("samples", elliptics_monitor_categories_samples)
 	;
 
 	bp::class_<elliptics_status>("SessionStatus", bp::init<>())
@@ -1951,16 +1960,18 @@ void init_elliptics_session() {
 		     "    assert async.successful()\n")
 
 		.def("start_iterator", &newapi::elliptics_session::start_iterator,
-		     bp::args("host", "port", "family", "backend_id",
-		              "flags", "key_ranges", "time_range"),
-		     "start_iterator(host, port, family, backend_id, flags, key_ranges, time_range)\n"
+		     (bp::arg("host"), bp::arg("port"), bp::arg("family"), bp::arg("backend_id"),
+		      bp::arg("flags"), bp::arg("key_ranges"), bp::arg("time_range"), bp::arg("parallelism")=0),
+		     "start_iterator(host, port, family, backend_id, flags, key_ranges, time_range, parallelism=0)\n"
 		     "    Start iterator on the Elliptics node specified by @host, @port, @family and @backend_id."
 		     "    Return elliptics.AsyncResult.\n"
 		     "    -- host, port, family - the node where iteration should be executed\n"
 		     "    -- backend_id - id of backend where iteration should be executed\n"
 		     "    -- flags - bits set of elliptics.iterator_flags\n"
 		     "    -- key_ranges - list of elliptics.IteratorRange by which keys on the node should be filtered\n"
-		     "    -- time_range - time range by which keys on the node should be filtered\n\n"
+		     "    -- time_range - time range by which keys on the node should be filtered\n"
+		     "    -- parallelism - hint how many threads the backend may use for iteration of @key_ranges,\n"
+		     "       0 lets the backend decide, keys iterated in parallel are returned in no particular order\n\n"
 		     "    flags = elliptics.iterator_flags.key_range\n"
 		     "    range = elliptics.IteratorRange()\n"
 		     "    range.key_begin = elliptics.Id([0] * 64, 1)\n"
@@ -355,6 +355,10 @@ void iterator_container_append_old(newapi::iterator_result_container &container,
 	container.append_old(result);
 }
 
+void iterator_container_append_container(newapi::iterator_result_container &container, newapi::iterator_result_entry &result) {
+	container.append_container(result);
+}
+
 void iterator_container_sort(newapi::iterator_result_container &container) {
 	container.sort();
 }
@@ -637,6 +641,11 @@ void init_result_entry() {
 		     (bp::arg("iterator_result_entry")),
 		     "append_old(iterator_result_entry)\n"
 		     "    Appends iterator_result_entry of type elliptics.core.IteratorResultEntry to the end of the container file")
+		.def("append_container", newapi::iterator_container_append_container,
+		     (bp::arg("iterator_result_entry")),
+		     "append_container(iterator_result_entry)\n"
+		     "    Appends all records of the container sent by disk iterator in iterator_result_entry\n"
+		     "    of type elliptics.core.newapi.IteratorResultEntry to the end of the container file")
 		.def("sort", newapi::iterator_container_sort,
 		     "sort()\n"
 		     "    Sorts items of the container file by (key, data_timestamp, json_timestamp, data_size) tuple")
@@ -247,12 +247,17 @@ class Session(elliptics.core.newapi.Session):
             backends = list(backends)
         return super(Session, self).monitor_stat(address, categories, backends)
 
-    def start_iterator(self, address, backend_id, flags, key_ranges=None, time_range=None):
-        """Start iterator on node @address and backend @backend_id."""
+    def start_iterator(self, address, backend_id, flags, key_ranges=None, time_range=None, parallelism=0):
+        """
+        Start iterator on node @address and backend @backend_id.
+        @parallelism is a hint how many threads the backend may use for iteration of @key_ranges,
+        0 lets the backend decide.
+        """
         return super(Session, self).start_iterator(host=address.host,
                                                    port=address.port,
                                                    family=address.family,
                                                    backend_id=backend_id,
                                                    flags=flags,
                                                    key_ranges=key_ranges,
-                                                   time_range=time_range)
+                                                   time_range=time_range,
+                                                   parallelism=parallelism)
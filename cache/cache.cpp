@@ -18,6 +18,8 @@
 #include "cache.hpp"
 #include "slru_cache.hpp"
 
+#include <chrono>
+
 #include <blackhole/attribute.hpp>
 #include <kora/config.hpp>
 
@@ -25,7 +27,6 @@
 #include "library/protocol.hpp"
 
 #include "monitor/measure_points.h"
-#include "rapidjson/document.h"
 
 #include "example/config.hpp"
 #include "local_session.h"
@@ -102,17 +103,41 @@ static size_t parse_size(const kora::config_t &value) {
 	return ret;
 }
 
+static std::string parse_compression(const kora::config_t &cache) {
+	const auto compression = cache.at<std::string>("compression", "none");
+	if (compression != "none" && compression != "zlib") {
+		throw elliptics::config::config_error(cache.path() + ".compression must be \"none\" or \"zlib\"");
+	}
+	return compression;
+}
+
 cache_config cache_config::parse(const kora::config_t &cache) {
 	return {/*size*/ parse_size(cache["size"]),
 	        /*count*/ cache.at<size_t>("shards", DNET_DEFAULT_CACHES_NUMBER),
 	        /*sync_timeout*/ cache.at<unsigned>("sync_timeout", DNET_DEFAULT_CACHE_SYNC_TIMEOUT_SEC),
 	        /*pages_proportions*/ cache.at("pages_proportions",
-	                                       std::vector<size_t>(DNET_DEFAULT_CACHE_PAGES_NUMBER, 1))};
+	                                       std::vector<size_t>(DNET_DEFAULT_CACHE_PAGES_NUMBER, 1)),
+	        /*sync_batch_size*/ cache.at<size_t>("sync_batch_size", DNET_DEFAULT_CACHE_SYNC_BATCH_SIZE),
+	        /*sync_threads*/ cache.at<size_t>("sync_threads", DNET_DEFAULT_CACHE_SYNC_THREADS),
+	        /*sync_rate_limit*/ cache.at<size_t>("sync_rate_limit", 0),
+	        /*snapshot_dir*/ cache.at<std::string>("snapshot_dir", ""),
+	        /*snapshot_data*/ cache.at<bool>("snapshot_data", false),
+	        /*snapshot_period*/ cache.at<unsigned>("snapshot_period", 0),
+	        /*metadata*/ cache.at<bool>("metadata", false),
+	        /*compression*/ parse_compression(cache),
+	        /*compression_threshold*/ cache.at<size_t>("compression_threshold",
+	                                                   DNET_DEFAULT_CACHE_COMPRESSION_THRESHOLD),
+	        /*compression_ratio*/ cache.at<unsigned>("compression_ratio", DNET_DEFAULT_CACHE_COMPRESSION_RATIO)};
 }
 
 cache_manager::cache_manager(dnet_node *n, dnet_backend &backend, const cache_config &config)
 : m_node(n)
-, m_need_exit(false) {
+, m_backend(backend)
+, m_need_exit(false)
+, m_snapshot_data(config.snapshot_data)
+, m_snapshot_period(config.snapshot_period)
+, m_snapshot_stop(false)
+, m_snapshot_loaded(false) {
 	size_t caches_number = config.count;
 	m_cache_pages_number = config.pages_proportions.size();
 	m_max_cache_size = config.size;
@@ -130,11 +155,17 @@ cache_manager::cache_manager(dnet_node *n, dnet_backend &backend, const cache_co
 
 	for (size_t i = 0; i < caches_number; ++i) {
 		m_caches.emplace_back(
-		        std::make_shared<slru_cache_t>(n, backend, pages_max_sizes, config.sync_timeout, m_need_exit));
+		        std::make_shared<slru_cache_t>(n, backend, pages_max_sizes, config, m_need_exit));
+	}
+
+	if (!config.snapshot_dir.empty()) {
+		m_snapshot_path = config.snapshot_dir + "/cache." + std::to_string(backend.backend_id()) + ".snapshot";
+		m_snapshot_thread = std::thread(std::bind(&cache_manager::snapshot_thread, this));
 	}
 }
 
 cache_manager::~cache_manager() {
+	shutdown();
 	m_need_exit = true;
 }
 
@@ -145,8 +176,8 @@ write_response_t cache_manager::write(dnet_net_state *st,
 	return m_caches[idx(request.id)]->write(st, cmd, request, context);
 }
 
-read_response_t cache_manager::read(const unsigned char *id, uint64_t ioflags) {
-	return m_caches[idx(id)]->read(id, ioflags);
+read_response_t cache_manager::read(const unsigned char *id, uint64_t ioflags, bool json_only) {
+	return m_caches[idx(id)]->read(id, ioflags, json_only);
 }
 
 int cache_manager::remove(const dnet_cmd *cmd,
@@ -155,8 +186,8 @@ int cache_manager::remove(const dnet_cmd *cmd,
 	return m_caches[idx(cmd->id.id)]->remove(cmd, request, context);
 }
 
-read_response_t cache_manager::lookup(const unsigned char *id) {
-	return m_caches[idx(id)]->lookup(id);
+read_response_t cache_manager::lookup(const unsigned char *id, bool populate) {
+	return m_caches[idx(id)]->lookup(id, populate);
 }
 
 void cache_manager::clear() {
@@ -183,6 +214,12 @@ cache_stats cache_manager::get_total_cache_stats() const {
 		stats.number_of_objects_marked_for_deletion += page_stats.number_of_objects_marked_for_deletion;
 		stats.size_of_objects_marked_for_deletion += page_stats.size_of_objects_marked_for_deletion;
 		stats.size_of_objects += page_stats.size_of_objects;
+		stats.number_of_objects_to_sync += page_stats.number_of_objects_to_sync;
+		stats.sync_lag = std::max(stats.sync_lag, page_stats.sync_lag);
+		stats.number_of_metadata_objects += page_stats.number_of_metadata_objects;
+		stats.number_of_compressed_objects += page_stats.number_of_compressed_objects;
+		stats.size_of_compressed_objects += page_stats.size_of_compressed_objects;
+		stats.raw_size_of_compressed_objects += page_stats.raw_size_of_compressed_objects;
 
 		for (size_t j = 0; j < m_cache_pages_number; ++j) {
 			stats.pages_sizes[j] += page_stats.pages_sizes[j];
@@ -192,25 +229,38 @@ cache_stats cache_manager::get_total_cache_stats() const {
 	return stats;
 }
 
-void cache_manager::statistics(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) const {
-	value.SetObject();
+void cache_manager::statistics(ioremap::monitor::json_writer &writer) const {
+	writer.StartObject();
 
-	rapidjson::Value total_cache(rapidjson::kObjectType);
+	writer.String("total_cache");
+	writer.StartObject();
 	{
-		rapidjson::Value size_stats(rapidjson::kObjectType);
-		get_total_cache_stats().to_json(size_stats, allocator);
-		total_cache.AddMember("size_stats", size_stats, allocator);
+		writer.String("size_stats");
+		get_total_cache_stats().to_json(writer);
 	}
-	value.AddMember("total_cache", total_cache, allocator);
+	writer.EndObject();
 
-	rapidjson::Value caches(rapidjson::kObjectType);
+	writer.String("caches");
+	writer.StartObject();
 	for (size_t i = 0; i < m_caches.size(); ++i) {
 		const auto &index = std::to_string(i);
-		rapidjson::Value cache_time_stats(rapidjson::kObjectType);
-		m_caches[i]->get_cache_stats().to_json(cache_time_stats, allocator);
-		caches.AddMember(index.c_str(), allocator, cache_time_stats, allocator);
+		writer.String(index.c_str(), index.size());
+		m_caches[i]->get_cache_stats().to_json(writer);
 	}
-	value.AddMember("caches", caches, allocator);
+	writer.EndObject();
+
+	writer.EndObject();
+}
+
+void cache_manager::shutdown() {
+	if (!m_snapshot_thread.joinable())
+		return;
+
+	m_snapshot_stop = true;
+	m_snapshot_thread.join();
+
+	if (m_snapshot_loaded)
+		write_snapshot();
 }
 
 size_t cache_manager::idx(const unsigned char *id) {
@@ -219,6 +269,103 @@ size_t cache_manager::idx(const unsigned char *id) {
 	return (i ^ j) % m_caches.size();
 }
 
+void cache_manager::snapshot_thread() {
+	dnet_set_name("dnet_cache_snap_%zu", m_backend.backend_id());
+
+	// cache is created while backend is activating and can't read from it yet
+	while (!m_snapshot_stop && m_backend.state() == DNET_BACKEND_ACTIVATING) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	if (m_snapshot_stop || m_backend.state() != DNET_BACKEND_ENABLED)
+		return;
+
+	load_snapshot();
+	m_snapshot_loaded = true;
+
+	auto last_snapshot = std::chrono::steady_clock::now();
+	while (!m_snapshot_stop) {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		const auto now = std::chrono::steady_clock::now();
+		if (m_snapshot_period && now - last_snapshot >= std::chrono::seconds(m_snapshot_period)) {
+			write_snapshot();
+			last_snapshot = now;
+		}
+	}
+}
+
+void cache_manager::load_snapshot() {
+	ioremap::elliptics::util::steady_timer timer;
+
+	snapshot_reader reader(m_snapshot_path);
+	int err = reader.open();
+	if (err) {
+		const auto level = err == -ENOENT ? DNET_LOG_INFO : DNET_LOG_ERROR;
+		DNET_LOG(m_node, level, "cache: backend: {}: failed to open snapshot: {}: {} [{}]",
+		         m_backend.backend_id(), m_snapshot_path, strerror(-err), err);
+		return;
+	}
+
+	// nothing is restored from a truncated or corrupted snapshot
+	err = reader.validate();
+	if (err) {
+		DNET_LOG_ERROR(m_node, "cache: backend: {}: snapshot: {} is rejected by validation: {} [{}]",
+		               m_backend.backend_id(), m_snapshot_path, strerror(-err), err);
+		return;
+	}
+
+	size_t restored = 0, skipped = 0;
+	snapshot_record record;
+	while (!m_snapshot_stop && (err = reader.next(record)) > 0) {
+		if (m_caches[idx(record.id.id)]->restore(record)) {
+			++restored;
+		} else {
+			++skipped;
+		}
+	}
+
+	if (err < 0) {
+		DNET_LOG_ERROR(m_node, "cache: backend: {}: snapshot: {} is corrupted after {} records: {} [{}]",
+		               m_backend.backend_id(), m_snapshot_path, restored + skipped, strerror(-err), err);
+	}
+
+	DNET_LOG_INFO(m_node, "cache: backend: {}: loaded snapshot: {}, with data: {}, restored: {}, skipped: {}, "
+	                      "elapsed: {} ms",
+	              m_backend.backend_id(), m_snapshot_path, reader.with_data(), restored, skipped,
+	              timer.get_ms());
+}
+
+int cache_manager::write_snapshot() {
+	ioremap::elliptics::util::steady_timer timer;
+
+	snapshot_writer writer(m_snapshot_path, m_snapshot_data);
+	int err = writer.open();
+
+	// shards are copied one by one, so only a single shard is duplicated in memory at a time
+	std::vector<snapshot_record> records;
+	for (size_t i = 0; i < m_caches.size() && !err; ++i) {
+		records.clear();
+		m_caches[i]->snapshot(records, m_snapshot_data);
+
+		for (const auto &record : records) {
+			err = writer.write(record);
+			if (err)
+				break;
+		}
+	}
+
+	if (!err)
+		err = writer.commit();
+
+	const auto level = err ? DNET_LOG_ERROR : DNET_LOG_INFO;
+	DNET_LOG(m_node, level, "cache: backend: {}: wrote snapshot: {}, with data: {}, records: {}, elapsed: {} ms: "
+	                        "{} [{}]",
+	         m_backend.backend_id(), m_snapshot_path, m_snapshot_data, writer.records(), timer.get_ms(),
+	         strerror(-err), err);
+	return err;
+}
+
 }} /* namespace ioremap::cache */
 
 using namespace ioremap::cache;
@@ -307,7 +454,7 @@ static int dnet_cmd_cache_io_write_new(struct cache_manager *cache,
 
 			it.timestamp, // data_timestamp
 			0, // data_offset
-			it.data->size(), // data_size
+			it.data_size, // data_size
 		});
 
 		cmd_stats->size = request.json_size + request.data_size;
@@ -335,7 +482,7 @@ static int dnet_cmd_cache_io_read(struct cache_manager *cache,
 	int err;
 	cache_item it;
 
-	std::tie(err, it) = cache->read(io->id, io->flags);
+	std::tie(err, it) = cache->read(io->id, io->flags, false);
 	if (err) {
 		return err;
 	}
@@ -398,7 +545,7 @@ static int dnet_cmd_cache_io_read_new(struct cache_manager *cache,
 	int err;
 	cache_item it;
 
-	std::tie(err, it) = cache->read(cmd->id.id, request.ioflags);
+	std::tie(err, it) = cache->read(cmd->id.id, request.ioflags, !(request.read_flags & DNET_READ_FLAGS_DATA));
 	if (err) {
 		return err;
 	}
@@ -436,7 +583,7 @@ static int dnet_cmd_cache_io_read_new(struct cache_manager *cache,
 		json.size(), // read_json_size
 
 		it.timestamp, // data_timestamp
-		raw_data->size(), // data_size
+		it.data_size, // data_size
 		request.data_offset, // read_data_offset
 		data_p.size(), // read_data_size
 	});
@@ -468,7 +615,7 @@ static int dnet_cmd_cache_io_lookup(struct dnet_backend *backend,
 	int err;
 	cache_item it;
 
-	std::tie(err, it) = backend->cache()->lookup(cmd->id.id);
+	std::tie(err, it) = backend->cache()->lookup(cmd->id.id, false);
 	if (err) {
 		return err;
 	}
@@ -505,7 +652,7 @@ static int dnet_cmd_cache_io_lookup_new(struct cache_manager *cache,
 	int err;
 	cache_item it;
 
-	std::tie(err, it) = cache->lookup(cmd->id.id);
+	std::tie(err, it) = cache->lookup(cmd->id.id, true);
 	if (err) {
 		return err;
 	}
@@ -522,7 +669,7 @@ static int dnet_cmd_cache_io_lookup_new(struct cache_manager *cache,
 
 		it.timestamp, // data_timestamp
 		0, // data_offset
-		it.data->size(), // data_size
+		it.data_size, // data_size
 	});
 
 	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
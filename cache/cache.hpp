@@ -20,6 +20,8 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <limits>
 #include <iostream>
 #include <stdarg.h>
@@ -34,7 +36,7 @@
 #include "elliptics/interface.h"
 #include "elliptics/utils.hpp"
 
-#include "rapidjson/document.h"
+#include "monitor/json_writer.hpp"
 
 #include "treap.hpp"
 
@@ -69,6 +71,10 @@ struct cache_item {
 	uint64_t user_flags;
 	std::shared_ptr<std::string> data;
 	std::shared_ptr<std::string> json;
+	// size of object's data, @data is empty if object is cached without data
+	uint64_t data_size;
+	// @data is compressed, reads decompress it unless only json was requested
+	bool compressed;
 };
 
 class data_t : public lru_list_base_hook_t, public treap_node_t<data_t> {
@@ -88,6 +94,10 @@ public:
 	, m_remove_from_cache(false)
 	, m_only_append(false)
 	, m_removed_from_page(true)
+	, m_need_validation(false)
+	, m_metadata_only(false)
+	, m_compressed(false)
+	, m_data_size(0)
 	, m_sync_state(sync_state_t::NOT_SYNCING)
 	, m_json()
 	{
@@ -108,6 +118,10 @@ public:
 	, m_remove_from_cache(false)
 	, m_only_append(false)
 	, m_removed_from_page(true)
+	, m_need_validation(false)
+	, m_metadata_only(false)
+	, m_compressed(false)
+	, m_data_size(0)
 	, m_sync_state(sync_state_t::NOT_SYNCING)
 	, m_data(std::make_shared<std::string>(data.to_string()))
 	, m_json(std::make_shared<std::string>(json.to_string())) {
@@ -248,6 +262,46 @@ public:
 		m_removed_from_page = removed_from_page;
 	}
 
+	// object was restored from the snapshot and should be checked against the backend on first access
+	bool need_validation() const {
+		return m_need_validation;
+	}
+
+	void set_need_validation(bool need_validation) {
+		m_need_validation = need_validation;
+	}
+
+	// object keeps only json and timestamps, its data is stored only in the backend
+	bool metadata_only() const {
+		return m_metadata_only;
+	}
+
+	void set_metadata_only(uint64_t data_size) {
+		m_metadata_only = true;
+		m_data_size = data_size;
+	}
+
+	// object's data is compressed, data() returns compressed bytes
+	bool compressed() const {
+		return m_compressed;
+	}
+
+	void set_compressed(std::shared_ptr<std::string> data, uint64_t data_size) {
+		m_data = std::move(data);
+		m_compressed = true;
+		m_data_size = data_size;
+	}
+
+	void set_decompressed(std::shared_ptr<std::string> data) {
+		m_data = std::move(data);
+		m_compressed = false;
+		m_data_size = 0;
+	}
+
+	uint64_t data_size() const {
+		return (m_metadata_only || m_compressed) ? m_data_size : m_data->size();
+	}
+
 	size_t size(void) const {
 		return capacity() + overhead_size();
 	}
@@ -262,7 +316,7 @@ public:
 	}
 
 	cache_item get_cache_item() const {
-		return {m_timestamp, m_json_timestamp, m_user_flags, m_data, m_json};
+		return {m_timestamp, m_json_timestamp, m_user_flags, m_data, m_json, data_size(), m_compressed};
 	}
 
 	friend bool operator< (const data_t &a, const data_t &b) {
@@ -315,6 +369,10 @@ private:
 	bool m_remove_from_cache;
 	bool m_only_append;
 	bool m_removed_from_page;
+	bool m_need_validation;
+	bool m_metadata_only;
+	bool m_compressed;
+	uint64_t m_data_size;
 	sync_state_t m_sync_state;
 	char m_cache_page_number;
 	struct dnet_raw_id m_id;
@@ -332,6 +390,12 @@ struct cache_stats {
 	, size_of_objects(0)
 	, number_of_objects_marked_for_deletion(0)
 	, size_of_objects_marked_for_deletion(0)
+	, number_of_objects_to_sync(0)
+	, sync_lag(0)
+	, number_of_metadata_objects(0)
+	, number_of_compressed_objects(0)
+	, size_of_compressed_objects(0)
+	, raw_size_of_compressed_objects(0)
 	{
 	}
 
@@ -339,27 +403,49 @@ struct cache_stats {
 	std::size_t size_of_objects;
 	std::size_t number_of_objects_marked_for_deletion;
 	std::size_t size_of_objects_marked_for_deletion;
+	// number of dirty objects collected by the current flush round and not yet written to the backend
+	std::size_t number_of_objects_to_sync;
+	// how long (in seconds) the oldest object of the current flush round has been waiting for the sync
+	std::size_t sync_lag;
+	// number of objects cached without data
+	std::size_t number_of_metadata_objects;
+	// number of objects with compressed data, size of their compressed data and size of the raw one
+	std::size_t number_of_compressed_objects;
+	std::size_t size_of_compressed_objects;
+	std::size_t raw_size_of_compressed_objects;
 
 	std::vector<size_t> pages_sizes;
 	std::vector<size_t> pages_max_sizes;
 
-	void to_json(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) const {
-		value.AddMember("size", size_of_objects, allocator);
-		value.AddMember("removing_size", size_of_objects_marked_for_deletion, allocator);
-		value.AddMember("objects", number_of_objects, allocator);
-		value.AddMember("removing_objects", number_of_objects_marked_for_deletion, allocator);
-
-		rapidjson::Value pages_sizes_stat(rapidjson::kArrayType);
+	void to_json(ioremap::monitor::json_writer &writer) const {
+		using ioremap::monitor::write_member;
+
+		writer.StartObject();
+		write_member(writer, "size", size_of_objects);
+		write_member(writer, "removing_size", size_of_objects_marked_for_deletion);
+		write_member(writer, "objects", number_of_objects);
+		write_member(writer, "removing_objects", number_of_objects_marked_for_deletion);
+		write_member(writer, "sync_pending_objects", number_of_objects_to_sync);
+		write_member(writer, "sync_lag", sync_lag);
+		write_member(writer, "metadata_objects", number_of_metadata_objects);
+		write_member(writer, "compressed_objects", number_of_compressed_objects);
+		write_member(writer, "compressed_size", size_of_compressed_objects);
+		write_member(writer, "compressed_raw_size", raw_size_of_compressed_objects);
+
+		writer.String("pages_sizes");
+		writer.StartArray();
 		for (auto it = pages_sizes.begin(), end = pages_sizes.end(); it != end; ++it) {
-			pages_sizes_stat.PushBack(*it, allocator);
+			writer.Uint64(*it);
 		}
-		value.AddMember("pages_sizes", pages_sizes_stat, allocator);
+		writer.EndArray();
 
-		rapidjson::Value pages_max_sizes_stat(rapidjson::kArrayType);
+		writer.String("pages_max_sizes");
+		writer.StartArray();
 		for (auto it = pages_max_sizes.begin(), end = pages_max_sizes.end(); it != end; ++it) {
-			pages_max_sizes_stat.PushBack(*it, allocator);
+			writer.Uint64(*it);
 		}
-		value.AddMember("pages_max_sizes", pages_max_sizes_stat, allocator);
+		writer.EndArray();
+		writer.EndObject();
 	}
 };
 
@@ -414,11 +500,18 @@ public:
 	                       const write_request &request,
 	                       dnet_access_context *context);
 
-	read_response_t read(const unsigned char *id, uint64_t ioflags);
+	/*
+	 * If @json_only is set, the caller doesn't need object's data and the object is cached
+	 * without data when metadata caching is enabled.
+	 */
+	read_response_t read(const unsigned char *id, uint64_t ioflags, bool json_only);
 
 	int remove(const dnet_cmd *cmd, ioremap::elliptics::dnet_remove_request &request, dnet_access_context *context);
 
-	read_response_t lookup(const unsigned char *id);
+	/*
+	 * If @populate is set and metadata caching is enabled, missed object is cached without data.
+	 */
+	read_response_t lookup(const unsigned char *id, bool populate);
 
 	void clear();
 
@@ -428,16 +521,39 @@ public:
 
 	cache_stats get_total_cache_stats() const;
 
-	void statistics(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) const;
+	void statistics(ioremap::monitor::json_writer &writer) const;
+
+	/*
+	 * Stops loading of the snapshot and writes the final one if snapshots are enabled.
+	 * Must be called while backend's io pool is still attached.
+	 */
+	void shutdown();
+
+	/*
+	 * Whether loading of the snapshot is finished, no matter whether anything was restored from it.
+	 */
+	bool snapshot_loaded() const { return m_snapshot_loaded; }
 
 private:
 	dnet_node *m_node;
+	dnet_backend &m_backend;
 	std::vector<std::shared_ptr<slru_cache_t>> m_caches;
 	size_t m_max_cache_size;
 	size_t m_cache_pages_number;
 	bool m_need_exit; // @m_need_exit is shared between slru_caches and signals them to stop
 
+	std::string m_snapshot_path; // empty if snapshots are disabled
+	bool m_snapshot_data;
+	unsigned m_snapshot_period;
+	std::thread m_snapshot_thread;
+	std::atomic_bool m_snapshot_stop;
+	std::atomic_bool m_snapshot_loaded; // the snapshot is overwritten only after it was loaded
+
 	size_t idx(const unsigned char *id);
+
+	void snapshot_thread();
+	void load_snapshot();
+	int write_snapshot();
 };
 
 template <typename T>
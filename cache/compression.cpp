@@ -0,0 +1,71 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compression.hpp"
+
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include "example/config.hpp"
+
+namespace ioremap { namespace cache {
+
+cache_compressor::cache_compressor(const cache_config &config)
+: m_enabled(config.compression == "zlib")
+, m_threshold(config.compression_threshold)
+, m_ratio(config.compression_ratio) {
+}
+
+bool cache_compressor::compress(const char *data, size_t size, std::string &compressed) const {
+	if (!m_enabled || !size || size < m_threshold)
+		return false;
+
+	// compressed data which doesn't fit into the ratio is useless, so zlib is limited by it
+	uLongf compressed_size = size * m_ratio / 100;
+	if (!compressed_size)
+		return false;
+
+	compressed.resize(compressed_size);
+
+	// cache is on the hot path, so the fastest level is used
+	const int err = compress2(reinterpret_cast<Bytef *>(&compressed[0]), &compressed_size,
+	                          reinterpret_cast<const Bytef *>(data), size, Z_BEST_SPEED);
+	if (err != Z_OK) {
+		compressed.clear();
+		return false;
+	}
+
+	compressed.resize(compressed_size);
+	compressed.shrink_to_fit();
+	return true;
+}
+
+std::shared_ptr<std::string> cache_compressor::decompress(const std::string &compressed, size_t size) const {
+	auto decompressed = std::make_shared<std::string>(size, '\0');
+
+	uLongf decompressed_size = size;
+	const int err = uncompress(reinterpret_cast<Bytef *>(&(*decompressed)[0]), &decompressed_size,
+	                           reinterpret_cast<const Bytef *>(compressed.data()), compressed.size());
+	if (err != Z_OK || decompressed_size != size) {
+		throw std::runtime_error("failed to decompress cached data: " + std::to_string(err));
+	}
+
+	return decompressed;
+}
+
+}} /* namespace ioremap::cache */
@@ -0,0 +1,52 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_COMPRESSION_HPP
+#define CACHE_COMPRESSION_HPP
+
+#include <memory>
+#include <string>
+
+namespace ioremap { namespace cache {
+
+struct cache_config;
+
+/*
+ * Codec of cached data. Data is compressed only if it is not smaller than the threshold
+ * and compressed data fits into the configured percent of the raw size, otherwise
+ * compress() returns false and data should be stored as is.
+ */
+class cache_compressor {
+public:
+	explicit cache_compressor(const cache_config &config);
+
+	bool enabled() const { return m_enabled; }
+
+	bool compress(const char *data, size_t size, std::string &compressed) const;
+
+	// @size is a size of raw data, throws std::runtime_error if @compressed is corrupted
+	std::shared_ptr<std::string> decompress(const std::string &compressed, size_t size) const;
+
+private:
+	bool m_enabled;
+	size_t m_threshold;
+	unsigned m_ratio;
+};
+
+}} /* namespace ioremap::cache */
+
+#endif // CACHE_COMPRESSION_HPP
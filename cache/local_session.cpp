@@ -79,7 +79,8 @@ int local_session::read(const dnet_id &id,
                         ioremap::elliptics::data_pointer *json,
                         dnet_time *json_ts,
                         ioremap::elliptics::data_pointer *data,
-                        dnet_time *data_ts) {
+                        dnet_time *data_ts,
+                        uint64_t *data_size) {
 	const uint64_t read_flags = (json ? DNET_READ_FLAGS_JSON : 0) | (data ? DNET_READ_FLAGS_DATA : 0);
 	auto packet = serialize(dnet_read_request{/*ioflags*/ m_ioflags,
 	                                          /*read_flags*/ read_flags,
@@ -96,7 +97,7 @@ int local_session::read(const dnet_id &id,
 	cmd.size = packet.size();
 	cmd.backend_id = m_backend.backend_id();
 
-	const int err = dnet_process_cmd_raw(m_state, &cmd, packet.data(), 0, 0, /*context*/ nullptr);
+	const int err = dnet_process_cmd_raw(m_state, &cmd, packet.data(), 0, 0, 0, /*context*/ nullptr);
 	if (err) {
 		clear_queue();
 		return err;
@@ -126,6 +127,8 @@ int local_session::read(const dnet_id &id,
 				*json_ts = response.json_timestamp;
 			if (data_ts)
 				*data_ts = response.data_timestamp;
+			if (data_size)
+				*data_size = response.data_size;
 
 			DNET_LOG_DEBUG(m_state->n, "entry in list, size: {}", req_cmd->size);
 
@@ -153,6 +156,9 @@ int local_session::read(const dnet_id &id,
 				*data = std::move(result);
 				return 0;
 			}
+
+			clear_queue();
+			return 0;
 		}
 	}
 
@@ -194,7 +200,7 @@ int local_session::write(const dnet_id &id, const char *data, size_t size, uint6
 	cmd.size = datap.size();
 	cmd.backend_id = m_backend.backend_id();
 
-	int err = dnet_process_cmd_raw(m_state, &cmd, datap.data(), 0, 0, /*context*/ nullptr);
+	int err = dnet_process_cmd_raw(m_state, &cmd, datap.data(), 0, 0, 0, /*context*/ nullptr);
 
 	clear_queue(&err);
 
@@ -241,7 +247,7 @@ int local_session::write(const dnet_id &id,
 	cmd.size = datap.size();
 	cmd.backend_id = m_backend.backend_id();
 
-	int err = dnet_process_cmd_raw(m_state, &cmd, datap.data(), 0, 0, /*context*/ nullptr);
+	int err = dnet_process_cmd_raw(m_state, &cmd, datap.data(), 0, 0, 0, /*context*/ nullptr);
 	clear_queue(&err);
 	return err;
 }
@@ -253,7 +259,7 @@ data_pointer local_session::lookup(const dnet_cmd &tmp_cmd, int *errp)
 	cmd.size = 0;
 	cmd.backend_id = m_backend.backend_id();
 
-	*errp = dnet_process_cmd_raw(m_state, &cmd, nullptr, 0, 0, /*context*/ nullptr);
+	*errp = dnet_process_cmd_raw(m_state, &cmd, nullptr, 0, 0, 0, /*context*/ nullptr);
 
 	if (*errp)
 		return data_pointer();
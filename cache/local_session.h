@@ -40,12 +40,17 @@ public:
 	void set_ioflags(uint32_t flags);
 	void set_cflags(uint64_t flags);
 
+	/*
+	 * Reads record @id from the backend, json and data are requested only if @json and @data are not null.
+	 * Returns 0 if the record was found, even when only json or only metadata was requested.
+	 */
 	int read(const dnet_id &id,
 	         uint64_t *user_flags,
 	         ioremap::elliptics::data_pointer *json,
 	         dnet_time *json_ts,
 	         ioremap::elliptics::data_pointer *data,
-	         dnet_time *data_ts);
+	         dnet_time *data_ts,
+	         uint64_t *data_size = nullptr);
 
 	int write(const dnet_id &id, const char *data, size_t size, uint64_t user_flags, const dnet_time &timestamp);
 	int write(const dnet_id &id,
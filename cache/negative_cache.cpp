@@ -0,0 +1,176 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "negative_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <kora/config.hpp>
+
+#include "example/config.hpp"
+#include "library/murmurhash.h"
+
+namespace ioremap { namespace cache {
+
+static const size_t negative_cache_shards_number = 16;
+
+negative_cache_config negative_cache_config::parse(const kora::config_t &config) {
+	return {/*size*/ config.at<size_t>("size", DNET_DEFAULT_NEGATIVE_CACHE_SIZE),
+	        /*ttl*/ config.at<unsigned>("ttl", DNET_DEFAULT_NEGATIVE_CACHE_TTL_MS)};
+}
+
+size_t negative_cache::raw_id_hash::operator()(const dnet_raw_id &id) const {
+	return MurmurHash64A(reinterpret_cast<const char *>(id.id), sizeof(id.id), 0);
+}
+
+bool negative_cache::raw_id_equal::operator()(const dnet_raw_id &lhs, const dnet_raw_id &rhs) const {
+	return !memcmp(lhs.id, rhs.id, sizeof(lhs.id));
+}
+
+negative_cache::negative_cache(const negative_cache_config &config)
+: m_shard_size(std::max<size_t>(config.size / negative_cache_shards_number, 1))
+, m_ttl(std::chrono::milliseconds(config.ttl))
+, m_shards(new shard[negative_cache_shards_number])
+, m_hits(0)
+, m_misses(0)
+, m_inserts(0)
+, m_invalidations(0)
+, m_evictions(0) {
+	for (size_t i = 0; i < negative_cache_shards_number; ++i) {
+		m_shards[i].generation = 0;
+		m_shards[i].forgotten_generation = 0;
+	}
+}
+
+negative_cache::~negative_cache() {
+}
+
+bool negative_cache::check(const unsigned char *id) {
+	auto &shard = get_shard(id);
+
+	dnet_raw_id key;
+	memcpy(key.id, id, DNET_ID_SIZE);
+
+	std::unique_lock<std::mutex> guard(shard.lock);
+	auto it = shard.entries.find(key);
+	if (it == shard.entries.end()) {
+		++m_misses;
+		return false;
+	}
+
+	if (clock::now() - it->second >= m_ttl) {
+		// stale record in @order will be skipped by insert()
+		shard.entries.erase(it);
+		++m_misses;
+		return false;
+	}
+
+	++m_hits;
+	return true;
+}
+
+uint64_t negative_cache::generation(const unsigned char *id) {
+	auto &shard = get_shard(id);
+	std::unique_lock<std::mutex> guard(shard.lock);
+	return shard.generation;
+}
+
+void negative_cache::insert(const unsigned char *id, uint64_t generation) {
+	auto &shard = get_shard(id);
+
+	dnet_raw_id key;
+	memcpy(key.id, id, DNET_ID_SIZE);
+
+	const auto now = clock::now();
+
+	std::unique_lock<std::mutex> guard(shard.lock);
+	// key could have been written while the backend was looking for it
+	if (generation < shard.forgotten_generation)
+		return;
+	auto tombstone = shard.tombstones.find(key);
+	if (tombstone != shard.tombstones.end() && tombstone->second > generation)
+		return;
+
+	while (!shard.order.empty() && (shard.entries.size() >= m_shard_size || shard.order.size() > 2 * m_shard_size)) {
+		const auto &oldest = shard.order.front();
+		auto it = shard.entries.find(oldest.first);
+		// the entry could have been invalidated or re-inserted after this record was queued
+		if (it != shard.entries.end() && it->second == oldest.second) {
+			shard.entries.erase(it);
+			++m_evictions;
+		}
+		shard.order.pop_front();
+	}
+
+	shard.entries[key] = now;
+	shard.order.emplace_back(key, now);
+	++m_inserts;
+}
+
+void negative_cache::invalidate(const unsigned char *id) {
+	auto &shard = get_shard(id);
+
+	dnet_raw_id key;
+	memcpy(key.id, id, DNET_ID_SIZE);
+
+	std::unique_lock<std::mutex> guard(shard.lock);
+	const uint64_t generation = ++shard.generation;
+	if (shard.entries.erase(key))
+		++m_invalidations;
+
+	shard.tombstones[key] = generation;
+	shard.tombstones_order.emplace_back(key, generation);
+	while (shard.tombstones_order.size() > m_shard_size) {
+		const auto &oldest = shard.tombstones_order.front();
+		auto it = shard.tombstones.find(oldest.first);
+		// the key could have been invalidated again after this tombstone was queued
+		if (it != shard.tombstones.end() && it->second == oldest.second)
+			shard.tombstones.erase(it);
+		shard.forgotten_generation = oldest.second;
+		shard.tombstones_order.pop_front();
+	}
+}
+
+void negative_cache::statistics(ioremap::monitor::json_writer &writer) const {
+	using ioremap::monitor::write_member;
+
+	size_t size = 0;
+	for (size_t i = 0; i < negative_cache_shards_number; ++i) {
+		std::unique_lock<std::mutex> guard(m_shards[i].lock);
+		size += m_shards[i].entries.size();
+	}
+
+	writer.StartObject();
+	write_member(writer, "size", size);
+	write_member(writer, "max_size", m_shard_size * negative_cache_shards_number);
+	write_member(writer, "ttl", uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(m_ttl).count()));
+	write_member(writer, "hits", m_hits.load());
+	write_member(writer, "misses", m_misses.load());
+	write_member(writer, "inserts", m_inserts.load());
+	write_member(writer, "invalidations", m_invalidations.load());
+	write_member(writer, "evictions", m_evictions.load());
+	writer.EndObject();
+}
+
+negative_cache::shard &negative_cache::get_shard(const unsigned char *id) {
+	size_t i = *(size_t *)id;
+	size_t j = *(size_t *)(id + DNET_ID_SIZE - sizeof(size_t));
+	return m_shards[(i ^ j) % negative_cache_shards_number];
+}
+
+}} /* namespace ioremap::cache */
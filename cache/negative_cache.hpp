@@ -0,0 +1,105 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_NEGATIVE_CACHE_HPP
+#define CACHE_NEGATIVE_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "elliptics/packet.h"
+
+#include "monitor/json_writer.hpp"
+
+namespace ioremap { namespace cache {
+
+struct negative_cache_config;
+
+/*
+ * negative_cache remembers keys which were recently not found in the backend, so repeated
+ * reads and lookups of missing keys are answered with -ENOENT without touching the backend.
+ * Entries expire after configured ttl, are evicted in FIFO order when the cache is full
+ * and are dropped by any write to the key. Every write leaves a tombstone for the key,
+ * so a lookup which raced with the write doesn't bring the key back while lookups of other keys do.
+ */
+class negative_cache {
+public:
+	explicit negative_cache(const negative_cache_config &config);
+	~negative_cache();
+
+	// returns true if @id was recently found missing and its entry is not expired yet
+	bool check(const unsigned char *id);
+
+	// returns current generation of @id's shard which should be passed to insert()
+	uint64_t generation(const unsigned char *id);
+
+	// remembers @id as missing unless @id was invalidated since @generation was taken
+	void insert(const unsigned char *id, uint64_t generation);
+
+	// forgets @id, should be called before any write to @id
+	void invalidate(const unsigned char *id);
+
+	void statistics(ioremap::monitor::json_writer &writer) const;
+
+private:
+	typedef std::chrono::steady_clock clock;
+
+	struct raw_id_hash {
+		size_t operator()(const dnet_raw_id &id) const;
+	};
+
+	struct raw_id_equal {
+		bool operator()(const dnet_raw_id &lhs, const dnet_raw_id &rhs) const;
+	};
+
+	struct shard {
+		std::mutex lock;
+		// key -> time when entry was inserted
+		std::unordered_map<dnet_raw_id, clock::time_point, raw_id_hash, raw_id_equal> entries;
+		// keys in insertion order, used for eviction of the oldest entries
+		std::deque<std::pair<dnet_raw_id, clock::time_point>> order;
+		// incremented on every invalidation
+		uint64_t generation;
+		// key -> generation of its last invalidation, only the last invalidations of the shard are kept
+		std::unordered_map<dnet_raw_id, uint64_t, raw_id_hash, raw_id_equal> tombstones;
+		// tombstones in invalidation order, used for forgetting the oldest ones
+		std::deque<std::pair<dnet_raw_id, uint64_t>> tombstones_order;
+		// generation of the latest forgotten tombstone, inserts taken before it are dropped
+		// since their key could have been invalidated by that tombstone
+		uint64_t forgotten_generation;
+	};
+
+	shard &get_shard(const unsigned char *id);
+
+	const size_t m_shard_size;
+	const clock::duration m_ttl;
+	std::unique_ptr<shard[]> m_shards;
+
+	std::atomic<uint64_t> m_hits;
+	std::atomic<uint64_t> m_misses;
+	std::atomic<uint64_t> m_inserts;
+	std::atomic<uint64_t> m_invalidations;
+	std::atomic<uint64_t> m_evictions;
+};
+
+}} /* namespace ioremap::cache */
+
+#endif // CACHE_NEGATIVE_CACHE_HPP
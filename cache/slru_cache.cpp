@@ -20,6 +20,7 @@
 
 #include "slru_cache.hpp"
 
+#include <algorithm>
 #include <deque>
 
 #include <blackhole/attribute.hpp>
@@ -29,6 +30,7 @@
 #include "library/protocol.hpp"
 
 #include "monitor/measure_points.h"
+#include "example/config.hpp"
 #include "local_session.h"
 
 // Cache implementation is moderately instrumented with statistics gathering
@@ -55,7 +57,7 @@ namespace ioremap { namespace cache {
 slru_cache_t::slru_cache_t(struct dnet_node *n,
                            dnet_backend &backend,
                            const std::vector<size_t> &cache_pages_max_sizes,
-                           unsigned sync_timeout,
+                           const cache_config &config,
                            bool &need_exit)
 : m_backend(backend)
 , m_node(n)
@@ -64,8 +66,25 @@ slru_cache_t::slru_cache_t(struct dnet_node *n,
 , m_cache_pages_sizes(m_cache_pages_number, 0)
 , m_cache_pages_lru(new lru_list_t[m_cache_pages_number])
 , m_clear_occured(false)
-, m_sync_timeout(sync_timeout)
+, m_sync_timeout(config.sync_timeout)
+, m_sync_batch_size(std::max<size_t>(config.sync_batch_size, 1))
+, m_sync_threads(std::max<size_t>(config.sync_threads, 1))
+, m_sync_rate_limit(config.sync_rate_limit)
+, m_sync_pending(0)
+, m_sync_lag(0)
+, m_sync_round_job(nullptr)
+, m_sync_round(0)
+, m_sync_round_threads(0)
+, m_sync_active(0)
+, m_sync_workers_stop(false)
+, m_metadata(config.metadata)
+, m_compressor(config)
 , m_need_exit{need_exit} {
+	// the life-check thread flushes batches itself, so it needs sync_threads - 1 helpers
+	m_sync_workers.reserve(m_sync_threads - 1);
+	for (size_t i = 1; i < m_sync_threads; ++i) {
+		m_sync_workers.emplace_back(std::bind(&slru_cache_t::sync_worker, this, i));
+	}
 	m_lifecheck = std::thread(std::bind(&slru_cache_t::life_check, this));
 }
 
@@ -73,6 +92,7 @@ slru_cache_t::~slru_cache_t() {
 	TIMER_SCOPE("dtor");
 	DNET_LOG_NOTICE(m_node, "cache: disable: backend: {}: destructing SLRU cache", m_backend.backend_id());
 	m_lifecheck.join();
+	stop_sync_workers();
 	DNET_LOG_NOTICE(m_node, "cache: disable: backend: {}: clearing", m_backend.backend_id());
 	clear();
 	DNET_LOG_NOTICE(m_node, "cache: disable: backend: {}: destructed", m_backend.backend_id());
@@ -92,6 +112,16 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 	const bool update_data = (request.ioflags & DNET_IO_FLAGS_PREPARE) || request.data.size();
 	const bool update_json = (request.ioflags & (DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_UPDATE_JSON)) || request.json.size();
 
+	/*
+	 * If compression is enabled, data of cached object is never modified in place: new data is built
+	 * and compressed without the lock and replaces the old one. Data overwritten entirely doesn't depend
+	 * on the cached one, so it is prepared even before the lock is taken.
+	 */
+	prepared_data prepared;
+	if (m_compressor.enabled() && update_data && !append && request.data_offset == 0) {
+		prepared = prepare_data(nullptr, false, 0, request);
+	}
+
 	TIMER_START("write.lock");
 	elliptics_unique_lock<std::mutex> guard(m_lock, m_node, "%s: CACHE WRITE: %p", dnet_dump_id_str(id), this);
 	TIMER_STOP("write.lock");
@@ -100,6 +130,15 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 	data_t* it = m_treap.find(id);
 	TIMER_STOP("write.find");
 
+	it = validate(guard, it);
+
+	if (it && it->metadata_only()) {
+		// object cached without data can't be modified in place, so it is dropped and
+		// the write is handled as for the object which isn't cached
+		erase_element(it);
+		it = nullptr;
+	}
+
 	if (!it && !cache) {
 		DNET_LOG_DEBUG(m_node, "{}: CACHE: not a cache call", dnet_dump_id_str(id));
 		return write_response_t{write_status::ERROR, -ENOTSUP, cache_item()};
@@ -111,15 +150,9 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 		sync_after_append(guard, false, &*it);
 
 		dnet_cmd_stats stats;
-		const auto &callbacks = m_backend.callbacks();
-		int err = callbacks.command_handler(st,
-		                                    callbacks.command_private,
-		                                    cmd,
-		                                    request.request_data,
-		                                    &stats,
-		                                    context);
+		int err = dnet_backend_process_cmd_raw(&m_backend, st, cmd, request.request_data, &stats, context);
 
-		it = populate_from_disk(guard, id, false, &err);
+		it = populate_from_disk(guard, id, false, false, &err);
 
 		return write_response_t{write_status::HANDLED_IN_BACKEND, err, it->get_cache_item()};
 	}
@@ -130,7 +163,7 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 		// If file not found and CACHE_ONLY flag is not set - fallback to backend request
 		if (!cache_only && request.data_offset != 0) {
 			int err = 0;
-			it = populate_from_disk(guard, id, remove_from_disk, &err);
+			it = populate_from_disk(guard, id, remove_from_disk, false, &err);
 			new_page = true;
 
 			if (err != 0 && err != -ENOENT)
@@ -154,7 +187,26 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 
 	DNET_LOG_DEBUG(m_node, "{}: CACHE: CAS checked", dnet_dump_id_str(id));
 
-	auto raw = it->data();
+	// objects which are only appended are synced by appends and are never compressed
+	if (!update_data || it->only_append()) {
+		prepared = prepared_data{};
+	} else if (!prepared.data && (m_compressor.enabled() || it->compressed())) {
+		// cached data is pinned while the lock is released, since it is never modified in place
+		// the same data after relock means the object wasn't written meanwhile
+		const auto base = it->data();
+		const bool base_compressed = it->compressed();
+		const uint64_t base_size = it->data_size();
+
+		guard.unlock();
+		prepared = prepare_data(base, base_compressed, base_size, request);
+		guard.lock();
+
+		it = m_treap.find(id);
+		if (!it || it->data() != base) {
+			guard.unlock();
+			return write(st, cmd, request, context);
+		}
+	}
 
 	const size_t new_json_size = [&] () -> size_t {
 		if (update_json) {
@@ -166,9 +218,9 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 
 	const size_t new_data_size = [&] () -> size_t {
 		if (!update_data) {
-			return raw->size();
+			return it->data_size();
 		} else if (append) {
-			return raw->size() + request.data.size();
+			return it->data_size() + request.data.size();
 		} else {
 			return request.data_offset + request.data.size();
 		}
@@ -206,7 +258,10 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 		}
 	}
 
-	if (update_data) {
+	if (prepared.data) {
+		set_prepared_data(it, std::move(prepared));
+	} else if (update_data) {
+		auto raw = it->data();
 		if (append) {
 			raw->append(reinterpret_cast<char *>(request.data.data()), request.data.size());
 		} else {
@@ -216,6 +271,7 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 		}
 	}
 	TIMER_STOP("write.modify");
+
 	m_cache_stats.size_of_objects += it->size();
 
 	it->set_remove_from_cache(false);
@@ -247,7 +303,7 @@ write_response_t slru_cache_t::write(dnet_net_state *st,
 	return write_response_t{write_status::HANDLED_IN_CACHE, 0, it->get_cache_item()};
 }
 
-read_response_t slru_cache_t::read(const unsigned char *id, uint64_t ioflags) {
+read_response_t slru_cache_t::read(const unsigned char *id, uint64_t ioflags, bool json_only) {
 	TIMER_SCOPE("read");
 
 	const bool cache = (ioflags & DNET_IO_FLAGS_CACHE);
@@ -264,13 +320,25 @@ read_response_t slru_cache_t::read(const unsigned char *id, uint64_t ioflags) {
 	auto it = m_treap.find(id);
 	TIMER_STOP("read.find");
 
+	it = validate(guard, it);
+
 	if (it && it->only_append()) {
 		sync_after_append(guard, true, &*it);
 		it = nullptr;
 	}
 
+	if (it && it->metadata_only() && !json_only) {
+		// data is not cached, it will be read from the backend
+		if (!cache || cache_only) {
+			return read_response_t{cache ? -ENOENT : -ENOTSUP, cache_item()};
+		}
+
+		erase_element(it);
+		it = nullptr;
+	}
+
 	if (!it && cache && !cache_only) {
-		it = populate_from_disk(guard, id, false, &err);
+		it = populate_from_disk(guard, id, false, json_only && m_metadata, &err);
 		new_page = true;
 	}
 
@@ -288,7 +356,16 @@ read_response_t slru_cache_t::read(const unsigned char *id, uint64_t ioflags) {
 		}
 
 		move_data_between_pages(id, page_number, new_page_number, &*it);
-		return read_response_t{0, it->get_cache_item()};
+
+		auto item = it->get_cache_item();
+		guard.unlock();
+
+		if (item.compressed && !json_only) {
+			TIMER_SCOPE("read.decompress");
+			item.data = m_compressor.decompress(*item.data, item.data_size);
+			item.compressed = false;
+		}
+		return read_response_t{0, item};
 	}
 
 	if (!err) {
@@ -383,7 +460,7 @@ int slru_cache_t::remove(const dnet_cmd *cmd,
 	return err;
 }
 
-read_response_t slru_cache_t::lookup(const unsigned char *id) {
+read_response_t slru_cache_t::lookup(const unsigned char *id, bool populate) {
 	TIMER_SCOPE("lookup");
 
 	TIMER_START("lookup.lock");
@@ -394,6 +471,14 @@ read_response_t slru_cache_t::lookup(const unsigned char *id) {
 	data_t* it = m_treap.find(id);
 	TIMER_STOP("lookup.find");
 
+	it = validate(guard, it);
+
+	if (!it && populate && m_metadata) {
+		// errors are ignored here, lookup will be handled by the backend
+		int err = 0;
+		it = populate_from_disk(guard, id, false, true, &err);
+	}
+
 	if (it) {
 		return read_response_t{0, it->get_cache_item()};
 	}
@@ -431,9 +516,161 @@ void slru_cache_t::clear() {
 cache_stats slru_cache_t::get_cache_stats() const {
 	m_cache_stats.pages_sizes = m_cache_pages_sizes;
 	m_cache_stats.pages_max_sizes = m_cache_pages_max_sizes;
+	m_cache_stats.number_of_objects_to_sync = m_sync_pending;
+	m_cache_stats.sync_lag = m_sync_lag;
 	return m_cache_stats;
 }
 
+namespace {
+// object referenced by the snapshot, its json and data are copied after the shard is unlocked
+struct snapshot_item {
+	snapshot_record record;
+	std::shared_ptr<std::string> json;
+	std::shared_ptr<std::string> data;
+	bool compressed;
+	size_t data_size;
+};
+} /* namespace */
+
+void slru_cache_t::snapshot(std::vector<snapshot_record> &records, bool with_data) {
+	TIMER_SCOPE("snapshot");
+
+	std::vector<snapshot_item> items;
+
+	{
+		elliptics_unique_lock<std::mutex> guard(m_lock, m_node, "CACHE SNAPSHOT: %p", this);
+
+		items.reserve(m_cache_stats.number_of_objects);
+		for (size_t page_number = 0; page_number < m_cache_pages_number; ++page_number) {
+			// lru list is iterated from the least recently used object, so restore() recreates the same order
+			for (const data_t &obj : m_cache_pages_lru[page_number]) {
+				// objects cached without data are cheap to repopulate and aren't worth restoring
+				if (obj.only_append() || obj.remove_from_cache() || obj.metadata_only())
+					continue;
+
+				snapshot_item item;
+				item.record.id = obj.id();
+				item.record.timestamp = obj.timestamp();
+				item.record.json_timestamp = obj.json_timestamp();
+				item.record.user_flags = obj.user_flags();
+				item.record.lifetime = obj.lifetime();
+				item.record.page_number = page_number;
+				item.record.has_data = with_data;
+				if (with_data) {
+					item.json = obj.json();
+					item.data = obj.data();
+					item.compressed = obj.compressed();
+					item.data_size = obj.data_size();
+				}
+
+				items.emplace_back(std::move(item));
+			}
+		}
+	}
+
+	auto pool = m_backend.io_pool();
+
+	dnet_id id;
+	memset(&id, 0, sizeof(id));
+
+	records.reserve(records.size() + items.size());
+	for (auto &item : items) {
+		if (with_data) {
+			// writes modify json and uncompressed data in place holding the key's oplock,
+			// so they are copied under it as sync_batch() does
+			memcpy(id.id, item.record.id.id, DNET_ID_SIZE);
+			if (pool)
+				dnet_oplock(pool, &id);
+
+			item.record.json = *item.json;
+			if (!item.compressed)
+				item.record.data = *item.data;
+
+			if (pool)
+				dnet_opunlock(pool, &id);
+
+			// compressed data is replaced on modification, not changed in place
+			if (item.compressed)
+				item.record.data = *m_compressor.decompress(*item.data, item.data_size);
+		}
+
+		records.emplace_back(std::move(item.record));
+	}
+}
+
+bool slru_cache_t::restore(snapshot_record &record) {
+	TIMER_SCOPE("restore");
+
+	const unsigned char *id = record.id.id;
+	const size_t page_number = std::min(record.page_number, m_cache_pages_number - 1);
+
+	if (record.lifetime && record.lifetime <= size_t(time(nullptr)))
+		return false;
+
+	if (!record.has_data) {
+		dnet_id raw;
+		memset(&raw, 0, sizeof(raw));
+		memcpy(raw.id, id, DNET_ID_SIZE);
+
+		// the same key can be written directly to the backend while it is read by populate_from_disk()
+		dnet_oplock_guard oplock(m_backend.io_pool(), &raw);
+
+		elliptics_unique_lock<std::mutex> guard(m_lock, m_node, "%s: CACHE RESTORE: %p", dnet_dump_id_str(id), this);
+		if (m_treap.find(id) || m_cache_pages_sizes[page_number] >= m_cache_pages_max_sizes[page_number])
+			return false;
+
+		int err = 0;
+		data_t *it = populate_from_disk(guard, id, false, false, &err);
+		if (!it)
+			return false;
+
+		move_data_between_pages(id, it->cache_page_number(), page_number, it);
+
+		if (record.lifetime && !it->lifetime()) {
+			const size_t previous_eventtime = it->eventtime();
+			it->set_lifetime(record.lifetime);
+			if (previous_eventtime != it->eventtime()) {
+				m_treap.decrease_key(it);
+			}
+		}
+		return true;
+	}
+
+	std::string compressed;
+	const bool is_compressed = m_compressor.compress(record.data.data(), record.data.size(), compressed);
+	const std::string &data = is_compressed ? compressed : record.data;
+
+	elliptics_unique_lock<std::mutex> guard(m_lock, m_node, "%s: CACHE RESTORE: %p", dnet_dump_id_str(id), this);
+
+	const size_t size = record.json.size() + data.size() + sizeof(data_t);
+	if (m_treap.find(id) || m_cache_pages_sizes[page_number] + size > m_cache_pages_max_sizes[page_number])
+		return false;
+
+	data_t *raw = new data_t(id, 0, ioremap::elliptics::data_pointer{}, ioremap::elliptics::data_pointer{}, false);
+	raw->json()->swap(record.json);
+	if (is_compressed) {
+		raw->set_compressed(std::make_shared<std::string>(std::move(compressed)), record.data.size());
+		m_cache_stats.number_of_compressed_objects++;
+		m_cache_stats.size_of_compressed_objects += raw->data()->size();
+		m_cache_stats.raw_size_of_compressed_objects += raw->data_size();
+	} else {
+		raw->data()->swap(record.data);
+	}
+	raw->set_user_flags(record.user_flags);
+	raw->set_timestamp(record.timestamp);
+	raw->set_json_timestamp(record.json_timestamp);
+	raw->set_lifetime(record.lifetime);
+	// the backend could have been modified since the snapshot was written
+	raw->set_need_validation(true);
+
+	insert_data_into_page(id, page_number, raw);
+
+	m_cache_stats.number_of_objects++;
+	m_cache_stats.size_of_objects += raw->size();
+	m_treap.insert(raw);
+	return true;
+}
+
 // private:
 
 bool slru_cache_t::need_exit() const {
@@ -441,6 +678,110 @@ bool slru_cache_t::need_exit() const {
 }
 
 
+data_t *slru_cache_t::validate(elliptics_unique_lock<std::mutex> &guard, data_t *it) {
+	if (!it || !it->need_validation())
+		return it;
+
+	TIMER_SCOPE("validate");
+
+	dnet_id id;
+	memset(&id, 0, sizeof(id));
+	memcpy(id.id, it->id().id, DNET_ID_SIZE);
+
+	const dnet_time timestamp = it->timestamp();
+	const dnet_time json_timestamp = it->json_timestamp();
+
+	guard.unlock();
+
+	local_session sess(m_backend, m_node);
+	sess.set_ioflags(DNET_IO_FLAGS_NOCACHE);
+
+	dnet_time disk_timestamp, disk_json_timestamp;
+	dnet_empty_time(&disk_timestamp);
+	dnet_empty_time(&disk_json_timestamp);
+	ioremap::elliptics::data_pointer json;
+
+	TIMER_START("validate.local_read");
+	const int err = sess.read(id, nullptr, &json, &disk_json_timestamp, nullptr, &disk_timestamp);
+	TIMER_STOP("validate.local_read");
+
+	guard.lock();
+
+	// object could have been removed or validated by somebody else while the lock was released
+	it = m_treap.find(id.id);
+	if (!it || !it->need_validation())
+		return it;
+
+	if (err || dnet_time_cmp(&timestamp, &disk_timestamp) || dnet_time_cmp(&json_timestamp, &disk_json_timestamp)) {
+		DNET_LOG_NOTICE(m_node, "{}: CACHE: dropping outdated object restored from snapshot, err: {}",
+		                dnet_dump_id_str(id.id), err);
+		erase_element(it);
+		return nullptr;
+	}
+
+	it->set_need_validation(false);
+	return it;
+}
+
+slru_cache_t::prepared_data slru_cache_t::prepare_data(const std::shared_ptr<std::string> &base,
+                                                       bool base_compressed,
+                                                       uint64_t base_size,
+                                                       const write_request &request) const {
+	TIMER_SCOPE("prepare_data");
+
+	std::string raw;
+	if (base && base_compressed) {
+		TIMER_SCOPE("prepare_data.decompress");
+		raw = std::move(*m_compressor.decompress(*base, base_size));
+	} else if (base) {
+		raw = *base;
+	}
+
+	if (request.ioflags & DNET_IO_FLAGS_APPEND) {
+		raw.append(reinterpret_cast<char *>(request.data.data()), request.data.size());
+	} else {
+		raw.resize(request.data_offset + request.data.size());
+		raw.replace(request.data_offset, std::string::npos,
+		            reinterpret_cast<char *>(request.data.data()), request.data.size());
+	}
+
+	prepared_data prepared;
+	prepared.data_size = raw.size();
+
+	TIMER_START("prepare_data.compress");
+	std::string compressed;
+	prepared.compressed = m_compressor.compress(raw.data(), raw.size(), compressed);
+	TIMER_STOP("prepare_data.compress");
+
+	prepared.data = std::make_shared<std::string>(std::move(prepared.compressed ? compressed : raw));
+	return prepared;
+}
+
+void slru_cache_t::set_prepared_data(data_t *it, prepared_data &&prepared) {
+	if (it->compressed()) {
+		m_cache_stats.number_of_compressed_objects--;
+		m_cache_stats.size_of_compressed_objects -= it->data()->size();
+		m_cache_stats.raw_size_of_compressed_objects -= it->data_size();
+	}
+
+	if (!prepared.compressed) {
+		it->set_decompressed(std::move(prepared.data));
+		return;
+	}
+
+	it->set_compressed(std::move(prepared.data), prepared.data_size);
+
+	m_cache_stats.number_of_compressed_objects++;
+	m_cache_stats.size_of_compressed_objects += it->data()->size();
+	m_cache_stats.raw_size_of_compressed_objects += it->data_size();
+}
+
+std::shared_ptr<std::string> slru_cache_t::raw_data(const data_t *it) const {
+	if (!it->compressed())
+		return it->data();
+	return m_compressor.decompress(*it->data(), it->data_size());
+}
+
 int slru_cache_t::check_cas(const data_t* it, const dnet_cmd *cmd, const write_request &request) const {
 	auto raw = it->data();
 
@@ -455,6 +796,10 @@ int slru_cache_t::check_cas(const data_t* it, const dnet_cmd *cmd, const write_r
 		// Data is already in memory, so it's free to use it
 		// raw.size() is zero only if there is no such file on the server
 		if (raw->size() != 0) {
+			if (it->compressed()) {
+				raw = m_compressor.decompress(*raw, it->data_size());
+			}
+
 			struct dnet_raw_id csum;
 			dnet_transform_node(m_node, raw->data(), raw->size(), csum.id, sizeof(csum.id));
 
@@ -512,7 +857,7 @@ void slru_cache_t::sync_if_required(data_t* it, elliptics_unique_lock<std::mutex
 		uint64_t user_flags = it->user_flags();
 		auto json = it->json();
 		const auto &json_timestamp = it->json_timestamp();
-		auto data = it->data();
+		auto data = raw_data(it);
 		const auto &timestamp = it->timestamp();
 
 		guard.unlock();
@@ -588,6 +933,7 @@ data_t *slru_cache_t::create_data(const unsigned char *id,
 data_t *slru_cache_t::populate_from_disk(elliptics_unique_lock<std::mutex> &guard,
                                          const unsigned char *id,
                                          bool remove_from_disk,
+                                         bool metadata_only,
                                          int *err) {
 	TIMER_SCOPE("populate_from_disk");
 
@@ -602,20 +948,31 @@ data_t *slru_cache_t::populate_from_disk(elliptics_unique_lock<std::mutex> &guar
 	memcpy(raw_id.id, id, DNET_ID_SIZE);
 
 	uint64_t user_flags = 0;
+	uint64_t data_size = 0;
 	dnet_time json_ts, data_ts;
 	dnet_empty_time(&json_ts);
 	dnet_empty_time(&data_ts);
 	ioremap::elliptics::data_pointer json, data;
 
 	TIMER_START("populate_from_disk.local_read");
-	*err = sess.read(raw_id, &user_flags, &json, &json_ts, &data, &data_ts);
+	*err = sess.read(raw_id, &user_flags, &json, &json_ts, metadata_only ? nullptr : &data, &data_ts, &data_size);
 	TIMER_STOP("populate_from_disk.local_read");
 
+	std::string compressed;
+	const bool is_compressed = !*err && !metadata_only &&
+	                           m_compressor.compress(data.data<char>(), data.size(), compressed);
+
 	TIMER_START("populate_from_disk.lock");
 	guard.lock();
 	TIMER_STOP("populate_from_disk.lock");
 	{
 		auto it = m_treap.find(id);
+		if (it && it->metadata_only() && !metadata_only) {
+			// object cached without data was populated while sess.read(), replace it by the full one
+			erase_element(it);
+			it = nullptr;
+		}
+
 		if (it) {
 			// some data for @id was written while sess.read().
 			if (!it->only_append()) {
@@ -634,11 +991,24 @@ data_t *slru_cache_t::populate_from_disk(elliptics_unique_lock<std::mutex> &guar
 	}
 
 	if (*err == 0) {
-		auto it = create_data(id, json, data, remove_from_disk);
+		auto it = create_data(id, json, is_compressed ? ioremap::elliptics::data_pointer::from_raw(compressed) : data,
+		                      remove_from_disk);
 		it->set_user_flags(user_flags);
 		it->set_json_timestamp(json_ts);
 		it->set_timestamp(data_ts);
 
+		if (metadata_only) {
+			it->set_metadata_only(data_size);
+			m_cache_stats.number_of_metadata_objects++;
+		}
+
+		if (is_compressed) {
+			it->set_compressed(it->data(), data.size());
+			m_cache_stats.number_of_compressed_objects++;
+			m_cache_stats.size_of_compressed_objects += it->data()->size();
+			m_cache_stats.raw_size_of_compressed_objects += it->data_size();
+		}
+
 		return it;
 	}
 
@@ -715,6 +1085,16 @@ void slru_cache_t::erase_element(data_t *obj) {
 		obj->clear_synctime();
 	}
 
+	if (obj->metadata_only()) {
+		m_cache_stats.number_of_metadata_objects--;
+	}
+
+	if (obj->compressed()) {
+		m_cache_stats.number_of_compressed_objects--;
+		m_cache_stats.size_of_compressed_objects -= obj->data()->size();
+		m_cache_stats.raw_size_of_compressed_objects -= obj->data_size();
+	}
+
 	if (obj->remove_from_cache()) {
 		m_cache_stats.number_of_objects_marked_for_deletion--;
 		m_cache_stats.size_of_objects_marked_for_deletion -= obj->size();
@@ -730,9 +1110,20 @@ void slru_cache_t::sync_element(const dnet_id &raw,
                                 const dnet_time &json_ts,
                                 const std::string &data,
                                 const dnet_time &data_ts) {
+	local_session sess(m_backend, m_node);
+	sync_element(sess, raw, after_append, user_flags, json, json_ts, data, data_ts);
+}
+
+void slru_cache_t::sync_element(local_session &sess,
+                                const dnet_id &raw,
+                                bool after_append,
+                                uint64_t user_flags,
+                                const std::string &json,
+                                const dnet_time &json_ts,
+                                const std::string &data,
+                                const dnet_time &data_ts) {
 	HANDY_TIMER_SCOPE("slru_cache.sync_element");
 
-	local_session sess(m_backend, m_node);
 	sess.set_ioflags(DNET_IO_FLAGS_NOCACHE | (after_append ? DNET_IO_FLAGS_APPEND : 0));
 
 	int err = sess.write(raw, user_flags, json, json_ts, data, data_ts);
@@ -745,10 +1136,157 @@ void slru_cache_t::sync_element(data_t *obj) {
 	memset(&raw, 0, sizeof(struct dnet_id));
 	memcpy(raw.id, obj->id().id, DNET_ID_SIZE);
 
-	sync_element(raw, obj->only_append(), obj->user_flags(), *obj->json(), obj->json_timestamp(), *obj->data(),
+	sync_element(raw, obj->only_append(), obj->user_flags(), *obj->json(), obj->json_timestamp(), *raw_data(obj),
 	             obj->timestamp());
 }
 
+size_t slru_cache_t::sync_batch(local_session &sess,
+                                std::vector<data_t *>::const_iterator begin,
+                                std::vector<data_t *>::const_iterator end) {
+	TIMER_SCOPE("life_check.sync_iterate.batch");
+
+	auto pool = m_backend.io_pool();
+	size_t synced_bytes = 0;
+
+	dnet_id id;
+	memset(&id, 0, sizeof(id));
+
+	for (auto it = begin; it != end; ++it) {
+		data_t *elem = *it;
+		memcpy(id.id, elem->id().id, DNET_ID_SIZE);
+
+		TIMER_START("life_check.sync_iterate.dnet_oplock");
+		dnet_oplock(pool, &id);
+		TIMER_STOP("life_check.sync_iterate.dnet_oplock");
+
+		// sync_element uses local_session which always uses DNET_FLAGS_NOLOCK
+		if (elem->is_syncing()) {
+			sync_element(sess, id, elem->only_append(), elem->user_flags(), *elem->json(),
+			             elem->json_timestamp(), *raw_data(elem), elem->timestamp());
+			synced_bytes += elem->size();
+			elem->set_sync_state(data_t::sync_state_t::ERASE_PHASE);
+		}
+
+		dnet_opunlock(pool, &id);
+	}
+
+	return synced_bytes;
+}
+
+void slru_cache_t::sync_elements(std::vector<data_t *> &elements) {
+	if (elements.empty())
+		return;
+
+	// Flush dirty records in key order, so the backend receives neighbouring keys one after another
+	std::sort(elements.begin(), elements.end(), [] (const data_t *lhs, const data_t *rhs) {
+		return *lhs < *rhs;
+	});
+
+	const size_t batches_number = (elements.size() + m_sync_batch_size - 1) / m_sync_batch_size;
+	const size_t threads_number = std::min(m_sync_threads, batches_number);
+	const auto start = std::chrono::steady_clock::now();
+
+	std::atomic_size_t next_batch(0);
+	std::atomic_size_t synced_bytes(0);
+
+	const std::function<void ()> flush = [&] () {
+		local_session sess(m_backend, m_node);
+
+		for (size_t batch = next_batch++; batch < batches_number; batch = next_batch++) {
+			if (m_clear_occured)
+				break;
+
+			const auto begin = elements.cbegin() + batch * m_sync_batch_size;
+			const auto end = elements.cbegin() + std::min(elements.size(), (batch + 1) * m_sync_batch_size);
+
+			synced_bytes += sync_batch(sess, begin, end);
+			m_sync_pending -= std::distance(begin, end);
+
+			HANDY_GAUGE_SET("slru_cache.life_check.sync_iterate.pending", m_sync_pending.load());
+
+			throttle_sync(start, synced_bytes);
+		}
+	};
+
+	run_sync_round(flush, threads_number);
+
+	DNET_LOG_DEBUG(m_node, "CACHE: flushed {} records in {} batches by {} threads, bytes: {}",
+	               elements.size(), batches_number, threads_number, synced_bytes.load());
+}
+
+void slru_cache_t::run_sync_round(const std::function<void ()> &job, size_t threads_number) {
+	{
+		std::unique_lock<std::mutex> guard(m_sync_workers_lock);
+		m_sync_round_job = &job;
+		// workers are numbered from 1, the calling thread is the first participant
+		m_sync_round_threads = std::min(threads_number, m_sync_workers.size() + 1);
+		m_sync_active = m_sync_round_threads - 1;
+		++m_sync_round;
+	}
+	if (m_sync_active)
+		m_sync_round_started.notify_all();
+
+	job();
+
+	std::unique_lock<std::mutex> guard(m_sync_workers_lock);
+	m_sync_round_finished.wait(guard, [this] () { return m_sync_active == 0; });
+	m_sync_round_job = nullptr;
+}
+
+void slru_cache_t::sync_worker(size_t index) {
+	dnet_set_name("dnet_csync_%zu_%zu", m_backend.backend_id(), index);
+
+	uint64_t round = 0;
+	std::unique_lock<std::mutex> guard(m_sync_workers_lock);
+	while (true) {
+		m_sync_round_started.wait(guard, [&] () { return m_sync_workers_stop || m_sync_round != round; });
+		if (m_sync_workers_stop)
+			break;
+
+		round = m_sync_round;
+		// there are less batches than workers, so this one isn't needed in the round
+		if (index >= m_sync_round_threads)
+			continue;
+
+		const auto job = m_sync_round_job;
+
+		guard.unlock();
+		(*job)();
+		guard.lock();
+
+		if (--m_sync_active == 0)
+			m_sync_round_finished.notify_all();
+	}
+}
+
+void slru_cache_t::stop_sync_workers() {
+	{
+		std::unique_lock<std::mutex> guard(m_sync_workers_lock);
+		m_sync_workers_stop = true;
+	}
+	m_sync_round_started.notify_all();
+
+	for (auto &worker : m_sync_workers) {
+		worker.join();
+	}
+	m_sync_workers.clear();
+}
+
+void slru_cache_t::throttle_sync(const std::chrono::steady_clock::time_point &start, size_t synced_bytes) const {
+	if (!m_sync_rate_limit)
+		return;
+
+	// the time synced_bytes should have taken to be written within sync_rate_limit bytes per second
+	const std::chrono::microseconds expected(synced_bytes * 1000000 / m_sync_rate_limit);
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start);
+
+	if (expected > elapsed) {
+		TIMER_SCOPE("life_check.sync_iterate.throttle");
+		std::this_thread::sleep_for(expected - elapsed);
+	}
+}
+
 void slru_cache_t::sync_after_append(elliptics_unique_lock<std::mutex> &guard, bool lock_guard, data_t *obj) {
 	TIMER_SCOPE("sync_after_append");
 
@@ -791,7 +1329,7 @@ void slru_cache_t::life_check(void) {
 			TIMER_SCOPE("life_check");
 
 			std::deque<struct dnet_id> remove;
-			std::deque<data_t*> elements_for_sync;
+			std::vector<data_t*> elements_for_sync;
 			size_t last_time = 0;
 			dnet_id id;
 			memset(&id, 0, sizeof(id));
@@ -822,6 +1360,10 @@ void slru_cache_t::life_check(void) {
 					}
 					else if (it->eventtime() == it->synctime())
 					{
+						// treap is ordered by eventtime, so the first collected element is the oldest one
+						if (elements_for_sync.empty()) {
+							m_sync_lag = time - it->synctime();
+						}
 						elements_for_sync.push_back(it);
 
 						it->clear_synctime();
@@ -839,26 +1381,12 @@ void slru_cache_t::life_check(void) {
 				TIMER_SCOPE("life_check.sync_iterate");
 				HANDY_GAUGE_SET("slru_cache.life_check.sync_iterate.element_count",
 				                elements_for_sync.size());
-				auto pool = m_backend.io_pool();
-				for (data_t *elem : elements_for_sync) {
-					if (m_clear_occured)
-						break;
-
-					memcpy(id.id, elem->id().id, DNET_ID_SIZE);
-
-					TIMER_START("life_check.sync_iterate.dnet_oplock");
-					dnet_oplock(pool, &id);
-					TIMER_STOP("life_check.sync_iterate.dnet_oplock");
+				HANDY_GAUGE_SET("slru_cache.life_check.sync_lag", m_sync_lag.load());
 
-					// sync_element uses local_session which always uses DNET_FLAGS_NOLOCK
-					if (elem->is_syncing()) {
-						sync_element(id, elem->only_append(), elem->user_flags(), *elem->json(),
-						             elem->json_timestamp(), *elem->data(), elem->timestamp());
-						elem->set_sync_state(data_t::sync_state_t::ERASE_PHASE);
-					}
-
-					dnet_opunlock(pool, &id);
-				}
+				m_sync_pending = elements_for_sync.size();
+				sync_elements(elements_for_sync);
+				m_sync_pending = 0;
+				m_sync_lag = 0;
 			}
 
 			{
@@ -17,20 +17,29 @@
 #ifndef SLRU_CACHE_HPP
 #define SLRU_CACHE_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <thread>
 
 #include "cache.hpp"
+#include "compression.hpp"
+#include "snapshot.hpp"
 
 class dnet_backend;
+class local_session;
 
 namespace ioremap { namespace cache {
 
+struct cache_config;
+
 class slru_cache_t {
 public:
 	slru_cache_t(struct dnet_node *n,
 	             dnet_backend &backend,
 	             const std::vector<size_t> &cache_pages_max_sizes,
-	             unsigned sync_timeout,
+	             const cache_config &config,
 	             bool &need_exit);
 
 	~slru_cache_t();
@@ -40,16 +49,22 @@ public:
 	                       const write_request &request,
 	                       dnet_access_context *context);
 
-	read_response_t read(const unsigned char *id, uint64_t ioflags);
+	read_response_t read(const unsigned char *id, uint64_t ioflags, bool json_only);
 
 	int remove(const dnet_cmd *cmd, ioremap::elliptics::dnet_remove_request &request, dnet_access_context *context);
 
-	read_response_t lookup(const unsigned char *id);
+	read_response_t lookup(const unsigned char *id, bool populate);
 
 	void clear();
 
 	cache_stats get_cache_stats() const;
 
+	// appends records of all cached objects ordered from the hottest page to the coldest one
+	void snapshot(std::vector<snapshot_record> &records, bool with_data);
+
+	// puts object restored from the snapshot into the cache, returns false if it was skipped
+	bool restore(snapshot_record &record);
+
 private:
 	dnet_backend &m_backend;
 	struct dnet_node *m_node;
@@ -63,6 +78,27 @@ private:
 	mutable cache_stats m_cache_stats;
 	bool m_clear_occured;
 	unsigned m_sync_timeout;
+	size_t m_sync_batch_size;
+	size_t m_sync_threads;
+	size_t m_sync_rate_limit;
+	std::atomic_size_t m_sync_pending;
+	std::atomic_size_t m_sync_lag;
+	/*
+	 * Helper threads flushing batches together with the life-check thread. They live as long as the cache and
+	 * run m_sync_round_job when m_sync_round is advanced if their index is below m_sync_round_threads,
+	 * m_sync_active counts those who haven't finished it yet.
+	 */
+	std::vector<std::thread> m_sync_workers;
+	std::mutex m_sync_workers_lock;
+	std::condition_variable m_sync_round_started;
+	std::condition_variable m_sync_round_finished;
+	const std::function<void ()> *m_sync_round_job;
+	uint64_t m_sync_round;
+	size_t m_sync_round_threads;
+	size_t m_sync_active;
+	bool m_sync_workers_stop;
+	bool m_metadata;
+	cache_compressor m_compressor;
 	const bool &m_need_exit;
 
 	slru_cache_t(const slru_cache_t &) = delete;
@@ -80,6 +116,28 @@ private:
 		return page_number + 1;
 	}
 
+	data_t *validate(elliptics_unique_lock<std::mutex> &guard, data_t *it);
+
+	// new data of the object built by write
+	struct prepared_data {
+		std::shared_ptr<std::string> data; // compressed if @compressed is set, nullptr if nothing is prepared
+		bool compressed = false;
+		uint64_t data_size = 0; // size of raw data
+	};
+
+	/*
+	 * Applies data of @request to @base (uncompressed data of @base_size bytes if @base_compressed is set)
+	 * and compresses the result. It is called without the lock, so @base must not be modified meanwhile.
+	 */
+	prepared_data prepare_data(const std::shared_ptr<std::string> &base, bool base_compressed, uint64_t base_size,
+	                           const write_request &request) const;
+
+	// replaces data of the object which is not placed into a page by @prepared
+	void set_prepared_data(data_t *it, prepared_data &&prepared);
+
+	// returns uncompressed data of the object
+	std::shared_ptr<std::string> raw_data(const data_t *it) const;
+
 	int check_cas(const data_t* it, const dnet_cmd *cmd, const write_request &request) const;
 
 	void sync_if_required(data_t* it, elliptics_unique_lock<std::mutex> &guard);
@@ -101,6 +159,7 @@ private:
 	data_t *populate_from_disk(elliptics_unique_lock<std::mutex> &guard,
 	                           const unsigned char *id,
 	                           bool remove_from_disk,
+	                           bool metadata_only,
 	                           int *err);
 
 	bool have_enough_space(const unsigned char *id, size_t page_number, size_t reserve);
@@ -117,8 +176,32 @@ private:
 	                  const std::string &data,
 	                  const dnet_time &data_ts);
 
+	void sync_element(local_session &sess,
+	                  const dnet_id &raw,
+	                  bool after_append,
+	                  uint64_t user_flags,
+	                  const std::string &json,
+	                  const dnet_time &json_ts,
+	                  const std::string &data,
+	                  const dnet_time &data_ts);
+
 	void sync_element(data_t *obj);
 
+	size_t sync_batch(local_session &sess,
+	                  std::vector<data_t *>::const_iterator begin,
+	                  std::vector<data_t *>::const_iterator end);
+
+	void sync_elements(std::vector<data_t *> &elements);
+
+	// runs @job by the calling thread and @threads_number - 1 sync workers, returns when all of them are done
+	void run_sync_round(const std::function<void ()> &job, size_t threads_number);
+
+	void sync_worker(size_t index);
+
+	void stop_sync_workers();
+
+	void throttle_sync(const std::chrono::steady_clock::time_point &start, size_t synced_bytes) const;
+
 	void sync_after_append(elliptics_unique_lock<std::mutex> &guard, bool lock_guard, data_t *obj);
 
 	void life_check(void);
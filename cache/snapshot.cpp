@@ -0,0 +1,264 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "snapshot.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "library/murmurhash.h"
+
+namespace ioremap { namespace cache {
+
+static const char snapshot_magic[8] = {'d', 'n', 'e', 't', 'c', 's', 'n', 'p'};
+static const uint32_t snapshot_version = 2;
+
+static uint64_t record_checksum(uint64_t seed,
+                                const snapshot_record_header &header,
+                                const std::string &json,
+                                const std::string &data) {
+	// checksum field itself is not covered
+	const char *fields = reinterpret_cast<const char *>(&header) + sizeof(header.checksum);
+	uint64_t checksum = MurmurHash64A(fields, sizeof(header) - sizeof(header.checksum), seed);
+	checksum = MurmurHash64A(json.data(), json.size(), checksum);
+	return MurmurHash64A(data.data(), data.size(), checksum);
+}
+
+static int write_all(FILE *file, const void *data, size_t size) {
+	if (size && fwrite(data, size, 1, file) != 1)
+		return errno ? -errno : -EIO;
+	return 0;
+}
+
+static int read_all(FILE *file, void *data, size_t size) {
+	if (size && fread(data, size, 1, file) != 1)
+		return feof(file) ? -ENODATA : (errno ? -errno : -EIO);
+	return 0;
+}
+
+snapshot_writer::snapshot_writer(const std::string &path, bool with_data)
+: m_path(path)
+, m_tmp_path(path + ".tmp")
+, m_with_data(with_data)
+, m_file(nullptr)
+, m_checksum(0)
+, m_records(0) {
+}
+
+snapshot_writer::~snapshot_writer() {
+	if (m_file) {
+		fclose(m_file);
+		unlink(m_tmp_path.c_str());
+	}
+}
+
+int snapshot_writer::open() {
+	m_file = fopen(m_tmp_path.c_str(), "w");
+	if (!m_file)
+		return -errno;
+
+	snapshot_header header;
+	memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+	header.version = snapshot_version;
+	header.flags = m_with_data ? DNET_CACHE_SNAPSHOT_WITH_DATA : 0;
+
+	m_checksum = MurmurHash64A(reinterpret_cast<const char *>(&header), sizeof(header), 0);
+	return write_all(m_file, &header, sizeof(header));
+}
+
+int snapshot_writer::write(const snapshot_record &record) {
+	static const std::string empty;
+	const std::string &json = m_with_data ? record.json : empty;
+	const std::string &data = m_with_data ? record.data : empty;
+
+	snapshot_record_header header;
+	memset(&header, 0, sizeof(header));
+	header.id = record.id;
+	header.timestamp = record.timestamp;
+	header.json_timestamp = record.json_timestamp;
+	header.user_flags = record.user_flags;
+	header.lifetime = record.lifetime;
+	header.page_number = record.page_number;
+	header.json_size = json.size();
+	header.data_size = data.size();
+	header.checksum = m_checksum = record_checksum(m_checksum, header, json, data);
+
+	int err = write_all(m_file, &header, sizeof(header));
+	if (!err)
+		err = write_all(m_file, json.data(), json.size());
+	if (!err)
+		err = write_all(m_file, data.data(), data.size());
+	if (!err)
+		++m_records;
+	return err;
+}
+
+int snapshot_writer::commit() {
+	snapshot_footer footer;
+	memcpy(footer.magic, snapshot_magic, sizeof(footer.magic));
+	footer.records = m_records;
+	footer.checksum = m_checksum;
+
+	int err = write_all(m_file, &footer, sizeof(footer));
+	if (!err && (fflush(m_file) || fsync(fileno(m_file))))
+		err = -errno;
+
+	fclose(m_file);
+	m_file = nullptr;
+
+	if (!err && rename(m_tmp_path.c_str(), m_path.c_str()))
+		err = -errno;
+
+	if (err)
+		unlink(m_tmp_path.c_str());
+	return err;
+}
+
+snapshot_reader::snapshot_reader(const std::string &path)
+: m_path(path)
+, m_with_data(false)
+, m_file(nullptr)
+, m_header_checksum(0)
+, m_checksum(0)
+, m_records(0)
+, m_finished(false)
+, m_size(0)
+, m_remaining(0) {
+}
+
+snapshot_reader::~snapshot_reader() {
+	if (m_file)
+		fclose(m_file);
+}
+
+int snapshot_reader::open() {
+	m_file = fopen(m_path.c_str(), "r");
+	if (!m_file)
+		return -errno;
+
+	struct stat st;
+	if (fstat(fileno(m_file), &st))
+		return -errno;
+
+	snapshot_header header;
+	int err = read_all(m_file, &header, sizeof(header));
+	if (err)
+		return err;
+	m_size = st.st_size;
+
+	if (memcmp(header.magic, snapshot_magic, sizeof(header.magic)) || header.version != snapshot_version)
+		return -EINVAL;
+
+	m_with_data = header.flags & DNET_CACHE_SNAPSHOT_WITH_DATA;
+	m_header_checksum = MurmurHash64A(reinterpret_cast<const char *>(&header), sizeof(header), 0);
+	return rewind();
+}
+
+int snapshot_reader::next(snapshot_record &record) {
+	if (m_finished)
+		return 0;
+
+	// record header is larger than the footer, so the footer is the only thing that fits the tail
+	if (m_remaining == sizeof(snapshot_footer))
+		return read_footer();
+	if (m_remaining < sizeof(snapshot_record_header))
+		return -EILSEQ;
+
+	snapshot_record_header header;
+	int err = read_all(m_file, &header, sizeof(header));
+	if (err)
+		return err;
+	m_remaining -= sizeof(header);
+
+	if (!m_with_data && (header.json_size || header.data_size))
+		return -EILSEQ;
+
+	// sizes aren't covered by the checksum yet, so corrupted ones mustn't make us allocate more than the file has
+	if (header.json_size > m_remaining || header.data_size > m_remaining - header.json_size)
+		return -EILSEQ;
+	m_remaining -= header.json_size + header.data_size;
+
+	try {
+		record.json.resize(header.json_size);
+		record.data.resize(header.data_size);
+	} catch (const std::exception &) {
+		return -ENOMEM;
+	}
+
+	err = read_all(m_file, &record.json[0], record.json.size());
+	if (!err)
+		err = read_all(m_file, &record.data[0], record.data.size());
+	if (err)
+		return err;
+
+	const uint64_t checksum = record_checksum(m_checksum, header, record.json, record.data);
+	if (checksum != header.checksum)
+		return -EILSEQ;
+	m_checksum = checksum;
+	++m_records;
+
+	record.id = header.id;
+	record.timestamp = header.timestamp;
+	record.json_timestamp = header.json_timestamp;
+	record.user_flags = header.user_flags;
+	record.lifetime = header.lifetime;
+	record.page_number = header.page_number;
+	record.has_data = m_with_data;
+	return 1;
+}
+
+int snapshot_reader::validate() {
+	snapshot_record record;
+	int err;
+	while ((err = next(record)) > 0) {
+	}
+
+	if (err)
+		return err;
+	return rewind();
+}
+
+int snapshot_reader::read_footer() {
+	snapshot_footer footer;
+	int err = read_all(m_file, &footer, sizeof(footer));
+	if (err)
+		return err;
+	m_remaining = 0;
+
+	if (memcmp(footer.magic, snapshot_magic, sizeof(footer.magic)) || footer.records != m_records ||
+	    footer.checksum != m_checksum)
+		return -EILSEQ;
+
+	m_finished = true;
+	return 0;
+}
+
+int snapshot_reader::rewind() {
+	if (m_size < sizeof(snapshot_header) || fseek(m_file, sizeof(snapshot_header), SEEK_SET))
+		return -EILSEQ;
+
+	m_checksum = m_header_checksum;
+	m_records = 0;
+	m_finished = false;
+	m_remaining = m_size - sizeof(snapshot_header);
+	return 0;
+}
+
+}} /* namespace ioremap::cache */
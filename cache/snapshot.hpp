@@ -0,0 +1,154 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_SNAPSHOT_HPP
+#define CACHE_SNAPSHOT_HPP
+
+#include <cstdio>
+#include <string>
+
+#include "elliptics/packet.h"
+
+namespace ioremap { namespace cache {
+
+/*
+ * Cache snapshot is a stream of records written one after another:
+ *
+ *   snapshot_header | record_header json data | record_header json data | ... | snapshot_footer
+ *
+ * Every record header carries a checksum of the record (header and payload) seeded by the checksum
+ * of the previous record, so a reader detects corruption of the stream and stops at the last valid record.
+ * The footer is written on commit and keeps the number of records and the checksum of the last one,
+ * a stream without it is truncated. json and data are stored only if snapshot was written with data,
+ * otherwise only keys, timestamps and page numbers are kept and data should be read from the backend.
+ */
+struct snapshot_header {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	flags;
+} __attribute__ ((packed));
+
+enum snapshot_flags {
+	DNET_CACHE_SNAPSHOT_WITH_DATA = 1 << 0,
+};
+
+struct snapshot_record_header {
+	uint64_t		checksum;
+	struct dnet_raw_id	id;
+	struct dnet_time	timestamp;
+	struct dnet_time	json_timestamp;
+	uint64_t		user_flags;
+	uint64_t		lifetime;
+	uint32_t		page_number;
+	uint32_t		reserved;
+	uint64_t		json_size;
+	uint64_t		data_size;
+} __attribute__ ((packed));
+
+struct snapshot_footer {
+	char		magic[8];
+	uint64_t	records;
+	uint64_t	checksum;
+} __attribute__ ((packed));
+
+struct snapshot_record {
+	struct dnet_raw_id	id;
+	dnet_time		timestamp;
+	dnet_time		json_timestamp;
+	uint64_t		user_flags;
+	size_t			lifetime;
+	size_t			page_number;
+	bool			has_data;
+	std::string		json;
+	std::string		data;
+};
+
+class snapshot_writer {
+public:
+	/*
+	 * Snapshot is written into temporary file next to @path and
+	 * replaces @path only on successful commit().
+	 */
+	snapshot_writer(const std::string &path, bool with_data);
+	~snapshot_writer();
+
+	int open();
+	int write(const snapshot_record &record);
+	int commit();
+
+	size_t records() const { return m_records; }
+
+private:
+	snapshot_writer(const snapshot_writer &) = delete;
+	snapshot_writer &operator =(const snapshot_writer &) = delete;
+
+	std::string m_path;
+	std::string m_tmp_path;
+	bool m_with_data;
+	FILE *m_file;
+	uint64_t m_checksum;
+	size_t m_records;
+};
+
+class snapshot_reader {
+public:
+	explicit snapshot_reader(const std::string &path);
+	~snapshot_reader();
+
+	/*
+	 * Returns 0 on success, -ENOENT if there is no snapshot and other negative error code
+	 * if snapshot can not be read or has unsupported format.
+	 */
+	int open();
+
+	/*
+	 * Reads next record into @record.
+	 * Returns 1 if record was read, 0 at the end of the stream and negative error code
+	 * if the rest of the stream is corrupted.
+	 */
+	int next(snapshot_record &record);
+
+	/*
+	 * Reads the whole stream checking every record and the footer, then rewinds it to the first record.
+	 * Returns 0 if the snapshot is complete and intact and negative error code otherwise.
+	 */
+	int validate();
+
+	bool with_data() const { return m_with_data; }
+
+private:
+	snapshot_reader(const snapshot_reader &) = delete;
+	snapshot_reader &operator =(const snapshot_reader &) = delete;
+
+	int read_footer();
+	int rewind();
+
+	std::string m_path;
+	bool m_with_data;
+	FILE *m_file;
+	uint64_t m_header_checksum;
+	uint64_t m_checksum;
+	size_t m_records;
+	bool m_finished;
+	uint64_t m_size;
+	/* number of bytes left unread in the file, bounds sizes of json and data taken from record headers */
+	uint64_t m_remaining;
+};
+
+}} /* namespace ioremap::cache */
+
+#endif // CACHE_SNAPSHOT_HPP
@@ -17,6 +17,7 @@ BuildRequires:	eblob-devel >= 0.24.0
 BuildRequires:  libblackhole-devel = 1.9.0
 BuildRequires:	libev-devel libtool-ltdl-devel
 BuildRequires:	cmake msgpack-devel python-msgpack
+BuildRequires:	zlib-devel
 BuildRequires:	handystats >= 1.11.6
 
 %define boost_ver %{nil}
@@ -88,6 +88,7 @@ static void parse_logger(config_data *data, const kora::config_t &logger) {
 	try {
 		const auto level = logger.at<std::string>("level", "info");
 		data->logger_level = dnet_log_parse_level(level.c_str());
+		data->logger_level_registration.reset(new log_level_registration(data->logger_level));
 	} catch (std::exception &e) {
 		throw config_error() << "failed to parse log level: " << e.what();
 	}
@@ -307,6 +308,9 @@ static void parse_options(config_data *data, const kora::config_t &options) {
 	if (options.has("cache"))
 		data->cache_config = ioremap::cache::cache_config::parse(options["cache"]);
 
+	if (options.has("negative_cache"))
+		data->negative_cache_config = ioremap::cache::negative_cache_config::parse(options["negative_cache"]);
+
 	data->queue_timeout = parse_queue_timeout(options);
 }
 
@@ -395,7 +399,10 @@ extern "C" int dnet_node_set_verbosity(struct dnet_node *node, enum dnet_log_lev
 	if (!node || !node->config_data || dnet_need_exit(node))
 		return -EINVAL;
 
-	dnet_node_get_config_data(node)->logger_level = level;
+	auto data = dnet_node_get_config_data(node);
+	if (data->logger_level_registration)
+		data->logger_level_registration->set(level);
+	data->logger_level = level;
 	node->io->backends_manager->set_verbosity(level);
 	return 0;
 }
@@ -415,7 +422,8 @@ static uint64_t parse_queue_timeout(const config_data &data, const kora::config_
 
 static dnet_config_backend &get_config_backend(const kora::config_t &config) {
 	static const std::unordered_map<std::string, dnet_config_backend *> backends = {
-	        {"blob", dnet_eblob_backend_info()}};
+	        {"blob", dnet_eblob_backend_info()},
+	        {"memory", dnet_memory_backend_info()}};
 
 	auto it = backends.find(config.at<std::string>("type"));
 	if (it == backends.end())
@@ -429,6 +437,13 @@ static boost::optional<cache::cache_config> parse_cache_config(const config_data
 	return config.has("cache") ? cache_config::parse(config["cache"]) : data.cache_config;
 }
 
+static boost::optional<cache::negative_cache_config> parse_negative_cache_config(const config_data &data,
+                                                                               const kora::config_t &config) {
+	using cache::negative_cache_config;
+	return config.has("negative_cache") ? negative_cache_config::parse(config["negative_cache"])
+	                                    : data.negative_cache_config;
+}
+
 backend_config::backend_config(const config_data &data, const kora::config_t &config)
 : raw_config{kora::to_json(config.underlying_object())}
 , backend_id{config.at<uint32_t>("backend_id")}
@@ -440,6 +455,7 @@ backend_config::backend_config(const config_data &data, const kora::config_t &co
 , pool_config(parse_io_pool_config(data, config))
 , queue_timeout{parse_queue_timeout(data, config)}
 , cache_config{parse_cache_config(data, config)}
+, negative_cache_config{parse_negative_cache_config(data, config)}
 , config_backend(get_config_backend(config))
 , config_backend_buffer(config_backend.size, '\0') {
 	config_backend.data = config_backend_buffer.data();
@@ -23,6 +23,7 @@ namespace ioremap {
 namespace elliptics {
 class address;
 class wrapper_t;
+class log_level_registration;
 }
 namespace monitor {
 struct monitor_config;
@@ -34,9 +35,30 @@ struct cache_config {
 	size_t			count;
 	unsigned		sync_timeout;
 	std::vector<size_t>	pages_proportions;
+	size_t			sync_batch_size;
+	size_t			sync_threads;
+	size_t			sync_rate_limit;
+	std::string		snapshot_dir;
+	bool			snapshot_data;
+	unsigned		snapshot_period;
+	// cache json and timestamps without data for json-only reads and lookups
+	bool			metadata;
+	// codec used for cached data: "none" or "zlib"
+	std::string		compression;
+	size_t			compression_threshold;
+	// max size of compressed data in percents of raw size
+	unsigned		compression_ratio;
 
 	static cache_config parse(const kora::config_t &cache);
 };
+
+struct negative_cache_config {
+	size_t			size;
+	// time in milliseconds a missing key is remembered
+	unsigned		ttl;
+
+	static negative_cache_config parse(const kora::config_t &config);
+};
 }} /* namespace ioremap::cache */
 
 namespace ioremap { namespace elliptics { namespace config {
@@ -121,6 +143,8 @@ struct backend_config {
 	const uint64_t					queue_timeout;
 
 	const boost::optional<cache::cache_config>	cache_config;
+	// cache of keys recently not found in the backend
+	const boost::optional<cache::negative_cache_config>	negative_cache_config;
 
 	dnet_config_backend				config_backend;
 
@@ -150,6 +174,8 @@ public:
 	 // logger section of config file
 	std::string					logger_value;
 	std::atomic<dnet_log_level>			logger_level;
+	// registration of logger_level checked by DNET_LOG before evaluation of arguments
+	std::unique_ptr<log_level_registration>		logger_level_registration;
 	// root logger is needed for re-opening log file
 	std::unique_ptr<blackhole::root_logger_t>	root_holder;
 	std::unique_ptr<blackhole::root_logger_t>	access_holder;
@@ -159,6 +185,7 @@ public:
 	// addresses of remote nodes
 	std::vector<address>				remotes;
 	boost::optional<cache::cache_config>		cache_config;
+	boost::optional<cache::negative_cache_config>	negative_cache_config;
 	// TODO: replace std::unique_ptr by std::optional or boost::optional
 	std::unique_ptr<monitor::monitor_config>	monitor_config;
 	// timeout used for dropping request stuck in a io pool's queue
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <errno.h>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitor/measure_points.h"
+
+/*
+ * \a congestion_control_monitor allows to limit amount of data sent to a remote backends simultaneously.
+ * Every destination group has its own window of in-flight bytes driven by AIMD: the window grows
+ * (exponentially until the first congestion, linearly after it) while writes to the group complete
+ * within LATENCY_TARGET_MSEC and is halved, at most once per smoothed RTT, when a write times out or is slower.
+ * Round trip time and throughput of every destination are estimated from its own completed writes,
+ * throughput is a delivery rate measured over THROUGHPUT_INTERVAL_MSEC intervals and smoothed like round trip time.
+ *
+ * Groups don't wait for each other: a write which doesn't fit into its group's window is queued
+ * and started when writes in flight to the same group complete, writes to other groups go on meanwhile.
+ */
+class congestion_control_monitor
+{
+public:
+	/*!
+	 * Constructor: initializes windows of destination \a groups,
+	 * \a name and \a backend_id are used for naming statistics.
+	 */
+	congestion_control_monitor(const std::string &name, uint32_t backend_id, const std::vector<int> &groups)
+	: m_name{name}
+	, m_backend_id{backend_id}
+	, m_bytes_pending{0} {
+		for (const int group : groups) {
+			m_windows.emplace(group, window{});
+		}
+	}
+
+	/*!
+	 * Starts \a write of \a bytes to \a group right away if the group's window has space available,
+	 * otherwise queues it until writes in flight to the group complete. Never waits.
+	 */
+	void add_bytes(int group, uint64_t bytes, std::function<void ()> write) {
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+
+			auto &w = m_windows[group];
+			m_bytes_pending += bytes;
+
+			if (!w.queue.empty() || is_window_full(w)) {
+				w.queued += bytes;
+				w.queue.emplace_back(bytes, std::move(write));
+				return;
+			}
+
+			w.in_flight += bytes;
+		}
+
+		write();
+	}
+
+	/*!
+	 * Waits until window of \a group had any space available and there are no writes queued to it,
+	 * then increments number of in-flight bytes of the group.
+	 */
+	void acquire(int group, uint64_t bytes) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+
+		auto &w = m_windows[group];
+		while (!w.queue.empty() || is_window_full(w)) {
+			m_cond.wait(lock);
+		}
+
+		w.in_flight += bytes;
+		m_bytes_pending += bytes;
+	}
+
+	/*!
+	 * Completes write of \a bytes to \a group which took \a rtt_us microseconds and finished with \a status:
+	 * updates window and estimations of the group and starts its queued writes which fit into the window.
+	 */
+	void remove_bytes(int group, uint64_t bytes, uint64_t rtt_us, int status) {
+		std::vector<std::function<void ()>> writes;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+
+			auto &w = m_windows[group];
+			w.in_flight -= bytes;
+			m_bytes_pending -= bytes;
+
+			sample(group, w, bytes, rtt_us, status);
+
+			while (!w.queue.empty() && !is_window_full(w)) {
+				auto &queued = w.queue.front();
+				w.in_flight += queued.first;
+				w.queued -= queued.first;
+				writes.emplace_back(std::move(queued.second));
+				w.queue.pop_front();
+			}
+
+			m_cond.notify_all();
+		}
+
+		for (const auto &write : writes) {
+			write();
+		}
+	}
+
+	/*!
+	 * Waits while writes queued to any destination take more than MAXIMAL_BACKLOG_SIZE bytes.
+	 * It bounds memory held by objects which are already sent to fast destinations but still wait for slow ones.
+	 */
+	void wait_backlog() {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		while (is_any_backlog_full()) {
+			m_cond.wait(lock);
+		}
+	}
+
+	/*!
+	 * Waits until all bytes are processed
+	 */
+	void wait_completion() {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		while (m_bytes_pending > 0) {
+			m_cond.wait(lock);
+		}
+	}
+
+	/*!
+	 * Returns current window of \a group in bytes.
+	 */
+	uint64_t window_size(int group) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		return m_windows[group].size;
+	}
+
+	/*!
+	 * Returns smoothed throughput of \a group in bytes per second.
+	 */
+	uint64_t throughput(int group) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		return m_windows[group].throughput;
+	}
+
+	/*!
+	 * Returns windows and estimations of all destinations in human-readable form.
+	 */
+	std::string dump() {
+		std::unique_lock<std::mutex> lock{m_mutex};
+
+		std::ostringstream out;
+		out << "{";
+		for (auto it = m_windows.begin(); it != m_windows.end(); ++it) {
+			if (it != m_windows.begin())
+				out << ", ";
+			out << it->first << ": {window: " << it->second.size
+			    << ", srtt_us: " << it->second.srtt_us
+			    << ", min_rtt_us: " << (it->second.delivered ? it->second.min_rtt_us : 0)
+			    << ", throughput: " << it->second.throughput << "}";
+		}
+		out << "}";
+		return out.str();
+	}
+
+	enum : uint64_t {
+		/*
+		 * Minimal amount of data being sent to a remote backend simultaneously,
+		 * also it is the step of linear growth of the window
+		 */
+		MINIMAL_WINDOW_SIZE = 1024 * 1024,
+		MAXIMAL_WINDOW_SIZE = 1024 * 1024 * 1024,
+
+		/*
+		 * max amount of data queued to a single destination before new objects are read
+		 */
+		MAXIMAL_BACKLOG_SIZE = 128 * 1024 * 1024,
+
+		/*
+		 * window is decreased if write to the destination takes longer than this timeout
+		 */
+		LATENCY_TARGET_MSEC = 1000,
+
+		/*
+		 * delivery rate of a destination is measured over intervals of at least this length
+		 */
+		THROUGHPUT_INTERVAL_MSEC = 1000,
+	};
+
+private:
+	struct window {
+		uint64_t size{MINIMAL_WINDOW_SIZE};
+		uint64_t in_flight{0};
+		bool slow_start{true};
+
+		/* writes waiting for space in the window */
+		std::deque<std::pair<uint64_t, std::function<void ()>>> queue;
+		uint64_t queued{0};
+
+		uint64_t min_rtt_us{UINT64_MAX};
+		uint64_t srtt_us{0};
+		uint64_t delivered{0};
+		uint64_t throughput{0}; /* bytes per second */
+		uint64_t interval_delivered{0}; /* bytes delivered since @interval_start */
+		std::chrono::steady_clock::time_point interval_start{std::chrono::steady_clock::now()};
+		std::chrono::steady_clock::time_point last_decrease;
+	};
+
+	void sample(int group, window &w, uint64_t bytes, uint64_t rtt_us, int status) {
+		const auto now = std::chrono::steady_clock::now();
+
+		if (status == 0) {
+			w.delivered += bytes;
+			w.interval_delivered += bytes;
+			w.min_rtt_us = std::min(w.min_rtt_us, rtt_us);
+			w.srtt_us = w.srtt_us ? (7 * w.srtt_us + rtt_us) / 8 : rtt_us;
+		}
+
+		const bool congested = (status == -ETIMEDOUT) || (status == 0 && rtt_us > LATENCY_TARGET_MSEC * 1000);
+		if (congested) {
+			const auto since_decrease = std::chrono::duration_cast<std::chrono::microseconds>(
+				now - w.last_decrease).count();
+			if (since_decrease >= static_cast<int64_t>(w.srtt_us)) {
+				w.size = std::max<uint64_t>(w.size / 2, MINIMAL_WINDOW_SIZE);
+				w.slow_start = false;
+				w.last_decrease = now;
+			}
+		} else if (status == 0) {
+			if (w.slow_start) {
+				w.size += bytes;
+			} else {
+				w.size += std::max<uint64_t>(bytes * MINIMAL_WINDOW_SIZE / w.size, 1);
+			}
+			w.size = std::min<uint64_t>(w.size, MAXIMAL_WINDOW_SIZE);
+		}
+
+		const auto interval_us = std::chrono::duration_cast<std::chrono::microseconds>(
+			now - w.interval_start).count();
+		if (interval_us >= static_cast<int64_t>(THROUGHPUT_INTERVAL_MSEC * 1000)) {
+			const uint64_t rate = w.interval_delivered * 1000000 / interval_us;
+			w.throughput = w.throughput ? (7 * w.throughput + rate) / 8 : rate;
+			w.interval_delivered = 0;
+			w.interval_start = now;
+		}
+
+		HANDY_GAUGE_SET(("backend.%u.server_send.%s.group.%d.window", m_backend_id, m_name.c_str(), group),
+		                w.size);
+		HANDY_GAUGE_SET(("backend.%u.server_send.%s.group.%d.throughput", m_backend_id, m_name.c_str(), group),
+		                w.throughput);
+	}
+
+	static bool is_window_full(const window &w) {
+		// always allow at least one write, otherwise object bigger than window will never be sent
+		return w.in_flight && w.in_flight >= w.size;
+	}
+
+	bool is_any_backlog_full() const {
+		for (const auto &w : m_windows) {
+			if (w.second.queued > MAXIMAL_BACKLOG_SIZE)
+				return true;
+		}
+		return false;
+	}
+
+	const std::string m_name;
+	const uint32_t m_backend_id;
+
+	std::unordered_map<int, window> m_windows;
+	uint64_t m_bytes_pending;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+};
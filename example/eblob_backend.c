@@ -225,6 +225,8 @@ static int blob_write(struct eblob_backend_config *c, void *state,
 
 	memcpy(key.id, io->id, EBLOB_ID_SIZE);
 
+	blob_header_cache_remove(c->header_cache, &key);
+
 	if (io->flags & DNET_IO_FLAGS_PREPARE) {
 		/*
 		 * We have to put ext header flag into prepare command, since otherwise
@@ -615,6 +617,7 @@ static int blob_del_range_callback(struct eblob_backend_config *c, struct eblob_
 	DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: DEL", dnet_dump_id_str(req->record_key));
 
 	memcpy(key.id, req->record_key, EBLOB_ID_SIZE);
+	blob_header_cache_remove(c->header_cache, &key);
 	err = eblob_remove(req->back, &key);
 	if (err) {
 		DNET_LOG_DEBUG(c->blog, "%s: EBLOB: blob-read-range: DEL: err: %d", dnet_dump_id_str(req->record_key),
@@ -768,6 +771,7 @@ static int blob_del(struct eblob_backend_config *c, struct dnet_cmd *cmd)
 
 	memcpy(key.id, cmd->id.id, EBLOB_ID_SIZE);
 
+	blob_header_cache_remove(c->header_cache, &key);
 	err = eblob_remove(c->eblob, &key);
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "%s: EBLOB: blob-del: REMOVE: %d: %s", dnet_dump_id_str(cmd->id.id), err,
@@ -1449,6 +1453,57 @@ static int dnet_blob_set_bg_ioprio_data(struct dnet_config_backend *b, const cha
 	return 0;
 }
 
+static int dnet_blob_set_bulk_read_threads(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->bulk_read_threads = atoi(value);
+	return 0;
+}
+
+static int dnet_blob_set_bulk_read_merge_size(struct dnet_config_backend *b,
+                                              const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->bulk_read_merge_size = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_threads(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->iterator_threads = atoi(value);
+	return 0;
+}
+
+static int dnet_blob_set_iterator_readahead_size(struct dnet_config_backend *b,
+                                                const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->iterator_readahead_size = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_group_commit_time(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->group_commit_time = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_group_commit_records(struct dnet_config_backend *b,
+                                              const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->group_commit_records = atoi(value);
+	return 0;
+}
+
+static int dnet_blob_set_header_cache_size(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->header_cache_size = strtoll(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_blob_set_read_buffer_size(struct dnet_config_backend *b, const char *key __unused, const char *value) {
+	struct eblob_backend_config *c = b->data;
+	c->read_buffer_size = strtoull(value, NULL, 0);
+	return 0;
+}
+
 
 uint64_t eblob_backend_total_elements(void *priv) {
 	struct eblob_backend_config *r = priv;
@@ -1465,6 +1520,13 @@ int eblob_backend_storage_stat_json(void *priv, char **json_stat, size_t *size)
 		return err;
 	}
 
+	if (r->group_commit) {
+		err = blob_group_commit_stat_json(r->group_commit, json_stat, size);
+		if (err) {
+			return err;
+		}
+	}
+
 	return 0;
 }
 
@@ -1472,8 +1534,18 @@ static void eblob_backend_cleanup(void *priv)
 {
 	struct eblob_backend_config *c = priv;
 
+	/* completes writes waiting for sync, so their replies are sent before the backend is gone */
+	blob_group_commit_destroy(c->group_commit);
+	c->group_commit = NULL;
+
 	eblob_cleanup(c->eblob);
 
+	blob_header_cache_destroy(c->header_cache);
+	c->header_cache = NULL;
+
+	blob_bulk_read_pool_destroy(c->bulk_read_pool);
+	c->bulk_read_pool = NULL;
+
 	pthread_mutex_destroy(&c->last_read_lock);
 }
 
@@ -1584,6 +1656,21 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 
 	c->data.log = &c->log;
 
+	if (c->bulk_read_threads <= 0)
+		c->bulk_read_threads = DNET_BLOB_DEFAULT_BULK_READ_THREADS;
+	if (!c->bulk_read_merge_size)
+		c->bulk_read_merge_size = DNET_BLOB_DEFAULT_BULK_READ_MERGE_SIZE;
+	if (!c->read_buffer_size)
+		c->read_buffer_size = DNET_BLOB_DEFAULT_READ_BUFFER_SIZE;
+	if (c->iterator_threads <= 0)
+		c->iterator_threads = DNET_BLOB_DEFAULT_ITERATOR_THREADS;
+	if (!c->iterator_readahead_size)
+		c->iterator_readahead_size = DNET_BLOB_DEFAULT_ITERATOR_READAHEAD_SIZE;
+	if (c->group_commit_records <= 0)
+		c->group_commit_records = DNET_BLOB_DEFAULT_GROUP_COMMIT_RECORDS;
+	if (!c->header_cache_size)
+		c->header_cache_size = DNET_BLOB_DEFAULT_HEADER_CACHE_SIZE;
+
 	err = pthread_mutex_init(&c->last_read_lock, NULL);
 	if (err) {
 		err = -err;
@@ -1608,6 +1695,30 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 
 	c->vm_total = st.vm_total * st.vm_total * 1024 * 1024;
 
+	if (c->group_commit_time) {
+		c->group_commit = blob_group_commit_create(c);
+		if (!c->group_commit) {
+			err = -ENOMEM;
+			goto err_out_eblob_cleanup;
+		}
+	}
+
+	if (c->header_cache_size > 0) {
+		c->header_cache = blob_header_cache_create(c);
+		if (!c->header_cache) {
+			err = -ENOMEM;
+			goto err_out_group_commit_destroy;
+		}
+	}
+
+	if (c->bulk_read_threads > 1) {
+		c->bulk_read_pool = blob_bulk_read_pool_create(c);
+		if (!c->bulk_read_pool) {
+			err = -ENOMEM;
+			goto err_out_header_cache_destroy;
+		}
+	}
+
 	b->cb.storage_stat_json = eblob_backend_storage_stat_json;
 	b->cb.total_elements = eblob_backend_total_elements;
 
@@ -1629,6 +1740,15 @@ static int dnet_blob_config_init(struct dnet_config_backend *b, enum dnet_log_le
 
 	return 0;
 
+err_out_header_cache_destroy:
+	blob_header_cache_destroy(c->header_cache);
+	c->header_cache = NULL;
+err_out_group_commit_destroy:
+	blob_group_commit_destroy(c->group_commit);
+	c->group_commit = NULL;
+err_out_eblob_cleanup:
+	eblob_cleanup(c->eblob);
+	c->eblob = NULL;
 err_out_last_read_lock_destroy:
 	pthread_mutex_destroy(&c->last_read_lock);
 err_out_exit:
@@ -1686,7 +1806,15 @@ static struct dnet_config_entry dnet_cfg_entries_blobsystem[] = {
 	{"periodic_timeout", dnet_blob_set_periodic_timeout},
 	{"backend_id", dnet_blob_set_backend_id},
 	{"bg_ioprio_class", dnet_blob_set_bg_ioprio_class},
-	{"bg_ioprio_data", dnet_blob_set_bg_ioprio_data}
+	{"bg_ioprio_data", dnet_blob_set_bg_ioprio_data},
+	{"bulk_read_threads", dnet_blob_set_bulk_read_threads},
+	{"bulk_read_merge_size", dnet_blob_set_bulk_read_merge_size},
+	{"read_buffer_size", dnet_blob_set_read_buffer_size},
+	{"iterator_threads", dnet_blob_set_iterator_threads},
+	{"iterator_readahead_size", dnet_blob_set_iterator_readahead_size},
+	{"group_commit_time", dnet_blob_set_group_commit_time},
+	{"group_commit_records", dnet_blob_set_group_commit_records},
+	{"header_cache_size", dnet_blob_set_header_cache_size}
 };
 
 static struct dnet_config_backend dnet_eblob_backend = {
@@ -19,11 +19,26 @@
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 
 #include <blackhole/wrapper.hpp>
 
 #include "example/eblob_backend.h"
+#include "example/congestion_control_monitor.hpp"
 
 #include "elliptics/packet.h"
 #include "elliptics/backends.h"
@@ -37,6 +52,7 @@
 #include "library/access_context.h"
 
 #include "monitor/measure_points.h"
+#include "monitor/json_writer.hpp"
 
 #include "bindings/cpp/timer.hpp"
 
@@ -78,6 +94,29 @@ int blob_check_corrupted_stamp(void *buffer, size_t buffer_size) {
 	return 0;
 }
 
+// Same as blob_read_and_check_stamp() but checks data which is already in memory.
+static int blob_check_stamp(const eblob_backend_config *c,
+                            const dnet_time *timestamp,
+                            const char *data,
+                            uint64_t data_size) {
+	constexpr size_t stamp_size = sizeof(eblob_disk_control) + sizeof(dnet_ext_list_hdr);
+
+	if (data_size < stamp_size) {
+		return 0;
+	}
+
+	if (!timestamp || timestamp->tsec > DNET_SERVER_SEND_BUGFIX_TIMESTAMP) {
+		return 0;
+	}
+
+	const int err = blob_check_corrupted_stamp(const_cast<char *>(data), stamp_size);
+	if (err == -EILSEQ) {
+		HANDY_COUNTER_INCREMENT(("backend.%u.stamp_corruption", c->data.stat_id), 1);
+	}
+
+	return err;
+}
+
 int blob_read_and_check_stamp(const eblob_backend_config *c,
                               const dnet_time *timestamp,
                               int fd,
@@ -93,17 +132,12 @@ int blob_read_and_check_stamp(const eblob_backend_config *c,
 		return 0;
 	}
 
-	int err = dnet_read_ll(fd, stamp.data(), stamp.size(), data_offset);
+	const int err = dnet_read_ll(fd, stamp.data(), stamp.size(), data_offset);
 	if (err) {
 		return err;
 	}
 
-	err = blob_check_corrupted_stamp(static_cast<void *>(stamp.data()), stamp.size());
-	if (err == -EILSEQ) {
-		HANDY_COUNTER_INCREMENT(("backend.%u.stamp_corruption", c->data.stat_id), 1);
-	}
-
-	return err;
+	return blob_check_stamp(c, timestamp, stamp.data(), data_size);
 }
 
 static int dnet_get_filename(int fd, std::string &filename) {
@@ -139,6 +173,14 @@ int dnet_blob_config_to_json(struct dnet_config_backend *b, char **json_stat, si
 	doc.AddMember("blob_size_limit", c->data.blob_size_limit, allocator);
 	doc.AddMember("defrag_time", c->data.defrag_time, allocator);
 	doc.AddMember("defrag_splay", c->data.defrag_splay, allocator);
+	doc.AddMember("bulk_read_threads", c->bulk_read_threads, allocator);
+	doc.AddMember("bulk_read_merge_size", c->bulk_read_merge_size, allocator);
+	doc.AddMember("read_buffer_size", c->read_buffer_size, allocator);
+	doc.AddMember("iterator_threads", c->iterator_threads, allocator);
+	doc.AddMember("iterator_readahead_size", c->iterator_readahead_size, allocator);
+	doc.AddMember("group_commit_time", c->group_commit_time, allocator);
+	doc.AddMember("group_commit_records", c->group_commit_records, allocator);
+	doc.AddMember("header_cache_size", c->header_cache_size, allocator);
 
 	rapidjson::StringBuffer buffer;
 	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -163,6 +205,408 @@ err_out_reset:
 	return err;
 }
 
+/*
+ * Group commit makes concurrent writes durable by a single fdatasync() of the blobs they were written to.
+ * Writers join the current batch and a dedicated thread closes the batch after group_commit_time usecs
+ * or when group_commit_records writers joined it, syncs it and completes its writers.
+ *
+ * Writes received from the network don't wait for the sync: their replies are deferred to the commit
+ * thread, so neither the io thread nor the key's oplock is held while the batch is filling up.
+ * Writes from local states (e.g. cache sync), whose replies are read right after the handler returns,
+ * wait for the sync instead. Every blob of a batch is synced via its own dup of the descriptor,
+ * so defragmentation may close the blob's descriptor meanwhile.
+ */
+struct blob_group_commit {
+	blob_group_commit(eblob_backend_config *c)
+	: c{c}
+	, stopped{false}
+	, records{0}
+	, bytes{0}
+	, batches{0}
+	, sync_time{0}
+	, batch_sizes(BATCH_SIZE_BUCKETS, 0) {
+		thread = std::thread([this] () {
+			dnet_set_name("dnet_gcommit_%d", this->c->data.stat_id);
+			run();
+		});
+	}
+
+	~blob_group_commit() {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			stopped = true;
+		}
+		queued.notify_all();
+		thread.join();
+	}
+
+	/* write whose reply is sent after its batch is synced */
+	struct deferred_reply {
+		dnet_net_state *st;
+		dnet_cmd cmd;
+		/* reply sent before the final ack, empty if only ack should be sent */
+		ioremap::elliptics::data_pointer response;
+	};
+
+	struct batch {
+		ioremap::elliptics::util::steady_timer started;
+		/* blobs of the batch identified by device and inode, and dups of their descriptors */
+		std::vector<std::pair<dev_t, ino_t>> files;
+		std::vector<int> fds;
+		std::vector<deferred_reply> replies;
+		size_t records{0};
+		uint64_t bytes{0};
+		bool done{false};
+		int err{0};
+	};
+
+	/* Returns true if reply to @state may be sent after the handler has returned */
+	static bool may_defer(void *state) {
+		auto st = static_cast<dnet_net_state *>(state);
+		return st != st->n->st && st->write_s >= 0;
+	}
+
+	/* Adds write of @size bytes to @fd to the current batch and waits until the batch is synced */
+	int commit(int fd, uint64_t size) {
+		std::unique_lock<std::mutex> guard(lock);
+
+		std::shared_ptr<batch> b;
+		const int err = join(fd, size, b);
+		if (err)
+			return err;
+
+		synced.wait(guard, [&] { return b->done; });
+		return b->err;
+	}
+
+	/*
+	 * Adds write of @size bytes to @fd to the current batch. @response (if any) and the final ack of @cmd
+	 * are sent to @state after the batch is synced, @cmd doesn't need ack from the caller after that.
+	 */
+	int defer(void *state, dnet_cmd *cmd, int fd, uint64_t size, ioremap::elliptics::data_pointer response) {
+		std::unique_lock<std::mutex> guard(lock);
+
+		std::shared_ptr<batch> b;
+		const int err = join(fd, size, b);
+		if (err)
+			return err;
+
+		auto st = dnet_state_get(static_cast<dnet_net_state *>(state));
+		b->replies.emplace_back(deferred_reply{st, *cmd, std::move(response)});
+		cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+		return 0;
+	}
+
+	int join(int fd, uint64_t size, std::shared_ptr<batch> &b) {
+		struct stat st;
+		if (fstat(fd, &st)) {
+			const int err = -errno;
+			DNET_LOG_ERROR(c->blog, "EBLOB: group-commit: fstat failed: fd: {}: {} [{}]",
+			               fd, strerror(-err), err);
+			return err;
+		}
+
+		if (!current)
+			current = std::make_shared<batch>();
+		b = current;
+
+		const auto file = std::make_pair(st.st_dev, st.st_ino);
+		if (std::find(b->files.begin(), b->files.end(), file) == b->files.end()) {
+			const int batch_fd = dup(fd);
+			if (batch_fd < 0) {
+				const int err = -errno;
+				DNET_LOG_ERROR(c->blog, "EBLOB: group-commit: dup failed: fd: {}: {} [{}]",
+				               fd, strerror(-err), err);
+				return err;
+			}
+			b->files.push_back(file);
+			b->fds.push_back(batch_fd);
+		}
+		b->records++;
+		b->bytes += size;
+
+		queued.notify_one();
+		return 0;
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> guard(lock);
+		while (true) {
+			queued.wait(guard, [&] { return current || stopped; });
+			if (!current)
+				break;
+
+			const auto full = [&] {
+				return stopped || current->records >= static_cast<size_t>(c->group_commit_records);
+			};
+			const uint64_t elapsed = current->started.get_us();
+			if (elapsed < c->group_commit_time)
+				queued.wait_for(guard, std::chrono::microseconds(c->group_commit_time - elapsed), full);
+
+			auto b = std::move(current);
+			current.reset();
+			guard.unlock();
+
+			ioremap::elliptics::util::steady_timer timer;
+			int err = 0;
+			for (const int batch_fd : b->fds) {
+				if (fdatasync(batch_fd)) {
+					err = -errno;
+					DNET_LOG_ERROR(c->blog, "EBLOB: group-commit: fdatasync failed: fd: {}: {} [{}]",
+					               batch_fd, strerror(-err), err);
+				}
+				close(batch_fd);
+			}
+			const uint64_t sync_elapsed = timer.get_us();
+
+			for (auto &reply : b->replies) {
+				if (!err && !reply.response.empty()) {
+					dnet_send_reply(reply.st, &reply.cmd, reply.response.data(), reply.response.size(), 0,
+					                /*context*/ nullptr);
+				}
+				dnet_send_ack(reply.st, &reply.cmd, err, 0, /*context*/ nullptr);
+				dnet_state_put(reply.st);
+			}
+
+			guard.lock();
+			b->done = true;
+			b->err = err;
+
+			records += b->records;
+			bytes += b->bytes;
+			batches++;
+			sync_time += sync_elapsed;
+			batch_sizes[batch_size_bucket(b->records)]++;
+
+			synced.notify_all();
+		}
+	}
+
+	/* index of histogram bucket: 0 - single write, i - from 2^(i-1)+1 to 2^i writes */
+	static size_t batch_size_bucket(size_t size) {
+		size_t bucket = 0;
+		while (bucket + 1 < BATCH_SIZE_BUCKETS && (1ul << bucket) < size)
+			bucket++;
+		return bucket;
+	}
+
+	static const size_t BATCH_SIZE_BUCKETS = 12;
+
+	eblob_backend_config *c;
+	const ioremap::elliptics::util::steady_timer uptime;
+
+	std::mutex lock;
+	/* notifies the commit thread about new writers and stop */
+	std::condition_variable queued;
+	/* notifies synchronous writers that their batch is synced */
+	std::condition_variable synced;
+	std::shared_ptr<batch> current;
+	bool stopped;
+	std::thread thread;
+
+	uint64_t records;
+	uint64_t bytes;
+	uint64_t batches;
+	uint64_t sync_time;
+	std::vector<uint64_t> batch_sizes;
+};
+
+struct blob_group_commit *blob_group_commit_create(struct eblob_backend_config *c) {
+	try {
+		return new blob_group_commit(c);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void blob_group_commit_destroy(struct blob_group_commit *gc) {
+	delete gc;
+}
+
+int blob_group_commit_stat_json(struct blob_group_commit *gc, char **json_stat, size_t *size) {
+	const size_t length = strnlen(*json_stat, *size);
+
+	rapidjson::StringBuffer buffer;
+	ioremap::monitor::json_writer writer(buffer);
+
+	/* group commit statistics is appended as the last member of eblob's statistics */
+	writer.StartObject();
+	if (!ioremap::monitor::copy_json_members(*json_stat, length, writer))
+		return -EINVAL;
+
+	{
+		std::unique_lock<std::mutex> guard(gc->lock);
+
+		const uint64_t uptime = std::max<uint64_t>(gc->uptime.get_ms(), 1);
+
+		writer.String("group_commit");
+		writer.StartObject();
+		writer.String("batches");
+		writer.Uint64(gc->batches);
+		writer.String("records");
+		writer.Uint64(gc->records);
+		writer.String("bytes");
+		writer.Uint64(gc->bytes);
+		writer.String("sync_time");
+		writer.Uint64(gc->sync_time);
+		writer.String("records_per_second");
+		writer.Uint64(gc->records * 1000 / uptime);
+		writer.String("bytes_per_second");
+		writer.Uint64(gc->bytes * 1000 / uptime);
+
+		writer.String("batch_size");
+		writer.StartObject();
+		for (size_t i = 0; i < gc->batch_sizes.size(); ++i) {
+			const std::string bucket = std::to_string(1ul << i);
+			writer.String(bucket.c_str(), bucket.size());
+			writer.Uint64(gc->batch_sizes[i]);
+		}
+		writer.EndObject();
+		writer.EndObject();
+	}
+	writer.EndObject();
+
+	char *json_copy = static_cast<char *>(malloc(buffer.Size() + 1));
+	if (!json_copy)
+		return -ENOMEM;
+
+	memcpy(json_copy, buffer.GetString(), buffer.Size() + 1);
+	free(*json_stat);
+	*json_stat = json_copy;
+	*size = buffer.Size();
+	return 0;
+}
+
+/*
+ * Cache of ext and json headers of recently looked up records, so lookups of hot keys don't read the disk
+ * beyond the index. Entry is valid only for the location (blob fd and offset) it was read from, entry of
+ * the record moved by defrag or rewritten to a new place is just not used. Records updated in place
+ * are dropped from the cache by writers and removers. Entries are evicted in insertion order.
+ */
+struct blob_header_cache {
+	struct entry {
+		int fd;
+		uint64_t data_offset;
+		dnet_ext_list_hdr ehdr;
+		dnet_json_header jhdr;
+		/* position of the key in the eviction order */
+		std::list<eblob_key>::iterator position;
+	};
+
+	struct key_hash {
+		size_t operator()(const eblob_key &key) const {
+			size_t hash;
+			memcpy(&hash, key.id, sizeof(hash));
+			return hash;
+		}
+	};
+
+	struct key_equal {
+		bool operator()(const eblob_key &lhs, const eblob_key &rhs) const {
+			return memcmp(lhs.id, rhs.id, EBLOB_ID_SIZE) == 0;
+		}
+	};
+
+	struct shard {
+		std::mutex lock;
+		std::unordered_map<eblob_key, entry, key_hash, key_equal> entries;
+		std::list<eblob_key> order;
+	};
+
+	blob_header_cache(eblob_backend_config *c)
+	: c{c}
+	, shard_size{std::max<size_t>(c->header_cache_size / SHARDS, 1)} {
+	}
+
+	bool get(const eblob_key &key, int fd, uint64_t data_offset, dnet_ext_list_hdr &ehdr, dnet_json_header &jhdr) {
+		auto &s = get_shard(key);
+		std::unique_lock<std::mutex> guard(s.lock);
+
+		auto it = s.entries.find(key);
+		if (it == s.entries.end() || it->second.fd != fd || it->second.data_offset != data_offset) {
+			guard.unlock();
+			HANDY_COUNTER_INCREMENT(("backend.%u.header_cache.misses", c->data.stat_id), 1);
+			return false;
+		}
+
+		ehdr = it->second.ehdr;
+		jhdr = it->second.jhdr;
+		guard.unlock();
+
+		HANDY_COUNTER_INCREMENT(("backend.%u.header_cache.hits", c->data.stat_id), 1);
+		return true;
+	}
+
+	void put(const eblob_key &key, int fd, uint64_t data_offset, const dnet_ext_list_hdr &ehdr,
+	         const dnet_json_header &jhdr) {
+		auto &s = get_shard(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+
+		auto it = s.entries.find(key);
+		if (it != s.entries.end()) {
+			it->second = entry{fd, data_offset, ehdr, jhdr, it->second.position};
+			return;
+		}
+
+		s.order.push_back(key);
+		s.entries.emplace(key, entry{fd, data_offset, ehdr, jhdr, std::prev(s.order.end())});
+		if (s.order.size() > shard_size) {
+			s.entries.erase(s.order.front());
+			s.order.pop_front();
+		}
+	}
+
+	void remove(const eblob_key &key) {
+		auto &s = get_shard(key);
+		std::lock_guard<std::mutex> guard(s.lock);
+
+		auto it = s.entries.find(key);
+		if (it == s.entries.end())
+			return;
+
+		s.order.erase(it->second.position);
+		s.entries.erase(it);
+	}
+
+	shard &get_shard(const eblob_key &key) {
+		/* the first bytes are used by hash function of the map, so shard is chosen by the next one */
+		return shards[key.id[sizeof(size_t)] % SHARDS];
+	}
+
+	static const size_t SHARDS = 16;
+
+	eblob_backend_config *c;
+	const size_t shard_size;
+	shard shards[SHARDS];
+};
+
+struct blob_header_cache *blob_header_cache_create(struct eblob_backend_config *c) {
+	try {
+		return new blob_header_cache(c);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void blob_header_cache_destroy(struct blob_header_cache *hc) {
+	delete hc;
+}
+
+void blob_header_cache_remove(struct blob_header_cache *hc, const struct eblob_key *key) {
+	if (hc)
+		hc->remove(*key);
+}
+
+static int blob_parse_json_header(const ioremap::elliptics::data_pointer &json_header, dnet_json_header *jhdr) {
+	try {
+		deserialize(json_header, *jhdr);
+	} catch( std::exception &) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 int dnet_read_json_header(int fd, uint64_t offset, uint64_t size, dnet_json_header *jhdr) {
 	memset(jhdr, 0, sizeof(*jhdr));
 
@@ -174,13 +618,52 @@ int dnet_read_json_header(int fd, uint64_t offset, uint64_t size, dnet_json_head
 	if (err)
 		return err;
 
-	try {
-		deserialize(json_header, *jhdr);
-	} catch( std::exception &) {
-		return -EINVAL;
-	}
+	return blob_parse_json_header(json_header, jhdr);
+}
 
-	return 0;
+/*
+ * Reads ext header and json header of the record by a single pread of the aligned range which covers both,
+ * json header is read separately only if it is bigger than expected.
+ */
+static int blob_read_headers(const eblob_write_control &wc, dnet_ext_list_hdr &ehdr, dnet_json_header &jhdr) {
+	static const uint64_t alignment = 4096;
+	/* serialized json header is 4 msgpack integers, it never exceeds this size */
+	static const uint64_t max_json_header_size = 64;
+
+	const uint64_t headers_size = std::min<uint64_t>(wc.total_data_size, sizeof(ehdr) + max_json_header_size);
+	const uint64_t start = wc.data_offset & ~(alignment - 1);
+	const uint64_t end = (wc.data_offset + headers_size + alignment - 1) & ~(alignment - 1);
+
+	thread_local std::vector<char> buffer;
+	if (buffer.size() < end - start)
+		buffer.resize(end - start);
+
+	/* aligned range may end beyond the end of the blob, so short read is fine if it covers the headers */
+	ssize_t bytes;
+	do {
+		bytes = pread(wc.data_fd, buffer.data(), end - start, start);
+	} while (bytes < 0 && errno == EINTR);
+	if (bytes < 0)
+		return -errno;
+
+	/* index points beyond the end of the blob */
+	const uint64_t ehdr_offset = wc.data_offset - start;
+	if (static_cast<uint64_t>(bytes) < ehdr_offset + sizeof(ehdr))
+		return -EIO;
+
+	memcpy(&ehdr, buffer.data() + ehdr_offset, sizeof(ehdr));
+
+	memset(&jhdr, 0, sizeof(jhdr));
+	/* broken ehdr.size is reported by caller */
+	if (!ehdr.size || wc.total_data_size < sizeof(ehdr) + ehdr.size)
+		return 0;
+
+	const uint64_t jhdr_offset = ehdr_offset + sizeof(ehdr);
+	if (static_cast<uint64_t>(bytes) < jhdr_offset + ehdr.size)
+		return dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
+
+	using ioremap::elliptics::data_pointer;
+	return blob_parse_json_header(data_pointer::from_raw(buffer.data() + jhdr_offset, ehdr.size), &jhdr);
 }
 
 static int blob_read_and_check_flags_new(const eblob_backend_config *c,
@@ -200,9 +683,8 @@ int blob_file_info_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, stru
 	using namespace ioremap::elliptics;
 
 	if (context) {
-		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
-		              {"backend_id", c->data.stat_id},
-		             });
+		context->set_id(cmd->id);
+		context->add({"backend_id", c->data.stat_id});
 	}
 
 	eblob_key key;
@@ -239,11 +721,15 @@ int blob_file_info_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, stru
 			return err;
 		}
 
-		err = dnet_ext_hdr_read(&ehdr, wc.data_fd, wc.data_offset);
-		if (err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read ext header: {} [{}]",
-			               dnet_dump_id(&cmd->id), strerror(-err), err);
-			return err;
+		const bool cached = c->header_cache &&
+		                    c->header_cache->get(key, wc.data_fd, wc.data_offset, ehdr, jhdr);
+		if (!cached) {
+			err = blob_read_headers(wc, ehdr, jhdr);
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read headers: {} [{}]",
+				               dnet_dump_id(&cmd->id), strerror(-err), err);
+				return err;
+			}
 		}
 
 		if (wc.total_data_size < sizeof(ehdr) + ehdr.size) {
@@ -255,13 +741,6 @@ int blob_file_info_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, stru
 			return err;
 		}
 
-		err = dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
-		if(err) {
-			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: failed to read json header: {} [{}]",
-			               dnet_dump_id(&cmd->id), strerror(-err), err);
-			return err;
-		}
-
 		if (wc.total_data_size < sizeof(ehdr) + ehdr.size + jhdr.capacity) {
 			err = -ERANGE;
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-file-info-new: invalid record: total_data_size({}) < "
@@ -271,6 +750,9 @@ int blob_file_info_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, stru
 			return err;
 		}
 
+		if (c->header_cache && !cached)
+			c->header_cache->put(key, wc.data_fd, wc.data_offset, ehdr, jhdr);
+
 		wc.size -= sizeof(ehdr) + ehdr.size + jhdr.capacity;
 		// wc.total_data_size -= sizeof(ehdr);
 		wc.data_offset += sizeof(ehdr) + ehdr.size + jhdr.capacity;
@@ -367,8 +849,8 @@ int blob_del_new(eblob_backend_config *c, dnet_cmd *cmd, void *data, struct dnet
 	} ();
 
 	if (context) {
-		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
-		              {"backend_id", c->data.stat_id},
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->data.stat_id},
 		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
 		             });
 		if (request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP) {
@@ -389,6 +871,7 @@ int blob_del_new(eblob_backend_config *c, dnet_cmd *cmd, void *data, struct dnet
 			return err;
 	}
 
+	blob_header_cache_remove(c->header_cache, &key);
 	err = eblob_remove(b, &key);
 
 	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "{}: EBLOB: {} finished: {}",
@@ -424,9 +907,39 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		return err;
 	}
 
-	auto verify_checksum = [&, wc] (uint64_t offset, uint64_t size, uint64_t &csum_time) mutable {
-		if (request.ioflags & DNET_IO_FLAGS_NOCSUM)
-			return 0;
+	/* Small records are read by a single pread into the per-thread buffer and are parsed and sent from it,
+	 * bigger ones are read part by part and their data is sent by sendfile.
+	 */
+	thread_local std::vector<char> read_buffer;
+	const char *record = nullptr;
+	const uint64_t record_start = wc.data_offset;
+	const uint64_t record_size = wc.total_data_size;
+
+	if (wc.size <= record_size && record_size <= c->read_buffer_size) {
+		if (read_buffer.size() < record_size)
+			read_buffer.resize(record_size);
+
+		err = dnet_read_ll(wc.data_fd, read_buffer.data(), record_size, record_start);
+		if (err) {
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read record: fd: {}, "
+			                        "offset: {}, size: {}: {} [{}]",
+			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), wc.data_fd, record_start,
+			               record_size, strerror(-err), err);
+			return err;
+		}
+		record = read_buffer.data();
+	}
+
+	auto read_record = [&] (void *data, uint64_t size, uint64_t offset) {
+		if (!record)
+			return dnet_read_ll(wc.data_fd, static_cast<char *>(data), size, offset);
+		if (offset < record_start || offset - record_start + size > record_size)
+			return -ERANGE;
+		memcpy(data, record + offset - record_start, size);
+		return 0;
+	};
+
+	auto verify_range = [&, wc] (uint64_t offset, uint64_t size, uint64_t &csum_time) mutable {
 		wc.offset = offset;
 		wc.size = size;
 		util::steady_timer timer;
@@ -435,6 +948,20 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		return ret;
 	};
 
+	/* Buffered record is verified once for the whole requested range after all parts are parsed,
+	 * pages have just been read by the pread above, so the verification doesn't hit the disk again.
+	 */
+	uint64_t csum_end = 0;
+	auto verify_checksum = [&] (uint64_t offset, uint64_t size, uint64_t &csum_time) {
+		if (request.ioflags & DNET_IO_FLAGS_NOCSUM)
+			return 0;
+		if (record) {
+			csum_end = std::max(csum_end, offset + size);
+			return 0;
+		}
+		return verify_range(offset, size, csum_time);
+	};
+
 	dnet_ext_list_hdr ehdr;
 	memset(&ehdr, 0, sizeof(ehdr));
 
@@ -454,7 +981,7 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			return err;
 		}
 
-		err = dnet_ext_hdr_read(&ehdr, wc.data_fd, wc.data_offset);
+		err = read_record(&ehdr, sizeof(ehdr), wc.data_offset);
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read ext header : {} [{}]",
 			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), strerror(-err), err);
@@ -470,7 +997,13 @@ static int blob_read_new_impl(eblob_backend_config *c,
 			return err;
 		}
 
-		err = dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
+		if (record && ehdr.size) {
+			const auto json_header = data_pointer::from_raw(const_cast<char *>(record) + sizeof(ehdr),
+			                                                ehdr.size);
+			err = blob_parse_json_header(json_header, &jhdr);
+		} else {
+			err = dnet_read_json_header(wc.data_fd, wc.data_offset + sizeof(ehdr), ehdr.size, &jhdr);
+		}
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read json header : {} [{}]",
 			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), strerror(-err), err);
@@ -509,7 +1042,11 @@ static int blob_read_new_impl(eblob_backend_config *c,
 	uint64_t data_size = wc.size - jhdr.capacity;
 	uint64_t data_offset = wc.data_offset + jhdr.capacity;
 
-	err = blob_read_and_check_stamp(c, &ehdr.timestamp, wc.data_fd, data_offset, data_size);
+	if (record) {
+		err = blob_check_stamp(c, &ehdr.timestamp, record + data_offset - record_start, data_size);
+	} else {
+		err = blob_read_and_check_stamp(c, &ehdr.timestamp, wc.data_fd, data_offset, data_size);
+	}
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new {}: corrupted signature: data offset {}, "
 		               "data size {}",
@@ -531,7 +1068,7 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		}
 
 		json = data_pointer::allocate(jhdr.size);
-		err = dnet_read_ll(wc.data_fd, (char*)json.data(), json.size(), wc.data_offset);
+		err = read_record(json.data(), json.size(), wc.data_offset);
 		if (err) {
 			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to read json: fd: {}, "
 			                        "offset: {}, size: {}: {} [{}]",
@@ -575,6 +1112,18 @@ static int blob_read_new_impl(eblob_backend_config *c,
 		}
 	}
 
+	if (csum_end) {
+		/* whole buffered range is accounted as data_csum_time */
+		err = verify_range(0, csum_end, data_csum_time);
+		if (err) {
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: {}: failed to verify checksum for "
+			                        "record: fd: {}, offset: {}, size: {}: {} [{}]",
+			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd), wc.data_fd, record_start,
+			               csum_end, strerror(-err), err);
+			return err;
+		}
+	}
+
 	cmd_stats->size = json.size() + data_size;
 
 	auto header = serialize(dnet_read_response{
@@ -603,8 +1152,14 @@ static int blob_read_new_impl(eblob_backend_config *c,
 	response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
 
 	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
-	err = dnet_send_fd((dnet_net_state *)state, response.data(), response.size(),
-	                   wc.data_fd, data_offset, data_size, 0, context);
+	if (record) {
+		char *data = data_size ? const_cast<char *>(record) + data_offset - record_start : nullptr;
+		err = dnet_send_data((dnet_net_state *)state, response.data(), response.size(),
+		                     data, data_size, context);
+	} else {
+		err = dnet_send_fd((dnet_net_state *)state, response.data(), response.size(),
+		                   wc.data_fd, data_offset, data_size, 0, context);
+	}
 
 	if (err) {
 		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-read-new: dnet_send_reply: data {:p}, size: {}: {} [{}]",
@@ -615,6 +1170,7 @@ static int blob_read_new_impl(eblob_backend_config *c,
 	if (context) {
 		context->add({{"response_json_size", json.size()},
 		              {"response_data_size", data_size},
+		              {"buffered_read", record != nullptr},
 		              {"header_csum_time", headers_csum_time},
 		              {"json_csum_time", json_csum_time},
 		              {"data_csum_time", data_csum_time},
@@ -644,8 +1200,8 @@ int blob_read_new(eblob_backend_config *c,
 	} ();
 
 	if (context) {
-		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
-		              {"backend_id", c->data.stat_id},
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->data.stat_id},
 		              {"read_flags", std::string(dnet_dump_read_flags(request.read_flags))},
 		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
 		            });
@@ -675,8 +1231,8 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 	} ();
 
 	if (context) {
-		context->add({{"id", std::string(dnet_dump_id(&cmd->id))},
-		              {"backend_id", c->data.stat_id},
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->data.stat_id},
 		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
 		              {"request_data_offset", request.data_offset},
 		              {"request_data_size", request.data_size},
@@ -859,6 +1415,9 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		iov.emplace_back(eblob_iovec{data_p.skip(request.json_size).data(), request.data_size, offset});
 	}
 
+	/* concurrent lookups of the key are excluded by oplock, so nobody caches headers until they are written */
+	blob_header_cache_remove(c->header_cache, &key);
+
 	if (request.ioflags & DNET_IO_FLAGS_PLAIN_WRITE) {
 		err = eblob_plain_writev(b, &key, iov.data(), iov.size(), flags);
 	} else if (request.ioflags & DNET_IO_FLAGS_UPDATE_JSON) {
@@ -892,8 +1451,32 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		return err;
 	}
 
+	/* replies to remote states are sent by group commit after the sync, replies to local ones wait for it here */
+	const bool defer_reply = c->group_commit && blob_group_commit::may_defer(state);
+
+	if (c->group_commit && !defer_reply) {
+		util::steady_timer timer;
+		err = c->group_commit->commit(wc.data_fd, cmd_stats->size);
+		if (context) {
+			context->add({"group_commit_time", timer.get_us()});
+		}
+		if (err) {
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: group commit failed: {} [{}]",
+			               dnet_dump_id(&cmd->id), strerror(-err), err);
+			return err;
+		}
+	}
+
 	if (request.ioflags & DNET_IO_FLAGS_WRITE_NO_FILE_INFO) {
 		cmd->flags |= DNET_FLAGS_NEED_ACK;
+		if (defer_reply) {
+			err = c->group_commit->defer(state, cmd, wc.data_fd, cmd_stats->size, data_pointer());
+			if (err) {
+				DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: group commit failed: {} [{}]",
+				               dnet_dump_id(&cmd->id), strerror(-err), err);
+				return err;
+			}
+		}
 		return 0;
 	}
 
@@ -929,11 +1512,21 @@ int blob_write_new(eblob_backend_config *c, void *state, dnet_cmd *cmd, void *da
 		wc.size ? (wc.size - jhdr.capacity) : 0,
 	});
 
-	err = dnet_send_reply(state, cmd, response.data(), response.size(), 0, context);
-	if (err) {
-		DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: dnet_send_reply: data: {:p}, size: {}: {} [{}]",
-		               dnet_dump_id(&cmd->id), (void *)response.data(), response.size(), strerror(-err), err);
-		return err;
+	if (defer_reply) {
+		err = c->group_commit->defer(state, cmd, wc.data_fd, cmd_stats->size, std::move(response));
+		if (err) {
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: group commit failed: {} [{}]",
+			               dnet_dump_id(&cmd->id), strerror(-err), err);
+			return err;
+		}
+	} else {
+		err = dnet_send_reply(state, cmd, response.data(), response.size(), 0, context);
+		if (err) {
+			DNET_LOG_ERROR(c->blog, "{}: EBLOB: blob-write-new: dnet_send_reply: data: {:p}, size: {}: {} [{}]",
+			               dnet_dump_id(&cmd->id), (void *)response.data(), response.size(),
+			               strerror(-err), err);
+			return err;
+		}
 	}
 
 	DNET_LOG_INFO(c->blog, "{}: EBLOB: blob-write-new: ioflags: {}, json_size: {}, data_size: {}",
@@ -1058,103 +1651,35 @@ struct iterated_key_info {
 typedef std::function<int (std::shared_ptr<iterated_key_info> info)> iterator_callback;
 
 /*
- * \a congestion_control_monitor allows to limit amount of data sent to a remote backends simultaneously.
+ * \a send_completion collects results of sending a key to destination groups which are sent
+ * independently of each other, the reply to the client is sent once all groups are done.
  */
-class congestion_control_monitor
-{
+class send_completion {
 public:
-	/*!
-	 * Constructor: initializes internal state.
-	 */
-	congestion_control_monitor()
-	: m_batch_size{MINIMAL_BATCH_SIZE}
-	, m_bytes_pending{0}
-	, m_bytes_processed{0}
-	, m_need_restart_timer{true} {
+	explicit send_completion(size_t groups)
+	: m_remaining{groups}
+	, m_error{0} {
 	}
 
 	/*!
-	 * Waits until batch had any space available, then increments
-	 * number of pending bytes in the batch.
+	 * Stores \a status of a finished group, returns true if it was the last group.
 	 */
-	void add_bytes(uint64_t bytes) {
-		std::unique_lock<std::mutex> lock{m_mutex};
-
-		while (is_batch_full()) {
-			m_cond.wait(lock);
-		}
-		m_bytes_pending += bytes;
-
-		if (m_need_restart_timer) {
-			m_batch_timer.restart();
-			m_need_restart_timer = false;
-		}
+	bool complete(int status) {
+		if (status)
+			m_error = status;
+		return --m_remaining == 0;
 	}
 
 	/*!
-	 * Decrements number of pending bytes in the batch and measures
-	 * elapsed time of processing of the batch for either increasing or decreasing size of
-	 * the batch.
+	 * Returns the last error of finished groups.
 	 */
-	void remove_bytes(uint64_t bytes) {
-		std::unique_lock<std::mutex> lock{m_mutex};
-
-		m_bytes_processed += bytes;
-
-		if (m_bytes_processed >= m_batch_size) {
-			m_bytes_processed -= m_batch_size;
-
-			if (m_batch_timer.get_ms() < BATCH_TIMEOUT_MSEC) {
-				m_batch_size *= 2;
-			} else {
-				m_batch_size = std::max(m_batch_size / 2, MINIMAL_BATCH_SIZE);
-			}
-
-			m_need_restart_timer = true;
-		}
-
-		m_bytes_pending -= bytes;
-
-		if (!is_batch_full()) {
-			m_cond.notify_one();
-		}
-	}
-
-	/*!
-	 * Waits until all bytes are processed
-	 */
-	void wait_completion() {
-		std::unique_lock<std::mutex> lock{m_mutex};
-		while (m_bytes_pending > 0) {
-			m_cond.wait(lock);
-		}
-	}
+	int error() const {
+		return m_error;
+	}
 
 private:
-	bool is_batch_full() const {
-		return m_bytes_pending >= m_batch_size;
-	}
-
-private:
-	/*
-	 * Minimal amount of data being sent to a remote backends simultaneously
-	 */
-	const uint64_t MINIMAL_BATCH_SIZE = 1024 * 1024;
-	uint64_t m_batch_size;
-
-	uint64_t m_bytes_pending;
-	uint64_t m_bytes_processed;
-
-	/*
-	 * batch size is either increased or decreased depending on
-	 * whether it was processed within this timeout or not
-	 */
-	const int BATCH_TIMEOUT_MSEC = 1000;
-	ioremap::elliptics::util::steady_timer m_batch_timer;
-	bool m_need_restart_timer;
-
-	std::mutex m_mutex;
-	std::condition_variable m_cond;
+	std::atomic<size_t> m_remaining;
+	std::atomic<int> m_error;
 };
 
 class base_object_sender {
@@ -1177,9 +1702,6 @@ public:
 	, counter_(counter)
 	, pool_(dnet_backend_get_pool(st->n, backend->data.stat_id))
 	, session_{st->n} {
-		json_.reserve(request_.chunk_size);
-		data_.reserve(request_.chunk_size);
-
 		session_.set_exceptions_policy(ioremap::elliptics::session::no_exceptions);
 		session_.set_filter(ioremap::elliptics::filters::all_final);
 		session_.set_trace_id(cmd_->trace_id);
@@ -1214,7 +1736,6 @@ public:
 	}
 
 	virtual ~base_object_sender() {
-		unlock_quota();
 		unlock_id();
 	}
 
@@ -1236,22 +1757,6 @@ protected:
 		id_locked_ = false;
 	}
 
-	void lock_quota() {
-		if (locked_quota_)
-			return;
-
-		locked_quota_ = json_.size() + data_.size();
-		monitor_.add_bytes(locked_quota_);
-	}
-
-	void unlock_quota() {
-		if (!locked_quota_)
-			return;
-
-		monitor_.remove_bytes(locked_quota_);
-		locked_quota_ = 0;
-	}
-
 	int read() {
 		lock_id();
 
@@ -1281,8 +1786,6 @@ protected:
 			}
 		}
 
-		lock_quota();
-
 		if (remaining_size <= request_.chunk_size) {
 			// unlock id because all its data has been read
 			unlock_id();
@@ -1317,6 +1820,11 @@ protected:
 		dnet_send_reply(st_, cmd_, response.data(), response.size(), 1, /*context*/ nullptr);
 	}
 
+	/* bytes written by the current chunk, json is written with the first chunk only */
+	uint64_t chunk_bytes() const {
+		return data_.size() + (data_offset_ ? 0 : json_.size());
+	}
+
 	uint64_t remaining_size() const {
 		uint64_t remaining_size = info_->data_size - data_offset_;
 		if (!data_offset_) {
@@ -1345,7 +1853,6 @@ protected:
 
 	const std::shared_ptr<iterated_key_info> info_;
 	congestion_control_monitor &monitor_;
-	uint64_t locked_quota_{0};
 	std::atomic<uint64_t> &counter_;
 
 	dnet_io_pool *pool_;
@@ -1365,266 +1872,937 @@ class small_object_sender : public base_object_sender, public std::enable_shared
 public:
 	using base_object_sender::base_object_sender;
 
+	/*
+	 * Reads the object once and writes it to every destination group independently:
+	 * each write waits only for its own group's window and is retried only for its own group.
+	 */
 	void send() {
-		retry_count_ = request_.chunk_retry_count;
-
 		if (const int err = read()) {
 			send_response(err);
 			return;
 		}
 
-		write();
+		bytes_ = chunk_bytes();
+		for (const int group : request_.groups) {
+			groups_[group].retry_count = request_.chunk_retry_count;
+		}
+		completion_ = std::make_shared<send_completion>(request_.groups.size());
+
+		for (const int group : request_.groups) {
+			start_write(group);
+		}
 	}
 
 private:
-	void write() {
-		session_.write(info_->key, json(), info_->jhdr.capacity, data(), info_->data_size)
-			.connect(std::bind(&small_object_sender::on_write, shared_from_this(), std::placeholders::_1,
-			                   std::placeholders::_2));
+	struct group_state {
+		uint8_t retry_count{0};
+		ioremap::elliptics::util::steady_timer timer;
+	};
+
+	void start_write(int group) {
+		auto self = shared_from_this();
+		monitor_.add_bytes(group, bytes_, [self, group] () {
+			self->write(group);
+		});
 	}
 
-	void on_write(const ioremap::elliptics::newapi::sync_write_result &results,
-	              const ioremap::elliptics::error_info &/*error*/) {
+	void write(int group) {
+		auto session = session_.clone();
+		session.set_groups({group});
+
+		groups_.at(group).timer.restart();
+		session.write(info_->key, json(), info_->jhdr.capacity, data(), info_->data_size)
+			.connect(std::bind(&small_object_sender::on_write, shared_from_this(), group,
+			                   std::placeholders::_1, std::placeholders::_2));
+	}
+
+	void on_write(int group, const ioremap::elliptics::newapi::sync_write_result &results,
+	              const ioremap::elliptics::error_info &error) {
+		auto &state = groups_.at(group);
+		const int status = results.empty() ? error.code() : results.front().status();
+		const uint64_t rtt_us = state.timer.get_us();
+
+		/* bytes of the finished write are released last: blob_send_new() waits for them
+		 * before it destroys the request, so the retry and the reply must be issued before that
+		 */
 		if (st_->__need_exit) {
 			DNET_LOG_ERROR(log_, "EBLOB: Interrupting server_send: peer has been disconnected");
-			return;
+		} else if (status == -ETIMEDOUT && state.retry_count--) {
+			DNET_LOG_INFO(log_, "EBLOB: server_send {}: small_object_sender: retrying write to group: {}"
+			                    ", retry: {:d}/{:d}",
+			              dnet_dump_id_str(info_->key.id), group,
+			              request_.chunk_retry_count - state.retry_count, request_.chunk_retry_count);
+			start_write(group);
+		} else if (completion_->complete(status)) {
+			send_response(completion_->error());
 		}
 
-		// collect groups with timeout
-		auto retry_groups = [&] {
-			std::vector<int> groups;
-			groups.reserve(results.size());
+		monitor_.remove_bytes(group, bytes_, rtt_us, status);
+	}
 
-			for (const auto &result: results) {
-				const auto group_id = result.command()->id.group_id;
-				switch (result.status()) {
-					case 0: break; // skip successes
-					case -ETIMEDOUT: // collect timed-out groups
-						groups.emplace_back(group_id);
-						break;
-					default: // store one other error
-						last_error_ = result.status();
-						break;
-				}
-			}
-			return groups;
+	uint64_t bytes_{0};
+	/* filled before the first write and never modified after that, every group's entry is used only
+	 * by the chain of writes to this group
+	 */
+	std::unordered_map<int, group_state> groups_;
+	std::shared_ptr<send_completion> completion_;
+};
 
-		}();
+/*
+ * \a large_object_reader reads chunks of a large object once for senders of all destination groups.
+ * The object is locked from the first chunk read until the last one, chunks are shared by the senders
+ * and freed when every group has written them, so groups write them independently and a group
+ * may go ahead of the slowest one by up to MAXIMAL_CHUNKS_AHEAD chunks.
+ */
+class large_object_reader {
+public:
+	struct chunk {
+		ioremap::elliptics::data_pointer json; /* json is read with the first chunk only */
+		ioremap::elliptics::data_pointer data;
+	};
 
-		if (retry_count_-- && !retry_groups.empty()) {
-			DNET_LOG_INFO(log_, "EBLOB: server_send {}: small_object_sender: retrying write to groups: {}"
-			                    ", retry: {:d}/{:d}",
-			              dnet_dump_id_str(info_->key.id), retry_groups,
-			              request_.chunk_retry_count - retry_count_, request_.chunk_retry_count);
+	large_object_reader(eblob_backend_config *backend,
+	                    dnet_net_state *st,
+	                    dnet_cmd *cmd,
+	                    std::shared_ptr<iterated_key_info> info,
+	                    const uint64_t chunk_size,
+	                    const size_t groups_count)
+	: m_log{backend->blog}
+	, m_info{std::move(info)}
+	, m_chunk_size{chunk_size}
+	, m_pool{dnet_backend_get_pool(st->n, backend->data.stat_id)}
+	, m_next(groups_count, 0) {
+		dnet_setup_id(&m_id, cmd->id.group_id, m_info->key.id);
+	}
+
+	~large_object_reader() {
+		unlock_id();
+	}
+
+	/*!
+	 * Fills \a result with chunk \a index for the group's sender \a slot, reading it if no group has read it yet.
+	 * Chunks before \a index are no longer needed by the slot. Waits while the slot is MAXIMAL_CHUNKS_AHEAD chunks
+	 * ahead of the slowest group. Returns error of reading the object.
+	 */
+	int get(size_t slot, size_t index, chunk &result) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+
+		m_next[slot] = index;
+		release_chunks();
 
-			session_.set_groups(retry_groups);
-			write();
+		while (index >= slowest() + MAXIMAL_CHUNKS_AHEAD) {
+			m_cond.wait(lock);
+		}
+
+		while (!m_error && m_first + m_chunks.size() <= index) {
+			m_error = read_chunk();
+		}
+
+		if (m_error)
+			return m_error;
+
+		result = m_chunks[index - m_first];
+		return 0;
+	}
+
+	/*!
+	 * Marks the group's sender \a slot as finished: it doesn't need any chunk anymore.
+	 */
+	void finish(size_t slot) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+
+		m_next[slot] = std::numeric_limits<size_t>::max();
+		release_chunks();
+
+		if (slowest() == std::numeric_limits<size_t>::max()) {
+			// all groups have finished before the last chunk was read
+			unlock_id();
+		}
+	}
+
+private:
+	void lock_id() {
+		if (m_id_locked)
+			return;
+
+		dnet_oplock(m_pool, &m_id);
+		m_id_locked = true;
+	}
+
+	void unlock_id() {
+		if (!m_id_locked)
 			return;
+
+		dnet_opunlock(m_pool, &m_id);
+		m_id_locked = false;
+	}
+
+	size_t slowest() const {
+		return *std::min_element(m_next.begin(), m_next.end());
+	}
+
+	void release_chunks() {
+		const size_t first_needed = slowest();
+		while (!m_chunks.empty() && m_first < first_needed) {
+			m_chunks.pop_front();
+			++m_first;
 		}
+		m_cond.notify_all();
+	}
+
+	int read_chunk() {
+		const size_t index = m_first + m_chunks.size();
+		const uint64_t offset = index * m_chunk_size;
+		const uint64_t size = std::min(m_info->data_size - offset, m_chunk_size);
 
-		if (!retry_groups.empty())
-			last_error_ = -ETIMEDOUT;
+		if (!index)
+			lock_id();
 
-		send_response(last_error_);
+		chunk result;
+		if (!index && m_info->jhdr.size) {
+			result.json = ioremap::elliptics::data_pointer::allocate(m_info->jhdr.size);
+			const int err = dnet_read_ll(m_info->fd, result.json.data<char>(), result.json.size(),
+			                             m_info->json_offset);
+			if (err) {
+				DNET_LOG_ERROR(m_log, "EBLOB: server_send: {}: failed to read json: {}",
+				               dnet_dump_id_str(m_info->key.id), dnet_print_error(err));
+				unlock_id();
+				return err;
+			}
+		}
+
+		result.data = ioremap::elliptics::data_pointer::allocate(size);
+		if (size) {
+			const int err = dnet_read_ll(m_info->fd, result.data.data<char>(), size,
+			                             m_info->data_offset + offset);
+			if (err) {
+				DNET_LOG_ERROR(m_log, "EBLOB: server_send: {}: failed to read data: {}",
+				               dnet_dump_id_str(m_info->key.id), dnet_print_error(err));
+				unlock_id();
+				return err;
+			}
+		}
+
+		if (offset + size >= m_info->data_size) {
+			// unlock id because all its data has been read
+			unlock_id();
+		}
+
+		m_chunks.emplace_back(std::move(result));
+		return 0;
 	}
 
-	uint8_t retry_count_{0};
-	int last_error_{0};
+	/* number of chunks a group may write ahead of the slowest group */
+	static constexpr size_t MAXIMAL_CHUNKS_AHEAD = 4;
+
+	dnet_logger *m_log;
+	const std::shared_ptr<iterated_key_info> m_info;
+	const uint64_t m_chunk_size;
+
+	dnet_io_pool *m_pool;
+	dnet_id m_id;
+	bool m_id_locked{false};
+
+	/* index of the chunk every group's sender needs next, max() for finished senders */
+	std::vector<size_t> m_next;
+	/* read chunks which are still needed by some group, the first of them has index @m_first */
+	std::deque<chunk> m_chunks;
+	size_t m_first{0};
+	int m_error{0};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
 };
 
+constexpr size_t large_object_reader::MAXIMAL_CHUNKS_AHEAD;
+
+/*
+ * \a large_object_sender sends large object to a single destination group chunk by chunk,
+ * every group is sent by its own thread, so a slow group doesn't delay chunks of other groups.
+ * Chunks are read by \a large_object_reader shared with senders of other groups.
+ */
 class large_object_sender : public base_object_sender {
 public:
-	using base_object_sender::base_object_sender;
+	large_object_sender(eblob_backend_config *backend,
+	                    dnet_net_state *st,
+	                    const uint64_t iterator_id,
+	                    dnet_cmd *cmd,
+	                    const ioremap::elliptics::dnet_server_send_request &request,
+	                    std::shared_ptr<iterated_key_info> info,
+	                    congestion_control_monitor &monitor,
+	                    std::atomic<uint64_t> &counter,
+	                    int group,
+	                    size_t slot,
+	                    std::shared_ptr<large_object_reader> reader,
+	                    std::shared_ptr<send_completion> completion)
+	: base_object_sender(backend, st, iterator_id, cmd, request, std::move(info), monitor, counter)
+	, group_{group}
+	, slot_{slot}
+	, reader_{std::move(reader)}
+	, completion_{std::move(completion)} {
+		session_.set_groups({group_});
+	}
 
 	void send() {
-		active_groups_.insert(request_.groups.begin(), request_.groups.end());
-		retry_groups_.reserve(request_.groups.size());
-
-		while (read_and_write_chunk()) {
-			data_offset_ += data_.size();
+		for (size_t index = 0; read_and_write_chunk(index); ++index) {
+			data_offset_ += chunk_.data.size();
 		}
 
-		send_response(last_error_);
+		chunk_ = large_object_reader::chunk{};
+		reader_->finish(slot_);
+
+		if (completion_->complete(last_error_))
+			send_response(completion_->error());
 	}
 
 private:
-	bool read_and_write_chunk() {
+	bool read_and_write_chunk(size_t index) {
 		if (st_->__need_exit)
 			return false;
 
 		if (!remaining_size())
 			return false;
 
-		if (const int err = read()) {
-			// TODO: should we remove the key from active_groups if read was failed?
+		if (const int err = reader_->get(slot_, index, chunk_)) {
 			last_error_ = err;
 			return false;
 		}
 
-		session_.set_groups({active_groups_.begin(), active_groups_.end()});
 		auto retry_count = request_.chunk_retry_count;
-		do {
-			if (!retry_groups_.empty()) {
-				DNET_LOG_INFO(log_, "EBLOB: server_send {}: large_object_sender: retrying write to "
-				                    "groups: {}, retry: {:d}/{:d}",
-				              dnet_dump_id_str(info_->key.id), retry_groups_,
-				              request_.chunk_retry_count - retry_count,
-				              request_.chunk_retry_count);
-				session_.set_groups(retry_groups_);
-				retry_groups_.clear();
+		int status = 0;
+		while (true) {
+			status = write_chunk();
+			if (status != -ETIMEDOUT || !retry_count--)
+				break;
+
+			DNET_LOG_INFO(log_, "EBLOB: server_send {}: large_object_sender: retrying write to "
+			                    "group: {}, retry: {:d}/{:d}",
+			              dnet_dump_id_str(info_->key.id), group_,
+			              request_.chunk_retry_count - retry_count, request_.chunk_retry_count);
+		}
+
+		// stop writing to the group after the first failed chunk and answer to client with the error
+		last_error_ = status;
+		return !status;
+	}
+
+	int write_chunk() {
+		const uint64_t bytes = chunk_.json.size() + chunk_.data.size();
+		monitor_.acquire(group_, bytes);
+
+		timer_.restart();
+		auto async = write();
+		const auto results = async.get();
+		const int status = results.empty() ? async.error().code() : results.front().status();
+
+		monitor_.remove_bytes(group_, bytes, timer_.get_us(), status);
+		return status;
+	}
+
+	ioremap::elliptics::newapi::async_write_result write() {
+		if (!data_offset_) {
+			return session_.write_prepare(info_->key,
+			                              chunk_.json, info_->jhdr.capacity,
+			                              chunk_.data, 0, info_->data_size);
+		} else if (remaining_size() > request_.chunk_size) {
+			return session_.write_plain(info_->key, "", chunk_.data, data_offset_);
+		} else {
+			session_.set_timeout(commit_timeout_);
+			return session_.write_commit(info_->key, "", chunk_.data, data_offset_, info_->data_size);
+		}
+	}
+
+
+	const int group_;
+	const size_t slot_;
+	const std::shared_ptr<large_object_reader> reader_;
+	large_object_reader::chunk chunk_;
+	const std::shared_ptr<send_completion> completion_;
+	ioremap::elliptics::util::steady_timer timer_;
+	int last_error_{0};
+};
+
+/*
+ * \a large_object_queue sends large objects to a single destination group in a separate thread, so they are
+ * pipelined independently of small objects which are sent asynchronously and of large objects sent to other groups.
+ */
+class large_object_queue {
+public:
+	/* large object shared by the queues of all destination groups */
+	struct item {
+		std::shared_ptr<iterated_key_info> info;
+		std::shared_ptr<large_object_reader> reader;
+		std::shared_ptr<send_completion> completion;
+	};
+
+	large_object_queue(std::function<void (const item &)> handler)
+	: m_handler{std::move(handler)}
+	, m_stopped{false}
+	, m_thread{&large_object_queue::run, this} {
+	}
+
+	~large_object_queue() {
+		stop();
+	}
+
+	/*!
+	 * Waits until the queue has free space and enqueues \a object
+	 */
+	void push(const item &object) {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		while (m_queue.size() >= MAXIMAL_QUEUE_SIZE) {
+			m_cond.wait(lock);
+		}
+		m_queue.emplace_back(object);
+		m_cond.notify_all();
+	}
+
+	/*!
+	 * Waits until all queued objects are sent and stops the thread
+	 */
+	void stop() {
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_stopped = true;
+			m_cond.notify_all();
+		}
+
+		if (m_thread.joinable())
+			m_thread.join();
+	}
+
+private:
+	void run() {
+		std::unique_lock<std::mutex> lock{m_mutex};
+		while (true) {
+			while (m_queue.empty() && !m_stopped) {
+				m_cond.wait(lock);
 			}
+			if (m_queue.empty())
+				break;
 
-			for (const auto &result: write()) {
-				const auto group_id = result.command()->id.group_id;
-				switch (result.status()) {
-					case 0: break; // skip successes
-					case -ETIMEDOUT: // collect timed-out groups
-						retry_groups_.emplace_back(group_id);
-						break;
-					default: // store one other error and remove group from active
-						last_error_ = result.status();
-						active_groups_.erase(group_id);
-						break;
+			auto object = std::move(m_queue.front());
+			m_queue.pop_front();
+			m_cond.notify_all();
+
+			lock.unlock();
+			m_handler(object);
+			lock.lock();
+		}
+	}
+
+	/* number of large objects waiting for the sending thread */
+	static constexpr size_t MAXIMAL_QUEUE_SIZE = 4;
+
+	std::function<void (const item &)> m_handler;
+	std::deque<item> m_queue;
+	bool m_stopped;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+};
+
+constexpr size_t large_object_queue::MAXIMAL_QUEUE_SIZE;
+
+static iterator_callback make_iterator_server_send_callback(eblob_backend_config *c,
+                                                            dnet_net_state *st,
+                                                            dnet_cmd *cmd,
+                                                            const ioremap::elliptics::dnet_server_send_request &request,
+                                                            uint64_t iterator_id,
+                                                            congestion_control_monitor &monitor,
+                                                            std::vector<std::unique_ptr<large_object_queue>> &large_objects,
+                                                            std::atomic<uint64_t> &counter) {
+	using namespace ioremap::elliptics;
+	return [=, &request, &counter, &monitor, &large_objects] (std::shared_ptr<iterated_key_info> info) -> int {
+		if (st->__need_exit) {
+			DNET_LOG_ERROR(c->blog, "EBLOB: Interrupting server_send: peer has been disconnected");
+			return -EINTR;
+		}
+
+		// use small key sender if data_size is less than chunk_size
+		if (info->data_size <= request.chunk_size) {
+			monitor.wait_backlog();
+
+			const auto sender = std::make_shared<small_object_sender>(c, st, iterator_id, cmd, request,
+			                                                          info, monitor, counter);
+			sender->send();
+		} else {
+			const large_object_queue::item object{
+				info,
+				std::make_shared<large_object_reader>(c, st, cmd, info, request.chunk_size, large_objects.size()),
+				std::make_shared<send_completion>(large_objects.size())
+			};
+			for (auto &queue : large_objects) {
+				queue->push(object);
+			}
+		}
+
+		return 0;
+	};
+}
+
+/*
+ * \a iterator_network_sender sends records iterated by DNET_ITYPE_NETWORK iterator to the client.
+ * Records which take up to a quarter of readahead window are sliced from large aligned windows read
+ * from the blob sequentially, their replies are packed into batches of up to batch_size bytes and every batch
+ * is sent by a single request. Batches hold their records in memory, so send queue accounts them both reply
+ * by reply and by bytes and the iterator sleeps while the state buffers more than DNET_SEND_BYTES_WATERMARK_HIGH.
+ * Larger records are sent by sendfile.
+ * Every worker thread of parallel iteration has its own window and batch.
+ */
+class iterator_network_sender {
+public:
+	iterator_network_sender(eblob_backend_config *c, dnet_net_state *st, dnet_cmd *cmd,
+	                        const ioremap::elliptics::dnet_iterator_request &request, const dnet_iterator *it)
+	: m_c{c}
+	, m_st{st}
+	, m_cmd{cmd}
+	, m_request(request)
+	, m_it{it}
+	, m_total_keys{eblob_total_elements(c->eblob)}
+	, m_counter{0} {}
+
+	int send(const iterated_key_info &info) {
+		if (m_st->__need_exit) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: Interrupting iterator: peer has been disconnected");
+			return -EINTR;
+		}
+
+		auto &s = get_stream();
+
+		const uint64_t json_size = ((m_request.flags & DNET_IFLAGS_JSON) && info.jhdr.size) ? info.jhdr.size : 0;
+		const uint64_t read_data_size = (m_request.flags & DNET_IFLAGS_DATA) ? info.data_size : 0;
+
+		bool buffered = true;
+		if (json_size || read_data_size) {
+			const uint64_t begin = json_size ? info.json_offset : info.data_offset;
+			const uint64_t end = read_data_size ? info.data_offset + read_data_size
+			                                    : info.json_offset + json_size;
+
+			buffered = end - begin <= m_c->iterator_readahead_size / 4;
+			if (buffered) {
+				const int err = s.load(info.fd, begin, end, m_c->iterator_readahead_size);
+				if (err) {
+					DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: {}: failed to read blob window: {} [{}]",
+					               dnet_dump_id_str(info.key.id), strerror(-err), err);
+					return err;
 				}
 			}
-		} while (retry_count-- && !retry_groups_.empty());
-
-		if (!retry_groups_.empty()) {
-			// set error to -ETIMEDOUT if retry groups aren't empty and
-			// error wasn't already set
-			last_error_ = -ETIMEDOUT;
-			// remove groups that were failed to retry from active groups
-			for (auto group_id: retry_groups_) {
-				active_groups_.erase(group_id);
+		}
+
+		if (buffered) {
+			const auto header = make_header(info, json_size, read_data_size);
+			const size_t reply_size = sizeof(*m_cmd) + header.size() + json_size + read_data_size;
+
+			/* a batch never outgrows batch_size unless it carries a single record */
+			if (s.batch.size() + reply_size > batch_size) {
+				const int err = flush(s);
+				if (err)
+					return err;
+			}
+
+			s.append(m_cmd, header, json_size ? s.at(info.json_offset) : nullptr, json_size,
+			         read_data_size ? s.at(info.data_offset) : nullptr, read_data_size);
+
+			if (s.batch.size() >= batch_size)
+				return flush(s);
+			return 0;
+		}
+
+		/* replies of a stream have to be sent in iteration order, so pending batch goes first */
+		int err = flush(s);
+		if (err)
+			return err;
+
+		using namespace ioremap::elliptics;
+
+		data_pointer json;
+		if (json_size) {
+			json = data_pointer::allocate(json_size);
+			err = dnet_read_ll(info.fd, json.data<char>(), json.size(), info.json_offset);
+			if (err) {
+				DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: {}: failed to read json: {} [{}]",
+				               dnet_dump_id_str(info.key.id), strerror(-err), err);
+				return err;
+			}
+		}
+
+		const auto header = make_header(info, json_size, read_data_size);
+
+		if (m_st->__need_exit) {
+			DNET_LOG_ERROR(m_c->blog,
+			               "EBLOB: iterator: Interrupting iterator because peer has been disconnected");
+			return -EINTR;
+		}
+
+		auto response = data_pointer::allocate(sizeof(*m_cmd) + header.size() + json.size());
+
+		memcpy(response.data(), m_cmd, sizeof(*m_cmd));
+		memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
+		if (!json.empty()) {
+			memcpy(response.skip(sizeof(*m_cmd) + header.size()).data(), json.data(), json.size());
+		}
+
+		response.data<dnet_cmd>()->size = header.size() + json.size() + read_data_size;
+		response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+		response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+
+		return dnet_send_fd_threshold(m_st, response.data(), response.size(),
+		                              info.fd, info.data_offset, read_data_size);
+	}
+
+	/* sends batches left by all worker threads, it is called after all workers have finished */
+	int flush_all() {
+		std::lock_guard<std::mutex> guard(m_lock);
+		for (auto &stream : m_streams) {
+			const int err = flush(*stream.second);
+			if (err)
+				return err;
+		}
+		return 0;
+	}
+
+private:
+	/* max size of replies packed into a single send request */
+	static const size_t batch_size = 1024 * 1024;
+	/* blob windows are aligned to pages to keep reads friendly to the page cache and direct io */
+	static const uint64_t window_alignment = 4096;
+
+	struct stream {
+		int fd = -1;
+		uint64_t window_offset = 0;
+		uint64_t window_size = 0;
+		std::vector<char> window;
+
+		std::vector<char> batch;
+		long replies = 0;
+
+		/* makes [begin, end) of \a fd available in the window reading the blob by \a readahead bytes */
+		int load(int record_fd, uint64_t begin, uint64_t end, uint64_t readahead) {
+			if (record_fd == fd && begin >= window_offset && end <= window_offset + window_size)
+				return 0;
+
+			if (record_fd != fd) {
+				/* new blob: let kernel know it will be read sequentially */
+				posix_fadvise(record_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+			}
+
+			fd = -1;
+			window_offset = begin & ~(window_alignment - 1);
+			window_size = std::max(readahead, end - window_offset);
+			window.resize(window_size);
+
+			uint64_t size = 0;
+			while (size < window_size) {
+				const ssize_t bytes = pread(record_fd, window.data() + size, window_size - size,
+				                            window_offset + size);
+				if (bytes < 0) {
+					if (errno == EINTR)
+						continue;
+					return -errno;
+				}
+				if (bytes == 0)
+					break;
+				size += bytes;
 			}
-			retry_groups_.clear();
+
+			window_size = size;
+			if (window_offset + window_size < end)
+				return -ENODATA;
+
+			fd = record_fd;
+			/* the next window is read by kernel while records of the current one are sent */
+			posix_fadvise(fd, window_offset + window_size, readahead, POSIX_FADV_WILLNEED);
+			return 0;
+		}
+
+		const char *at(uint64_t offset) const {
+			return window.data() + (offset - window_offset);
+		}
+
+		void append(const dnet_cmd *cmd, const ioremap::elliptics::data_pointer &header,
+		            const char *json, uint64_t json_size, const char *data, uint64_t data_size) {
+			dnet_cmd reply = *cmd;
+			reply.size = header.size() + json_size + data_size;
+			reply.flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+			reply.flags &= ~DNET_FLAGS_NEED_ACK;
+
+			const char *raw = reinterpret_cast<const char *>(&reply);
+			batch.insert(batch.end(), raw, raw + sizeof(reply));
+			batch.insert(batch.end(), header.data<char>(), header.data<char>() + header.size());
+			if (json_size)
+				batch.insert(batch.end(), json, json + json_size);
+			if (data_size)
+				batch.insert(batch.end(), data, data + data_size);
+			++replies;
+		}
+	};
+
+	ioremap::elliptics::data_pointer make_header(const iterated_key_info &info,
+	                                             uint64_t json_size, uint64_t read_data_size) {
+		return ioremap::elliptics::serialize(ioremap::elliptics::dnet_iterator_response{
+			m_it->id, // iterator_id
+			info.key, // key
+			0, // status
+
+			++m_counter, // iterated_keys
+			m_total_keys, // total_keys
+
+			info.record_flags, // record_flags
+			info.ehdr.flags, // user_flags
+
+			info.jhdr.timestamp, // json_timestamp
+			info.jhdr.size, // json_size
+			info.jhdr.capacity, // json_capacity
+			json_size, // read_json_size
+
+			info.ehdr.timestamp, // data timestamp
+			info.data_size, // data_size
+			read_data_size, // read_data_size
+			info.data_offset, // data_offset
+			static_cast<uint64_t>(info.fd) // blob_id
+		});
+	}
+
+	int flush(stream &s) {
+		if (!s.replies)
+			return 0;
+
+		if (m_st->__need_exit) {
+			DNET_LOG_ERROR(m_c->blog,
+			               "EBLOB: iterator: Interrupting iterator because peer has been disconnected");
+			return -EINTR;
+		}
+
+		const int err = dnet_send_replies_threshold(m_st, s.batch.data(), s.batch.size(), s.replies);
+		s.batch.clear();
+		s.replies = 0;
+		return err;
+	}
+
+	stream &get_stream() {
+		std::lock_guard<std::mutex> guard(m_lock);
+		auto &s = m_streams[std::this_thread::get_id()];
+		if (!s) {
+			s.reset(new stream);
+			s->batch.reserve(batch_size);
+		}
+		return *s;
+	}
+
+	eblob_backend_config *m_c;
+	dnet_net_state *m_st;
+	dnet_cmd *m_cmd;
+	const ioremap::elliptics::dnet_iterator_request &m_request;
+	const dnet_iterator *m_it;
+	const uint64_t m_total_keys;
+	std::atomic<uint64_t> m_counter;
+
+	std::mutex m_lock;
+	std::unordered_map<std::thread::id, std::unique_ptr<stream>> m_streams;
+};
+
+const size_t iterator_network_sender::batch_size;
+const uint64_t iterator_network_sender::window_alignment;
+
+/*
+ * \a iterator_container collects dnet_iterator_response records of DNET_ITYPE_DISK iterator
+ * into a local file in the format read by dnet_iterator_response_container_*().
+ * The file is created in "iter" directory next to the blobs and is unlinked right away,
+ * so it is removed as soon as the container is sent to the client or the iterator fails.
+ */
+class iterator_container {
+public:
+	iterator_container(eblob_backend_config *c)
+	: m_c{c}
+	, m_fd{-1}
+	, m_size{0} {
+		m_buffer.reserve(flush_size);
+	}
+
+	~iterator_container() {
+		if (m_fd >= 0)
+			close(m_fd);
+	}
+
+	iterator_container(const iterator_container &) = delete;
+	iterator_container &operator=(const iterator_container &) = delete;
+
+	int open(uint64_t iterator_id) {
+		std::string dir = m_c->data.file ? m_c->data.file : "";
+		const auto pos = dir.find_last_of('/');
+		dir = (pos == std::string::npos) ? "iter" : dir.substr(0, pos) + "/iter";
+
+		if (mkdir(dir.c_str(), 0755) && errno != EEXIST) {
+			const int err = -errno;
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to create container directory: {}: {} [{}]",
+			               dir, strerror(-err), err);
+			return err;
+		}
+
+		std::string path = dir + "/" + std::to_string(iterator_id) + ".XXXXXX";
+		m_fd = mkstemp(&path[0]);
+		if (m_fd < 0) {
+			const int err = -errno;
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to create container: {}: {} [{}]",
+			               path, strerror(-err), err);
+			return err;
+		}
+
+		unlink(path.c_str());
+
+		DNET_LOG_INFO(m_c->blog, "EBLOB: iterator: created container: {}", path);
+		return 0;
+	}
+
+	int append(const dnet_iterator_response &response) {
+		std::unique_lock<std::mutex> guard(m_lock);
+
+		m_buffer.push_back(response);
+		dnet_convert_iterator_response(&m_buffer.back());
+
+		if (m_buffer.size() < flush_size)
+			return 0;
+		return flush_nolock();
+	}
+
+	/* Flushes buffered records and sorts the container, returns its size in bytes */
+	int64_t finish() {
+		std::unique_lock<std::mutex> guard(m_lock);
+
+		int err = flush_nolock();
+		if (err)
+			return err;
+
+		err = dnet_iterator_response_container_sort(m_fd, m_size);
+		if (err) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to sort container: size: {}: {} [{}]",
+			               m_size, strerror(-err), err);
+			return err;
 		}
 
-		// if active_groups are empty then there is no group can continue writes,
-		// so stop writing and answer to client with the last error.
-		return !active_groups_.empty();
+		return m_size;
 	}
 
-	ioremap::elliptics::newapi::async_write_result write() {
-		if (!data_offset_) {
-			return session_.write_prepare(info_->key,
-			                              json(), info_->jhdr.capacity,
-			                              data(), 0, info_->data_size);
-		} else if (remaining_size() > request_.chunk_size) {
-			return session_.write_plain(info_->key, "", data(), data_offset_);
-		} else {
-			session_.set_timeout(commit_timeout_);
-			return session_.write_commit(info_->key, "", data(), data_offset_, info_->data_size);
+	/* Passes ownership of the container file to the caller */
+	int release() {
+		const int fd = m_fd;
+		m_fd = -1;
+		return fd;
+	}
+
+private:
+	int flush_nolock() {
+		if (m_buffer.empty())
+			return 0;
+
+		const size_t size = m_buffer.size() * sizeof(m_buffer.front());
+		const int err = dnet_write_ll(m_fd, reinterpret_cast<const char *>(m_buffer.data()), size, m_size);
+		if (err) {
+			DNET_LOG_ERROR(m_c->blog, "EBLOB: iterator: failed to write container: offset: {}, size: {}: {} [{}]",
+			               m_size, size, strerror(-err), err);
+			return err;
 		}
+
+		m_size += size;
+		m_buffer.clear();
+		return 0;
 	}
 
+	/* number of records buffered in memory before they are written to the container */
+	static const size_t flush_size = 1024;
 
-	std::unordered_set<int> active_groups_;
-	std::vector<int> retry_groups_;
-	int last_error_{0};
+	eblob_backend_config *m_c;
+	std::mutex m_lock;
+	int m_fd;
+	uint64_t m_size;
+	std::vector<dnet_iterator_response> m_buffer;
 };
 
-static iterator_callback make_iterator_server_send_callback(eblob_backend_config *c,
-                                                            dnet_net_state *st,
-                                                            dnet_cmd *cmd,
-                                                            const ioremap::elliptics::dnet_server_send_request &request,
-                                                            uint64_t iterator_id,
-                                                            congestion_control_monitor &monitor,
-                                                            std::atomic<uint64_t> &counter) {
-	using namespace ioremap::elliptics;
-	return [=, &request, &counter, &monitor] (std::shared_ptr<iterated_key_info> info) -> int {
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog, "EBLOB: Interrupting server_send: peer has been disconnected");
-			return -EINTR;
-		}
+static iterator_callback make_iterator_disk_callback(eblob_backend_config *c,
+                                                     std::shared_ptr<iterator_container> container,
+                                                     const dnet_iterator *it) {
+	auto counter = std::make_shared<std::atomic<uint64_t>>(0);
+	const uint64_t total_keys = eblob_total_elements(c->eblob);
 
-		// use small key sender if data_size is less than chunk_size
-		if (info->data_size <= request.chunk_size) {
-			const auto sender = std::make_shared<small_object_sender>(c, st, iterator_id, cmd, request,
-			                                                          info, monitor, counter);
-			sender->send();
-		} else {
-			large_object_sender sender{c, st, iterator_id, cmd, request, info, monitor, counter};
-			sender.send();
-		}
+	return [=] (std::shared_ptr<iterated_key_info> info) -> int {
+		dnet_iterator_response response;
+		memset(&response, 0, sizeof(response));
 
-		return 0;
+		response.id = it->id;
+		response.key = info->key;
+		response.timestamp = info->ehdr.timestamp;
+		response.user_flags = info->ehdr.flags;
+		response.size = info->data_size;
+		response.iterated_keys = ++(*counter);
+		response.total_keys = total_keys;
+		response.flags = info->record_flags;
+
+		return container->append(response);
 	};
 }
 
-static iterator_callback make_iterator_network_callback(eblob_backend_config *c, dnet_net_state *st,
-                                                        dnet_cmd *cmd,
-                                                        ioremap::elliptics::dnet_iterator_request &request,
-                                                        const dnet_iterator *it) {
+/*
+ * Sends sorted container of DNET_ITYPE_DISK iterator to the client as a single reply:
+ * the reply's data is the whole container, its data_size is the size of the container
+ * and iterated_keys is the number of records in it.
+ */
+static int blob_iterator_send_container(eblob_backend_config *c, dnet_net_state *st, dnet_cmd *cmd,
+                                        const dnet_iterator *it, iterator_container &container) {
 	using namespace ioremap::elliptics;
-	auto counter = std::make_shared<std::atomic<uint64_t>>(0);
-	const uint64_t total_keys = eblob_total_elements(c->eblob);
-
-	return [=, &request] (std::shared_ptr<iterated_key_info> info) -> int {
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog, "EBLOB: iterator: Interrupting iterator: peer has been disconnected");
-			return -EINTR;
-		}
 
-		data_pointer json;
-		if ((request.flags & DNET_IFLAGS_JSON) && info->jhdr.size) {
-			json = data_pointer::allocate(info->jhdr.size);
-			const int err = dnet_read_ll(info->fd, json.data<char>(), json.size(), info->json_offset);
-			if (err) {
-				DNET_LOG_ERROR(c->blog, "EBLOB: iterator: {}: failed to read json: {} [{}]",
-				               dnet_dump_id_str(info->key.id), strerror(-err), err);
-				return err;
-			}
-		}
+	const int64_t size = container.finish();
+	if (size < 0)
+		return size;
 
-		const uint64_t read_data_size = (request.flags & DNET_IFLAGS_DATA) ? info->data_size : 0;
+	const uint64_t records = size / sizeof(::dnet_iterator_response);
 
-		auto header = serialize(ioremap::elliptics::dnet_iterator_response{
-			it->id, // iterator_id
-			info->key, // key
-			0, // status
+	auto header = serialize(ioremap::elliptics::dnet_iterator_response{
+		it->id, // iterator_id
+		dnet_raw_id{{0}}, // key
+		0, // status
 
-			++(*counter), // iterated_keys
-			total_keys, // total_keys
+		records, // iterated_keys
+		uint64_t(eblob_total_elements(c->eblob)), // total_keys
 
-			info->record_flags, // record_flags
-			info->ehdr.flags, // user_flags
+		0, // record_flags
+		0, // user_flags
 
-			info->jhdr.timestamp, // json_timestamp
-			info->jhdr.size, // json_size
-			info->jhdr.capacity, // json_capacity
-			json.size(), // read_json_size
+		dnet_time{0, 0}, // json_timestamp
+		0, // json_size
+		0, // json_capacity
+		0, // read_json_size
 
-			info->ehdr.timestamp, // data timestamp
-			info->data_size, // data_size
-			read_data_size, // read_data_size
-			info->data_offset, // data_offset
-			static_cast<uint64_t>(info->fd) // blob_id
-		});
+		dnet_time{0, 0}, // data timestamp
+		uint64_t(size), // data_size
+		uint64_t(size), // read_data_size
+		0, // data_offset
+		0 // blob_id
+	});
 
-		if (st->__need_exit) {
-			DNET_LOG_ERROR(c->blog,
-			               "EBLOB: iterator: Interrupting iterator because peer has been disconnected");
-			return -EINTR;
-		}
+	auto response = data_pointer::allocate(sizeof(*cmd) + header.size());
+	memcpy(response.data(), cmd, sizeof(*cmd));
+	memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
 
-		auto response = data_pointer::allocate(sizeof(*cmd) + header.size() + json.size());
+	response.data<dnet_cmd>()->size = header.size() + size;
+	response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+	response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
 
-		memcpy(response.data(), cmd, sizeof(*cmd));
-		memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
-		if (!json.empty()) {
-			memcpy(response.skip(sizeof(*cmd) + header.size()).data(), json.data(), json.size());
-		}
+	/* reply to the local state reads the file synchronously and doesn't close it */
+	const bool local = (st == st->n->st);
+	const int fd = container.release();
 
-		response.data<dnet_cmd>()->size = header.size() + json.size() + read_data_size;
-		response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
-		response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+	const int err = dnet_send_fd(st, response.data(), response.size(), fd, 0, size,
+	                             local ? 0 : DNET_IO_REQ_FLAGS_CLOSE, /*context*/ nullptr);
+	if (err || local)
+		close(fd);
 
-		return dnet_send_fd_threshold(st, response.data(), response.size(), info->fd, info->data_offset, read_data_size);
-	};
+	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO,
+	         "EBLOB: iterator: {}: sent container: records: {}, size: {}: {} [{}]",
+	         it->id, records, size, strerror(-err), err);
+	return err;
 }
 
-
 static int blob_iterate_callback_common(const eblob_backend_config *c,
                                         const ioremap::elliptics::dnet_iterator_request &request,
                                         dnet_iterator *it,
@@ -1707,6 +2885,49 @@ static int blob_iterate_callback_common(const eblob_backend_config *c,
 	return dnet_iterator_flow_control(it);
 }
 
+/*
+ * Splits key space into \a parts slices of equal size by the first 8 bytes of the key and intersects
+ * them with \a ranges. Returns ranges of every slice, slices which don't intersect with \a ranges are omitted.
+ */
+static std::vector<std::vector<eblob_index_block>> blob_iterator_partition(const std::vector<eblob_index_block> &ranges,
+                                                                           size_t parts) {
+	auto make_key = [] (uint64_t prefix, int fill) {
+		eblob_key key;
+		memset(key.id, fill, EBLOB_ID_SIZE);
+		for (size_t i = 0; i < sizeof(prefix); ++i) {
+			key.id[i] = prefix >> (8 * (sizeof(prefix) - 1 - i));
+		}
+		return key;
+	};
+
+	auto less = [] (const eblob_key &lhs, const eblob_key &rhs) {
+		return memcmp(lhs.id, rhs.id, EBLOB_ID_SIZE) < 0;
+	};
+
+	const uint64_t step = UINT64_MAX / parts;
+
+	std::vector<std::vector<eblob_index_block>> slices;
+	for (size_t part = 0; part < parts; ++part) {
+		const eblob_key begin = make_key(step * part, 0);
+		const eblob_key end = (part + 1 == parts) ? make_key(UINT64_MAX, 0xff) : make_key(step * (part + 1) - 1, 0xff);
+
+		std::vector<eblob_index_block> slice;
+		for (const auto &range : ranges) {
+			const eblob_key &slice_begin = less(range.start_key, begin) ? begin : range.start_key;
+			const eblob_key &slice_end = less(end, range.end_key) ? end : range.end_key;
+			if (!less(slice_end, slice_begin)) {
+				slice.emplace_back(eblob_index_block{slice_begin, slice_end, 0, 0});
+			}
+		}
+
+		if (!slice.empty()) {
+			slices.emplace_back(std::move(slice));
+		}
+	}
+
+	return slices;
+}
+
 static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *st, dnet_cmd *cmd,
                                ioremap::elliptics::dnet_iterator_request &request) {
 	using namespace ioremap::elliptics;
@@ -1761,14 +2982,24 @@ static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *s
 	}
 
 	iterator_callback callback;
+	std::shared_ptr<iterator_container> container;
+	std::shared_ptr<iterator_network_sender> sender;
 
 	switch (request.type) {
 		case DNET_ITYPE_DISK: {
-			DNET_LOG_ERROR(c->blog, "EBLOB: iteration failed: type: 'DNET_ITYPE_DISK' is not implemented");
-			return -ENOTSUP;
+			container = std::make_shared<iterator_container>(c);
+			const int err = container->open(it->id);
+			if (err)
+				return err;
+
+			callback = make_iterator_disk_callback(c, container, it.get());
+			break;
 		}
 		case DNET_ITYPE_NETWORK: {
-			callback = make_iterator_network_callback(c, st, cmd, request, it.get());
+			sender = std::make_shared<iterator_network_sender>(c, st, cmd, request, it.get());
+			callback = [sender] (std::shared_ptr<iterated_key_info> info) -> int {
+				return sender->send(*info);
+			};
 			break;
 		}
 		default: {
@@ -1777,7 +3008,12 @@ static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *s
 		}
 	}
 
+	/* the first error of parallel workers, it stops all other workers */
+	std::atomic<int> failed{0};
+
 	auto common_callback = [&] (const eblob_disk_control *dc, int fd, uint64_t data_offset) -> int {
+		if (const int err = failed.load())
+			return err;
 		return blob_iterate_callback_common(c, request, it.get(), dc, fd, data_offset, callback);
 	};
 
@@ -1789,7 +3025,54 @@ static int blob_iterator_start(struct eblob_backend_config *c, dnet_net_state *s
 		return callback(dc, fd, data_offset);
 	};
 
-	return eblob_iterate(c->eblob, &control);
+	/* only requested key ranges are split between threads, iteration without key ranges
+	 * keeps going through the plain unranged eblob_iterate()
+	 */
+	const size_t threads_num = std::min<size_t>(request.parallelism, std::max(c->iterator_threads, 1));
+	std::vector<std::vector<eblob_index_block>> slices;
+	if (threads_num > 1 && !ranges.empty())
+		slices = blob_iterator_partition(ranges, threads_num);
+
+	int err = 0;
+	if (slices.size() <= 1) {
+		err = eblob_iterate(c->eblob, &control);
+	} else {
+		DNET_LOG_INFO(c->blog, "EBLOB: iterator: {}: iterating in {} threads", it->id, slices.size());
+
+		/* every worker iterates its own slice of key space,
+		 * progress counters and flow control are shared by all workers via callback and @it
+		 */
+		auto worker = [&] (const std::vector<eblob_index_block> &slice) {
+			eblob_iterate_control worker_control = control;
+			worker_control.range = const_cast<eblob_index_block *>(slice.data());
+			worker_control.range_num = slice.size();
+
+			const int worker_err = eblob_iterate(c->eblob, &worker_control);
+			if (worker_err) {
+				int expected = 0;
+				failed.compare_exchange_strong(expected, worker_err);
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(slices.size());
+		for (const auto &slice : slices) {
+			workers.emplace_back(worker, std::cref(slice));
+		}
+		for (auto &worker_thread : workers) {
+			worker_thread.join();
+		}
+
+		err = failed.load();
+	}
+
+	if (!err && sender)
+		err = sender->flush_all();
+
+	if (!err && container)
+		err = blob_iterator_send_container(c, st, cmd, it.get(), *container);
+
+	return err;
 }
 
 int blob_iterate(struct eblob_backend_config *c,
@@ -1891,6 +3174,11 @@ int blob_send_new(struct eblob_backend_config *c,
 	              __func__, request.keys.size(), request.groups, request.chunk_write_timeout,
 	              request.chunk_commit_timeout, request.chunk_retry_count);
 
+	if (request.groups.empty()) {
+		DNET_LOG_ERROR(c->blog, "EBLOB: {} failed: no destination groups", __func__);
+		return -EINVAL;
+	}
+
 	int err = 0;
 
 	std::atomic<uint64_t> counter(0);
@@ -1925,10 +3213,25 @@ int blob_send_new(struct eblob_backend_config *c,
 		return dnet_send_reply(state, cmd, response_data.data(), response_data.size(), 1, /*context*/ nullptr);
 	};
 
-	congestion_control_monitor monitor;
+	congestion_control_monitor small_monitor{"small", c->data.stat_id, request.groups};
+	congestion_control_monitor large_monitor{"large", c->data.stat_id, request.groups};
+
+	std::vector<std::unique_ptr<large_object_queue>> large_objects;
+	large_objects.reserve(request.groups.size());
+	for (size_t slot = 0; slot < request.groups.size(); ++slot) {
+		const int group = request.groups[slot];
+		large_objects.emplace_back(new large_object_queue{
+			[&, group, slot] (const large_object_queue::item &object) {
+				large_object_sender sender{c, reinterpret_cast<dnet_net_state*>(state), cmd->backend_id, cmd,
+				                           request, object.info, large_monitor, counter, group, slot,
+				                           object.reader, object.completion};
+				sender.send();
+			}});
+	}
 
 	auto callback = make_iterator_server_send_callback(c, reinterpret_cast<dnet_net_state*>(state),
-	                                                   cmd, request, cmd->backend_id, monitor, counter);
+	                                                   cmd, request, cmd->backend_id, small_monitor,
+	                                                   large_objects, counter);
 
 	eblob_key ekey;
 	eblob_write_control wc;
@@ -2052,13 +3355,217 @@ int blob_send_new(struct eblob_backend_config *c,
 		}
 	}
 
-	monitor.wait_completion();
+	for (auto &queue : large_objects) {
+		queue->stop();
+	}
+	small_monitor.wait_completion();
+	large_monitor.wait_completion();
+
+	const auto small_windows = small_monitor.dump();
+	const auto large_windows = large_monitor.dump();
+
+	if (context) {
+		context->add({{"small_windows", small_windows},
+		              {"large_windows", large_windows},
+		             });
+	}
 
-	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "EBLOB: {} finished: {}", __func__,
-	         dnet_print_error(err));
+	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "EBLOB: {} finished: small windows: {}, "
+	         "large windows: {}: {}", __func__, small_windows, large_windows, dnet_print_error(err));
 	return err;
 }
 
+/*
+ * Helper threads reading spans of bulk reads. They are started once per backend and are shared
+ * by all bulk reads handled by it: a bulk read queues itself up to bulk_read_threads - 1 times,
+ * reads spans by its own io thread too and, when there are no spans left, withdraws its entries
+ * which weren't picked up by helpers and waits only for helpers which are still reading its spans.
+ */
+struct blob_bulk_read_pool {
+	struct task {
+		const std::function<void ()> *work;
+		size_t running{0};
+	};
+
+	blob_bulk_read_pool(eblob_backend_config *c)
+	: stopped{false} {
+		workers.reserve(c->bulk_read_threads - 1);
+		for (int i = 1; i < c->bulk_read_threads; ++i) {
+			workers.emplace_back([this, c, i] () {
+				dnet_set_name("dnet_bread_%d_%d", c->data.stat_id, i);
+				run();
+			});
+		}
+	}
+
+	~blob_bulk_read_pool() {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			stopped = true;
+		}
+		queued.notify_all();
+
+		for (auto &worker : workers) {
+			worker.join();
+		}
+	}
+
+	/* Runs @work by the calling thread and by up to @helpers pool's threads, returns when all of them are done */
+	void execute(size_t helpers, const std::function<void ()> &work) {
+		auto t = std::make_shared<task>();
+		t->work = &work;
+
+		helpers = std::min(helpers, workers.size());
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			tasks.insert(tasks.end(), helpers, t);
+		}
+		for (size_t i = 0; i < helpers; ++i) {
+			queued.notify_one();
+		}
+
+		work();
+
+		std::unique_lock<std::mutex> guard(lock);
+		tasks.erase(std::remove(tasks.begin(), tasks.end(), t), tasks.end());
+		finished.wait(guard, [&] () { return t->running == 0; });
+	}
+
+private:
+	void run() {
+		std::unique_lock<std::mutex> guard(lock);
+		while (true) {
+			queued.wait(guard, [this] () { return stopped || !tasks.empty(); });
+			if (stopped)
+				break;
+
+			auto t = std::move(tasks.front());
+			tasks.pop_front();
+			++t->running;
+
+			guard.unlock();
+			(*t->work)();
+			guard.lock();
+
+			--t->running;
+			finished.notify_all();
+		}
+	}
+
+	std::mutex lock;
+	std::condition_variable queued;
+	std::condition_variable finished;
+	std::deque<std::shared_ptr<task>> tasks;
+	std::vector<std::thread> workers;
+	bool stopped;
+};
+
+struct blob_bulk_read_pool *blob_bulk_read_pool_create(struct eblob_backend_config *c) {
+	try {
+		return new blob_bulk_read_pool(c);
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(c->blog, "blob: failed to start bulk read threads: {}", e.what());
+		return nullptr;
+	}
+}
+
+void blob_bulk_read_pool_destroy(struct blob_bulk_read_pool *pool) {
+	delete pool;
+}
+
+namespace {
+/*
+ * Location of the record resolved by bulk read before records are read.
+ */
+struct bulk_read_record {
+	dnet_id id;
+	int err;
+	int fd;
+	uint64_t offset;
+	uint64_t size;
+	size_t index; /* position of the key in the request */
+};
+
+/*
+ * Resolves locations of @keys and orders them by blob and offset within it.
+ * Keys which couldn't be resolved are placed at the beginning.
+ */
+std::vector<bulk_read_record> blob_bulk_read_resolve(eblob_backend_config *c, const std::vector<dnet_id> &keys) {
+	std::vector<bulk_read_record> records;
+	records.reserve(keys.size());
+
+	for (const auto &id : keys) {
+		eblob_key key;
+		memcpy(key.id, id.id, EBLOB_ID_SIZE);
+
+		eblob_write_control wc;
+		memset(&wc, 0, sizeof(wc));
+
+		const int err = blob_read_and_check_flags_new(c, &key, &wc);
+		if (err) {
+			records.push_back({id, err, -1, 0, 0, records.size()});
+		} else {
+			records.push_back({id, 0, wc.data_fd, wc.ctl_data_offset, wc.total_size, records.size()});
+		}
+	}
+
+	std::sort(records.begin(), records.end(), [] (const bulk_read_record &lhs, const bulk_read_record &rhs) {
+		return std::make_tuple(lhs.err == 0, lhs.fd, lhs.offset) < std::make_tuple(rhs.err == 0, rhs.fd, rhs.offset);
+	});
+	return records;
+}
+
+/*
+ * Splits resolved records [@begin, @end) into spans of adjacent records of the same blob
+ * which are not larger than @merge_size. Returns indexes of the first records of spans.
+ */
+std::vector<size_t> blob_bulk_read_spans(const std::vector<bulk_read_record> &records, size_t begin, size_t end,
+                                         uint64_t merge_size) {
+	std::vector<size_t> spans;
+	for (size_t i = begin; i < end; ++i) {
+		if (spans.empty()) {
+			spans.push_back(i);
+			continue;
+		}
+
+		const auto &first = records[spans.back()];
+		const auto &prev = records[i - 1];
+		const auto &cur = records[i];
+
+		if (cur.fd != prev.fd || cur.offset != prev.offset + prev.size ||
+		    cur.offset + cur.size - first.offset > merge_size) {
+			spans.push_back(i);
+		}
+	}
+	return spans;
+}
+
+/*
+ * Prefetches records from @first to @tail resolved by blob_bulk_read_resolve(). Their location could have been
+ * changed by defragmentation since they were resolved, so the first record is looked up again under its oplock,
+ * as it is done by reads, and the data file is taken from that lookup. Nothing is prefetched if the record moved.
+ */
+void blob_bulk_read_prefetch(eblob_backend_config *c,
+                             dnet_io_pool *pool,
+                             const bulk_read_record &first,
+                             const bulk_read_record &tail) {
+	dnet_id id = first.id;
+	dnet_oplock_guard oplock_guard{pool, &id};
+
+	eblob_key key;
+	memcpy(key.id, id.id, EBLOB_ID_SIZE);
+
+	eblob_write_control wc;
+	memset(&wc, 0, sizeof(wc));
+
+	if (blob_read_and_check_flags_new(c, &key, &wc) || wc.data_fd != first.fd ||
+	    wc.ctl_data_offset != first.offset)
+		return;
+
+	posix_fadvise(wc.data_fd, wc.ctl_data_offset, tail.offset + tail.size - first.offset, POSIX_FADV_WILLNEED);
+}
+} /* namespace */
+
 int blob_bulk_read_new(struct eblob_backend_config *c,
                        void *state,
                        struct dnet_cmd *cmd,
@@ -2095,28 +3602,43 @@ int blob_bulk_read_new(struct eblob_backend_config *c,
 		return -EINVAL;
 	}
 
-	int err = 0;
 	dnet_read_request request;
 	request.ioflags = bulk_request.ioflags;
 	request.read_flags = bulk_request.read_flags;
 	request.data_offset = request.data_size = 0;
 	request.deadline = bulk_request.deadline;
 
-	ioremap::elliptics::util::steady_timer timer;
-	struct dnet_cmd_stats orig_stats(*cmd_stats);
+	const struct dnet_cmd_stats orig_stats(*cmd_stats);
+	std::atomic<uint64_t> total_size{0};
 
 	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
-	struct dnet_cmd cmd_copy(*cmd);
-	const auto num_keys = bulk_request.keys.size();
-	for (size_t i = 0; i < num_keys && !st->__need_exit; ++i) {
-		timer.restart();
 
+	/* Locations are resolved without oplock and are used only to order reads,
+	 * each record is looked up again under oplock when it is read.
+	 */
+	const auto records = blob_bulk_read_resolve(c, bulk_request.keys);
+	const size_t num_keys = records.size();
+
+	auto reply = [&] (const bulk_read_record &record, int err, bool last_read) {
+		struct dnet_cmd cmd_copy(*cmd);
+		cmd_copy.status = err;
+		cmd_copy.id = record.id;
+		dnet_send_reply(st, &cmd_copy, nullptr, 0, last_read ? 0 : 1, /*context*/ nullptr);
+
+		backend->command_stats().command_counter(DNET_CMD_READ_NEW, cmd_copy.trans, err, /*handled_in_cache*/ 0,
+		                                         0, 0);
+	};
+
+	auto read = [&] (const bulk_read_record &record, bool last_read) {
+		ioremap::elliptics::util::steady_timer timer;
+
+		struct dnet_cmd cmd_copy(*cmd);
 		cmd_copy.status = 0;
-		cmd_copy.id = bulk_request.keys[i];
+		cmd_copy.id = record.id;
 
 		auto read_stats = orig_stats;
 
-		const bool last_read = i >= (num_keys - 1);
+		int err;
 		{
 			dnet_oplock_guard oplock_guard{pool, &cmd_copy.id};
 			// bulk_read doesn't provide its context to read to decrease verbosity
@@ -2132,14 +3654,57 @@ int blob_bulk_read_new(struct eblob_backend_config *c,
 			cmd_copy.status = err;
 			dnet_send_reply(st, &cmd_copy, nullptr, 0, last_read ? 0 : 1, /*context*/ nullptr);
 		}
-		cmd_stats->size += read_stats.size;
+		total_size += read_stats.size;
 
 		read_stats.handle_time = timer.get_us();
 
 		backend->command_stats().command_counter(DNET_CMD_READ_NEW, cmd_copy.trans, err, /*handled_in_cache*/ 0,
 		                                         read_stats.size, read_stats.handle_time);
+	};
+
+	size_t first_resolved = 0;
+	for (; first_resolved < num_keys && records[first_resolved].err; ++first_resolved) {
+		reply(records[first_resolved], records[first_resolved].err, first_resolved == num_keys - 1);
+	}
+
+	if (first_resolved < num_keys) {
+		/* The last record is read after all others, so its reply without DNET_FLAGS_MORE
+		 * is guaranteed to be the last one on the wire.
+		 */
+		const size_t last = num_keys - 1;
+		const auto spans = blob_bulk_read_spans(records, first_resolved, last, c->bulk_read_merge_size);
+
+		std::atomic<size_t> next_span{0};
+		const std::function<void ()> worker = [&] () {
+			for (size_t i = next_span++; i < spans.size() && !st->__need_exit; i = next_span++) {
+				const size_t begin = spans[i];
+				const size_t end = (i + 1 < spans.size()) ? spans[i + 1] : last;
+
+				/* Records of the span are adjacent in the blob, so they are prefetched by a single
+				 * large read instead of many small ones made by reading every record.
+				 */
+				if (end - begin > 1)
+					blob_bulk_read_prefetch(c, pool, records[begin], records[end - 1]);
+
+				for (size_t j = begin; j < end && !st->__need_exit; ++j) {
+					read(records[j], false);
+				}
+			}
+		};
+
+		if (c->bulk_read_pool && spans.size() > 1) {
+			c->bulk_read_pool->execute(spans.size() - 1, worker);
+		} else {
+			worker();
+		}
+
+		read(records[last], true);
 	}
 
+	cmd_stats->size += total_size;
+
+	DNET_LOG_INFO(c->blog, "{}: EBLOB: {}: keys: {}, unresolved: {}", dnet_dump_id(&cmd->id), __func__, num_keys,
+	              first_resolved);
 	return 0;
 }
 
@@ -2184,31 +3749,65 @@ int blob_bulk_remove_new(struct eblob_backend_config *config,
 	eblob_backend *b = config->eblob;
 
 	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+	cmd->backend_id = backend_id;
 
-	const size_t num_keys = bulk_request.keys.size();
-	for (size_t i = 0; i < num_keys; ++i) {
-		int err = 0;
-		struct dnet_cmd cmd_copy(*cmd);
-		cmd_copy.backend_id = backend_id;
-		cmd_copy.id = bulk_request.keys[i];
+	/* max number of keys locked and removed at once */
+	static const size_t lock_batch = 64;
+
+	/* Keys are removed in order of their location in blobs, so index and data are accessed sequentially.
+	 * Locations are resolved without oplock and are used only to order removals.
+	 */
+	const auto records = blob_bulk_read_resolve(config, bulk_request.keys);
+	const size_t num_keys = records.size();
+
+	dnet_bulk_remove_replier replier(st, cmd, num_keys, bulk_request.status_array);
+
+	std::vector<dnet_id> ids;
+	std::vector<int> statuses;
+	ids.reserve(lock_batch);
+	statuses.reserve(lock_batch);
+
+	for (size_t begin = 0; begin < num_keys; begin += lock_batch) {
+		const size_t end = std::min(num_keys, begin + lock_batch);
+
+		ids.clear();
+		statuses.clear();
+		for (size_t i = begin; i < end; ++i) {
+			ids.emplace_back(records[i].id);
+		}
 
-		struct eblob_key key;
-		memcpy(key.id, bulk_request.keys[i].id, EBLOB_ID_SIZE);
-		
 		{
-			dnet_oplock_guard oplock_guard{pool, &cmd_copy.id};
-			if (bulk_request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP) {
-				dnet_remove_request single_request{bulk_request.ioflags, bulk_request.timestamps[i]};
-				err = blob_del_new_cas(config, b, &cmd_copy, key, single_request);
-			}
-			if (!err) {
-				err = eblob_remove(b, &key);
+			dnet_oplock_batch_guard oplock_guard{pool, ids.data(), ids.size()};
+			for (size_t i = begin; i < end; ++i) {
+				const auto &record = records[i];
+
+				struct dnet_cmd cmd_copy(*cmd);
+				cmd_copy.id = record.id;
+
+				struct eblob_key key;
+				memcpy(key.id, record.id.id, EBLOB_ID_SIZE);
+
+				int err = 0;
+				if (bulk_request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP) {
+					dnet_remove_request single_request{bulk_request.ioflags,
+					                                   bulk_request.timestamps[record.index]};
+					err = blob_del_new_cas(config, b, &cmd_copy, key, single_request);
+				}
+				if (!err) {
+					blob_header_cache_remove(config->header_cache, &key);
+					err = eblob_remove(b, &key);
+				}
+				statuses.emplace_back(err);
 			}
 		}
 
-		cmd_copy.status = err;
-		const bool last_read = i >= (num_keys - 1);
-		dnet_send_reply(st, &cmd_copy, nullptr, 0, last_read ? 0 : 1, /*context*/ nullptr);
+		/* replies are sent after the batch is unlocked */
+		for (size_t i = begin; i < end; ++i) {
+			replier.reply(records[i].id, backend_id, statuses[i - begin]);
+		}
 	}
+
+	DNET_LOG_INFO(config->blog, "{}: EBLOB: {}: BULK_REMOVE_NEW: keys: {}, status array: {}",
+	              dnet_dump_id(&cmd->id), __func__, num_keys, bulk_request.status_array);
 	return 0;
 }
@@ -32,6 +32,29 @@ extern "C" {
 
 struct dnet_config_backend;
 struct dnet_cmd_stats;
+struct blob_group_commit;
+struct blob_header_cache;
+
+/* Default max number of threads reading records of a single bulk read */
+#define DNET_BLOB_DEFAULT_BULK_READ_THREADS	4
+
+/* Default max size of adjacent records read from the blob as a single span by bulk read */
+#define DNET_BLOB_DEFAULT_BULK_READ_MERGE_SIZE	(1024 * 1024)
+
+/* Default max size of a record which is read into memory by a single pread instead of being sent by sendfile */
+#define DNET_BLOB_DEFAULT_READ_BUFFER_SIZE	(128 * 1024)
+
+/* Default max number of threads a single iterator may use when client asks for parallel iteration */
+#define DNET_BLOB_DEFAULT_ITERATOR_THREADS	8
+
+/* Default size of blob window read by network iterator at once, records up to a quarter of it are sent from memory */
+#define DNET_BLOB_DEFAULT_ITERATOR_READAHEAD_SIZE	(8 * 1024 * 1024)
+
+/* Default max number of writes synced by a single group commit */
+#define DNET_BLOB_DEFAULT_GROUP_COMMIT_RECORDS	64
+
+/* Default max number of records whose ext and json headers are cached for lookups */
+#define DNET_BLOB_DEFAULT_HEADER_CACHE_SIZE	(64 * 1024)
 
 struct eblob_read_params {
 	int			fd;
@@ -50,10 +73,46 @@ struct eblob_backend_config {
 	int				random_access;
 	int				last_read_index;
 	struct eblob_read_params	last_reads[100];
+
+	/* max number of threads reading records of a single bulk read */
+	int				bulk_read_threads;
+	/* max size of adjacent records which are prefetched by bulk read as a single span */
+	uint64_t			bulk_read_merge_size;
+	/* threads helping io threads to read spans of bulk reads, NULL if bulk_read_threads is 1 */
+	struct blob_bulk_read_pool	*bulk_read_pool;
+	/* max size of a record which is read, verified and sent from memory */
+	uint64_t			read_buffer_size;
+	/* max number of threads used by a single iterator */
+	int				iterator_threads;
+	/* size of sequential reads by which network iterator reads blobs */
+	uint64_t			iterator_readahead_size;
+
+	/* max time in usecs writes are accumulated by group commit before they are synced, 0 - disabled */
+	uint64_t			group_commit_time;
+	/* max number of writes synced by a single group commit */
+	int				group_commit_records;
+	struct blob_group_commit	*group_commit;
+
+	/* max number of records whose headers are cached for lookups, 0 - default, negative - disabled */
+	int64_t				header_cache_size;
+	struct blob_header_cache	*header_cache;
 };
 
 int dnet_blob_config_to_json(struct dnet_config_backend *b, char **json_stat, size_t *size);
 
+struct blob_group_commit *blob_group_commit_create(struct eblob_backend_config *c);
+void blob_group_commit_destroy(struct blob_group_commit *gc);
+/* Adds group commit statistics to eblob's statistics json @json_stat */
+int blob_group_commit_stat_json(struct blob_group_commit *gc, char **json_stat, size_t *size);
+
+struct blob_bulk_read_pool *blob_bulk_read_pool_create(struct eblob_backend_config *c);
+void blob_bulk_read_pool_destroy(struct blob_bulk_read_pool *pool);
+
+struct blob_header_cache *blob_header_cache_create(struct eblob_backend_config *c);
+void blob_header_cache_destroy(struct blob_header_cache *hc);
+/* Drops cached headers of @key, must be called before the record is overwritten or removed */
+void blob_header_cache_remove(struct blob_header_cache *hc, const struct eblob_key *key);
+
 int blob_file_info_new(struct eblob_backend_config *c, void *state, struct dnet_cmd *cmd,
                        struct dnet_access_context *context);
 int blob_del_new(struct eblob_backend_config *c, struct dnet_cmd *cmd, void *data, struct dnet_access_context *context);
@@ -0,0 +1,1488 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * In-memory backend: keeps records in a sharded hash map and serves the same new-protocol commands as eblob
+ * backend. It is used as a reference backend for benchmarking the network/cache layers without disk and
+ * as a hot tier for small records. Payloads of records are kept in per-shard arenas of power-of-two slots.
+ * Records can be dumped to a snapshot file on cleanup and loaded on start.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include <blackhole/wrapper.hpp>
+
+#include "elliptics/packet.h"
+#include "elliptics/interface.h"
+#include "elliptics/backends.h"
+#include "elliptics/newapi/session.hpp"
+
+#include "library/protocol.hpp"
+#include "library/elliptics.h"
+#include "library/backend.h"
+#include "library/logger.hpp"
+#include "library/access_context.h"
+
+#include "monitor/measure_points.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+/* Default number of independently locked parts of the hash map */
+#define DNET_MEMORY_DEFAULT_SHARDS	64
+
+/* Size of chunks which payload slots of a shard are cut from */
+#define DNET_MEMORY_ARENA_CHUNK_SIZE	(4 * 1024 * 1024)
+/* Minimal payload slot, smaller payloads are rounded up to it */
+#define DNET_MEMORY_ARENA_MIN_SLOT	64
+
+namespace {
+
+struct memory_storage;
+
+struct memory_backend_config {
+	dnet_logger			*blog;
+	uint32_t			backend_id;
+
+	/* number of independently locked parts of the hash map */
+	uint64_t			shards;
+	/* max total size of stored records in bytes, 0 - unlimited */
+	uint64_t			size_limit;
+	/* file records are loaded from on start and saved to on cleanup, NULL - don't use snapshot */
+	char				*snapshot;
+
+	memory_storage			*storage;
+	/* config the backend is initialized from, its storage_free follows memory taken by arenas */
+	dnet_config_backend		*config;
+};
+
+struct memory_record {
+	uint64_t record_flags;
+	uint64_t user_flags;
+	dnet_time timestamp;
+	dnet_time json_timestamp;
+	uint64_t json_capacity;
+	uint64_t json_size;
+	/* space reserved for data by prepare, it is released by commit */
+	uint64_t data_capacity;
+	uint64_t data_size;
+
+	/* arena slot of json_capacity bytes of json followed by data, it is valid only under shard's lock */
+	char *payload;
+	uint64_t slot_size;
+
+	char *json() const {
+		return payload;
+	}
+
+	char *data() const {
+		return payload ? payload + json_capacity : nullptr;
+	}
+
+	uint64_t footprint() const {
+		return json_capacity + std::max<uint64_t>(data_size, data_capacity);
+	}
+
+	bool uncommitted() const {
+		return record_flags & DNET_RECORD_FLAGS_UNCOMMITTED;
+	}
+};
+
+/*
+ * Arena of record payloads of a shard. Payloads are placed into power-of-two slots cut from large chunks,
+ * freed slots are kept in per-size free lists and are reused by the next payloads of the same size.
+ * Payloads bigger than a chunk get dedicated allocations. Chunks are released only with the arena.
+ * Arena is protected by the lock of its shard.
+ */
+class memory_arena {
+public:
+	memory_arena()
+	: m_free(slot_class(DNET_MEMORY_ARENA_CHUNK_SIZE) + 1)
+	, m_tail{nullptr}
+	, m_tail_size{0}
+	, m_reserved{0} {
+	}
+
+	/* Returns slot of at least @size bytes and sets @slot_size to its real size, throws std::bad_alloc */
+	char *allocate(uint64_t size, uint64_t &slot_size) {
+		if (!size) {
+			slot_size = 0;
+			return nullptr;
+		}
+
+		if (size > DNET_MEMORY_ARENA_CHUNK_SIZE) {
+			char *slot = new char[size];
+			slot_size = size;
+			m_reserved += size;
+			return slot;
+		}
+
+		const size_t index = slot_class(size);
+		slot_size = uint64_t(DNET_MEMORY_ARENA_MIN_SLOT) << index;
+
+		auto &free_slots = m_free[index];
+		if (!free_slots.empty()) {
+			char *slot = free_slots.back();
+			free_slots.pop_back();
+			return slot;
+		}
+
+		if (m_tail_size < slot_size) {
+			std::unique_ptr<char[]> chunk{new char[DNET_MEMORY_ARENA_CHUNK_SIZE]};
+			release_tail();
+			m_tail = chunk.get();
+			m_tail_size = DNET_MEMORY_ARENA_CHUNK_SIZE;
+			m_reserved += DNET_MEMORY_ARENA_CHUNK_SIZE;
+			m_chunks.emplace_back(std::move(chunk));
+		}
+
+		char *slot = m_tail;
+		m_tail += slot_size;
+		m_tail_size -= slot_size;
+		return slot;
+	}
+
+	void free(char *slot, uint64_t slot_size) {
+		if (!slot)
+			return;
+
+		if (slot_size > DNET_MEMORY_ARENA_CHUNK_SIZE) {
+			delete[] slot;
+			m_reserved -= slot_size;
+			return;
+		}
+
+		m_free[slot_class(slot_size)].push_back(slot);
+	}
+
+	/* total size of chunks and dedicated allocations */
+	uint64_t reserved() const {
+		return m_reserved;
+	}
+
+private:
+	/* index of the smallest slot which fits @size */
+	static size_t slot_class(uint64_t size) {
+		size_t index = 0;
+		while ((uint64_t(DNET_MEMORY_ARENA_MIN_SLOT) << index) < size)
+			++index;
+		return index;
+	}
+
+	/* splits the rest of the current chunk into free slots, so it is not wasted when the next chunk is started */
+	void release_tail() {
+		for (size_t index = m_free.size(); index-- > 0;) {
+			const uint64_t slot_size = uint64_t(DNET_MEMORY_ARENA_MIN_SLOT) << index;
+			if (m_tail_size >= slot_size) {
+				m_free[index].push_back(m_tail);
+				m_tail += slot_size;
+				m_tail_size -= slot_size;
+			}
+		}
+		m_tail = nullptr;
+		m_tail_size = 0;
+	}
+
+	std::vector<std::unique_ptr<char[]>> m_chunks;
+	std::vector<std::vector<char *>> m_free;
+	/* not yet used part of the last chunk */
+	char *m_tail;
+	uint64_t m_tail_size;
+	uint64_t m_reserved;
+};
+
+struct raw_id_hash {
+	size_t operator()(const dnet_raw_id &id) const {
+		size_t hash;
+		memcpy(&hash, id.id, sizeof(hash));
+		return hash;
+	}
+};
+
+struct raw_id_equal {
+	bool operator()(const dnet_raw_id &lhs, const dnet_raw_id &rhs) const {
+		return memcmp(lhs.id, rhs.id, DNET_ID_SIZE) == 0;
+	}
+};
+
+/*
+ * Sharded hash map of records whose payloads are stored in per-shard arenas. Payloads are accessed only
+ * under shard's lock: replies are sent under it since dnet_send_data() copies the payload into the request,
+ * and commands which use a record for longer (e.g. server_send) take a copy.
+ */
+struct memory_storage {
+	typedef std::unordered_map<dnet_raw_id, memory_record, raw_id_hash, raw_id_equal> records_map;
+
+	struct shard {
+		~shard() {
+			for (const auto &item : records) {
+				arena.free(item.second.payload, item.second.slot_size);
+			}
+		}
+
+		std::mutex lock;
+		records_map records;
+		memory_arena arena;
+	};
+
+	explicit memory_storage(size_t shards_num)
+	: shards(shards_num) {
+		for (auto &s : shards) {
+			s.reset(new shard);
+		}
+	}
+
+	shard &get_shard(const dnet_raw_id &id) {
+		/* the first bytes are used by hash function of the map, so shard is chosen by the next ones */
+		uint64_t hash;
+		memcpy(&hash, id.id + sizeof(hash), sizeof(hash));
+		return *shards[hash % shards.size()];
+	}
+
+	std::vector<std::unique_ptr<shard>> shards;
+
+	std::atomic<uint64_t> records{0};
+	std::atomic<uint64_t> used_size{0};
+};
+
+static dnet_raw_id memory_key(const dnet_id &id) {
+	dnet_raw_id key;
+	memcpy(key.id, id.id, DNET_ID_SIZE);
+	return key;
+}
+
+/* Returns committed record @key of @shard or nullptr, @shard must be locked */
+static const memory_record *memory_find_committed(memory_storage::shard &shard, const dnet_raw_id &key) {
+	auto it = shard.records.find(key);
+	if (it == shard.records.end() || it->second.uncommitted())
+		return nullptr;
+	return &it->second;
+}
+
+/*
+ * Copies metadata of committed record @key to @info, its payload is not copied and @info.payload is reset.
+ * If @json and @data are set, they get copies of the record's json and data.
+ */
+static int memory_get_committed(memory_backend_config *c, const dnet_raw_id &key, memory_record &info,
+                                ioremap::elliptics::data_pointer *json = nullptr,
+                                ioremap::elliptics::data_pointer *data = nullptr) {
+	using namespace ioremap::elliptics;
+
+	auto &shard = c->storage->get_shard(key);
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	const memory_record *record = memory_find_committed(shard, key);
+	if (!record)
+		return -ENOENT;
+
+	info = *record;
+	info.payload = nullptr;
+	info.slot_size = 0;
+
+	try {
+		if (json && record->json_size)
+			*json = data_pointer::copy(record->json(), record->json_size);
+		if (data && record->data_size)
+			*data = data_pointer::copy(record->data(), record->data_size);
+	} catch (const std::bad_alloc &) {
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+static int memory_send_lookup_response(void *state, dnet_cmd *cmd, const memory_record &record,
+                                       dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	auto response = serialize(dnet_lookup_response{
+		record.record_flags,
+		record.user_flags,
+		"",
+
+		record.json_timestamp,
+		0,
+		record.json_size,
+		record.json_capacity,
+
+		record.timestamp,
+		record.json_capacity,
+		record.data_size,
+	});
+
+	return dnet_send_reply(state, cmd, response.data(), response.size(), 0, context);
+}
+
+static int memory_file_info_new(memory_backend_config *c, void *state, dnet_cmd *cmd, dnet_access_context *context) {
+	if (context) {
+		context->set_id(cmd->id);
+		context->add({"backend_id", c->backend_id});
+	}
+
+	memory_record record;
+	int err = memory_get_committed(c, memory_key(cmd->id), record);
+	if (err) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: lookup-new: failed: {} [{}]", dnet_dump_id(&cmd->id),
+		               strerror(-err), err);
+		return err;
+	}
+
+	err = memory_send_lookup_response(state, cmd, record, context);
+	if (err) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: lookup-new: dnet_send_reply failed: {} [{}]",
+		               dnet_dump_id(&cmd->id), strerror(-err), err);
+		return err;
+	}
+
+	DNET_LOG_INFO(c->blog, "{}: MEMORY: lookup-new: json_size: {}, data_size: {}", dnet_dump_id(&cmd->id),
+	              record.json_size, record.data_size);
+	return 0;
+}
+
+static int memory_read_new_impl(memory_backend_config *c, void *state, dnet_cmd *cmd, dnet_cmd_stats *cmd_stats,
+                                const ioremap::elliptics::dnet_read_request &request, bool last_read,
+                                dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	const auto key = memory_key(cmd->id);
+	auto &shard = c->storage->get_shard(key);
+
+	/* payload is valid only under the lock, it is copied into the reply by dnet_send_data() */
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	const memory_record *record = memory_find_committed(shard, key);
+	if (!record) {
+		const int err = -ENOENT;
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: read-new: failed: {} [{}]", dnet_dump_id(&cmd->id),
+		               strerror(-err), err);
+		return err;
+	}
+
+	uint64_t json_size = 0;
+	if (request.read_flags & DNET_READ_FLAGS_JSON)
+		json_size = record->json_size;
+
+	uint64_t data_size = 0;
+	if (request.read_flags & DNET_READ_FLAGS_DATA) {
+		data_size = record->data_size;
+
+		if (request.data_offset && request.data_offset >= data_size) {
+			const int err = -E2BIG;
+			DNET_LOG_ERROR(c->blog, "{}: MEMORY: read-new: requested offset({}) >= data_size({}): {} [{}]",
+			               dnet_dump_id(&cmd->id), request.data_offset, data_size, strerror(-err), err);
+			return err;
+		}
+
+		data_size -= request.data_offset;
+		if (request.data_size && request.data_size < data_size)
+			data_size = request.data_size;
+	}
+
+	cmd_stats->size = json_size + data_size;
+
+	auto header = serialize(dnet_read_response{
+		record->record_flags,
+		record->user_flags,
+
+		record->json_timestamp,
+		record->json_size,
+		record->json_capacity,
+		json_size,
+
+		record->timestamp,
+		record->data_size,
+		request.data_offset,
+		data_size,
+	});
+
+	auto response = data_pointer::allocate(sizeof(*cmd) + header.size() + json_size);
+	memcpy(response.data(), cmd, sizeof(*cmd));
+	memcpy(response.skip(sizeof(*cmd)).data(), header.data(), header.size());
+	if (json_size)
+		memcpy(response.skip(sizeof(*cmd) + header.size()).data(), record->json(), json_size);
+
+	response.data<dnet_cmd>()->size = header.size() + json_size + data_size;
+	response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | (last_read ? 0 : DNET_FLAGS_MORE);
+	response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+
+	char *data = data_size ? record->data() + request.data_offset : nullptr;
+	const int err = dnet_send_data((dnet_net_state *)state, response.data(), response.size(), data, data_size,
+	                               context);
+	if (err) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: read-new: dnet_send_data: size: {}: {} [{}]",
+		               dnet_dump_id(&cmd->id), response.size(), strerror(-err), err);
+		return err;
+	}
+
+	if (context) {
+		context->add({{"response_json_size", json_size},
+		              {"response_data_size", data_size},
+		             });
+	}
+
+	DNET_LOG_INFO(c->blog, "{}: MEMORY: read-new: json_size: {}, data_size: {}", dnet_dump_id(&cmd->id),
+	              json_size, data_size);
+	return 0;
+}
+
+static int memory_read_new(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                           dnet_cmd_stats *cmd_stats, dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	dnet_read_request request;
+	deserialize(data_pointer::from_raw(data, cmd->size), request);
+
+	if (context) {
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->backend_id},
+		              {"read_flags", std::string(dnet_dump_read_flags(request.read_flags))},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
+		             });
+	}
+
+	return memory_read_new_impl(c, state, cmd, cmd_stats, request, true, context);
+}
+
+static int memory_write_new(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                            dnet_cmd_stats *cmd_stats, dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	auto data_p = data_pointer::from_raw(data, cmd->size);
+	auto request = [&data_p] () {
+		size_t offset = 0;
+		dnet_write_request request;
+		deserialize(data_p, request, offset);
+		data_p = data_p.skip(offset);
+		return request;
+	} ();
+
+	if (context) {
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->backend_id},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
+		              {"request_data_offset", request.data_offset},
+		              {"request_data_size", request.data_size},
+		              {"request_json_size", request.json_size},
+		             });
+	}
+
+	cmd_stats->size = request.json_size + request.data_size;
+
+	if (request.ioflags & DNET_IO_FLAGS_APPEND) {
+		DNET_LOG_NOTICE(c->blog, "{}: MEMORY: write-new: append is not supported", dnet_dump_id(&cmd->id));
+		return -ENOTSUP;
+	}
+
+	if (data_p.size() < request.json_size + request.data_size) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: payload ({}) is less than json ({}) + data ({})",
+		               dnet_dump_id(&cmd->id), data_p.size(), request.json_size, request.data_size);
+		return -EINVAL;
+	}
+
+	const auto key = memory_key(cmd->id);
+	auto &shard = c->storage->get_shard(key);
+
+	/* metadata of the written record, the response is built from it after the lock is released */
+	memory_record info;
+	int err = [&] () {
+		std::lock_guard<std::mutex> guard(shard.lock);
+
+		auto it = shard.records.find(key);
+		memory_record *disk = (it == shard.records.end()) ? nullptr : &it->second;
+
+		if ((request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP) && disk) {
+			if (dnet_time_cmp(&disk->timestamp, &request.timestamp) > 0 ||
+			    (disk->json_capacity && dnet_time_cmp(&disk->json_timestamp, &request.json_timestamp) > 0)) {
+				DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: failed cas: stored timestamp is greater "
+				                        "than timestamp of data to be written", dnet_dump_id(&cmd->id));
+				return -EBADFD;
+			}
+		}
+
+		if (request.ioflags & DNET_IO_FLAGS_UPDATE_JSON) {
+			/* update_json can not be applied to nonexistent or uncommitted records */
+			if (!disk || disk->uncommitted())
+				return -ENOENT;
+		} else if (!(request.ioflags & DNET_IO_FLAGS_PREPARE)) {
+			/* plain_write and commit without prepare can not be applied to nonexistent or committed records */
+			if (!disk)
+				return -ENOENT;
+			if (!disk->uncommitted())
+				return -EPERM;
+		}
+
+		const uint64_t json_capacity = (request.ioflags & DNET_IO_FLAGS_PREPARE)
+		                               ? request.json_capacity
+		                               : disk->json_capacity;
+		if (request.json_size > json_capacity) {
+			DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: json ({}) exceed capacity ({})",
+			               dnet_dump_id(&cmd->id), request.json_size, json_capacity);
+			return -E2BIG;
+		}
+
+		/* prepare starts a new record, other writes modify the stored one */
+		memory_record record;
+		if (request.ioflags & DNET_IO_FLAGS_PREPARE) {
+			memset(&record, 0, sizeof(record));
+			record.record_flags = DNET_RECORD_FLAGS_EXTHDR | DNET_RECORD_FLAGS_UNCOMMITTED;
+			record.json_capacity = request.json_capacity;
+			record.data_capacity = request.data_capacity;
+		} else {
+			record = *disk;
+		}
+
+		const uint64_t old_size = disk ? disk->footprint() : 0;
+		const uint64_t write_end = request.data_size ? request.data_offset + request.data_size : 0;
+		uint64_t new_data_size = std::max<uint64_t>(record.data_size, write_end);
+		if (request.ioflags & DNET_IO_FLAGS_COMMIT)
+			new_data_size = request.data_commit_size;
+
+		const uint64_t new_size = record.json_capacity +
+		                          std::max<uint64_t>(new_data_size,
+		                                             (request.ioflags & DNET_IO_FLAGS_COMMIT)
+		                                             ? 0 : record.data_capacity);
+		if (c->size_limit && new_size > old_size &&
+		    c->storage->used_size + new_size - old_size > c->size_limit) {
+			DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: size limit {} is reached, used: {}, "
+			                        "record grows from {} to {}",
+			               dnet_dump_id(&cmd->id), c->size_limit, c->storage->used_size.load(), old_size,
+			               new_size);
+			return -ENOSPC;
+		}
+
+		/* the slot also has to fit the written chunk which may be truncated by commit afterwards */
+		const uint64_t payload_size = std::max(new_size, record.json_capacity + write_end);
+		if (payload_size > record.slot_size) {
+			uint64_t slot_size;
+			char *payload;
+			try {
+				payload = shard.arena.allocate(payload_size, slot_size);
+			} catch (const std::bad_alloc &) {
+				return -ENOMEM;
+			}
+
+			if (record.payload)
+				memcpy(payload, record.payload, record.json_capacity + record.data_size);
+			if (disk)
+				shard.arena.free(disk->payload, disk->slot_size);
+			record.payload = payload;
+			record.slot_size = slot_size;
+		} else if (disk && record.payload != disk->payload) {
+			/* prepare of empty record over the existing one */
+			shard.arena.free(disk->payload, disk->slot_size);
+		}
+
+		if (!(request.ioflags & DNET_IO_FLAGS_UPDATE_JSON))
+			record.timestamp = request.timestamp;
+		record.user_flags = request.user_flags;
+
+		if (request.ioflags & DNET_IO_FLAGS_NOCSUM)
+			record.record_flags |= DNET_RECORD_FLAGS_NOCSUM;
+		else
+			record.record_flags &= ~DNET_RECORD_FLAGS_NOCSUM;
+
+		if ((request.ioflags & (DNET_IO_FLAGS_PREPARE | DNET_IO_FLAGS_UPDATE_JSON)) || request.json_size) {
+			if (request.json_size)
+				memcpy(record.json(), data_p.data(), request.json_size);
+			record.json_size = request.json_size;
+			record.json_timestamp = request.json_timestamp;
+		}
+
+		/* data which has not been written yet reads as zeroes */
+		auto grow_data = [&record] (uint64_t size) {
+			if (record.data_size < size) {
+				memset(record.data() + record.data_size, 0, size - record.data_size);
+				record.data_size = size;
+			}
+		};
+
+		if (request.data_size) {
+			grow_data(request.data_offset);
+			memcpy(record.data() + request.data_offset, data_p.skip(request.json_size).data(),
+			       request.data_size);
+			record.data_size = std::max(record.data_size, write_end);
+		}
+
+		if (request.ioflags & DNET_IO_FLAGS_COMMIT) {
+			grow_data(request.data_commit_size);
+			record.data_size = request.data_commit_size;
+			record.data_capacity = 0;
+			record.record_flags &= ~DNET_RECORD_FLAGS_UNCOMMITTED;
+		}
+
+		if (disk) {
+			*disk = record;
+		} else {
+			shard.records.emplace(key, record);
+			++c->storage->records;
+		}
+
+		c->storage->used_size += record.footprint();
+		c->storage->used_size -= old_size;
+
+		info = record;
+		info.payload = nullptr;
+		return 0;
+	} ();
+
+	if (err) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: ioflags: {}: failed: {} [{}]", dnet_dump_id(&cmd->id),
+		               dnet_flags_dump_ioflags(request.ioflags), strerror(-err), err);
+		return err;
+	}
+
+	if (request.ioflags & DNET_IO_FLAGS_WRITE_NO_FILE_INFO) {
+		cmd->flags |= DNET_FLAGS_NEED_ACK;
+		return 0;
+	}
+
+	err = memory_send_lookup_response(state, cmd, info, context);
+	if (err) {
+		DNET_LOG_ERROR(c->blog, "{}: MEMORY: write-new: dnet_send_reply failed: {} [{}]",
+		               dnet_dump_id(&cmd->id), strerror(-err), err);
+		return err;
+	}
+
+	DNET_LOG_INFO(c->blog, "{}: MEMORY: write-new: ioflags: {}, json_size: {}, data_size: {}",
+	              dnet_dump_id(&cmd->id), dnet_flags_dump_ioflags(request.ioflags), info.json_size,
+	              info.data_size);
+	return 0;
+}
+
+static int memory_remove(memory_backend_config *c, const dnet_raw_id &key, const dnet_time *cas_timestamp) {
+	auto &shard = c->storage->get_shard(key);
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	auto it = shard.records.find(key);
+	if (it == shard.records.end())
+		return -ENOENT;
+
+	if (cas_timestamp && dnet_time_cmp(&it->second.timestamp, cas_timestamp) > 0)
+		return -EBADFD;
+
+	c->storage->used_size -= it->second.footprint();
+	--c->storage->records;
+	shard.arena.free(it->second.payload, it->second.slot_size);
+	shard.records.erase(it);
+	return 0;
+}
+
+static int memory_del_new(memory_backend_config *c, dnet_cmd *cmd, void *data, dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	dnet_remove_request request;
+	deserialize(data_pointer::from_raw(data, cmd->size), request);
+
+	if (context) {
+		context->set_id(cmd->id);
+		context->add({{"backend_id", c->backend_id},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(request.ioflags))},
+		             });
+	}
+
+	const bool cas = request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP;
+	const int err = memory_remove(c, memory_key(cmd->id), cas ? &request.timestamp : nullptr);
+
+	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "{}: MEMORY: remove-new: ioflags: {}: {}",
+	         dnet_dump_id(&cmd->id), dnet_flags_dump_ioflags(request.ioflags), dnet_print_error(err));
+	return err;
+}
+
+static int memory_bulk_read_new(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                                dnet_cmd_stats *cmd_stats, dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	dnet_bulk_read_request bulk_request;
+	deserialize(data_pointer::from_raw(data, cmd->size), bulk_request);
+
+	if (context) {
+		context->add({{"keys", bulk_request.keys.size()},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(bulk_request.ioflags))},
+		              {"read_flags", std::string(dnet_dump_read_flags(bulk_request.read_flags))},
+		              {"backend_id", c->backend_id},
+		             });
+	}
+
+	dnet_read_request request;
+	request.ioflags = bulk_request.ioflags;
+	request.read_flags = bulk_request.read_flags;
+	request.data_offset = request.data_size = 0;
+	request.deadline = bulk_request.deadline;
+
+	auto st = reinterpret_cast<dnet_net_state *>(state);
+	uint64_t total_size = 0;
+
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+
+	const size_t num_keys = bulk_request.keys.size();
+	for (size_t i = 0; i < num_keys && !st->__need_exit; ++i) {
+		dnet_cmd cmd_copy(*cmd);
+		cmd_copy.status = 0;
+		cmd_copy.id = bulk_request.keys[i];
+
+		const bool last_read = i == num_keys - 1;
+		dnet_cmd_stats read_stats(*cmd_stats);
+
+		// bulk_read doesn't provide its context to read to decrease verbosity
+		const int err = memory_read_new_impl(c, state, &cmd_copy, &read_stats, request, last_read,
+		                                     /*context*/ nullptr);
+		if (err) {
+			cmd_copy.status = err;
+			dnet_send_reply(st, &cmd_copy, nullptr, 0, last_read ? 0 : 1, /*context*/ nullptr);
+		}
+		total_size += read_stats.size;
+	}
+
+	cmd_stats->size += total_size;
+
+	DNET_LOG_INFO(c->blog, "{}: MEMORY: bulk-read-new: keys: {}", dnet_dump_id(&cmd->id), num_keys);
+	return 0;
+}
+
+static int memory_bulk_remove_new(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                                  dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	dnet_bulk_remove_request bulk_request;
+	deserialize(data_pointer::from_raw(data, cmd->size), bulk_request);
+	if (!bulk_request.is_valid())
+		return -EINVAL;
+
+	if (context) {
+		context->add({{"keys", bulk_request.keys.size()},
+		              {"ioflags", std::string(dnet_flags_dump_ioflags(bulk_request.ioflags))},
+		              {"backend_id", c->backend_id},
+		             });
+	}
+
+	auto st = reinterpret_cast<dnet_net_state *>(state);
+	const bool cas = bulk_request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP;
+
+	cmd->flags &= ~DNET_FLAGS_NEED_ACK;
+
+	const size_t num_keys = bulk_request.keys.size();
+	dnet_bulk_remove_replier replier(st, cmd, num_keys, bulk_request.status_array);
+	for (size_t i = 0; i < num_keys; ++i) {
+		const dnet_id &id = bulk_request.keys[i];
+		const int err = memory_remove(c, memory_key(id), cas ? &bulk_request.timestamps[i] : nullptr);
+		replier.reply(id, c->backend_id, err);
+	}
+
+	DNET_LOG_INFO(c->blog, "{}: MEMORY: bulk-remove-new: keys: {}", dnet_dump_id(&cmd->id), num_keys);
+	return 0;
+}
+
+static bool memory_key_in_ranges(const ioremap::elliptics::dnet_iterator_request &request, const dnet_raw_id &key) {
+	if (!(request.flags & DNET_IFLAGS_KEY_RANGE) || request.key_ranges.empty())
+		return true;
+
+	for (const auto &range : request.key_ranges) {
+		if (dnet_id_cmp_str(range.key_begin.id, key.id) <= 0 && dnet_id_cmp_str(key.id, range.key_end.id) <= 0)
+			return true;
+	}
+	return false;
+}
+
+static bool memory_ts_in_range(const ioremap::elliptics::dnet_iterator_request &request, const dnet_time &ts) {
+	if (!(request.flags & DNET_IFLAGS_TS_RANGE))
+		return true;
+
+	return dnet_time_cmp(&ts, &std::get<0>(request.time_range)) >= 0 &&
+	       dnet_time_cmp(&ts, &std::get<1>(request.time_range)) <= 0;
+}
+
+static int memory_iterator_start(memory_backend_config *c, dnet_net_state *st, dnet_cmd *cmd,
+                                 const ioremap::elliptics::dnet_iterator_request &request) {
+	using namespace ioremap::elliptics;
+
+	if (request.flags & ~DNET_IFLAGS_ALL) {
+		DNET_LOG_ERROR(c->blog, "MEMORY: iteration failed: unknown iteration flags: {}", request.flags);
+		return -ENOTSUP;
+	}
+
+	if (request.type != DNET_ITYPE_NETWORK) {
+		DNET_LOG_ERROR(c->blog, "MEMORY: iteration failed: unsupported iteration type: {}", request.type);
+		return -ENOTSUP;
+	}
+
+	for (const auto &range : request.key_ranges) {
+		if (dnet_id_cmp_str(range.key_begin.id, range.key_end.id) > 0) {
+			DNET_LOG_ERROR(c->blog, "MEMORY: iteration failed: key_begin > key_end");
+			return -ERANGE;
+		}
+	}
+
+	auto deleter = [&st] (dnet_iterator *p) {
+		dnet_iterator_destroy(st->n, p);
+	};
+
+	std::unique_ptr<dnet_iterator, decltype(deleter)> it{dnet_iterator_create(st->n), deleter};
+	if (!it) {
+		return -ENOMEM;
+	}
+
+	const uint64_t total_keys = c->storage->records;
+	uint64_t iterated_keys = 0;
+
+	auto send_record = [&] (const dnet_raw_id &key, const memory_record &record) -> int {
+		const bool uncommitted = record.uncommitted();
+		const uint64_t data_size = uncommitted ? 0 : record.data_size;
+		const uint64_t read_json_size = (request.flags & DNET_IFLAGS_JSON) ? record.json_size : 0;
+		const uint64_t read_data_size = (request.flags & DNET_IFLAGS_DATA) ? data_size : 0;
+
+		auto header = serialize(ioremap::elliptics::dnet_iterator_response{
+			it->id, // iterator_id
+			key, // key
+			0, // status
+
+			++iterated_keys, // iterated_keys
+			total_keys, // total_keys
+
+			record.record_flags, // record_flags
+			record.user_flags, // user_flags
+
+			record.json_timestamp, // json_timestamp
+			record.json_size, // json_size
+			record.json_capacity, // json_capacity
+			read_json_size, // read_json_size
+
+			record.timestamp, // data timestamp
+			data_size, // data_size
+			read_data_size, // read_data_size
+			0, // data_offset
+			0 // blob_id
+		});
+
+		auto response = data_pointer::allocate(sizeof(*cmd) + header.size() + read_json_size);
+		memcpy(response.data(), cmd, sizeof(*cmd));
+		memcpy(response.skip<dnet_cmd>().data(), header.data(), header.size());
+		if (read_json_size)
+			memcpy(response.skip(sizeof(*cmd) + header.size()).data(), record.json(), read_json_size);
+
+		response.data<dnet_cmd>()->size = header.size() + read_json_size + read_data_size;
+		response.data<dnet_cmd>()->flags |= DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+		response.data<dnet_cmd>()->flags &= ~DNET_FLAGS_NEED_ACK;
+
+		char *data = read_data_size ? record.data() : nullptr;
+		return dnet_send_data(st, response.data(), response.size(), data, read_data_size, /*context*/ nullptr);
+	};
+
+	/*
+	 * keys of matching records of a shard are collected under its lock, then every record is sent under the lock
+	 * (the reply gets a copy of its payload) and flow control waits after the lock is released
+	 */
+	std::vector<dnet_raw_id> keys;
+	for (auto &shard : c->storage->shards) {
+		keys.clear();
+		{
+			std::lock_guard<std::mutex> guard(shard->lock);
+			for (const auto &item : shard->records) {
+				if (memory_key_in_ranges(request, item.first) &&
+				    memory_ts_in_range(request, item.second.timestamp)) {
+					keys.emplace_back(item.first);
+				}
+			}
+		}
+
+		for (const auto &key : keys) {
+			if (st->__need_exit) {
+				DNET_LOG_ERROR(c->blog, "MEMORY: iterator: Interrupting iterator: peer has been disconnected");
+				return -EINTR;
+			}
+
+			int err = [&] () {
+				std::lock_guard<std::mutex> guard(shard->lock);
+
+				/* record has been removed after its key was collected */
+				auto record = shard->records.find(key);
+				if (record == shard->records.end())
+					return 0;
+
+				return send_record(key, record->second);
+			} ();
+			if (err)
+				return err;
+
+			err = dnet_iterator_flow_control(it.get());
+			if (err)
+				return err;
+		}
+	}
+
+	return 0;
+}
+
+static int memory_iterate(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                          dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	ioremap::elliptics::dnet_iterator_request request;
+	deserialize(data_pointer::from_raw(data, cmd->size), request);
+
+	if (context) {
+		context->add({{"iterator_id", request.iterator_id},
+		              {"action", request.action},
+		              {"type", request.type},
+		              {"flags", to_hex_string(request.flags)},
+		              {"key_ranges", request.key_ranges.size()},
+		             });
+	}
+
+	int err = -ENOTSUP;
+	if (request.action == DNET_ITERATOR_ACTION_START)
+		err = memory_iterator_start(c, reinterpret_cast<dnet_net_state *>(state), cmd, request);
+
+	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "MEMORY: iterator: id: {}, type: {}, flags: {}, "
+	         "action: {}, key_ranges: {}: {}", request.iterator_id, request.type, request.flags, request.action,
+	         request.key_ranges.size(), dnet_print_error(err));
+	return err;
+}
+
+/*
+ * Writes \a record with \a json and \a data copied from it to remote groups by chunks of \a request.chunk_size,
+ * timed out writes are retried up to \a request.chunk_retry_count times. Returns the last error of the groups.
+ */
+static int memory_server_send_record(memory_backend_config *c, ioremap::elliptics::newapi::session &session,
+                                     const ioremap::elliptics::dnet_server_send_request &request,
+                                     const dnet_raw_id &key, const memory_record &record,
+                                     const ioremap::elliptics::data_pointer &json,
+                                     const ioremap::elliptics::data_pointer &data) {
+	using namespace ioremap::elliptics;
+
+	session.set_user_flags(record.user_flags);
+	session.set_json_timestamp(record.json_timestamp);
+	session.set_timestamp(record.timestamp);
+
+	const uint64_t chunk_size = std::max<uint64_t>(request.chunk_size, 1);
+	const uint64_t data_size = data.size();
+
+	auto chunk = [&] (uint64_t offset) {
+		return data.slice(offset, std::min(chunk_size, data_size - offset));
+	};
+
+	auto write = [&] (uint64_t offset) -> newapi::async_write_result {
+		if (data_size <= chunk_size)
+			return session.write(key, json, record.json_capacity, chunk(0), data_size);
+		if (!offset)
+			return session.write_prepare(key, json, record.json_capacity, chunk(0), 0, data_size);
+		if (data_size - offset > chunk_size)
+			return session.write_plain(key, "", chunk(offset), offset);
+		return session.write_commit(key, "", chunk(offset), offset, data_size);
+	};
+
+	std::vector<int> groups = request.groups;
+	int last_error = 0;
+
+	for (uint64_t offset = 0; offset == 0 || offset < data_size; offset += chunk_size) {
+		session.set_groups(groups);
+		std::vector<int> retry_groups;
+		auto retry_count = request.chunk_retry_count;
+
+		do {
+			if (!retry_groups.empty()) {
+				DNET_LOG_INFO(c->blog, "MEMORY: server_send {}: retrying write to groups: {}",
+				              dnet_dump_id_str(key.id), retry_groups);
+				session.set_groups(retry_groups);
+				retry_groups.clear();
+			}
+
+			for (const auto &result : write(offset).get()) {
+				const auto group_id = result.command()->id.group_id;
+				switch (result.status()) {
+					case 0: break;
+					case -ETIMEDOUT:
+						retry_groups.emplace_back(group_id);
+						break;
+					default:
+						last_error = result.status();
+						groups.erase(std::remove(groups.begin(), groups.end(), group_id),
+						             groups.end());
+						break;
+				}
+			}
+		} while (retry_count-- && !retry_groups.empty());
+
+		for (auto group_id : retry_groups) {
+			last_error = -ETIMEDOUT;
+			groups.erase(std::remove(groups.begin(), groups.end(), group_id), groups.end());
+		}
+
+		if (groups.empty())
+			break;
+	}
+
+	return last_error;
+}
+
+static int memory_send_new(memory_backend_config *c, void *state, dnet_cmd *cmd, void *data,
+                           dnet_access_context *context) {
+	using namespace ioremap::elliptics;
+
+	ioremap::elliptics::dnet_server_send_request request;
+	deserialize(data_pointer::from_raw(data, cmd->size), request);
+
+	if (context) {
+		context->add({{"keys", request.keys.size()},
+		              {"backend_id", c->backend_id},
+		              {"chunk_size", request.chunk_size},
+		              {"flags", to_hex_string(request.flags)},
+		             });
+	}
+
+	auto st = reinterpret_cast<dnet_net_state *>(state);
+
+	newapi::session session{st->n};
+	session.set_exceptions_policy(ioremap::elliptics::session::no_exceptions);
+	session.set_filter(filters::all_final);
+	session.set_trace_id(cmd->trace_id);
+	session.set_trace_bit(!!(cmd->flags & DNET_FLAGS_TRACE_BIT));
+	session.set_ioflags(DNET_IO_FLAGS_CAS_TIMESTAMP);
+	session.set_timeout(std::max(1lu, (request.chunk_write_timeout - 1) / 1000 + 1));
+
+	uint64_t counter = 0;
+	int err = 0;
+
+	for (const auto &key : request.keys) {
+		if (st->__need_exit) {
+			DNET_LOG_ERROR(c->blog, "MEMORY: Interrupting server_send: peer has been disconnected");
+			err = -EINTR;
+			break;
+		}
+
+		memory_record record{};
+		data_pointer json, data;
+		int status = memory_get_committed(c, key, record, &json, &data);
+		if (!status)
+			status = memory_server_send_record(c, session, request, key, record, json, data);
+
+		auto response = serialize(ioremap::elliptics::dnet_iterator_response{
+			uint64_t(cmd->backend_id), // iterator_id
+			key, // key
+			status, // status
+
+			++counter, // iterated_keys
+			request.keys.size(), // total_keys
+
+			record.record_flags, // record_flags
+			record.user_flags, // user_flags
+
+			record.json_timestamp, // json_timestamp
+			record.json_size, // json_size
+			record.json_capacity, // json_capacity
+			0, // read_json_size
+
+			record.timestamp, // data timestamp
+			record.data_size, // data_size
+			0, // read_data_size
+			0, // data_offset
+			0 // blob_id
+		});
+
+		err = dnet_send_reply(state, cmd, response.data(), response.size(), 1, /*context*/ nullptr);
+		if (err)
+			break;
+	}
+
+	DNET_LOG(c->blog, err ? DNET_LOG_ERROR : DNET_LOG_INFO, "MEMORY: server_send: keys: {}, groups: {}: {}",
+	         request.keys.size(), request.groups, dnet_print_error(err));
+	return err;
+}
+
+static int memory_backend_command_handler(void *state, void *priv, struct dnet_cmd *cmd, void *data,
+                                          void *cmd_stats, struct dnet_access_context *context) {
+	FORMATTED(HANDY_TIMER_SCOPE, ("memory_backend.cmd.%s", dnet_cmd_string(cmd->cmd)));
+
+	auto c = static_cast<memory_backend_config *>(priv);
+	auto stats = static_cast<dnet_cmd_stats *>(cmd_stats);
+
+	switch (cmd->cmd) {
+		case DNET_CMD_LOOKUP_NEW:
+			return memory_file_info_new(c, state, cmd, context);
+		case DNET_CMD_READ_NEW:
+			return memory_read_new(c, state, cmd, data, stats, context);
+		case DNET_CMD_WRITE_NEW:
+			return memory_write_new(c, state, cmd, data, stats, context);
+		case DNET_CMD_ITERATOR_NEW:
+			return memory_iterate(c, state, cmd, data, context);
+		case DNET_CMD_SEND_NEW:
+			return memory_send_new(c, state, cmd, data, context);
+		case DNET_CMD_DEL_NEW:
+			return memory_del_new(c, cmd, data, context);
+		case DNET_CMD_BULK_READ_NEW:
+			return memory_bulk_read_new(c, state, cmd, data, stats, context);
+		case DNET_CMD_BULK_REMOVE_NEW:
+			return memory_bulk_remove_new(c, state, cmd, data, context);
+		default:
+			return -ENOTSUP;
+	}
+}
+
+/*
+ * Snapshot is a sequence of records: memory_snapshot_header followed by json and data of the record.
+ * It is written in the host byte order and is supposed to be loaded by the same node.
+ */
+struct memory_snapshot_header {
+	dnet_raw_id key;
+	uint64_t record_flags;
+	uint64_t user_flags;
+	dnet_time timestamp;
+	dnet_time json_timestamp;
+	uint64_t json_capacity;
+	uint64_t json_size;
+	uint64_t data_size;
+};
+
+static int memory_snapshot_save(memory_backend_config *c) {
+	const std::string path = c->snapshot;
+	const std::string tmp_path = path + ".tmp";
+
+	std::unique_ptr<FILE, int (*)(FILE *)> file{fopen(tmp_path.c_str(), "w"), &fclose};
+	if (!file) {
+		const int err = -errno;
+		DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: failed to open {}: {}", tmp_path, dnet_print_error(err));
+		return err;
+	}
+
+	uint64_t records = 0;
+	int err = 0;
+	for (auto &shard : c->storage->shards) {
+		std::lock_guard<std::mutex> guard(shard->lock);
+		for (const auto &item : shard->records) {
+			const auto &record = item.second;
+			if (record.uncommitted())
+				continue;
+
+			memory_snapshot_header header;
+			memset(&header, 0, sizeof(header));
+			header.key = item.first;
+			header.record_flags = record.record_flags;
+			header.user_flags = record.user_flags;
+			header.timestamp = record.timestamp;
+			header.json_timestamp = record.json_timestamp;
+			header.json_capacity = record.json_capacity;
+			header.json_size = record.json_size;
+			header.data_size = record.data_size;
+
+			if (fwrite(&header, sizeof(header), 1, file.get()) != 1 ||
+			    (record.json_size && fwrite(record.json(), record.json_size, 1, file.get()) != 1) ||
+			    (record.data_size && fwrite(record.data(), record.data_size, 1, file.get()) != 1)) {
+				err = -EIO;
+				break;
+			}
+			++records;
+		}
+		if (err)
+			break;
+	}
+
+	if (!err && (fflush(file.get()) || fsync(fileno(file.get()))))
+		err = -errno;
+	file.reset();
+
+	if (!err && rename(tmp_path.c_str(), path.c_str()))
+		err = -errno;
+
+	if (err) {
+		unlink(tmp_path.c_str());
+		DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: failed to save {}: {}", path, dnet_print_error(err));
+		return err;
+	}
+
+	DNET_LOG_INFO(c->blog, "MEMORY: snapshot: saved {} records to {}", records, path);
+	return 0;
+}
+
+static int memory_snapshot_load(memory_backend_config *c) {
+	const std::string path = c->snapshot;
+
+	std::unique_ptr<FILE, int (*)(FILE *)> file{fopen(path.c_str(), "r"), &fclose};
+	if (!file) {
+		const int err = -errno;
+		if (err == -ENOENT) {
+			DNET_LOG_INFO(c->blog, "MEMORY: snapshot: {} doesn't exist, starting empty", path);
+			return 0;
+		}
+		DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: failed to open {}: {}", path, dnet_print_error(err));
+		return err;
+	}
+
+	uint64_t records = 0;
+	memory_snapshot_header header;
+	while (fread(&header, sizeof(header), 1, file.get()) == 1) {
+		if (header.json_size > header.json_capacity) {
+			DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: {}: record {}: json ({}) exceeds capacity ({})", path,
+			               dnet_dump_id_str(header.key.id), header.json_size, header.json_capacity);
+			return -EINVAL;
+		}
+
+		memory_record record{};
+		record.record_flags = header.record_flags;
+		record.user_flags = header.user_flags;
+		record.timestamp = header.timestamp;
+		record.json_timestamp = header.json_timestamp;
+		record.json_capacity = header.json_capacity;
+		record.json_size = header.json_size;
+		record.data_size = header.data_size;
+
+		auto &shard = c->storage->get_shard(header.key);
+		try {
+			record.payload = shard.arena.allocate(record.json_capacity + record.data_size, record.slot_size);
+		} catch (const std::bad_alloc &) {
+			DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: {}: failed to allocate record {}, loaded {} records",
+			               path, dnet_dump_id_str(header.key.id), records);
+			return -ENOMEM;
+		}
+
+		if ((record.json_size && fread(record.json(), record.json_size, 1, file.get()) != 1) ||
+		    (record.data_size && fread(record.data(), record.data_size, 1, file.get()) != 1)) {
+			shard.arena.free(record.payload, record.slot_size);
+			DNET_LOG_ERROR(c->blog, "MEMORY: snapshot: {}: truncated record {}, loaded {} records", path,
+			               dnet_dump_id_str(header.key.id), records);
+			return -EINVAL;
+		}
+
+		if (!shard.records.emplace(header.key, record).second) {
+			shard.arena.free(record.payload, record.slot_size);
+			continue;
+		}
+
+		c->storage->used_size += record.footprint();
+		++c->storage->records;
+		++records;
+	}
+
+	DNET_LOG_INFO(c->blog, "MEMORY: snapshot: loaded {} records from {}", records, path);
+	return 0;
+}
+
+/* Recomputes storage_free of the backend's config from memory taken by arenas of all shards, returns arenas' size */
+static uint64_t memory_update_storage_free(memory_backend_config *c) {
+	uint64_t arena_size = 0;
+	for (auto &shard : c->storage->shards) {
+		std::lock_guard<std::mutex> guard(shard->lock);
+		arena_size += shard->arena.reserved();
+	}
+
+	if (c->size_limit)
+		c->config->storage_free = c->size_limit - std::min<uint64_t>(c->size_limit, arena_size);
+
+	return arena_size;
+}
+
+static int memory_backend_storage_stat_json(void *priv, char **json_stat, size_t *size) {
+	auto c = static_cast<memory_backend_config *>(priv);
+
+	rapidjson::Document doc;
+	doc.SetObject();
+	rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
+
+	uint64_t records = c->storage->records;
+	uint64_t used_size = c->storage->used_size;
+	uint64_t arena_size = memory_update_storage_free(c);
+	doc.AddMember("records", records, allocator);
+	doc.AddMember("used_size", used_size, allocator);
+	doc.AddMember("arena_size", arena_size, allocator);
+	doc.AddMember("size_limit", c->size_limit, allocator);
+	doc.AddMember("storage_free", static_cast<uint64_t>(c->config->storage_free), allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	std::string json = buffer.GetString();
+
+	*json_stat = (char *)malloc(json.length() + 1);
+	if (!*json_stat) {
+		*size = 0;
+		return -ENOMEM;
+	}
+
+	*size = json.length();
+	snprintf(*json_stat, *size + 1, "%s", json.c_str());
+	return 0;
+}
+
+static uint64_t memory_backend_total_elements(void *priv) {
+	auto c = static_cast<memory_backend_config *>(priv);
+	return c->storage->records;
+}
+
+static void memory_backend_cleanup(void *priv) {
+	auto c = static_cast<memory_backend_config *>(priv);
+
+	if (c->snapshot)
+		memory_snapshot_save(c);
+
+	delete c->storage;
+	c->storage = nullptr;
+}
+
+static int dnet_memory_set_backend_id(struct dnet_config_backend *b, const char *, const char *value) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+	c->backend_id = strtoul(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_memory_set_shards(struct dnet_config_backend *b, const char *, const char *value) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+	c->shards = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_memory_set_size_limit(struct dnet_config_backend *b, const char *, const char *value) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+	c->size_limit = strtoull(value, NULL, 0);
+	return 0;
+}
+
+static int dnet_memory_set_snapshot(struct dnet_config_backend *b, const char *, const char *value) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+
+	free(c->snapshot);
+	c->snapshot = strdup(value);
+	if (!c->snapshot)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static int dnet_memory_config_init(struct dnet_config_backend *b, enum dnet_log_level) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+
+	c->blog = b->log;
+	c->config = b;
+
+	if (!c->shards)
+		c->shards = DNET_MEMORY_DEFAULT_SHARDS;
+
+	try {
+		c->storage = new memory_storage(c->shards);
+	} catch (...) {
+		return -ENOMEM;
+	}
+
+	if (c->snapshot) {
+		const int err = memory_snapshot_load(c);
+		if (err) {
+			delete c->storage;
+			c->storage = nullptr;
+			return err;
+		}
+	}
+
+	if (c->size_limit) {
+		b->storage_size = c->size_limit;
+		memory_update_storage_free(c);
+	}
+
+	b->cb.storage_stat_json = memory_backend_storage_stat_json;
+	b->cb.total_elements = memory_backend_total_elements;
+
+	b->cb.command_private = c;
+	b->cb.command_handler = memory_backend_command_handler;
+	b->cb.backend_cleanup = memory_backend_cleanup;
+
+	DNET_LOG_INFO(c->blog, "MEMORY: initialized: shards: {}, size_limit: {}, snapshot: {}, records: {}",
+	              c->shards, c->size_limit, c->snapshot ? c->snapshot : "", c->storage->records.load());
+	return 0;
+}
+
+static void dnet_memory_config_cleanup(struct dnet_config_backend *b) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+
+	/* the same as for eblob, config of disabled backend is cleaned up without being initialized */
+	if (c->storage)
+		memory_backend_cleanup(c);
+
+	free(c->snapshot);
+	c->snapshot = nullptr;
+}
+
+static int dnet_memory_config_to_json(struct dnet_config_backend *b, char **json_stat, size_t *size) {
+	auto c = static_cast<memory_backend_config *>(b->data);
+
+	rapidjson::Document doc;
+	doc.SetObject();
+	rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
+
+	doc.AddMember("shards", c->shards, allocator);
+	doc.AddMember("size_limit", c->size_limit, allocator);
+	doc.AddMember("snapshot", c->snapshot ? c->snapshot : "", allocator);
+	if (c->storage)
+		memory_update_storage_free(c);
+	doc.AddMember("storage_free", static_cast<uint64_t>(b->storage_free), allocator);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	doc.Accept(writer);
+
+	std::string json = buffer.GetString();
+
+	*json_stat = (char *)malloc(json.length() + 1);
+	if (!*json_stat) {
+		*size = 0;
+		return -ENOMEM;
+	}
+
+	*size = json.length();
+	snprintf(*json_stat, *size + 1, "%s", json.c_str());
+	return 0;
+}
+
+static void dnet_memory_set_verbosity(struct dnet_config_backend *, enum dnet_log_level) {
+}
+
+static struct dnet_config_entry dnet_cfg_entries_memory[] = {
+	{"backend_id", dnet_memory_set_backend_id},
+	{"shards", dnet_memory_set_shards},
+	{"size_limit", dnet_memory_set_size_limit},
+	{"snapshot", dnet_memory_set_snapshot},
+};
+
+} /* namespace */
+
+struct dnet_config_backend *dnet_memory_backend_info(void) {
+	static struct dnet_config_backend backend = [] () {
+		struct dnet_config_backend backend;
+		memset(&backend, 0, sizeof(backend));
+		snprintf(backend.name, sizeof(backend.name), "memory");
+		backend.ent = dnet_cfg_entries_memory;
+		backend.num = ARRAY_SIZE(dnet_cfg_entries_memory);
+		backend.size = sizeof(struct memory_backend_config);
+		backend.init = dnet_memory_config_init;
+		backend.cleanup = dnet_memory_config_cleanup;
+		backend.to_json = dnet_memory_config_to_json;
+		backend.set_verbosity = dnet_memory_set_verbosity;
+		return backend;
+	} ();
+
+	return &backend;
+}
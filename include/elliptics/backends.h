@@ -130,6 +130,7 @@ int dnet_ext_hdr_write(const struct dnet_ext_list_hdr *ehdr, int fd, uint64_t of
  * library/backend.cpp dnet_backend_info::parse() method
  */
 struct dnet_config_backend *dnet_eblob_backend_info(void);
+struct dnet_config_backend *dnet_memory_backend_info(void);
 
 int backend_storage_size(struct dnet_config_backend *b, const char *root);
 
@@ -83,6 +83,24 @@
 
 #define DNET_DEFAULT_CACHE_PAGES_NUMBER 1
 
+/* Default number of dirty cache records flushed to the backend as a single batch */
+#define DNET_DEFAULT_CACHE_SYNC_BATCH_SIZE 128
+
+/* Default number of threads flushing dirty batches of a single cache shard */
+#define DNET_DEFAULT_CACHE_SYNC_THREADS 1
+
+/* Default max number of keys remembered by backend's negative cache */
+#define DNET_DEFAULT_NEGATIVE_CACHE_SIZE 100000
+
+/* Default min size of cached data which is compressed if cache compression is enabled */
+#define DNET_DEFAULT_CACHE_COMPRESSION_THRESHOLD 4096
+
+/* Default max size of compressed data in percents of raw size, objects which compress worse are stored as is */
+#define DNET_DEFAULT_CACHE_COMPRESSION_RATIO 90
+
+/* Default time in ms a missing key is remembered by backend's negative cache */
+#define DNET_DEFAULT_NEGATIVE_CACHE_TTL_MS 1000
+
 /* Default size of a chunk in server_send */
 #define DNET_DEFAULT_SERVER_SEND_CHUNK_SIZE	(10 * 1024 * 1024)
 
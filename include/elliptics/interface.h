@@ -905,6 +905,11 @@ int dnet_send_reply_threshold(void *state, struct dnet_cmd *cmd,
 
 int dnet_send_fd_threshold(struct dnet_net_state *st, void *header, uint64_t hsize,
                            int fd, uint64_t offset, uint64_t dsize);
+/*
+ * Sends @replies complete replies (command followed by its data) packed into @data by a single request,
+ * they are accounted by send queue watermarks as @replies separate replies and as @size bytes buffered in memory.
+ */
+int dnet_send_replies_threshold(struct dnet_net_state *st, void *data, uint64_t size, long replies);
 
 struct dnet_route_entry
 {
@@ -84,6 +84,8 @@ public:
 	// Appends one result to container
 	void append(const iterator_result_entry &result);
 	void append_old(const ioremap::elliptics::iterator_result_entry &result);
+	// Appends all records of the container received from DNET_ITYPE_DISK iterator
+	void append_container(const iterator_result_entry &result);
 	// Sorts container
 	void sort();
 	iterator_container_item operator [](size_t n) const;
@@ -112,10 +112,25 @@ public:
 	 */
 	async_lookup_result update_json(const key &id, const argument_data &json);
 
-
+	/* Start iterator on backend \a backend_id at node \a addr.
+	 * \a parallelism is a hint how many threads the backend may use for the iteration of \a key_ranges,
+	 * 0 lets the backend decide. Iteration without \a key_ranges always runs in a single thread.
+	 * Keys iterated by parallel threads are returned in no particular order.
+	 */
 	async_iterator_result start_iterator(const address &addr, uint32_t backend_id, uint64_t flags,
 	                                     const std::vector<dnet_iterator_range> &key_ranges,
-	                                     const std::tuple<dnet_time, dnet_time> &time_range);
+	                                     const std::tuple<dnet_time, dnet_time> &time_range,
+	                                     uint32_t parallelism = 0);
+
+	/* Start iterator on backend \a backend_id at node \a addr which collects iterated keys into
+	 * a sorted container on the node's side. The container is sent back as the data of a single reply,
+	 * read it with iterator_result_container::append_container().
+	 * Json and data of the records are never sent, \a flags are applied the same way as by start_iterator().
+	 */
+	async_iterator_result start_disk_iterator(const address &addr, uint32_t backend_id, uint64_t flags,
+	                                          const std::vector<dnet_iterator_range> &key_ranges,
+	                                          const std::tuple<dnet_time, dnet_time> &time_range,
+	                                          uint32_t parallelism = 0);
 
 	async_iterator_result server_send(const std::vector<dnet_raw_id> &keys, uint64_t flags, uint64_t chunk_size,
 	                                  const int src_group, const std::vector<int> &dst_groups);
@@ -111,6 +111,8 @@ enum dnet_commands {
 #define DNET_MONITOR_STATS		(1<<5)				/* statistics gathered by handystats */
 #define DNET_MONITOR_PROCFS		(1<<6)				/* virtual memory statistics */
 #define DNET_MONITOR_TOP		(1<<7)				/* statistics of top keys ordered by generated traffic */
+#define DNET_MONITOR_LATENCY		(1<<8)				/* histograms of commands latencies */
+#define DNET_MONITOR_SAMPLES		(1<<9)				/* timings of sampled requests split by stages */
 #define DNET_MONITOR_ALL		(-1)				/* all available statistics */
 
 enum dnet_backend_command {
@@ -1117,13 +1119,15 @@ struct dnet_monitor_stat_request {
 	uint32_t	backends_number; // size of array of backends ids.
 	                                 // This array is located behind this structure in binary packet
 	uint32_t        reserved_uint32t;
-	uint64_t	reserved[3];
+	uint64_t	since_version; // if non-zero, only values changed since statistics of this version are requested
+	uint64_t	reserved[2];
 } __attribute__ ((packed));
 
 static inline void dnet_convert_monitor_stat_request(struct dnet_monitor_stat_request *r)
 {
 	r->categories = dnet_bswap64(r->categories);
 	r->backends_number = dnet_bswap32(r->backends_number);
+	r->since_version = dnet_bswap64(r->since_version);
 }
 
 
@@ -629,6 +629,15 @@ public:
 	async_monitor_stat_result monitor_stat(const address &addr, uint64_t categories,
 	                                       const std::unordered_set<uint32_t> &backends_ids);
 
+	/*!
+	 * Queries monitor statistics information for backends defined in \a backends_ids
+	 * from the server node specified by \a addr. If the node still has statistics of \a since_version,
+	 * only values changed since it are returned, otherwise the whole statistics is returned.
+	 */
+	async_monitor_stat_result monitor_stat(const address &addr, uint64_t categories,
+	                                       const std::unordered_set<uint32_t> &backends_ids,
+	                                       uint64_t since_version);
+
 	/*!
 	 * Returns the number of session states.
 	 */
@@ -19,39 +19,362 @@
 
 #include "access_context.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
 #include "elliptics/interface.h"
+#include "elliptics.h"
 #include "logger.hpp"
 
+namespace {
+
+void print_access_record(dnet_node *node, const dnet_access_record &record) {
+	static const char *access_types[] = {"", "server", "server/control", "server/forward"};
+
+	blackhole::attributes_t attributes;
+	attributes.reserve(record.attributes.size() + 3 * record.replies_count + 16);
+
+	if (record.fields & dnet_access_record::has_request) {
+		attributes.insert(attributes.end(), {
+			{"cmd", std::string(dnet_cmd_string(record.cmd))},
+			{"trans", record.trans},
+			{"st", std::string(dnet_addr_string(&record.addr))},
+			{"trace_id", ioremap::elliptics::to_hex_string(record.trace_id)},
+			{"request_size", record.request_size},
+			{"receive_time", record.receive_time},
+			{"receive_queue_time", record.receive_queue_time},
+		});
+	}
+	if (record.fields & dnet_access_record::has_access)
+		attributes.push_back({"access", std::string(access_types[record.access_type])});
+	if (record.fields & dnet_access_record::has_forward)
+		attributes.push_back({"forward", std::string(dnet_addr_string(&record.forward_addr))});
+	if (record.fields & dnet_access_record::has_id)
+		attributes.push_back({"id", std::string(dnet_dump_id(&record.id))});
+
+	attributes.insert(attributes.end(), record.attributes.begin(), record.attributes.end());
+
+	if (record.fields & dnet_access_record::has_status)
+		attributes.push_back({"status", record.status});
+	// every reply is logged by its own attributes as it was before the record was introduced
+	for (size_t i = 0; i < record.replies_count; ++i) {
+		const auto &reply = record.replies[i];
+		attributes.insert(attributes.end(), {
+			{"send_time", reply.send_time},
+			{"send_queue_time", reply.send_queue_time},
+			{"response_size", reply.size},
+		});
+	}
+	if (record.replies_overflow) {
+		attributes.insert(attributes.end(), {
+			{"replies_overflow", record.replies_overflow},
+			{"replies_overflow_size", record.replies_overflow_size},
+		});
+	}
+	attributes.push_back({"total_time", record.total_time});
+
+	dnet_log_access(node, blackhole::attribute_list{attributes.begin(), attributes.end()});
+}
+
+// Single-producer single-consumer ring of access records released by a thread for the access writer.
+class access_ring {
+public:
+	static const size_t capacity = 256;
+
+	// moves @record into the ring, returns false if the ring is full or closed
+	bool push(dnet_access_record &record) {
+		// pairs with close(): either the ring is seen closed or close() waits for the push
+		m_pushing.store(true);
+		if (m_closed.load()) {
+			m_pushing.store(false, std::memory_order_release);
+			return false;
+		}
+
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		const bool full = head - m_tail.load(std::memory_order_acquire) == capacity;
+		if (!full) {
+			m_records[head & (capacity - 1)] = std::move(record);
+			// sequentially consistent to be ordered with the check of sleeping writer made by the caller
+			m_head.store(head + 1);
+		}
+
+		m_pushing.store(false, std::memory_order_release);
+		return !full;
+	}
+
+	// calls @handler for all pushed records and frees them, returns their number
+	template <typename Handler>
+	size_t drain(const Handler &handler) {
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		const size_t head = m_head.load(std::memory_order_acquire);
+		for (size_t position = tail; position != head; ++position) {
+			auto &record = m_records[position & (capacity - 1)];
+			handler(record);
+			record = dnet_access_record();
+		}
+		m_tail.store(head, std::memory_order_release);
+		return head - tail;
+	}
+
+	bool empty() const {
+		return m_head.load() == m_tail.load(std::memory_order_acquire);
+	}
+
+	// forbids further pushes and waits for the one in progress, the ring should be drained after that
+	void close() {
+		m_closed.store(true);
+		while (m_pushing.load())
+			std::this_thread::yield();
+	}
+
+	bool closed() const {
+		return m_closed.load(std::memory_order_relaxed);
+	}
+
+private:
+	// written by the producer
+	std::atomic<size_t> m_head{0};
+	std::atomic<bool> m_pushing{false};
+	std::atomic<bool> m_closed{false};
+	// keeps the writer's position off the producer's cache line,
+	// padding is used since rings are allocated by operator new which ignores extended alignment
+	char m_padding[64];
+	// written by the writer
+	std::atomic<size_t> m_tail{0};
+	dnet_access_record m_records[capacity];
+};
+
+const size_t access_ring::capacity;
+
+} /* namespace */
+
+/*
+ * Access writer moves formatting and writing of access logs out of threads which handle requests.
+ * The record of a context whose last reference is put is moved into the ring of the releasing thread
+ * and is printed by the writer thread. If the ring is full or the writer is stopped, the record is printed
+ * by the releasing thread as before.
+ *
+ * The writer sleeps while rings are empty. Releasing threads take the mutex only to wake it up,
+ * so a busy writer isn't notified per record.
+ */
+struct dnet_access_writer {
+public:
+	explicit dnet_access_writer(dnet_node *node);
+	~dnet_access_writer();
+
+	// returns false if @record was not staged and should be printed by the caller
+	bool push(dnet_access_record &record);
+	// closes all rings, prints records staged in them and joins the thread
+	void stop();
+
+private:
+	access_ring *thread_ring();
+	void run();
+	size_t drain();
+	bool empty() const;
+
+	dnet_node *m_node;
+	// identifies the writer in thread-local lists of rings
+	const uint64_t m_id;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stop;
+	// whether the writer is woken up by a releasing thread
+	bool m_wakeup;
+	// set by the writer before it goes to sleep, releasing threads wake it up only if it is set
+	std::atomic<bool> m_sleeping;
+	std::vector<std::shared_ptr<access_ring>> m_rings;
+	// copy of m_rings drained without holding m_mutex, it is used only by the writer thread
+	std::vector<std::shared_ptr<access_ring>> m_drained;
+
+	std::thread m_thread;
+};
+
+static uint64_t next_access_writer_id() {
+	static std::atomic<uint64_t> next_id{0};
+	return ++next_id;
+}
+
+dnet_access_writer::dnet_access_writer(dnet_node *node)
+: m_node(node)
+, m_id(next_access_writer_id())
+, m_stop(false)
+, m_wakeup(false)
+, m_sleeping(false) {
+	m_thread = std::thread(&dnet_access_writer::run, this);
+}
+
+dnet_access_writer::~dnet_access_writer() {
+	stop();
+}
+
+void dnet_access_writer::stop() {
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (m_stop)
+			return;
+
+		// rings are registered under m_mutex only while the writer isn't stopped,
+		// so every record pushed into any ring is seen by the writer's last pass
+		for (const auto &ring : m_rings) {
+			ring->close();
+		}
+		m_stop = true;
+	}
+	m_condition.notify_one();
+	m_thread.join();
+}
+
+bool dnet_access_writer::push(dnet_access_record &record) {
+	auto ring = thread_ring();
+	if (!ring || !ring->push(record))
+		return false;
+
+	if (m_sleeping.load()) {
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_wakeup = true;
+		}
+		m_condition.notify_one();
+	}
+	return true;
+}
+
+access_ring *dnet_access_writer::thread_ring() {
+	static thread_local std::vector<std::pair<uint64_t, std::shared_ptr<access_ring>>> rings;
+
+	for (const auto &item : rings) {
+		if (item.first == m_id)
+			return item.second.get();
+	}
+
+	rings.erase(std::remove_if(rings.begin(), rings.end(), [] (const std::pair<uint64_t, std::shared_ptr<access_ring>> &item) {
+		return item.second->closed();
+	}), rings.end());
+
+	auto ring = std::make_shared<access_ring>();
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (m_stop)
+			return nullptr;
+		m_rings.emplace_back(ring);
+	}
+	rings.emplace_back(m_id, ring);
+	return ring.get();
+}
+
+size_t dnet_access_writer::drain() {
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		// rings of exited threads are owned only by the writer
+		m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [] (const std::shared_ptr<access_ring> &ring) {
+			return ring.use_count() == 1 && ring->empty();
+		}), m_rings.end());
+		m_drained = m_rings;
+	}
+
+	size_t printed = 0;
+	for (const auto &ring : m_drained) {
+		printed += ring->drain([this] (const dnet_access_record &record) {
+			print_access_record(m_node, record);
+		});
+	}
+	return printed;
+}
+
+bool dnet_access_writer::empty() const {
+	return std::all_of(m_rings.begin(), m_rings.end(), [] (const std::shared_ptr<access_ring> &ring) {
+		return ring->empty();
+	});
+}
+
+void dnet_access_writer::run() {
+	dnet_set_name("dnet_access");
+
+	while (true) {
+		drain();
+
+		std::unique_lock<std::mutex> guard(m_mutex);
+		if (m_stop)
+			break;
+
+		// pairs with push(): either the record is seen here or its thread sees the writer sleeping
+		m_sleeping.store(true);
+		if (!empty()) {
+			m_sleeping.store(false);
+			continue;
+		}
+
+		m_condition.wait(guard, [this] () { return m_wakeup || m_stop; });
+		m_wakeup = false;
+		m_sleeping.store(false);
+	}
+
+	// rings are closed, so this pass prints everything staged before the stop
+	drain();
+	m_drained.clear();
+}
+
+constexpr size_t dnet_access_record::max_replies;
 
 dnet_access_context::dnet_access_context(dnet_node *node)
 : node_(node) {}
 
 dnet_access_context::~dnet_access_context() {
-	print();
-}
+	if (released_)
+		return;
 
+	record_.total_time = timer_.get_us();
+	print_access_record(node_, record_);
+}
 
 void dnet_access_context::add(blackhole::attribute_t attribute) {
 	std::lock_guard<std::mutex> guard(mutex_);
-	attributes_.emplace_back(std::move(attribute));
+	record_.attributes.emplace_back(std::move(attribute));
 }
 void dnet_access_context::add(std::initializer_list<blackhole::attribute_t> attributes) {
 	std::lock_guard<std::mutex> guard(mutex_);
-	attributes_.insert(attributes_.end(), attributes.begin(), attributes.end());
+	record_.attributes.insert(record_.attributes.end(), attributes.begin(), attributes.end());
 }
 
-void dnet_access_context::increment_ref() {
-	++ref_counter_;
+void dnet_access_context::set_id(const dnet_id &id) {
+	record_.fields |= dnet_access_record::has_id;
+	record_.id = id;
+}
+
+void dnet_access_context::add_reply(const dnet_access_reply &reply) {
+	std::lock_guard<std::mutex> guard(mutex_);
+	if (record_.replies_count < dnet_access_record::max_replies) {
+		record_.replies[record_.replies_count++] = reply;
+	} else {
+		++record_.replies_overflow;
+		record_.replies_overflow_size += reply.size;
+	}
 }
 
-void dnet_access_context::print() {
-	add({"total_time", timer_.get_us()});
-	dnet_log_access(node_, blackhole::attribute_list{attributes_.begin(), attributes_.end()});
+dnet_access_record &dnet_access_context::record() {
+	return record_;
+}
+
+void dnet_access_context::increment_ref() {
+	++ref_counter_;
 }
 
 void dnet_access_context::decrement_ref() {
-	if (!--ref_counter_)
-		delete this;
+	if (--ref_counter_)
+		return;
+
+	record_.total_time = timer_.get_us();
+	released_ = true;
+
+	auto writer = node_->access_writer;
+	if (!writer || !writer->push(record_))
+		print_access_record(node_, record_);
+
+	delete this;
 }
 
 struct dnet_access_context *dnet_access_context_create(struct dnet_node *node) {
@@ -104,3 +427,70 @@ void dnet_access_context_add_trace_id(struct dnet_access_context *context, uint6
 
 	context->add({"trace_id", ioremap::elliptics::to_hex_string(value)});
 }
+
+void dnet_access_context_set_request(struct dnet_access_context *context, const struct dnet_cmd *cmd,
+                                     const struct dnet_addr *addr, uint64_t request_size,
+                                     uint64_t receive_time, uint64_t receive_queue_time) {
+	if (!context)
+		return;
+
+	auto &record = context->record();
+	record.fields |= dnet_access_record::has_request;
+	record.cmd = cmd->cmd;
+	record.trans = cmd->trans;
+	record.trace_id = cmd->trace_id;
+	record.addr = *addr;
+	record.request_size = request_size;
+	record.receive_time = receive_time;
+	record.receive_queue_time = receive_queue_time;
+}
+
+void dnet_access_context_set_access(struct dnet_access_context *context, enum dnet_access_type type,
+                                    const struct dnet_addr *forward) {
+	if (!context)
+		return;
+
+	auto &record = context->record();
+	record.fields |= dnet_access_record::has_access;
+	record.access_type = type;
+	if (forward) {
+		record.fields |= dnet_access_record::has_forward;
+		record.forward_addr = *forward;
+	}
+}
+
+void dnet_access_context_set_status(struct dnet_access_context *context, int status) {
+	if (!context)
+		return;
+
+	auto &record = context->record();
+	record.fields |= dnet_access_record::has_status;
+	record.status = status;
+}
+
+void dnet_access_context_add_reply(struct dnet_access_context *context, uint64_t send_time,
+                                   uint64_t send_queue_time, uint64_t size) {
+	if (!context)
+		return;
+
+	context->add_reply(dnet_access_reply{send_time, send_queue_time, size});
+}
+
+struct dnet_access_writer *dnet_access_writer_create(struct dnet_node *node) {
+	try {
+		return new dnet_access_writer(node);
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(node, "Failed to create access writer: {}, access logs will be printed synchronously",
+		               e.what());
+		return nullptr;
+	}
+}
+
+void dnet_access_writer_stop(struct dnet_access_writer *writer) {
+	if (writer)
+		writer->stop();
+}
+
+void dnet_access_writer_destroy(struct dnet_access_writer *writer) {
+	delete writer;
+}
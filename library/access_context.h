@@ -21,6 +21,13 @@
 
 #include "elliptics/packet.h"
 
+// How the request is handled by the server
+enum dnet_access_type {
+	DNET_ACCESS_SERVER = 1,
+	DNET_ACCESS_SERVER_CONTROL,
+	DNET_ACCESS_SERVER_FORWARD,
+};
+
 #ifdef __cplusplus
 
 #include <atomic>
@@ -32,23 +39,82 @@
 #include "bindings/cpp/timer.hpp"
 
 struct dnet_node;
+struct dnet_access_writer;
+
+// Reply sent within the request
+struct dnet_access_reply {
+	uint64_t send_time;
+	uint64_t send_queue_time;
+	uint64_t size;
+};
+
+// Access log of the request. Its fixed fields are filled without any string conversions,
+// they are made only when the record is printed.
+struct dnet_access_record {
+	enum field : uint32_t {
+		has_request = 1 << 0,
+		has_access = 1 << 1,
+		has_forward = 1 << 2,
+		has_status = 1 << 3,
+		has_id = 1 << 4,
+	};
+
+	// set of fields filled in the record
+	uint32_t fields{0};
+
+	int cmd{0};
+	uint64_t trans{0};
+	uint64_t trace_id{0};
+	dnet_addr addr{};
+	uint64_t request_size{0};
+	uint64_t receive_time{0};
+	uint64_t receive_queue_time{0};
+
+	dnet_access_type access_type{DNET_ACCESS_SERVER};
+	dnet_addr forward_addr{};
+
+	// key the request is handled for by the backend
+	dnet_id id{};
+
+	int status{0};
+
+	uint64_t total_time{0};
+
+	// attributes attached by backends and clients and replies sent by network threads,
+	// they may be added while the request is still handled, so they are guarded by the context's mutex
+	blackhole::attributes_t attributes;
+
+	// most requests send a few replies, so they are kept inline without allocations,
+	// replies beyond max_replies (e.g. of iterators) are only counted
+	static constexpr size_t max_replies = 4;
+	dnet_access_reply replies[max_replies];
+	size_t replies_count{0};
+	uint64_t replies_overflow{0};
+	uint64_t replies_overflow_size{0};
+};
 
 struct dnet_access_context {
 public:
 	explicit dnet_access_context(dnet_node *node);
+	// print final log if it is not printed yet
 	~dnet_access_context();
 
 	// attach @attribute to the final log
 	void add(blackhole::attribute_t attribute);
 	// attach batch of @attributes gto the final log
 	void add(std::initializer_list<blackhole::attribute_t> attributes);
+	// attach key @id the request is handled for, it is printed as "id" attribute
+	void set_id(const dnet_id &id);
+	// account reply sent within the request
+	void add_reply(const dnet_access_reply &reply);
+
+	// fixed fields of the final log, they should be set by the thread which handles the request
+	dnet_access_record &record();
 
 	void increment_ref();
+	// the last reference hands the record over to the node's access writer and frees the context
 	void decrement_ref();
 private:
-	// print final log
-	void print();
-
 	// we have to add reference counter since an instance is created and removed in C
 	// by various threads.
 	std::atomic<size_t> ref_counter_{0};
@@ -58,9 +124,12 @@ private:
 	// Timer to measure total time spent on the request.
 	ioremap::elliptics::util::steady_timer timer_;
 
-	// mutex to synchronize adding attributes from various attributes
+	dnet_access_record record_;
+	// whether the record is already printed or handed over to access writer
+	bool released_{false};
+
+	// mutex to synchronize adding attributes and replies from various threads
 	std::mutex mutex_{};
-	blackhole::attributes_t attributes_{};
 };
 
 extern "C" {
@@ -68,6 +137,7 @@ extern "C" {
 struct dnet_node;
 struct dnet_io_req;
 struct dnet_access_context;
+struct dnet_access_writer;
 #endif
 
 // Create dnet_access_context
@@ -84,6 +154,25 @@ void dnet_access_context_add_uint(struct dnet_access_context *context, const cha
 void dnet_access_context_add_string(struct dnet_access_context *context, const char *name, const char *value);
 // Add trace_id attribute with @value
 void dnet_access_context_add_trace_id(struct dnet_access_context *context, uint64_t value);
+// Set fields of request @cmd of @request_size bytes received from @addr
+void dnet_access_context_set_request(struct dnet_access_context *context, const struct dnet_cmd *cmd,
+                                     const struct dnet_addr *addr, uint64_t request_size,
+                                     uint64_t receive_time, uint64_t receive_queue_time);
+// Set how the request is handled, @forward is address of the node the request is forwarded to
+void dnet_access_context_set_access(struct dnet_access_context *context, enum dnet_access_type type,
+                                    const struct dnet_addr *forward);
+// Set final status of the request
+void dnet_access_context_set_status(struct dnet_access_context *context, int status);
+// Account reply of @size bytes which spent @send_queue_time in send queue and was sent within @send_time
+void dnet_access_context_add_reply(struct dnet_access_context *context, uint64_t send_time,
+                                   uint64_t send_queue_time, uint64_t size);
+
+// Create writer which prints access logs of @node's requests in background
+struct dnet_access_writer *dnet_access_writer_create(struct dnet_node *node);
+// Print access logs staged in @writer and stop its thread, logs released after that are printed synchronously
+void dnet_access_writer_stop(struct dnet_access_writer *writer);
+// Free @writer stopped by dnet_access_writer_stop()
+void dnet_access_writer_destroy(struct dnet_access_writer *writer);
 
 #ifdef __cplusplus
 }
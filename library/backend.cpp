@@ -2,6 +2,7 @@
 
 #include <fcntl.h>
 #include <fstream>
+#include <map>
 #include <memory>
 
 #include <blackhole/wrapper.hpp>
@@ -11,6 +12,7 @@
 #include "bindings/cpp/timer.hpp"
 
 #include "cache/cache.hpp"
+#include "cache/negative_cache.hpp"
 #include "example/config.hpp"
 #include "library/access_context.h"
 #include "library/logger.hpp"
@@ -20,6 +22,9 @@
 #include "monitor/io_stat_provider.hpp"
 #include "monitor/monitor.hpp"
 
+using ioremap::monitor::copy_json;
+using ioremap::monitor::write_member;
+
 // @dnet_io_pools_manager is responsible for storing and providing access to shared io pools
 class dnet_io_pools_manager {
 public:
@@ -31,8 +36,8 @@ public:
 	// check and stop io pool with @pool_id if no backends are attached to it.
 	// should be called whenever backend is decided to be detached from io pool.
 	int detach(const std::string &pool_id);
-	// fill @value with all shared io pools' statistics
-	void statistics(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
+	// write all shared io pools' statistics as members of the currently opened object
+	void statistics(json_writer &writer);
 	// add to @queue_size and @threads_count all shared io pools' queues' sizes and number of threads.
 	void check(uint64_t &queue_size, uint64_t threads_count);
 
@@ -142,15 +147,16 @@ int dnet_io_pools_manager::detach(const std::string &pool_id) {
 	return 0;
 }
 
-void dnet_io_pools_manager::statistics(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+void dnet_io_pools_manager::statistics(json_writer &writer) {
 	boost::shared_lock<boost::shared_mutex> guard(m_pools_mutex);
 	for (auto &item : m_pools) {
 		const auto &pool_id = item.first;
 		const auto &io_pool = item.second;
 
-		rapidjson::Value pool(rapidjson::kObjectType);
-		ioremap::monitor::dump_io_pool_stats(*io_pool, pool, allocator);
-		value.AddMember(pool_id.c_str(), allocator, pool, allocator);
+		writer.String(pool_id.c_str(), pool_id.size());
+		writer.StartObject();
+		ioremap::monitor::dump_io_pool_stats(*io_pool, writer);
+		writer.EndObject();
 	}
 }
 
@@ -564,6 +570,7 @@ dnet_backend::dnet_backend(dnet_node *node, std::shared_ptr<backend_config> conf
 , m_state{DNET_BACKEND_DISABLED}
 , m_last_start_err{0}
 , m_cache{}
+, m_negative_cache{}
 , m_log{new blackhole::wrapper_t{get_logger(node), {{"source", "eblob"}, {"backend_id", m_config->backend_id}}}}
 , m_pool_id{} {
 	dnet_empty_time(&m_last_start);
@@ -599,6 +606,7 @@ int dnet_backend::enable() {
 	auto fail = [this](int err) {
 		detach_from_io_pool();
 		m_cache.reset();
+		m_negative_cache.reset();
 		{
 			dnet_current_time(&m_last_start);
 			m_last_start_err = err;
@@ -673,6 +681,10 @@ int dnet_backend::enable() {
 		}
 	}
 
+	if (m_config->negative_cache_config) {
+		m_negative_cache.reset(new ioremap::cache::negative_cache(*m_config->negative_cache_config));
+	}
+
 	int ids_num = 0;
 	auto ids = dnet_ids_init(m_node, m_config->history, &ids_num, m_config->config_backend.storage_free,
 	                         m_node->addrs, m_config->backend_id);
@@ -717,9 +729,13 @@ int dnet_backend::disable() {
 
 	dnet_route_list_disable_backend(m_node->route, m_config->backend_id);
 
+	if (m_cache)
+		m_cache->shutdown();
+
 	detach_from_io_pool();
 
 	m_cache.reset();
+	m_negative_cache.reset();
 	m_config->config_backend.cleanup(&m_config->config_backend);
 	memset(&m_callbacks, 0, sizeof(m_callbacks));
 
@@ -885,8 +901,7 @@ public:
 	: session_(st->n)
 	, node_(st->n)
 	, state_(dnet_state_get(st))
-	, orig_cmd_(*cmd)
-	, total_(0) {
+	, orig_cmd_(*cmd) {
 		using namespace ioremap::elliptics;
 		session_.set_exceptions_policy(session::no_exceptions);
 		session_.set_filter(filters::all_with_ack);
@@ -897,9 +912,13 @@ public:
 	void start(const ioremap::elliptics::dnet_bulk_remove_request &request) {
 		using namespace ioremap::elliptics;
 
+		std::unique_lock<std::mutex> guard(mutex_);
+		replier_.reset(new dnet_bulk_remove_replier(state_.get(), &orig_cmd_, request.keys.size(),
+		                                            request.status_array));
+
 		auto process_ioflags_error = [&]() {
 			for (const auto &id : request.keys)
-				send_fail_reply(id, -1, -EINVAL); 
+				replier_->reply(id, -1, -EINVAL);
 		};
 
 		if (!(request.ioflags & DNET_IO_FLAGS_CAS_TIMESTAMP)) {
@@ -911,21 +930,17 @@ public:
 			process_ioflags_error();
 			return;
 		}
-		total_ = request.keys.size();
-		for (size_t i = 0; i < total_; ++i) {
+
+		for (size_t i = 0; i < request.keys.size(); ++i) {
 			auto backend_id = dnet_state_search_backend(node_, &request.keys[i]);
 			if (backend_id < 0) {
-				send_fail_reply(request.keys[i], backend_id, -ENXIO);
+				replier_->reply(request.keys[i], backend_id, -ENXIO);
 				continue;
 			}
 			backend_keys_[backend_id].emplace_back(request.keys[i], request.timestamps[i]);
+			++pending_keys_[backend_id][request.keys[i]];
 		}
-
-		num_backend_responses_.reserve(backend_keys_.size());
-		for (const auto &pair : backend_keys_) {
-			auto &backend_id = pair.first;
-			num_backend_responses_.emplace(backend_id, 0);
-		}
+		guard.unlock();
 
 		address addr(node_->addrs[0]);
 		for (const auto &pair : backend_keys_) {
@@ -946,57 +961,45 @@ public:
 
 private:
 	void process(uint32_t backend_id, const ioremap::elliptics::callback_result_entry &entry) {
-
 		const auto entry_cmd = entry.command();
-		if (entry_cmd->status == 0) {
-			dnet_cmd cmd(orig_cmd_);
-			cmd.id = entry_cmd->id;
-			cmd.backend_id = backend_id;		
-			send_reply(cmd);
-		} else {
-			send_fail_reply(entry_cmd->id, backend_id, entry_cmd->status);
-		}
-		++num_backend_responses_[backend_id];
 
 		DNET_LOG_NOTICE(node_, "{}: {}: local: process: status: {}", dnet_dump_id(&entry_cmd->id),
 		                dnet_cmd_string(DNET_CMD_BULK_REMOVE_NEW), entry_cmd->status);
+
+		std::lock_guard<std::mutex> guard(mutex_);
+		/* backend handles keys in its own order, so responded keys are tracked by id */
+		auto &pending = pending_keys_[backend_id];
+		auto it = pending.find(entry_cmd->id);
+		if (it == pending.end())
+			return;
+
+		if (--it->second == 0)
+			pending.erase(it);
+		replier_->reply(entry_cmd->id, backend_id, entry_cmd->status);
 	}
 
 	void complete(uint32_t backend_id, const ioremap::elliptics::error_info &error) {
-		/* Send fail replies for keys which wasn't processed by backend. Keys are read in original order,
-		 * so number of read keys can be used as index of last read key.
-		 */
-		const auto &keys = backend_keys_[backend_id];
-		for (size_t i = num_backend_responses_[backend_id]; i < keys.size(); ++i) {
-			send_fail_reply(keys[i].first, backend_id, error.code());
+		std::lock_guard<std::mutex> guard(mutex_);
+		/* Send fail replies for keys which wasn't processed by backend */
+		for (const auto &pair : pending_keys_[backend_id]) {
+			for (size_t i = 0; i < pair.second; ++i) {
+				replier_->reply(pair.first, backend_id, error.code());
+			}
 		}
+		pending_keys_.erase(backend_id);
+
 		DNET_LOG_NOTICE(node_, "{}: local: complete for backend_id {}: status: {}", backend_id, 
 		                dnet_cmd_string(DNET_CMD_BULK_REMOVE_NEW), error.code());
 	}
 
-	void send_fail_reply(const dnet_id &id, uint32_t backend_id, int err) {
-		dnet_cmd cmd(orig_cmd_);
-		cmd.id = id;
-		cmd.status = err;
-		cmd.backend_id = backend_id;
-	
-		send_reply(cmd);
-	}
-	
-	void send_reply(struct dnet_cmd &cmd) {
-		std::lock_guard<std::mutex> guard(mutex_);	
-		const int more = --total_ ? 1 : 0;
-		dnet_send_reply(state_.get(), &cmd, nullptr, 0, more, /*context*/ nullptr);
-	}
-
 private:
 	ioremap::elliptics::newapi::session session_;
 	struct dnet_node *node_;
 	ioremap::elliptics::net_state_ptr state_;
 	const struct dnet_cmd orig_cmd_;
 	std::unordered_map<uint32_t, std::vector<std::pair<dnet_id, dnet_time>>> backend_keys_; // backend_id -> [list of keys]
-	std::unordered_map<uint32_t, size_t> num_backend_responses_;      // backend_id -> num_responses
-	size_t total_;
+	std::unordered_map<uint32_t, std::map<dnet_id, size_t>> pending_keys_; // backend_id -> {key -> num_replies}
+	std::unique_ptr<dnet_bulk_remove_replier> replier_;
 	std::mutex mutex_;
 };
 
@@ -1026,6 +1029,49 @@ int dnet_cmd_bulk_remove_new(struct dnet_net_state *st, struct dnet_cmd *cmd,
 }
 
 
+dnet_bulk_remove_replier::dnet_bulk_remove_replier(struct dnet_net_state *st, const struct dnet_cmd *cmd,
+                                                   size_t total, bool status_array)
+: m_st{st}
+, m_cmd(*cmd)
+, m_left{total}
+, m_status_array{status_array} {
+}
+
+void dnet_bulk_remove_replier::reply(const struct dnet_id &id, int backend_id, int status) {
+	if (!m_left)
+		return;
+	--m_left;
+
+	if (!m_status_array) {
+		dnet_cmd cmd(m_cmd);
+		cmd.id = id;
+		cmd.backend_id = backend_id;
+		cmd.status = status;
+		dnet_send_reply(m_st, &cmd, nullptr, 0, m_left ? 1 : 0, /*context*/ nullptr);
+		return;
+	}
+
+	m_keys.emplace_back(id);
+	m_statuses.emplace_back(status);
+	m_backend_ids.emplace_back(backend_id);
+	if (m_keys.size() >= frame_keys || !m_left)
+		send_frame();
+}
+
+void dnet_bulk_remove_replier::send_frame() {
+	using namespace ioremap::elliptics;
+
+	dnet_bulk_remove_response response;
+	response.keys.swap(m_keys);
+	response.statuses.swap(m_statuses);
+	response.backend_ids.swap(m_backend_ids);
+	const auto packet = serialize(response);
+
+	dnet_cmd cmd(m_cmd);
+	cmd.status = 0;
+	dnet_send_reply(m_st, &cmd, packet.data(), packet.size(), m_left ? 1 : 0, /*context*/ nullptr);
+}
+
 int dnet_backend::change_state(dnet_backend_state state) {
 	auto set_activating = [this]() {
 		switch (m_state) {
@@ -1142,55 +1188,139 @@ void dnet_backend::fill_status(dnet_backend_status &status) {
 		status.inspect_state = m_callbacks.inspect_status(m_callbacks.command_private);
 }
 
-void dnet_backend::fill_status(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+void dnet_backend::fill_status(json_writer &writer) {
 	boost::shared_lock<boost::shared_mutex> guard(m_state_mutex);
 
-	value.AddMember("backend_id", m_config->backend_id, allocator);
-	rapidjson::Value status(rapidjson::kObjectType);
+	write_member(writer, "backend_id", m_config->backend_id);
+	writer.String("status");
+	writer.StartObject();
 	{
-		status.AddMember("backend_id",  m_config->backend_id, allocator);
-		status.AddMember("state",  (int)m_state, allocator);
-		status.AddMember("string_state",  dnet_backend_state_string(m_state), allocator);
-		status.AddMember("read_only",  m_read_only, allocator);
-		status.AddMember("delay",  m_delay, allocator);
-		status.AddMember("group",  m_config->group_id, allocator);
-		status.AddMember("pool_id", m_pool_id.c_str(), allocator);
-		const auto defrag_state = (m_state == DNET_BACKEND_ENABLED && m_callbacks.defrag_status)
-		                          ? m_callbacks.defrag_status(m_callbacks.command_private)
-		                          : DNET_BACKEND_DEFRAG_NOT_STARTED;
-		status.AddMember("defrag_state", defrag_state, allocator);
-		status.AddMember("string_defrag_state", dnet_backend_defrag_state_string(defrag_state), allocator);
-		rapidjson::Value last_start(rapidjson::kObjectType);
+		write_member(writer, "backend_id",  m_config->backend_id);
+		write_member(writer, "state",  (int)m_state);
+		write_member(writer, "string_state",  dnet_backend_state_string(m_state));
+		write_member(writer, "read_only",  m_read_only);
+		write_member(writer, "delay",  m_delay);
+		write_member(writer, "group",  m_config->group_id);
+		write_member(writer, "pool_id", m_pool_id);
+		const int defrag_state = (m_state == DNET_BACKEND_ENABLED && m_callbacks.defrag_status)
+		                         ? m_callbacks.defrag_status(m_callbacks.command_private)
+		                         : DNET_BACKEND_DEFRAG_NOT_STARTED;
+		write_member(writer, "defrag_state", defrag_state);
+		write_member(writer, "string_defrag_state", dnet_backend_defrag_state_string(defrag_state));
+		writer.String("last_start");
+		writer.StartObject();
 		{
-			last_start.AddMember("tv_sec", m_last_start.tsec, allocator);
-			last_start.AddMember("tv_usec", m_last_start.tnsec / 1000, allocator);
+			write_member(writer, "tv_sec", m_last_start.tsec);
+			write_member(writer, "tv_usec", m_last_start.tnsec / 1000);
 		}
-		status.AddMember("last_start", last_start, allocator);
-		status.AddMember("string_last_time", dnet_print_time(&m_last_start), allocator);
-		status.AddMember("last_start_err", m_last_start_err, allocator);
+		writer.EndObject();
+		write_member(writer, "string_last_time", dnet_print_time(&m_last_start));
+		write_member(writer, "last_start_err", m_last_start_err);
 
 		// TODO(shaitan): make a request inspect status from the backend
-		const auto inspect_state = (m_state == DNET_BACKEND_ENABLED && m_callbacks.inspect_status)
-		                           ? m_callbacks.inspect_status(m_callbacks.command_private)
-		                           : DNET_BACKEND_INSPECT_NOT_STARTED;
-		status.AddMember("inspect_state", inspect_state, allocator);
-		status.AddMember("string_inspect_state", dnet_backend_inspect_state_string(inspect_state), allocator);
+		const int inspect_state = (m_state == DNET_BACKEND_ENABLED && m_callbacks.inspect_status)
+		                          ? m_callbacks.inspect_status(m_callbacks.command_private)
+		                          : DNET_BACKEND_INSPECT_NOT_STARTED;
+		write_member(writer, "inspect_state", inspect_state);
+		write_member(writer, "string_inspect_state", dnet_backend_inspect_state_string(inspect_state));
 	}
-	value.AddMember("status", status, allocator);
+	writer.EndObject();
 }
 
-void dnet_backend::fill_backend_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Document backend(&allocator);
+namespace {
+
+/*
+ * Handler of json events which copies backend's statistics or config to the writer and appends
+ * the backend's group and queue_timeout to its config: the root object itself if @config_depth is 1
+ * or root's "config" member if it is 2. The root object is left opened, so the caller can append
+ * its own members to it before closing.
+ */
+class backend_json_writer {
+public:
+	backend_json_writer(json_writer &writer, const backend_config &config, int config_depth)
+	: m_writer(writer)
+	, m_config(config)
+	, m_config_depth(config_depth)
+	, m_depth(0)
+	, m_key_expected(false)
+	, m_in_config(false) {}
+
+	void Null() { value(); m_writer.Null(); }
+	void Bool(bool b) { value(); m_writer.Bool(b); }
+	void Int(int i) { value(); m_writer.Int(i); }
+	void Uint(unsigned u) { value(); m_writer.Uint(u); }
+	void Int64(int64_t i64) { value(); m_writer.Int64(i64); }
+	void Uint64(uint64_t u64) { value(); m_writer.Uint64(u64); }
+	void Double(double d) { value(); m_writer.Double(d); }
+
+	void String(const char *str, rapidjson::SizeType length, bool copy) {
+		if (m_depth == 1 && m_key_expected) {
+			m_key_expected = false;
+			m_in_config = (length == 6 && memcmp(str, "config", 6) == 0);
+		} else {
+			value();
+		}
+		m_writer.String(str, length, copy);
+	}
+
+	void StartObject() {
+		if (++m_depth == 1)
+			m_key_expected = true;
+		m_writer.StartObject();
+	}
+
+	void EndObject(rapidjson::SizeType) {
+		if (m_depth == m_config_depth && (m_depth == 1 || m_in_config)) {
+			write_member(m_writer, "group", m_config.group_id);
+			write_member(m_writer, "queue_timeout", m_config.queue_timeout);
+		}
+		if (--m_depth == 0)
+			return;
+		end();
+		m_writer.EndObject();
+	}
+
+	void StartArray() {
+		++m_depth;
+		m_writer.StartArray();
+	}
+
+	void EndArray(rapidjson::SizeType) {
+		--m_depth;
+		end();
+		m_writer.EndArray();
+	}
+
+private:
+	void value() {
+		if (m_depth == 1)
+			m_key_expected = true;
+	}
+
+	void end() {
+		if (m_depth == 1)
+			m_key_expected = true;
+	}
+
+	json_writer		&m_writer;
+	const backend_config	&m_config;
+	const int		m_config_depth;
+	int			m_depth;
+	bool			m_key_expected;
+	bool			m_in_config;
+};
+
+} /* namespace */
+
+void dnet_backend::fill_backend_stats(json_writer &writer) {
+	writer.String("backend");
 	if (m_state == DNET_BACKEND_ENABLED) {
 		char *json_stat = nullptr;
 		size_t json_size = 0;
 		m_callbacks.storage_stat_json(m_callbacks.command_private, &json_stat, &json_size);
-		if (json_stat && json_size) {
-			backend.Parse<0>(json_stat);
-			auto &config_value = backend["config"];
-			config_value.AddMember("group", m_config->group_id, allocator);
-			config_value.AddMember("queue_timeout", m_config->queue_timeout, allocator);
-		}
+		backend_json_writer backend(writer, *m_config, 2);
+		if (!json_stat || !copy_json(json_stat, strnlen(json_stat, json_size), backend))
+			writer.StartObject();
 		free(json_stat);
 	} else {
 		if (m_state == DNET_BACKEND_DISABLED) {
@@ -1202,70 +1332,111 @@ void dnet_backend::fill_backend_stats(rapidjson::Value &value, rapidjson::Docume
 				m_config = std::move(config);
 		}
 
+		writer.StartObject();
 		char *json_stat = nullptr;
 		size_t json_size = 0;
 		m_config->config_backend.to_json(&m_config->config_backend, &json_stat, &json_size);
 		if (json_stat && json_size) {
-			rapidjson::Document config_value(&allocator);
-			config_value.Parse<0>(json_stat);
-			config_value.AddMember("group", m_config->group_id, allocator);
-			config_value.AddMember("queue_timeout", m_config->queue_timeout, allocator);
-			backend.SetObject();
-			backend.AddMember("config", static_cast<rapidjson::Value &>(config_value), allocator);
+			writer.String("config");
+			backend_json_writer config(writer, *m_config, 1);
+			if (copy_json(json_stat, strnlen(json_stat, json_size), config))
+				writer.EndObject();
+			else
+				writer.Null();
 		}
 		free(json_stat);
 	}
 
-	if (!backend.IsObject())
-		backend.SetObject();
+	const auto &initial_config = m_config->raw_config;
+	writer.String("initial_config");
+	if (!copy_json(initial_config.c_str(), initial_config.size(), writer))
+		writer.Null();
+	writer.EndObject();
+}
 
-	rapidjson::Document initial_config(&allocator);
-	initial_config.Parse<0>(m_config->raw_config.c_str());
-	backend.AddMember("initial_config", static_cast<rapidjson::Value &>(initial_config), allocator);
+void dnet_backend::fill_io_stats(json_writer &writer) {
+	if (m_state != DNET_BACKEND_ENABLED)
+		return;
 
-	value.AddMember("backend", static_cast<rapidjson::Value &>(backend), allocator);
+	writer.String("io");
+	writer.StartObject();
+	ioremap::monitor::dump_io_pool_stats(*m_pool, writer);
+	writer.EndObject();
 }
 
-void dnet_backend::fill_io_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
-	if (m_state != DNET_BACKEND_ENABLED)
+void dnet_backend::fill_negative_cache_stats(json_writer &writer) {
+	if (m_state != DNET_BACKEND_ENABLED || !m_negative_cache)
 		return;
 
-	rapidjson::Value io(rapidjson::kObjectType);
-	ioremap::monitor::dump_io_pool_stats(*m_pool, io, allocator);
-	value.AddMember("io", io, allocator);
+	writer.String("negative_cache");
+	m_negative_cache->statistics(writer);
 }
 
-void dnet_backend::fill_cache_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+void dnet_backend::fill_cache_stats(json_writer &writer) {
 	if (m_state != DNET_BACKEND_ENABLED || !m_cache)
 		return;
 
-	rapidjson::Value cache;
-	m_cache->statistics(cache, allocator);
-	value.AddMember("cache", cache, allocator);
+	writer.String("cache");
+	m_cache->statistics(writer);
+}
+
+void dnet_backend::fill_commands_stats(json_writer &writer) {
+	if (m_state != DNET_BACKEND_ENABLED)
+		return;
+
+	writer.String("commands");
+	writer.StartObject();
+	m_command_stats.commands_report(nullptr, writer);
+	writer.EndObject();
 }
 
-void dnet_backend::fill_commands_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
+void dnet_backend::fill_latency_stats(json_writer &writer) {
 	if (m_state != DNET_BACKEND_ENABLED)
 		return;
 
-	rapidjson::Value commands_value(rapidjson::kObjectType);
-	m_command_stats.commands_report(nullptr, commands_value, allocator);
-	value.AddMember("commands", commands_value, allocator);
+	writer.String("latency");
+	writer.StartObject();
+	m_command_stats.latency_report(writer);
+	writer.EndObject();
 }
 
-void dnet_backend::statistics(uint64_t categories,
-                              rapidjson::Value &value,
-                              rapidjson::Document::AllocatorType &allocator) {
+void dnet_backend::statistics(uint64_t categories, json_writer &writer) {
 	boost::shared_lock<boost::shared_mutex> guard(m_state_mutex);
-	fill_status(value, allocator);
-	if (categories & DNET_MONITOR_BACKEND)
-		fill_backend_stats(value, allocator);
+	writer.StartObject();
+	fill_status(writer);
+	if (categories & DNET_MONITOR_BACKEND) {
+		fill_backend_stats(writer);
+		fill_negative_cache_stats(writer);
+	}
 	if (categories & DNET_MONITOR_IO)
-		fill_io_stats(value, allocator);
+		fill_io_stats(writer);
 	if (categories & DNET_MONITOR_CACHE)
-		fill_cache_stats(value, allocator);
+		fill_cache_stats(writer);
 	if (categories & DNET_MONITOR_COMMANDS)
-		fill_commands_stats(value, allocator);
+		fill_commands_stats(writer);
+	if (categories & DNET_MONITOR_LATENCY)
+		fill_latency_stats(writer);
+	writer.EndObject();
+}
+
+void dnet_backend::metrics(uint64_t categories, ioremap::monitor::metrics_writer &writer) {
+	using namespace ioremap::monitor;
+
+	boost::shared_lock<boost::shared_mutex> guard(m_state_mutex);
+
+	const metric_labels labels = {{"backend_id", std::to_string(m_config->backend_id)}};
+	writer.gauge("elliptics_backend_state", "State of the backend", labels, m_state);
+	if (categories & DNET_MONITOR_BACKEND) {
+		writer.gauge("elliptics_backend_read_only", "Whether the backend is in read-only mode", labels,
+		             m_read_only);
+	}
+
+	if (m_state != DNET_BACKEND_ENABLED)
+		return;
+
+	if (categories & DNET_MONITOR_IO)
+		write_io_pool_metrics(*m_pool, labels, writer);
+	m_command_stats.metrics(categories, labels, writer);
 }
 
 dnet_backends_manager::dnet_backends_manager(struct dnet_node *node)
@@ -1420,38 +1591,51 @@ struct dnet_backend_status_list *dnet_backends_manager::get_status() {
 	return list;
 }
 
-void dnet_backends_manager::statistics(const ioremap::monitor::request &request,
-                                       rapidjson::Value &value,
-                                       rapidjson::Document::AllocatorType &allocator) {
-	value.SetObject();
+void dnet_backends_manager::statistics(const ioremap::monitor::request &request, json_writer &writer) {
+	writer.StartObject();
 
 	boost::shared_lock<boost::shared_mutex> guard(m_backends_mutex);
 	if (request.backends_ids.empty()) {
 		for (auto &item: m_backends) {
 			const auto &backend_id = std::to_string(item.first);
-			auto &backend = item.second;
-			rapidjson::Value backend_value(rapidjson::kObjectType);
-			backend->statistics(request.categories, backend_value, allocator);
-			value.AddMember(backend_id.c_str(), allocator, backend_value, allocator);
+			writer.String(backend_id.c_str(), backend_id.size());
+			item.second->statistics(request.categories, writer);
 		}
 	} else {
 		for (auto backend_id: request.backends_ids){
+			const auto &str_backend_id = std::to_string(backend_id);
+			writer.String(str_backend_id.c_str(), str_backend_id.size());
 			auto item = m_backends.find(backend_id);
-			rapidjson::Value backend_value;
 			if (item != m_backends.end()) {
-				auto &backend = item->second;
-				backend->statistics(request.categories, backend_value.SetObject(), allocator);
+				item->second->statistics(request.categories, writer);
+			} else {
+				writer.Null();
 			}
-			const auto &str_backend_id = std::to_string(backend_id);
-			value.AddMember(str_backend_id.c_str(), allocator, backend_value, allocator);
 		}
 	}
+	guard.unlock();
+
+	writer.EndObject();
 }
 
-void dnet_io_pools_fill_stats(struct dnet_node *node,
-                              rapidjson::Value &value,
-                              rapidjson::Document::AllocatorType &allocator) {
-	node->io->pools_manager->statistics(value, allocator);
+void dnet_backends_manager::metrics(const ioremap::monitor::request &request,
+                                    ioremap::monitor::metrics_writer &writer) {
+	boost::shared_lock<boost::shared_mutex> guard(m_backends_mutex);
+	if (request.backends_ids.empty()) {
+		for (auto &item: m_backends) {
+			item.second->metrics(request.categories, writer);
+		}
+	} else {
+		for (auto backend_id: request.backends_ids) {
+			auto item = m_backends.find(backend_id);
+			if (item != m_backends.end())
+				item->second->metrics(request.categories, writer);
+		}
+	}
+}
+
+void dnet_io_pools_fill_stats(struct dnet_node *node, json_writer &writer) {
+	node->io->pools_manager->statistics(writer);
 }
 
 void dnet_io_pools_check(struct dnet_io_pools_manager *pools_manager, uint64_t *queue_size, uint64_t *threads_count) {
@@ -1531,6 +1715,38 @@ int dnet_backend_process_cmd_raw(struct dnet_backend *backend,
                                  void *data,
                                  struct dnet_cmd_stats *cmd_stats,
                                  struct dnet_access_context *context) {
+	dnet_thread_state_guard state_guard(DNET_THREAD_STATE_BACKEND);
+
 	auto &callbacks = backend->callbacks();
+	auto negative_cache = backend->negative_cache();
+	if (!negative_cache)
+		return callbacks.command_handler(st, callbacks.command_private, cmd, data, cmd_stats, context);
+
+	switch (cmd->cmd) {
+	case DNET_CMD_WRITE:
+	case DNET_CMD_WRITE_NEW:
+		negative_cache->invalidate(cmd->id.id);
+		break;
+	case DNET_CMD_READ:
+	case DNET_CMD_READ_NEW:
+	case DNET_CMD_LOOKUP:
+	case DNET_CMD_LOOKUP_NEW: {
+		if (negative_cache->check(cmd->id.id)) {
+			DNET_LOG_DEBUG(st->n, "{}: {}: key is missing according to negative cache",
+			               dnet_dump_id(&cmd->id), dnet_cmd_string(cmd->cmd));
+			return -ENOENT;
+		}
+
+		const auto generation = negative_cache->generation(cmd->id.id);
+		const int err = callbacks.command_handler(st, callbacks.command_private, cmd, data, cmd_stats,
+		                                          context);
+		if (err == -ENOENT)
+			negative_cache->insert(cmd->id.id, generation);
+		return err;
+	}
+	default:
+		break;
+	}
+
 	return callbacks.command_handler(st, callbacks.command_private, cmd, data, cmd_stats, context);
 }
@@ -8,11 +8,11 @@
 #include <string>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
 
-#include <rapidjson/document.h>
-
+#include "monitor/json_writer.hpp"
 #include "monitor/statistics.hpp"
 
 namespace ioremap { namespace monitor {
@@ -21,6 +21,7 @@ struct request;
 
 namespace ioremap { namespace cache {
 class cache_manager;
+class negative_cache;
 }} /* namespace ioremap::cache */
 
 namespace ioremap { namespace elliptics { namespace config {
@@ -28,6 +29,7 @@ struct backend_config;
 }}} /* namespace ioremap::elliptics::config */
 
 using backend_config = ioremap::elliptics::config::backend_config;
+using json_writer = ioremap::monitor::json_writer;
 
 // TODO(shaitan): wrap dnet_backend_callbacks and backend_config::dnet_config_backend by RAII structure
 // with API for working with underlying backend
@@ -55,6 +57,8 @@ public:
 	const dnet_backend_callbacks &callbacks() const { return m_callbacks; }
 	// return cache which can be nullptr if cache is disabled
 	ioremap::cache::cache_manager *cache() { return m_cache.get(); }
+	// return cache of missing keys which can be nullptr if it is disabled
+	ioremap::cache::negative_cache *negative_cache() { return m_negative_cache.get(); }
 	// return whether read-only mode is enabled
 	bool read_only() const { return m_read_only; }
 	// enable/disable read-only mode
@@ -93,8 +97,10 @@ public:
 	// status and statistics methods
 	// fill backend's status
 	void fill_status(dnet_backend_status &status);
-	// fill backend's statistics for monitor
-	void statistics(uint64_t categories, rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
+	// write backend's statistics for monitor
+	void statistics(uint64_t categories, json_writer &writer);
+	// write backend's statistics for monitor in Prometheus text format
+	void metrics(uint64_t categories, ioremap::monitor::metrics_writer &writer);
 
 private:
 	dnet_node						*m_node;
@@ -118,6 +124,8 @@ private:
 	ioremap::monitor::command_stats				m_command_stats;
 	// cache. It will be nullptr if cache is disabled
 	std::unique_ptr<ioremap::cache::cache_manager>		m_cache;
+	// cache of missing keys. It will be nullptr if negative cache is disabled
+	std::unique_ptr<ioremap::cache::negative_cache>		m_negative_cache;
 	// logger with attached backend's attributes
 	std::unique_ptr<dnet_logger>				m_log;
 	// id of io pool serves the backend. It can be individual or shared.
@@ -133,16 +141,22 @@ private:
 
 	// statistics methods
 
-	// fill @value with backend's status
-	void fill_status(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
-	// fill @value with backend's statistics
-	void fill_backend_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
-	// fill @value with statistics of backend's io pool
-	void fill_io_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
-	// fill @value with statistics of backend's cache
-	void fill_cache_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
-	// fill @value with statistics of handled by the backend commands
-	void fill_commands_stats(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator);
+	// all fill_* methods write members to the currently opened object of @writer
+
+	// write backend's status
+	void fill_status(json_writer &writer);
+	// write backend's statistics
+	void fill_backend_stats(json_writer &writer);
+	// write statistics of backend's io pool
+	void fill_io_stats(json_writer &writer);
+	// write statistics of backend's negative cache
+	void fill_negative_cache_stats(json_writer &writer);
+	// write statistics of backend's cache
+	void fill_cache_stats(json_writer &writer);
+	// write statistics of handled by the backend commands
+	void fill_commands_stats(json_writer &writer);
+	// write latency histograms of commands handled by the backend
+	void fill_latency_stats(json_writer &writer);
 };
 
 struct dnet_backends_manager {
@@ -168,9 +182,10 @@ public:
 	void set_verbosity(const dnet_log_level level);
 	// return status of all backends
 	struct dnet_backend_status_list *get_status();
-	// return statistics of backends in accordance with the request
-	void statistics(const ioremap::monitor::request &request, rapidjson::Value &value,
-	                rapidjson::Document::AllocatorType &allocator);
+	// write statistics of backends in accordance with the request
+	void statistics(const ioremap::monitor::request &request, json_writer &writer);
+	// write statistics of backends in accordance with the request in Prometheus text format
+	void metrics(const ioremap::monitor::request &request, ioremap::monitor::metrics_writer &writer);
 
 private:
 	dnet_node							*m_node;
@@ -180,10 +195,34 @@ private:
 	boost::shared_mutex						m_backends_mutex;
 };
 
-// fill @value with all io pools statistics
-void dnet_io_pools_fill_stats(struct dnet_node *node,
-                              rapidjson::Value &value,
-                              rapidjson::Document::AllocatorType &allocator);
+// write all io pools statistics as members of the currently opened object
+void dnet_io_pools_fill_stats(struct dnet_node *node, json_writer &writer);
+
+/*
+ * Replies statuses of keys removed by BULK_REMOVE_NEW. If client accepts status arrays, statuses are packed
+ * into dnet_bulk_remove_response frames of up to frame_keys keys, otherwise every key gets its own reply.
+ * The reply for the last of @total keys is sent without DNET_FLAGS_MORE. It is not thread-safe.
+ */
+class dnet_bulk_remove_replier {
+public:
+	dnet_bulk_remove_replier(struct dnet_net_state *st, const struct dnet_cmd *cmd, size_t total,
+	                         bool status_array);
+
+	void reply(const struct dnet_id &id, int backend_id, int status);
+
+private:
+	void send_frame();
+
+	static const size_t frame_keys = 4096;
+
+	struct dnet_net_state	*m_st;
+	const struct dnet_cmd	m_cmd;
+	size_t			m_left;
+	const bool		m_status_array;
+	std::vector<dnet_id>	m_keys;
+	std::vector<int>	m_statuses;
+	std::vector<int>	m_backend_ids;
+};
 
 extern "C" {
 
@@ -211,10 +250,8 @@ uint64_t __attribute__((weak)) dnet_backend_get_queue_timeout(struct dnet_node *
 // update statistics for commands handled by the @backend
 void dnet_backend_command_stats_update(struct dnet_backend *backend,
                                        struct dnet_cmd *cmd,
-                                       uint64_t size,
-                                       int handled_in_cache,
-                                       int err,
-                                       long diff);
+                                       const struct dnet_cmd_stats *cmd_stats,
+                                       int err);
 // handle command by @backend
 int dnet_backend_process_cmd_raw(struct dnet_backend *backend,
                                  struct dnet_net_state *st,
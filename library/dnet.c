@@ -266,15 +266,26 @@ int dnet_send_reply(void *state,
 	return err;
 }
 
+static int dnet_queue_above_threshold(struct dnet_net_state *st)
+{
+	return atomic_read(&st->send_queue_size) > DNET_SEND_WATERMARK_HIGH ||
+		atomic_read(&st->send_queue_bytes) > DNET_SEND_BYTES_WATERMARK_HIGH;
+}
+
 static void dnet_queue_wait_threshold(struct dnet_net_state *st)
 {
+	int previous_state;
+
 	/* If send succeeded then we should increase queue size */
-	while ((atomic_read(&st->send_queue_size) > DNET_SEND_WATERMARK_HIGH) && !st->__need_exit) {
+	while (dnet_queue_above_threshold(st) && !st->__need_exit) {
 		/* If high watermark is reached we should sleep */
 		dnet_log(st->n, DNET_LOG_NOTICE,
-				"State high_watermark reached by iterator: %s: %ld, sleeping",
+				"State high_watermark reached by iterator: %s: %ld, bytes: %ld, sleeping",
 				dnet_addr_string(&st->addr),
-				atomic_read(&st->send_queue_size));
+				atomic_read(&st->send_queue_size),
+				atomic_read(&st->send_queue_bytes));
+
+		previous_state = dnet_thread_state_switch(DNET_THREAD_STATE_SEND);
 
 		pthread_mutex_lock(&st->send_lock);
 		// after successful dnet_send_reply the state can be removed from another thread
@@ -283,9 +294,13 @@ static void dnet_queue_wait_threshold(struct dnet_net_state *st)
 			pthread_cond_wait(&st->send_wait, &st->send_lock);
 		pthread_mutex_unlock(&st->send_lock);
 
-		dnet_log(st->n, DNET_LOG_NOTICE, "State woken up, iterator will continue: %s: %ld",
+		if (previous_state >= 0)
+			dnet_thread_state_switch(previous_state);
+
+		dnet_log(st->n, DNET_LOG_NOTICE, "State woken up, iterator will continue: %s: %ld, bytes: %ld",
 				dnet_addr_string(&st->addr),
-				atomic_read(&st->send_queue_size));
+				atomic_read(&st->send_queue_size),
+				atomic_read(&st->send_queue_bytes));
 	}
 }
 
@@ -328,6 +343,30 @@ int dnet_send_fd_threshold(struct dnet_net_state *st, void *header, uint64_t hsi
 	return err;
 }
 
+int dnet_send_replies_threshold(struct dnet_net_state *st, void *data, uint64_t size, long replies) {
+	int err;
+	if (st == st->n->st)
+		return 0;
+
+	/*
+	 * Batch is accounted before it is queued: net thread may send and unaccount it
+	 * before dnet_send_replies() returns. Unlike sendfile replies the batch holds
+	 * its records in memory, so it is also bounded by its size.
+	 */
+	atomic_add(&st->send_queue_size, replies);
+	atomic_add(&st->send_queue_bytes, size);
+
+	err = dnet_send_replies(st, data, size, replies);
+	if (err == 0) {
+		dnet_queue_wait_threshold(st);
+	} else {
+		atomic_sub(&st->send_queue_size, replies);
+		atomic_sub(&st->send_queue_bytes, size);
+	}
+
+	return err;
+}
+
 /*!
  * Internal callback that writes result to \a fd opened in append mode
  */
@@ -1312,7 +1351,8 @@ static int dnet_cmd_bulk_read(struct dnet_backend *backend,
 			dnet_oplock(pool, &lock_id);
 		}
 
-		ret = dnet_process_cmd_raw(st, &read_cmd, &ios[i], 1, cmd_stats->queue_time, /*context*/ NULL);
+		ret = dnet_process_cmd_raw(st, &read_cmd, &ios[i], 1, cmd_stats->queue_time, cmd_stats->recv_time,
+		                           /*context*/ NULL);
 		dnet_log(st->n, DNET_LOG_NOTICE, "%s: processing BULK_READ.READ for %d/%d command, err: %d",
 			dnet_dump_id(&cmd->id), (int) i, (int) count, ret);
 
@@ -1659,8 +1699,7 @@ static int dnet_process_cmd_with_backend_raw(struct dnet_net_state *st,
 			cmd_stats->size = 0;
 	}
 
-	dnet_backend_command_stats_update(backend, cmd, cmd_stats->size, cmd_stats->handled_in_cache, err,
-	                                  cmd_stats->handle_time);
+	dnet_backend_command_stats_update(backend, cmd, cmd_stats, err);
 
 	dnet_backend_unlock_state(backend);
 	return err;
@@ -1671,22 +1710,26 @@ int dnet_process_cmd_raw(struct dnet_net_state *st,
                          void *data,
                          int recursive,
                          const long queue_time,
+                         const long recv_time,
                          struct dnet_access_context *context) {
 	int err = 0;
 	struct dnet_node *n = st->n;
 	const unsigned long long tid = cmd->trans;
 	struct dnet_io_attr *io = NULL;
 	struct timespec start, end;
+	uint64_t lock_wait_start;
 
 	struct dnet_cmd_stats cmd_stats;
 
 	memset(&cmd_stats, 0, sizeof(cmd_stats));
 	cmd_stats.queue_time = queue_time;
+	cmd_stats.recv_time = recv_time;
 
 	HANDY_TIMER_SCOPE(recursive ? "io.cmd_recursive" : "io.cmd");
 	HANDY_TIMER_SCOPE(("io.cmd%s.%s", (recursive ? "_recursive" : ""), dnet_cmd_string(cmd->cmd)));
 
 	clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+	lock_wait_start = dnet_oplock_wait_time();
 
 	err = dnet_process_cmd_without_backend_raw(st, cmd, data, &cmd_stats, context);
 	if (err == -ENOTSUP)
@@ -1694,6 +1737,7 @@ int dnet_process_cmd_raw(struct dnet_net_state *st,
 
 	clock_gettime(CLOCK_MONOTONIC_RAW, &end);
 	cmd_stats.handle_time = DIFF_TIMESPEC(start, end);
+	cmd_stats.lock_time = dnet_oplock_wait_time() - lock_wait_start;
 
 	switch (cmd->cmd) {
 		case DNET_CMD_READ:
@@ -1739,10 +1783,10 @@ int dnet_process_cmd_raw(struct dnet_net_state *st,
 				tid, dnet_flags_dump_cflags(cmd->flags), cmd_stats.handle_time, queue_time, err);
 	}
 
-	dnet_access_context_add_int(context, "status", err);
+	dnet_access_context_set_status(context, err);
 
 	// we must provide real error from the backend into statistics
-	dnet_monitor_stats_update(n, cmd, err, cmd_stats.handled_in_cache, cmd_stats.size, cmd_stats.handle_time);
+	dnet_monitor_stats_update(n, cmd, err, &cmd_stats);
 
 	HANDY_COUNTER_INCREMENT(
 	("io.cmd%s.%d.%s.%d", (recursive ? "_recursive" : ""), cmd->backend_id, dnet_cmd_string(cmd->cmd), err), 1);
@@ -79,6 +79,12 @@ struct dnet_io_req {
 	uint64_t		queue_time;
 	uint64_t		recv_time;
 
+	/*
+	 * number of replies packed into the request, it is accounted in st->send_queue_size, 0 means 1,
+	 * header of a request with packed replies is also accounted in st->send_queue_bytes
+	 */
+	long			replies;
+
 	struct dnet_access_context *context;
 };
 
@@ -104,6 +110,10 @@ struct dnet_io_req {
 #define DNET_SEND_WATERMARK_HIGH	(1024 * 100)
 #define DNET_SEND_WATERMARK_LOW		(512 * 100)
 
+/* Iterator watermarks for bytes of batched replies buffered in send queue */
+#define DNET_SEND_BYTES_WATERMARK_HIGH	(64 * 1024 * 1024)
+#define DNET_SEND_BYTES_WATERMARK_LOW	(32 * 1024 * 1024)
+
 /* Internal flag to ignore cache */
 #define DNET_IO_FLAGS_NOCACHE		(1<<28)
 
@@ -168,6 +178,8 @@ struct dnet_net_state
 	pthread_cond_t		send_wait;
 	/* Number of queued requests in send queue from iterator */
 	atomic_t		send_queue_size;
+	/* Number of bytes of batched replies buffered in send queue from iterator */
+	atomic_t		send_queue_bytes;
 
 	pthread_mutex_t		trans_lock;
 	struct rb_root		trans_root;
@@ -331,10 +343,71 @@ struct dnet_transform
 int dnet_crypto_init(struct dnet_node *n);
 void dnet_crypto_cleanup(struct dnet_node *n);
 
+/*
+ * States of io and net threads. Every thread accounts time spent in each state,
+ * so utilization of pools is known without sampling or profiling.
+ */
+enum dnet_thread_state {
+	DNET_THREAD_STATE_RUNNING = 0,	/* processing outside of the states below */
+	DNET_THREAD_STATE_WAIT_QUEUE,	/* waiting for a request in io queue or for network events */
+	DNET_THREAD_STATE_WAIT_LOCK,	/* waiting for a key locked by another request */
+	DNET_THREAD_STATE_BACKEND,	/* handling a command by backend */
+	DNET_THREAD_STATE_SEND,		/* sending data or waiting for send queue of a peer to drain */
+	DNET_THREAD_STATE_BLOCKED,	/* net thread is suspended because io queues are full */
+	__DNET_THREAD_STATE_MAX
+};
+
+const char *dnet_thread_state_str(int state);
+
+/*
+ * Time spent by a thread in every state. It is written only by the thread itself and
+ * is read by monitor without any synchronization.
+ */
+struct dnet_thread_stats {
+	int		state;
+	/* nsecs of monotonic clock when the thread has entered current state */
+	uint64_t	state_start;
+	/* nsecs spent in every state, time spent in current state is not included */
+	uint64_t	time[__DNET_THREAD_STATE_MAX];
+};
+
+/* Returns current time used by thread stats in nsecs */
+uint64_t dnet_thread_stats_now(void);
+/* Starts accounting of calling thread's time in @stats, the thread enters @state */
+void dnet_thread_stats_attach(struct dnet_thread_stats *stats, int state);
+/* Stops accounting of calling thread's time */
+void dnet_thread_stats_detach(void);
+/*
+ * Switches calling thread to @state and returns its previous state.
+ * Returns -1 and does nothing if the thread doesn't account its time.
+ */
+int dnet_thread_state_switch(int state);
+/* Adds time spent by thread with @stats in every state up to @now to @time */
+void dnet_thread_stats_sum(const struct dnet_thread_stats *stats, uint64_t now, uint64_t *time);
+
+/*
+ * Utilization of a group of threads reported by monitor. It is recalculated from time accounted
+ * since the previous recalculation, so it describes recent load rather than the whole lifetime.
+ */
+struct dnet_thread_utilization {
+	/* nsecs summed over threads at the last recalculation */
+	uint64_t	time[__DNET_THREAD_STATE_MAX];
+	uint64_t	timestamp;
+	/* fraction of threads' time spent in every state */
+	double		ratio[__DNET_THREAD_STATE_MAX];
+};
+
+/*
+ * Recalculates @utilization from @time summed over threads at @now.
+ * It is kept for a second after recalculation, so frequent requests don't shrink the observed interval.
+ */
+void dnet_thread_utilization_update(struct dnet_thread_utilization *utilization, const uint64_t *time, uint64_t now);
+
 struct dnet_net_io {
 	int			epoll_fd;
 	pthread_t		tid;
 	struct dnet_node	*n;
+	struct dnet_thread_stats	stats;
 };
 
 enum dnet_work_io_mode {
@@ -352,6 +425,7 @@ struct dnet_work_io {
 	pthread_t		tid;
 	int			joined;
 	struct dnet_work_pool	*pool;
+	struct dnet_thread_stats	stats;
 };
 
 struct list_stat {
@@ -382,6 +456,9 @@ struct dnet_work_pool {
 	struct dnet_work_io		*wio_list;
 
 	struct dnet_request_queue	*request_queue;
+
+	/* utilization reported by monitor, it is protected by lock of the pool's place */
+	struct dnet_thread_utilization	utilization;
 };
 
 struct dnet_work_pool_place
@@ -430,6 +507,13 @@ struct dnet_io {
 	int			blocked;
 
 	struct list_stat	output_stats;
+
+	/*
+	 * utilization of net threads reported by monitor, it has its own lock
+	 * since @full_lock is taken by net threads on every received request
+	 */
+	pthread_mutex_t			net_utilization_lock;
+	struct dnet_thread_utilization	net_utilization;
 };
 
 int dnet_state_accept_process(struct dnet_net_state *st, struct epoll_event *ev);
@@ -451,6 +535,13 @@ struct dnet_config_data {
 
 void dnet_config_data_destroy(struct dnet_config_data *config_data);
 
+/* Number of shards of node command counters */
+#define DNET_COUNTER_SHARDS	16
+
+struct dnet_counter_shard {
+	struct dnet_stat_count	counters[__DNET_CMD_MAX * 2];
+} __attribute__ ((aligned (64)));
+
 struct dnet_route_list;
 struct dnet_node {
 	struct dnet_transform	transform;
@@ -489,6 +580,8 @@ struct dnet_node {
 
 	dnet_logger		*log;
 	dnet_logger		*access_log;
+	/* prints access logs of released requests in background */
+	struct dnet_access_writer	*access_writer;
 
 	struct timespec		wait_ts;
 
@@ -527,8 +620,11 @@ struct dnet_node {
 	struct dnet_addr	*route_addr;
 	size_t			route_addr_num;
 
-	struct dnet_lock	counters_lock;
-	struct dnet_stat_count	counters[__DNET_CMD_MAX * 2];
+	/*
+	 * Per-command storage/proxy counters, every thread increments its own shard,
+	 * shards are summed up only when statistics are collected.
+	 */
+	struct dnet_counter_shard	counter_shards[DNET_COUNTER_SHARDS];
 
 	int			bg_ionice_class;
 	int			bg_ionice_prio;
@@ -605,41 +701,64 @@ struct dnet_session {
 	int			nsize;
 };
 
+/* Returns shard of node counters used by the calling thread, threads are spread over shards round-robin */
+int dnet_counter_shard(void);
+
 static inline int dnet_counter_init(struct dnet_node *n)
 {
-	memset(&n->counters, 0, __DNET_CMD_MAX * 2 * sizeof(struct dnet_stat_count));
-	return dnet_lock_init(&n->counters_lock);
+	memset(&n->counter_shards, 0, sizeof(n->counter_shards));
+	return 0;
 }
 
-static inline void dnet_counter_destroy(struct dnet_node *n)
+static inline void dnet_counter_destroy(struct dnet_node *n __unused)
 {
-	return dnet_lock_destroy(&n->counters_lock);
 }
 
 static inline void dnet_counter_inc(struct dnet_node *n, int counter, int err)
 {
+	struct dnet_stat_count *c;
+
 	if (counter >= __DNET_CMD_MAX * 2)
 		counter = DNET_CMD_UNKNOWN + __DNET_CMD_MAX;
 
-	dnet_lock_lock(&n->counters_lock);
+	/* shard may still be shared by several threads if there are more threads than shards */
+	c = &n->counter_shards[dnet_counter_shard()].counters[counter];
 	if (!err)
-		n->counters[counter].count++;
+		__sync_add_and_fetch(&c->count, 1);
 	else
-		n->counters[counter].err++;
-	dnet_lock_unlock(&n->counters_lock);
+		__sync_add_and_fetch(&c->err, 1);
 }
 
 static inline void dnet_counter_set(struct dnet_node *n, int counter, int err, int64_t val)
 {
+	int i;
+
 	if (counter >= __DNET_CMD_MAX * 2)
 		counter = DNET_CMD_UNKNOWN + __DNET_CMD_MAX;
 
-	dnet_lock_lock(&n->counters_lock);
-	if (!err)
-		n->counters[counter].count = val;
-	else
-		n->counters[counter].err = val;
-	dnet_lock_unlock(&n->counters_lock);
+	for (i = 0; i < DNET_COUNTER_SHARDS; ++i) {
+		struct dnet_stat_count *c = &n->counter_shards[i].counters[counter];
+		const uint64_t value = i ? 0 : val;
+
+		if (!err)
+			__sync_lock_test_and_set(&c->count, value);
+		else
+			__sync_lock_test_and_set(&c->err, value);
+	}
+}
+
+/* Sums up @counter over all shards */
+static inline struct dnet_stat_count dnet_counter_get(struct dnet_node *n, int counter)
+{
+	struct dnet_stat_count res;
+	int i;
+
+	res.count = res.err = 0;
+	for (i = 0; i < DNET_COUNTER_SHARDS; ++i) {
+		res.count += __atomic_load_n(&n->counter_shards[i].counters[counter].count, __ATOMIC_RELAXED);
+		res.err += __atomic_load_n(&n->counter_shards[i].counters[counter].err, __ATOMIC_RELAXED);
+	}
+	return res;
 }
 
 struct dnet_trans;
@@ -649,6 +768,7 @@ int __attribute__((weak)) dnet_process_cmd_raw(struct dnet_net_state *st,
                                                void *data,
                                                int recursive,
                                                long queue_time,
+                                               long recv_time,
                                                struct dnet_access_context *context);
 int dnet_process_recv(struct dnet_net_state *st, struct dnet_io_req *r);
 void dnet_trans_update_timestamp(struct dnet_trans *t);
@@ -663,6 +783,14 @@ int __attribute__((weak)) dnet_send_ack(struct dnet_net_state *st,
                                         int err,
                                         int recursive,
                                         struct dnet_access_context *context);
+/*
+ * accounts time spent on sending reply @cmd and time @queue_time it spent in send queue in monitor statistics,
+ * it is provided by server only
+ */
+void __attribute__((weak)) dnet_monitor_send_time_update(struct dnet_node *n,
+                                                         const struct dnet_cmd *cmd,
+                                                         unsigned long queue_time,
+                                                         unsigned long time);
 void dnet_schedule_io(struct dnet_node *n, struct dnet_io_req *r);
 
 struct dnet_config;
@@ -766,6 +894,8 @@ ssize_t dnet_send_data(struct dnet_net_state *st,
                        uint64_t dsize,
                        struct dnet_access_context *context);
 ssize_t dnet_send(struct dnet_net_state *st, void *data, uint64_t size, struct dnet_access_context *context);
+/* Queues @replies replies packed one after another into @data as a single request */
+ssize_t dnet_send_replies(struct dnet_net_state *st, void *data, uint64_t size, long replies);
 ssize_t dnet_send_nolock(struct dnet_net_state *st, void *data, uint64_t size);
 
 struct dnet_addr_storage
@@ -1005,8 +1135,10 @@ static inline const char* dnet_print_trans(const struct dnet_trans *t) {
  */
 struct dnet_cmd_stats {
 	long queue_time;	// time that the command spent in queue
+	long recv_time;		// time spent on receiving the command
 	int handled_in_cache;	// whether the command handled by cache
 	long handle_time;	// time spent on the command handle
+	long lock_time;		// time spent on waiting for locked keys during the command handle
 	uint64_t size;		// size of data received or sent by command
 };
 
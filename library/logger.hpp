@@ -68,6 +68,29 @@ struct backend_scope {
 };
 
 std::string to_hex_string(uint64_t value);
+
+/*
+ * Registers level of a logger which filters records by level for the lifetime of the registration.
+ * The lowest registered level is kept in log_verbosity and is checked by DNET_LOG before its arguments
+ * are evaluated. While no logger is registered every record is evaluated.
+ */
+class log_level_registration {
+public:
+	explicit log_level_registration(int level);
+	~log_level_registration();
+
+	log_level_registration(const log_level_registration &) = delete;
+	log_level_registration &operator =(const log_level_registration &) = delete;
+
+	/* changes registered level, should be called when the logger's level is changed */
+	void set(int level);
+
+private:
+	int m_level;
+};
+
+/* the lowest level passed by registered loggers */
+extern std::atomic<int> log_verbosity;
 }} /* namespace ioremap::elliptics */
 
 namespace std {
@@ -160,13 +183,31 @@ template <class T> inline blackhole::logger_facade<dnet_logger> make_facade(T &&
 	return blackhole::logger_facade<dnet_logger>(logger_ref(log));
 }
 
+/*
+ * Returns whether record of @severity can be passed by any logger.
+ * Records of traced requests are passed regardless of level (see log_filter()).
+ */
+inline bool log_enabled(int severity) {
+	return severity >= log_verbosity.load(std::memory_order_relaxed) || dnet_logger_get_trace_bit();
+}
+
 }} /* namespace ioremap::elliptics */
 
 void dnet_log_access(dnet_node *node,
                      const blackhole::attribute_list &attributes);
 
-#define DNET_LOG(__log__, __severity__, ...) \
-	ioremap::elliptics::make_facade(__log__).log(__severity__, __VA_ARGS__)
+/*
+ * Verbosity is checked before the logger and arguments are evaluated, so filtered out records
+ * cost neither dumps of ids, flags and addresses nor formatting.
+ */
+#define DNET_LOG(__log__, __severity__, ...)							\
+	do {											\
+		const int __dnet_log_severity__ = (__severity__);				\
+		if (ioremap::elliptics::log_enabled(__dnet_log_severity__)) {			\
+			ioremap::elliptics::make_facade(__log__).log(__dnet_log_severity__,	\
+			                                             __VA_ARGS__);		\
+		}										\
+	} while (0)
 
 #define DNET_LOG_DEBUG(__log__, ...)	DNET_LOG(__log__, DNET_LOG_DEBUG, __VA_ARGS__)
 #define DNET_LOG_NOTICE(__log__, ...)	DNET_LOG(__log__, DNET_LOG_NOTICE, __VA_ARGS__)
@@ -204,6 +204,7 @@ static struct dnet_io_req *dnet_io_req_copy(struct dnet_net_state *st, struct dn
 	}
 	memset(r, 0, sizeof(struct dnet_io_req));
 	r->fd = -1;
+	r->replies = orig->replies;
 	r->context = dnet_access_context_get(orig->context);
 
 	if (orig->header && orig->hsize) {
@@ -408,6 +409,18 @@ ssize_t dnet_send_data(struct dnet_net_state *st,
 	return dnet_io_req_queue(st, &r);
 }
 
+ssize_t dnet_send_replies(struct dnet_net_state *st, void *data, uint64_t size, long replies) {
+	struct dnet_io_req r;
+
+	memset(&r, 0, sizeof(r));
+	r.header = data;
+	r.hsize = size;
+	r.fd = -1;
+	r.replies = replies;
+
+	return dnet_io_req_queue(st, &r);
+}
+
 static ssize_t dnet_send_fd_nolock(struct dnet_net_state *st, int fd, uint64_t offset, uint64_t dsize)
 {
 	ssize_t err = 0;
@@ -709,17 +722,12 @@ int dnet_process_recv(struct dnet_net_state *st, struct dnet_io_req *r) {
 
 	// context is created only for requests, all replies should be handled within their request's context
 	context = dnet_access_context_create(n);
-	dnet_access_context_add_string(context, "cmd", dnet_cmd_string(cmd->cmd));
-	dnet_access_context_add_uint(context, "trans", cmd->trans);
-	dnet_access_context_add_string(context, "st", dnet_state_dump_addr(st));
-	dnet_access_context_add_trace_id(context, cmd->trace_id);
-	dnet_access_context_add_uint(context, "request_size", r->hsize + r->dsize + r->fsize);
-	dnet_access_context_add_uint(context, "receive_time", r->recv_time);
-	dnet_access_context_add_uint(context, "receive_queue_time", r->queue_time);
+	dnet_access_context_set_request(context, cmd, dnet_state_addr(st), r->hsize + r->dsize + r->fsize,
+	                                r->recv_time, r->queue_time);
 
 	err = dnet_process_control(st, cmd, r->data);
 	if (err != -ENOTSUP) {
-		dnet_access_context_add_string(context, "access", "server/control");
+		dnet_access_context_set_access(context, DNET_ACCESS_SERVER_CONTROL, NULL);
 		goto out;
 	}
 
@@ -731,12 +739,11 @@ int dnet_process_recv(struct dnet_net_state *st, struct dnet_io_req *r) {
 	if (!forward_state || forward_state == st || forward_state == n->st) {
 		dnet_state_put(forward_state);
 
-		dnet_access_context_add_string(context, "access", "server");
+		dnet_access_context_set_access(context, DNET_ACCESS_SERVER, NULL);
 		HANDY_COUNTER_INCREMENT("io.cmds", 1);
-		err = dnet_process_cmd_raw(st, cmd, r->data, 0, r->queue_time, context);
+		err = dnet_process_cmd_raw(st, cmd, r->data, 0, r->queue_time, r->recv_time, context);
 	} else {
-		dnet_access_context_add_string(context, "access", "server/forward");
-		dnet_access_context_add_string(context, "forward", dnet_state_dump_addr(forward_state));
+		dnet_access_context_set_access(context, DNET_ACCESS_SERVER_FORWARD, dnet_state_addr(forward_state));
 		HANDY_COUNTER_INCREMENT("io.forwards", 1);
 		err = dnet_trans_forward(r, st, forward_state);
 		if (err)
@@ -990,6 +997,7 @@ int dnet_state_micro_init(struct dnet_net_state *st,
 	}
 
 	atomic_init(&st->send_queue_size, 0);
+	atomic_init(&st->send_queue_bytes, 0);
 	atomic_init(&st->refcnt, 1);
 
 	memcpy(&st->addr, addr, sizeof(struct dnet_addr));
@@ -1359,9 +1367,10 @@ err_out_exit:
 
 		if (st->send_offset == total_size) {
 			level = !(cmd->flags & DNET_FLAGS_MORE) ? DNET_LOG_INFO : DNET_LOG_NOTICE;
-			dnet_access_context_add_uint(r->context, "send_time", send_time);
-			dnet_access_context_add_uint(r->context, "send_queue_time", r->queue_time);
-			dnet_access_context_add_uint(r->context, "response_size", total_size);
+			dnet_access_context_add_reply(r->context, send_time, r->queue_time, total_size);
+
+			if (!err && (cmd->flags & DNET_FLAGS_REPLY) && st->n->monitor && dnet_monitor_send_time_update)
+				dnet_monitor_send_time_update(st->n, cmd, r->queue_time, send_time);
 		}
 		dnet_log(st->n, level, "%s: %s: sending trans: %lld -> %s/%d: size: %llu, cflags: %s, finish-sent: "
 		                       "%zd/%zd, send-queue-time: %lu usecs, send-time: %lu usecs",
@@ -25,20 +25,35 @@
 #include <fcntl.h>
 #include <signal.h>
 
+#include "access_context.h"
 #include "elliptics.h"
 #include "elliptics/interface.h"
 #include "monitor/monitor.h"
 #include "library/logger.hpp"
 
+int dnet_counter_shard(void)
+{
+	static int next_shard;
+	static __thread int shard = -1;
+
+	if (shard < 0)
+		shard = __sync_fetch_and_add(&next_shard, 1) % DNET_COUNTER_SHARDS;
+	return shard;
+}
+
 static struct dnet_node *dnet_node_alloc(struct dnet_config *cfg)
 {
 	struct dnet_node *n;
 	int err;
 
-	n = calloc(1, sizeof(struct dnet_node));
-	if (!n) {
+	/* counter shards are cache line aligned to keep threads of different shards off each other's lines,
+	 * calloc() doesn't guarantee such alignment of the node they are embedded into
+	 */
+	if (posix_memalign((void **)&n, __alignof__(struct dnet_node), sizeof(struct dnet_node))) {
+		n = NULL;
 		goto err_out_free;
 	}
+	memset(n, 0, sizeof(struct dnet_node));
 
 	atomic_init(&n->trans, 0);
 
@@ -53,7 +68,7 @@ static struct dnet_node *dnet_node_alloc(struct dnet_config *cfg)
 
 	err = dnet_counter_init(n);
 	if (err) {
-		DNET_ERROR(n, "Failed to initialize statistics counters lock: err: %d", err);
+		DNET_ERROR(n, "Failed to initialize statistics counters: err: %d", err);
 		goto err_out_destroy_state;
 	}
 
@@ -848,6 +863,12 @@ void dnet_node_cleanup_common_resources(struct dnet_node *n)
 
 	dnet_io_cleanup(n);
 
+	/*
+	 * Access logs of requests released by stopped threads are staged already and printed here,
+	 * logs of requests released later are printed synchronously. The writer itself is freed with the node.
+	 */
+	dnet_access_writer_stop(n->access_writer);
+
 	pthread_attr_destroy(&n->attr);
 
 	pthread_mutex_destroy(&n->state_lock);
@@ -872,6 +893,7 @@ void dnet_node_destroy(struct dnet_node *n)
 	dnet_node_cleanup_common_resources(n);
 	dnet_counter_destroy(n);
 
+	dnet_access_writer_destroy(n->access_writer);
 	free(n);
 }
 
@@ -53,6 +53,106 @@ static char *dnet_work_io_mode_str(int mode)
 	return dnet_work_io_mode_string[mode];
 }
 
+static const char *dnet_thread_state_string[] = {
+	[DNET_THREAD_STATE_RUNNING] = "running",
+	[DNET_THREAD_STATE_WAIT_QUEUE] = "wait_queue",
+	[DNET_THREAD_STATE_WAIT_LOCK] = "wait_lock",
+	[DNET_THREAD_STATE_BACKEND] = "backend",
+	[DNET_THREAD_STATE_SEND] = "send",
+	[DNET_THREAD_STATE_BLOCKED] = "blocked",
+};
+
+const char *dnet_thread_state_str(int state)
+{
+	if (state < 0 || state >= (int)ARRAY_SIZE(dnet_thread_state_string))
+		return NULL;
+
+	return dnet_thread_state_string[state];
+}
+
+/* stats of the calling thread, NULL if the thread doesn't account its time */
+static __thread struct dnet_thread_stats *dnet_current_thread_stats;
+
+uint64_t dnet_thread_stats_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void dnet_thread_stats_attach(struct dnet_thread_stats *stats, int state)
+{
+	memset(stats, 0, sizeof(struct dnet_thread_stats));
+	stats->state = state;
+	stats->state_start = dnet_thread_stats_now();
+	dnet_current_thread_stats = stats;
+}
+
+void dnet_thread_stats_detach(void)
+{
+	dnet_current_thread_stats = NULL;
+}
+
+int dnet_thread_state_switch(int state)
+{
+	struct dnet_thread_stats *stats = dnet_current_thread_stats;
+	uint64_t now;
+	int previous;
+
+	if (!stats)
+		return -1;
+
+	previous = stats->state;
+	if (previous == state)
+		return previous;
+
+	/* the thread is the only writer, monitor may read values of different switches but never torn ones */
+	now = dnet_thread_stats_now();
+	__atomic_store_n(&stats->time[previous], stats->time[previous] + now - stats->state_start, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats->state_start, now, __ATOMIC_RELAXED);
+	__atomic_store_n(&stats->state, state, __ATOMIC_RELAXED);
+
+	return previous;
+}
+
+void dnet_thread_stats_sum(const struct dnet_thread_stats *stats, uint64_t now, uint64_t *time)
+{
+	const int state = __atomic_load_n(&stats->state, __ATOMIC_RELAXED);
+	const uint64_t state_start = __atomic_load_n(&stats->state_start, __ATOMIC_RELAXED);
+	int i;
+
+	for (i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		time[i] += __atomic_load_n(&stats->time[i], __ATOMIC_RELAXED);
+	}
+
+	if (now > state_start)
+		time[state] += now - state_start;
+}
+
+void dnet_thread_utilization_update(struct dnet_thread_utilization *utilization, const uint64_t *time, uint64_t now)
+{
+	static const uint64_t period = 1000000000ULL;
+	uint64_t delta[__DNET_THREAD_STATE_MAX];
+	uint64_t total = 0;
+	int i;
+
+	if (utilization->timestamp && now - utilization->timestamp < period)
+		return;
+
+	for (i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		delta[i] = (time[i] > utilization->time[i]) ? time[i] - utilization->time[i] : 0;
+		total += delta[i];
+	}
+	if (!total)
+		return;
+
+	for (i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		utilization->ratio[i] = (double)delta[i] / total;
+		utilization->time[i] = time[i];
+	}
+	utilization->timestamp = now;
+}
+
 void dnet_work_pool_stop(struct dnet_work_pool_place *place) {
 	int i;
 	struct dnet_work_io *wio;
@@ -680,14 +780,36 @@ static int dnet_process_send_single(struct dnet_net_state *st)
 			pthread_mutex_unlock(&st->n->io->full_lock);
 			HANDY_COUNTER_DECREMENT("io.output.queue.size", 1);
 
-			if (atomic_read(&st->send_queue_size) > 0)
-				if (atomic_dec(&st->send_queue_size) == DNET_SEND_WATERMARK_LOW) {
+			{
+				const long replies = r->replies ? r->replies : 1;
+				const long bytes = r->replies ? (long)r->hsize : 0;
+				long queue_size = atomic_read(&st->send_queue_size);
+				long queue_bytes = atomic_read(&st->send_queue_bytes);
+				int low_watermark = 0;
+
+				/* bytes are accounted only for batches and always before they are queued,
+				 * so they are unaccounted regardless of send_queue_size which plain replies
+				 * sent without accounting may have already drained
+				 */
+				if (bytes) {
+					queue_bytes = atomic_sub(&st->send_queue_bytes, bytes);
+					low_watermark = queue_bytes <= DNET_SEND_BYTES_WATERMARK_LOW &&
+					                queue_bytes + bytes > DNET_SEND_BYTES_WATERMARK_LOW;
+				}
+
+				if (queue_size > 0) {
+					queue_size = atomic_sub(&st->send_queue_size, replies);
+					low_watermark |= queue_size <= DNET_SEND_WATERMARK_LOW &&
+					                 queue_size + replies > DNET_SEND_WATERMARK_LOW;
+				}
+
+				if (low_watermark) {
 					dnet_log(st->n, DNET_LOG_DEBUG,
-							"State low_watermark reached: %s: %ld, waking up",
-							dnet_addr_string(&st->addr),
-							atomic_read(&st->send_queue_size));
+							"State low_watermark reached: %s: %ld, bytes: %ld, waking up",
+							dnet_addr_string(&st->addr), queue_size, queue_bytes);
 					pthread_cond_broadcast(&st->send_wait);
 				}
+			}
 
 			dnet_io_req_free(r);
 			st->send_offset = 0;
@@ -789,7 +911,9 @@ static int dnet_state_net_process(struct dnet_net_state *st, struct epoll_event
 			goto err_out_exit;
 	}
 	if (ev->events & EPOLLOUT) {
+		dnet_thread_state_switch(DNET_THREAD_STATE_SEND);
 		err = dnet_process_send_single(st);
+		dnet_thread_state_switch(DNET_THREAD_STATE_RUNNING);
 		if (err && (err != -EAGAIN))
 			goto err_out_exit;
 	}
@@ -886,6 +1010,8 @@ static void *dnet_io_process_network(void *data_)
 	// get current timestamp for future outputting "Net pool is suspended..." logging
 	clock_gettime(CLOCK_MONOTONIC_RAW, &prev_ts);
 
+	dnet_thread_stats_attach(&nio->stats, DNET_THREAD_STATE_RUNNING);
+
 	while (!n->need_exit) {
 		// check if epoll possibly has more events to process then evs_size
 		if (num_events >= evs_size) {
@@ -897,7 +1023,9 @@ static void *dnet_io_process_network(void *data_)
 			}
 		}
 
+		dnet_thread_state_switch(DNET_THREAD_STATE_WAIT_QUEUE);
 		err = epoll_wait(nio->epoll_fd, evs, evs_size, 1000);
+		dnet_thread_state_switch(DNET_THREAD_STATE_RUNNING);
 		if (err == 0)
 			continue;
 
@@ -974,6 +1102,7 @@ static void *dnet_io_process_network(void *data_)
 				prev_ts = curr_ts;
 			}
 			// wait condition variable - io queues has a free slot or some socket has something to send
+			dnet_thread_state_switch(DNET_THREAD_STATE_BLOCKED);
 			pthread_mutex_lock(&n->io->full_lock);
 			n->io->blocked = 1;
 			while (!n->need_exit && !dnet_check_io(n->io)) {
@@ -984,9 +1113,12 @@ static void *dnet_io_process_network(void *data_)
 			}
 			n->io->blocked = 0;
 			pthread_mutex_unlock(&n->io->full_lock);
+			dnet_thread_state_switch(DNET_THREAD_STATE_RUNNING);
 		}
 	}
 
+	dnet_thread_stats_detach();
+
 	free(evs);
 
 err_out_exit:
@@ -1031,11 +1163,15 @@ void *dnet_io_process(void *data_) {
 	dnet_log(n, DNET_LOG_NOTICE, "started io thread: #%d, nonblocking: %d, lifo: %d, pool: %s", wio->thread_index,
 	         nonblocking, lifo, pool->pool_id);
 
+	dnet_thread_stats_attach(&wio->stats, DNET_THREAD_STATE_WAIT_QUEUE);
+
 	while (!n->need_exit && !pool->need_exit) {
 		r = dnet_pop_request(wio, thread_stat_id);
 		if (!r)
 			continue;
 
+		dnet_thread_state_switch(DNET_THREAD_STATE_RUNNING);
+
 		pthread_cond_broadcast(&n->io->full_wait);
 
 		FORMATTED(HANDY_COUNTER_INCREMENT, ("pool.%s.active_threads", thread_stat_id), 1);
@@ -1064,8 +1200,12 @@ void *dnet_io_process(void *data_) {
 		dnet_logger_unset_backend_id();
 
 		FORMATTED(HANDY_COUNTER_DECREMENT, ("pool.%s.active_threads", thread_stat_id), 1);
+
+		dnet_thread_state_switch(DNET_THREAD_STATE_WAIT_QUEUE);
 	}
 
+	dnet_thread_stats_detach();
+
 	dnet_log(n, DNET_LOG_NOTICE, "finished io thread: #%d, nonblocking: %d, lifo: %d, pool: %s", wio->thread_index,
 	         nonblocking, lifo, pool->pool_id);
 
@@ -1098,6 +1238,12 @@ int dnet_io_init(struct dnet_node *n, struct dnet_config *cfg)
 		goto err_out_free_mutex;
 	}
 
+	err = pthread_mutex_init(&n->io->net_utilization_lock, NULL);
+	if (err) {
+		err = -err;
+		goto err_out_free_cond;
+	}
+
 	list_stat_init(&n->io->output_stats);
 
 	n->io->net_thread_num = cfg->net_thread_num;
@@ -1106,7 +1252,7 @@ int dnet_io_init(struct dnet_node *n, struct dnet_config *cfg)
 
 	err = dnet_work_pool_place_init(&n->io->pool.recv_pool);
 	if (err) {
-		goto err_out_free_cond;
+		goto err_out_free_utilization_lock;
 	}
 
 	err = dnet_work_pool_alloc(&n->io->pool.recv_pool, n, cfg->io_thread_num, DNET_WORK_IO_MODE_BLOCKING,
@@ -1167,6 +1313,8 @@ err_out_free_recv_pool:
 	dnet_work_pool_exit(&n->io->pool.recv_pool);
 err_out_cleanup_recv_place:
 	dnet_work_pool_place_cleanup(&n->io->pool.recv_pool);
+err_out_free_utilization_lock:
+	pthread_mutex_destroy(&n->io->net_utilization_lock);
 err_out_free_cond:
 	pthread_cond_destroy(&n->io->full_wait);
 err_out_free_mutex:
@@ -1208,6 +1356,7 @@ void dnet_io_cleanup(struct dnet_node *n)
 
 	dnet_io_cleanup_states(n);
 
+	pthread_mutex_destroy(&io->net_utilization_lock);
 	free(io);
 	n->io = NULL;
 }
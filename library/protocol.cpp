@@ -1,8 +1,9 @@
 #include "protocol.hpp"
 
-#include <msgpack.hpp>
+#include <cctype>
+#include <cstring>
 
-#include "rapidjson/document.h"
+#include <msgpack.hpp>
 
 namespace msgpack {
 using namespace ioremap::elliptics;
@@ -322,13 +323,20 @@ inline ioremap::elliptics::dnet_iterator_request &operator >>(msgpack::object o,
 	p[6].convert(&std::get<1>(v.time_range));
 	p[7].convert(&v.groups);
 
+	if (o.via.array.size > 8) {
+		p[8].convert(&v.parallelism);
+	} else {
+		// older protocol
+		v.parallelism = 0;
+	}
+
 	return v;
 }
 
 template <typename Stream>
 inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
                                             const ioremap::elliptics::dnet_iterator_request &v) {
-	o.pack_array(8);
+	o.pack_array(9);
 	o.pack(v.iterator_id);
 	o.pack(v.action);
 	o.pack(v.type);
@@ -337,6 +345,7 @@ inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
 	o.pack(std::get<0>(v.time_range));
 	o.pack(std::get<1>(v.time_range));
 	o.pack(v.groups);
+	o.pack(v.parallelism);
 
 	return o;
 }
@@ -485,16 +494,58 @@ inline ioremap::elliptics::dnet_bulk_remove_request &operator >> (msgpack::objec
 	p[1].convert(&v.keys);
 	p[2].convert(&v.timestamps);
 
+	if (o.via.array.size > 3) {
+		p[3].convert(&v.status_array);
+	} else {
+		// older protocol
+		v.status_array = false;
+	}
+
 	return v;
 }
 
 template <typename Stream>
 inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
                                             const ioremap::elliptics::dnet_bulk_remove_request &v) {
-	o.pack_array(3);
+	o.pack_array(4);
 	o.pack(v.ioflags);
 	o.pack(v.keys);
 	o.pack(v.timestamps);
+	o.pack(v.status_array);
+	return o;
+}
+
+inline ioremap::elliptics::dnet_bulk_remove_response &operator >> (msgpack::object o,
+                                                                   ioremap::elliptics::dnet_bulk_remove_response &v) {
+	if (o.type != msgpack::type::ARRAY || o.via.array.size < 2) {
+		throw msgpack::type_error();
+	}
+
+	const object *p = o.via.array.ptr;
+	p[0].convert(&v.keys);
+	p[1].convert(&v.statuses);
+
+	if (o.via.array.size > 2) {
+		p[2].convert(&v.backend_ids);
+	} else {
+		v.backend_ids.clear();
+	}
+
+	if (v.keys.size() != v.statuses.size() ||
+	    (!v.backend_ids.empty() && v.keys.size() != v.backend_ids.size())) {
+		throw msgpack::type_error();
+	}
+
+	return v;
+}
+
+template <typename Stream>
+inline msgpack::packer<Stream> &operator <<(msgpack::packer<Stream> &o,
+                                            const ioremap::elliptics::dnet_bulk_remove_response &v) {
+	o.pack_array(3);
+	o.pack(v.keys);
+	o.pack(v.statuses);
+	o.pack(v.backend_ids);
 	return o;
 }
 
@@ -510,7 +561,8 @@ dnet_iterator_request::dnet_iterator_request()
 	, flags{0}
 	, key_ranges{}
 	, time_range{dnet_time{0, 0}, dnet_time{0, 0}}
-	, groups{} {
+	, groups{}
+	, parallelism{0} {
 }
 
 dnet_iterator_request::dnet_iterator_request(uint32_t type, uint64_t flags,
@@ -522,7 +574,8 @@ dnet_iterator_request::dnet_iterator_request(uint32_t type, uint64_t flags,
 	, flags{flags}
 	, key_ranges{key_ranges}
 	, time_range(time_range)
-	, groups{} {
+	, groups{}
+	, parallelism{0} {
 }
 
 dnet_bulk_remove_request::dnet_bulk_remove_request() {}
@@ -562,18 +615,313 @@ void deserialize(const data_pointer &data, T &value, size_t &offset) {
 	msg.get().convert(&value);
 }
 
-void validate_json(const std::string &json) {
-	if (json.empty())
-		return;
+namespace {
+
+/*
+ * Checks well-formedness of json without building any document and without allocations.
+ * It accepts only documents which rapidjson's reader parses, so they can be streamed by the reader afterwards.
+ * Nesting of containers is kept as a bit per level, so documents nested deeper than max_depth are rejected.
+ */
+class json_scanner {
+public:
+	json_scanner(const char *data, size_t size)
+	: m_begin(data)
+	, m_cur(data)
+	, m_end(data + size)
+	, m_depth(0) {
+		memset(m_objects, 0, sizeof(m_objects));
+	}
+
+	/*
+	 * Returns nullptr if the data is a single json object surrounded only by whitespaces,
+	 * otherwise returns description of the first error
+	 */
+	const char *scan() {
+		skip_whitespaces();
+		if (m_cur == m_end || *m_cur != '{')
+			return "the document root must be an object";
+
+		do {
+			bool completed;
+			if (const char *error = value(completed))
+				return error;
+			if (!completed)
+				continue;
+			if (const char *error = next())
+				return error;
+		} while (m_depth);
+
+		skip_whitespaces();
+		if (m_cur != m_end)
+			return "the document root must not be followed by other values";
+		return nullptr;
+	}
+
+	size_t offset() const { return m_cur - m_begin; }
+
+private:
+	static const size_t max_depth = 1024;
+
+	bool is_object() const {
+		return m_objects[(m_depth - 1) / 64] & (1ULL << ((m_depth - 1) % 64));
+	}
+
+	const char *push(bool object) {
+		if (m_depth == max_depth)
+			return "too deep nesting";
+
+		const uint64_t bit = 1ULL << (m_depth % 64);
+		if (object)
+			m_objects[m_depth / 64] |= bit;
+		else
+			m_objects[m_depth / 64] &= ~bit;
+		++m_depth;
+		return nullptr;
+	}
+
+	void skip_whitespaces() {
+		while (m_cur != m_end && (*m_cur == ' ' || *m_cur == '\n' || *m_cur == '\r' || *m_cur == '\t'))
+			++m_cur;
+	}
+
+	/*
+	 * Scans a value. Scalars and empty containers are scanned entirely and set @completed,
+	 * otherwise the container is opened (with the first key if it is an object) and its value is expected next.
+	 */
+	const char *value(bool &completed) {
+		skip_whitespaces();
+		completed = true;
+		if (m_cur == m_end)
+			return "unexpected end of data, a value is expected";
+
+		switch (*m_cur) {
+		case '{':
+		case '[': {
+			const bool object = (*m_cur == '{');
+			++m_cur;
+			skip_whitespaces();
+			if (m_cur != m_end && *m_cur == (object ? '}' : ']')) {
+				++m_cur;
+				return nullptr;
+			}
+
+			completed = false;
+			if (const char *error = push(object))
+				return error;
+			return object ? key() : nullptr;
+		}
+		case '"':
+			return string();
+		case 't':
+			return literal("true");
+		case 'f':
+			return literal("false");
+		case 'n':
+			return literal("null");
+		default:
+			return number();
+		}
+	}
+
+	/*
+	 * Scans separators and closings of containers which follow a completed value
+	 * until the next value is expected or the root object is closed
+	 */
+	const char *next() {
+		while (m_depth) {
+			skip_whitespaces();
+			if (m_cur == m_end)
+				return "unexpected end of data";
+
+			const bool object = is_object();
+			if (*m_cur == ',') {
+				++m_cur;
+				return object ? key() : nullptr;
+			}
+			if (*m_cur != (object ? '}' : ']'))
+				return object ? "missing a comma or '}' after an object member"
+				              : "missing a comma or ']' after an array element";
+			++m_cur;
+			--m_depth;
+		}
+		return nullptr;
+	}
+
+	const char *key() {
+		skip_whitespaces();
+		if (m_cur == m_end || *m_cur != '"')
+			return "name of an object member must be a string";
+		if (const char *error = string())
+			return error;
+
+		skip_whitespaces();
+		if (m_cur == m_end || *m_cur != ':')
+			return "there must be a colon after the name of an object member";
+		++m_cur;
+		return nullptr;
+	}
+
+	const char *string() {
+		for (++m_cur; m_cur != m_end; ++m_cur) {
+			const unsigned char c = *m_cur;
+			if (c == '"') {
+				++m_cur;
+				return nullptr;
+			}
+			if (c < 0x20)
+				return "incorrect unescaped character in string";
+			if (c != '\\')
+				continue;
+
+			if (++m_cur == m_end)
+				break;
+			if (*m_cur == 'u') {
+				unsigned codepoint;
+				if (const char *error = hex4(codepoint))
+					return error;
+				// high surrogate must be followed by low one as rapidjson's reader requires
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+					if (m_end - m_cur < 3 || m_cur[1] != '\\' || m_cur[2] != 'u')
+						return "missing the second \\u in surrogate pair";
+					m_cur += 2;
+					if (const char *error = hex4(codepoint))
+						return error;
+					if (codepoint < 0xDC00 || codepoint > 0xDFFF)
+						return "the second \\u in surrogate pair is invalid";
+				}
+			} else if (!strchr("\"\\/bfnrt", *m_cur) || !*m_cur) {
+				return "incorrect escape character in string";
+			}
+		}
+		return "string lacks ending quotation";
+	}
+
+	// scans 4 hex digits following the current 'u' of \\u escape to @codepoint
+	const char *hex4(unsigned &codepoint) {
+		codepoint = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (++m_cur == m_end)
+				return "unexpected end of data in string";
+
+			const unsigned char c = *m_cur;
+			if (!isxdigit(c))
+				return "incorrect hex digit after \\u escape";
+			codepoint = codepoint * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+		}
+		return nullptr;
+	}
+
+	const char *literal(const char *expected) {
+		const size_t size = strlen(expected);
+		if (static_cast<size_t>(m_end - m_cur) < size || memcmp(m_cur, expected, size))
+			return "invalid value";
+		m_cur += size;
+		return nullptr;
+	}
+
+	size_t digits() {
+		const char *start = m_cur;
+		while (m_cur != m_end && *m_cur >= '0' && *m_cur <= '9')
+			++m_cur;
+		return m_cur - start;
+	}
+
+	/*
+	 * Scans a number. Numbers which rapidjson's reader can't store in double are rejected as it does:
+	 * integer part which exceeds 64 bits is accumulated in double and must stay below 1e307 before every digit,
+	 * absolute value of the exponent must not exceed 308 (324 if it is negative).
+	 */
+	const char *number() {
+		const bool minus = (*m_cur == '-');
+		if (minus)
+			++m_cur;
+
+		if (m_cur != m_end && *m_cur == '0') {
+			++m_cur;
+		} else {
+			const char *start = m_cur;
+			const size_t count = digits();
+			if (!count)
+				return "invalid value";
+			// 19 digits always fit into 64 bits
+			if (count > 19 && !integer_fits(start, minus))
+				return "number too big to store in double";
+		}
+
+		if (m_cur != m_end && *m_cur == '.') {
+			++m_cur;
+			if (!digits())
+				return "at least one digit is required in fraction part";
+		}
+
+		if (m_cur != m_end && (*m_cur == 'e' || *m_cur == 'E')) {
+			++m_cur;
+			bool negative = false;
+			if (m_cur != m_end && (*m_cur == '+' || *m_cur == '-'))
+				negative = (*m_cur++ == '-');
+
+			const char *start = m_cur;
+			if (!digits())
+				return "at least one digit is required in exponent";
+
+			int exponent = 0;
+			for (const char *digit = start; digit != m_cur; ++digit) {
+				exponent = exponent * 10 + (*digit - '0');
+				if (exponent > (negative ? 324 : 308))
+					return negative ? "number too small to store in double" : "number too big to store in double";
+			}
+		}
+		return nullptr;
+	}
 
-	rapidjson::Document doc;
-	doc.Parse<0>(json.c_str());
+	// repeats accumulation of integer part [@start, m_cur) made by rapidjson's reader
+	bool integer_fits(const char *start, bool minus) const {
+		const uint64_t limit = minus ? 922337203685477580ULL : 1844674407370955161ULL;
+		const char last = minus ? '8' : '5';
+
+		const char *digit = start;
+		uint64_t value = 0;
+		for (; digit != m_cur; ++digit) {
+			if (value >= limit && (value != limit || *digit > last))
+				break;
+			value = value * 10 + (*digit - '0');
+		}
+
+		double d = value;
+		for (; digit != m_cur; ++digit) {
+			if (d >= 1E307)
+				return false;
+			d = d * 10 + (*digit - '0');
+		}
+		return true;
+	}
+
+	const char	*m_begin;
+	const char	*m_cur;
+	const char	*m_end;
+	size_t		m_depth;
+	uint64_t	m_objects[max_depth / 64];
+};
+
+} /* namespace */
 
-	if (doc.HasParseError() || !doc.IsObject()) {
-		throw std::runtime_error(doc.GetParseError());
+void validate_json(const char *data, size_t size) {
+	if (size && data[size - 1] == '\0')
+		--size;
+
+	if (!size)
+		return;
+
+	json_scanner scanner(data, size);
+	if (const char *error = scanner.scan()) {
+		throw std::runtime_error(std::string(error) + " at offset " + std::to_string(scanner.offset()));
 	}
 }
 
+void validate_json(const std::string &json) {
+	validate_json(json.data(), json.size());
+}
+
 #define DEFINE_HEADER(TYPE) \
 template data_pointer serialize<TYPE>(const TYPE &); \
 template void deserialize(const data_pointer &data, TYPE &value, size_t &offset);
@@ -586,6 +934,7 @@ DEFINE_HEADER(dnet_write_request);
 DEFINE_HEADER(dnet_lookup_response);
 
 DEFINE_HEADER(dnet_bulk_remove_request)
+DEFINE_HEADER(dnet_bulk_remove_response);
 DEFINE_HEADER(dnet_remove_request);
 
 DEFINE_HEADER(dnet_iterator_request);
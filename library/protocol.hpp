@@ -104,6 +104,14 @@ struct dnet_bulk_remove_request {
 	uint64_t ioflags{0};
 	std::vector<dnet_id> keys;
 	std::vector<dnet_time> timestamps;
+	bool status_array{false}; /* client accepts statuses packed into dnet_bulk_remove_response */
+};
+
+/* Statuses of keys removed by BULK_REMOVE_NEW, a single reply may carry any subset of requested keys */
+struct dnet_bulk_remove_response {
+	std::vector<dnet_id> keys;
+	std::vector<int> statuses;
+	std::vector<int> backend_ids; /* backend which has handled the key, -1 if the key wasn't routed to any */
 };
 
 struct dnet_iterator_request {
@@ -119,6 +127,7 @@ struct dnet_iterator_request {
 	std::vector<dnet_iterator_range> key_ranges;
 	std::tuple<dnet_time, dnet_time> time_range;
 	std::vector<uint32_t> groups;
+	uint32_t parallelism; /* hint: number of threads backend may use for the iteration, 0 - backend's choice */
 };
 
 struct dnet_iterator_response {
@@ -166,6 +175,12 @@ void deserialize(const data_pointer &data, T &value) {
 	deserialize(data, value, offset);
 }
 
+/*
+ * Checks that @size bytes at @data are a json object without building a document,
+ * throws std::runtime_error describing the first error otherwise. Empty data is accepted.
+ * A single trailing '\0' (e.g. size of zero-terminated C string including its terminator) is ignored.
+ */
+void validate_json(const char *data, size_t size);
 void validate_json(const std::string &json);
 
 }} // namespace ioremap::elliptics
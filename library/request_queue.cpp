@@ -2,7 +2,10 @@
 
 #include <blackhole/attribute.hpp>
 
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
+#include <vector>
 
 #include "murmurhash.h"
 #include "monitor/measure_points.h"
@@ -18,6 +21,34 @@ static bool dnet_id_equal(const dnet_id &lhs, const dnet_id &rhs) {
 	return !dnet_id_cmp(&lhs, &rhs);
 }
 
+/* total time the thread has waited for keys locked by others in lock_key() and lock_keys() */
+static thread_local uint64_t oplock_wait_time = 0;
+
+static void account_oplock_wait(const std::chrono::steady_clock::time_point &wait_start) {
+	const auto elapsed = std::chrono::steady_clock::now() - wait_start;
+	oplock_wait_time += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+dnet_thread_state_guard::dnet_thread_state_guard()
+: m_previous(-1) {
+}
+
+dnet_thread_state_guard::dnet_thread_state_guard(int state)
+: m_previous(-1) {
+	enter(state);
+}
+
+dnet_thread_state_guard::~dnet_thread_state_guard() {
+	if (m_previous >= 0)
+		dnet_thread_state_switch(m_previous);
+}
+
+void dnet_thread_state_guard::enter(int state) {
+	const int previous = dnet_thread_state_switch(state);
+	if (m_previous < 0)
+		m_previous = previous;
+}
+
 dnet_request_queue::dnet_request_queue(bool lifo, size_t queue_limit)
 : m_queue_size(0)
 , m_queue_limit(queue_limit)
@@ -260,17 +291,30 @@ void dnet_request_queue::release_request(const dnet_io_req *req)
 
 void dnet_request_queue::lock_key(const dnet_id *id)
 {
+	std::chrono::steady_clock::time_point wait_start;
+	bool waited = false;
+	dnet_thread_state_guard state_guard;
+
 	std::unique_lock<std::mutex> lock(m_locks_mutex);
 	while (1) {
 		auto it = m_locked_keys.find(*id);
 		if (it == m_locked_keys.end())
 			break;
 
+		if (!waited) {
+			wait_start = std::chrono::steady_clock::now();
+			waited = true;
+			state_guard.enter(DNET_THREAD_STATE_WAIT_LOCK);
+		}
+
 		auto lock_entry = it->second;
 		lock_entry->unlock_event.wait_for(lock, std::chrono::seconds(1));
 	}
 	auto lock_entry = take_lock_entry(nullptr);
 	m_locked_keys.emplace(*id, lock_entry);
+
+	if (waited)
+		account_oplock_wait(wait_start);
 }
 
 void dnet_request_queue::unlock_key(const dnet_id *id)
@@ -279,9 +323,72 @@ void dnet_request_queue::unlock_key(const dnet_id *id)
 	m_queue_wait.notify_one();
 }
 
+void dnet_request_queue::lock_keys(const dnet_id *ids, size_t num)
+{
+	/*
+	 * Keys are taken one by one in sorted order and kept while waiting for the next one, so the batch isn't
+	 * starved by lockers of single keys and batches sharing keys can't deadlock with each other.
+	 */
+	std::vector<const dnet_id *> sorted(num);
+	for (size_t i = 0; i < num; ++i) {
+		sorted[i] = &ids[i];
+	}
+	std::sort(sorted.begin(), sorted.end(), [] (const dnet_id *lhs, const dnet_id *rhs) {
+		return dnet_id_cmp(lhs, rhs) < 0;
+	});
+
+	std::chrono::steady_clock::time_point wait_start;
+	bool waited = false;
+	dnet_thread_state_guard state_guard;
+
+	std::unique_lock<std::mutex> lock(m_locks_mutex);
+	for (size_t i = 0; i < num; ++i) {
+		/* the same key can be met in the batch several times */
+		if (i > 0 && !dnet_id_cmp(sorted[i - 1], sorted[i]))
+			continue;
+
+		while (1) {
+			auto it = m_locked_keys.find(*sorted[i]);
+			if (it == m_locked_keys.end())
+				break;
+
+			if (!waited) {
+				wait_start = std::chrono::steady_clock::now();
+				waited = true;
+				state_guard.enter(DNET_THREAD_STATE_WAIT_LOCK);
+			}
+
+			auto lock_entry = it->second;
+			lock_entry->unlock_event.wait_for(lock, std::chrono::seconds(1));
+		}
+
+		auto lock_entry = take_lock_entry(nullptr);
+		m_locked_keys.emplace(*sorted[i], lock_entry);
+	}
+
+	if (waited)
+		account_oplock_wait(wait_start);
+}
+
+void dnet_request_queue::unlock_keys(const dnet_id *ids, size_t num)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_locks_mutex);
+		for (size_t i = 0; i < num; ++i) {
+			release_key_locked(&ids[i]);
+		}
+	}
+	m_queue_wait.notify_all();
+}
+
 void dnet_request_queue::release_key(const dnet_id *id)
 {
 	std::unique_lock<std::mutex> lock(m_locks_mutex);
+	release_key_locked(id);
+}
+
+void dnet_request_queue::release_key_locked(const dnet_id *id)
+{
 	auto it = m_locked_keys.find(*id);
 	if (it != m_locked_keys.end()) {
 		auto lock_entry = it->second;
@@ -374,6 +481,19 @@ void dnet_oplock_guard::unlock()
 	}
 }
 
+dnet_oplock_batch_guard::dnet_oplock_batch_guard(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num)
+: m_pool{pool}
+, m_ids{ids}
+, m_num{num}
+{
+	dnet_oplock_batch(m_pool, m_ids, m_num);
+}
+
+dnet_oplock_batch_guard::~dnet_oplock_batch_guard()
+{
+	dnet_opunlock_batch(m_pool, m_ids, m_num);
+}
+
 void dnet_push_request(struct dnet_work_pool *pool, struct dnet_io_req *req, const char *thread_stat_id) {
 	pool->request_queue->push_request(req, thread_stat_id);
 }
@@ -394,6 +514,18 @@ void dnet_opunlock(struct dnet_io_pool *pool, const struct dnet_id *id) {
 	pool->recv_pool.pool->request_queue->unlock_key(id);
 }
 
+void dnet_oplock_batch(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num) {
+	pool->recv_pool.pool->request_queue->lock_keys(ids, num);
+}
+
+void dnet_opunlock_batch(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num) {
+	pool->recv_pool.pool->request_queue->unlock_keys(ids, num);
+}
+
+uint64_t dnet_oplock_wait_time(void) {
+	return oplock_wait_time;
+}
+
 size_t dnet_get_pool_queue_size(struct dnet_work_pool *pool) {
 	return pool->request_queue->size();
 }
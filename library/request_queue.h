@@ -56,6 +56,15 @@ public:
 	 * Removes key identified by /a id from /a m_locked_keys and notifies waiting threads
 	 */
 	void unlock_key(const dnet_id *id);
+	/*!
+	 * Locks all \a num keys from \a ids under a single /a m_locks_mutex: saves them into /a m_locked_keys
+	 * one by one in sorted order waiting for every key locked by others while holding the ones already taken.
+	 */
+	void lock_keys(const dnet_id *ids, size_t num);
+	/*!
+	 * Removes \a num keys from \a ids from /a m_locked_keys and notifies waiting threads
+	 */
+	void unlock_keys(const dnet_id *ids, size_t num);
 
 	/*!
 	 * Returns size of the queue
@@ -76,6 +85,10 @@ private:
 	 * Removes key identified by /a id from /a m_locked_keys
 	 */
 	void release_key(const dnet_id *id);
+	/*!
+	 * Same as release_key() but expects /a m_locks_mutex to be held by the caller
+	 */
+	void release_key_locked(const dnet_id *id);
 	/*!
 	 * Takes dnet_locks_entry object from /a m_lock_pool
 	 */
@@ -103,6 +116,26 @@ private:
 	std::mutex m_locks_mutex;
 };
 
+/*
+ * Switches the calling thread to a state and restores its previous state on destruction,
+ * nothing is done for threads which don't account their time (see dnet_thread_stats_attach())
+ */
+class dnet_thread_state_guard
+{
+public:
+	dnet_thread_state_guard();
+	explicit dnet_thread_state_guard(int state);
+	~dnet_thread_state_guard();
+
+	/*!
+	 * Switches the thread to \a state, the state preceding the first switch is restored on destruction
+	 */
+	void enter(int state);
+
+private:
+	int m_previous;
+};
+
 class dnet_oplock_guard
 {
 public:
@@ -118,6 +151,18 @@ private:
 	bool m_locked;
 };
 
+class dnet_oplock_batch_guard
+{
+public:
+	dnet_oplock_batch_guard(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num);
+	~dnet_oplock_batch_guard();
+
+private:
+	struct dnet_io_pool *m_pool;
+	const struct dnet_id *m_ids;
+	size_t m_num;
+};
+
 extern "C" {
 #endif // __cplusplus
 
@@ -132,6 +177,14 @@ size_t dnet_get_pool_queue_size(struct dnet_work_pool *pool);
 
 void dnet_oplock(struct dnet_io_pool *pool, const struct dnet_id *id);
 void dnet_opunlock(struct dnet_io_pool *pool, const struct dnet_id *id);
+void dnet_oplock_batch(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num);
+void dnet_opunlock_batch(struct dnet_io_pool *pool, const struct dnet_id *ids, size_t num);
+
+/*
+ * Returns total time in usecs the calling thread has waited for keys locked by others
+ * in dnet_oplock() and dnet_oplock_batch()
+ */
+uint64_t dnet_oplock_wait_time(void);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <signal.h>
 
+#include "access_context.h"
 #include "elliptics.h"
 #include "backend.h"
 #include "route.h"
@@ -103,6 +104,9 @@ struct dnet_node *dnet_server_node_create(struct dnet_config_data *cfg_data)
 
 	n->config_data = cfg_data;
 
+	/* only servers handle requests, clients print access logs of their own requests synchronously */
+	n->access_writer = dnet_access_writer_create(n);
+
 	err = dnet_backends_init(n);
 	if (err)
 		goto err_out_node_destroy;
@@ -237,5 +241,6 @@ void dnet_server_node_destroy(struct dnet_node *n)
 
 	dnet_config_data_destroy(n->config_data);
 
+	dnet_access_writer_destroy(n->access_writer);
 	free(n);
 }
@@ -27,9 +27,6 @@
 #include "library/backend.h"
 #include "library/request_queue.h"
 
-#include "rapidjson/document.h"
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
 #include "cache/cache.hpp"
 
 namespace ioremap { namespace monitor {
@@ -41,25 +38,38 @@ backends_stat_provider::backends_stat_provider(struct dnet_node *node)
 /*
  * Generates json statistics from backends in accordance with the request
  */
-void backends_stat_provider::statistics(const request &request,
-                                        rapidjson::Value &value,
-                                        rapidjson::Document::AllocatorType &allocator) const {
-	if (!(request.categories & (DNET_MONITOR_IO | DNET_MONITOR_CACHE | DNET_MONITOR_BACKEND)))
+void backends_stat_provider::write_statistics(const request &request, json_writer &writer) const {
+	if (!(request.categories & (DNET_MONITOR_IO | DNET_MONITOR_CACHE | DNET_MONITOR_BACKEND | DNET_MONITOR_LATENCY))) {
+		writer.Null();
 		return;
+	}
 
-	m_node->io->backends_manager->statistics(request, value, allocator);
+	m_node->io->backends_manager->statistics(request, writer);
+}
+
+void backends_stat_provider::metrics(const request &request, metrics_writer &writer) const {
+	if (!(request.categories & (DNET_MONITOR_IO | DNET_MONITOR_COMMANDS | DNET_MONITOR_BACKEND |
+	                            DNET_MONITOR_LATENCY)))
+		return;
+
+	m_node->io->backends_manager->metrics(request, writer);
 }
 
 }} /* namespace ioremap::monitor */
 
 void dnet_backend_command_stats_update(struct dnet_backend *backend,
                                        struct dnet_cmd *cmd,
-                                       uint64_t size,
-                                       int handled_in_cache,
-                                       int err,
-                                       long diff) {
+                                       const struct dnet_cmd_stats *cmd_stats,
+                                       int err) {
+	using namespace ioremap::monitor;
+
 	if (!backend)
 		return;
 
-	backend->command_stats().command_counter(cmd->cmd, cmd->trans, err, handled_in_cache, size, diff);
+	auto &stats = backend->command_stats();
+	stats.command_counter(cmd->cmd, cmd->trans, err, cmd_stats->handled_in_cache, cmd_stats->size,
+	                      cmd_stats->handle_time);
+	stats.latency_counter(cmd->cmd, cmd_stats->handled_in_cache, handle_latency, cmd_stats->handle_time);
+	stats.latency_counter(cmd->cmd, cmd_stats->handled_in_cache, queue_latency, cmd_stats->queue_time);
+	stats.latency_counter(cmd->cmd, cmd_stats->handled_in_cache, recv_latency, cmd_stats->recv_time);
 }
@@ -0,0 +1,107 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_CACHE_ALIGNED_HPP
+#define __DNET_MONITOR_CACHE_ALIGNED_HPP
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ioremap { namespace monitor {
+
+/*
+ * Objects updated by different threads are aligned to cache lines by alignas(cache_line_size).
+ * Operator new of gnu++0x doesn't honour alignment above alignof(max_align_t), so such objects
+ * are allocated by posix_memalign() and constructed in place by the helpers below.
+ */
+static const size_t cache_line_size = 64;
+
+/*!
+ * Destroys objects allocated by make_cache_aligned() and make_cache_aligned_array()
+ */
+template <typename T>
+class cache_aligned_deleter {
+public:
+	explicit cache_aligned_deleter(size_t count = 1) : m_count(count) {}
+
+	void operator()(T *objects) const {
+		if (!objects)
+			return;
+		for (size_t i = m_count; i > 0; --i)
+			objects[i - 1].~T();
+		free(objects);
+	}
+
+private:
+	size_t m_count;
+};
+
+template <typename T>
+using cache_aligned_ptr = std::unique_ptr<T, cache_aligned_deleter<T>>;
+
+template <typename T>
+using cache_aligned_array = std::unique_ptr<T[], cache_aligned_deleter<T>>;
+
+/*!
+ * Allocates \a count objects of \a T at a cache line boundary without constructing them
+ */
+template <typename T>
+T *allocate_cache_aligned(size_t count) {
+	static_assert(alignof(T) <= cache_line_size, "T is aligned stricter than cache line");
+
+	void *memory = nullptr;
+	if (posix_memalign(&memory, cache_line_size, sizeof(T) * count))
+		throw std::bad_alloc();
+	return static_cast<T *>(memory);
+}
+
+/*!
+ * Creates \a T from \a args at a cache line boundary, value-initializes it if \a args are empty
+ */
+template <typename T, typename... Args>
+cache_aligned_ptr<T> make_cache_aligned(Args &&...args) {
+	T *memory = allocate_cache_aligned<T>(1);
+	try {
+		return cache_aligned_ptr<T>(new (memory) T(std::forward<Args>(args)...));
+	} catch (...) {
+		free(memory);
+		throw;
+	}
+}
+
+/*!
+ * Creates array of \a count value-initialized objects of \a T starting at a cache line boundary
+ */
+template <typename T>
+cache_aligned_array<T> make_cache_aligned_array(size_t count) {
+	T *objects = allocate_cache_aligned<T>(count);
+	size_t constructed = 0;
+	try {
+		for (; constructed < count; ++constructed)
+			new (objects + constructed) T();
+	} catch (...) {
+		cache_aligned_deleter<T>{constructed}(objects);
+		throw;
+	}
+	return cache_aligned_array<T>(objects, cache_aligned_deleter<T>(count));
+}
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_CACHE_ALIGNED_HPP */
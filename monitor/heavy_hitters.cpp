@@ -0,0 +1,175 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "heavy_hitters.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ioremap { namespace monitor {
+
+static size_t slots_count(size_t capacity) {
+	// load factor of the table doesn't exceed 1/2, so probe sequences stay short
+	size_t count = 2;
+	while (count < capacity * 2)
+		count <<= 1;
+	return count;
+}
+
+static bool id_equal(const dnet_id &lhs, const dnet_id &rhs) {
+	return lhs.group_id == rhs.group_id && memcmp(lhs.id, rhs.id, DNET_ID_SIZE) == 0;
+}
+
+const uint32_t space_saving::empty_slot;
+
+space_saving::space_saving(size_t capacity)
+: m_capacity(std::max<size_t>(capacity, 1))
+, m_mask(slots_count(m_capacity) - 1)
+, m_total(0) {
+	m_items.reserve(m_capacity);
+	m_item_slots.reserve(m_capacity);
+	m_slots.assign(m_mask + 1, empty_slot);
+}
+
+size_t space_saving::item_size() {
+	return sizeof(item) + sizeof(uint32_t) * 3;
+}
+
+void space_saving::add(const dnet_id &id, double weight, double secondary, time_t time) {
+	m_total += weight;
+
+	size_t slot = find_slot(id);
+	if (m_slots[slot] != empty_slot) {
+		const size_t index = m_slots[slot];
+		auto &current = m_items[index];
+		current.count += weight;
+		current.secondary += secondary;
+		current.last_access = time;
+		sift_down(index);
+		return;
+	}
+
+	if (!full()) {
+		const size_t index = m_items.size();
+		m_items.push_back(item{id, weight, 0., secondary, time});
+		m_item_slots.push_back(slot);
+		m_slots[slot] = index;
+		sift_up(index);
+		return;
+	}
+
+	// replace the key with the smallest count, its count bounds weight of the new key accumulated before
+	auto &victim = m_items.front();
+	erase_slot(m_item_slots.front());
+	slot = find_slot(id);
+
+	const double min = victim.count;
+	victim = item{id, min + weight, min, secondary, time};
+	m_item_slots.front() = slot;
+	m_slots[slot] = 0;
+	sift_down(0);
+}
+
+void space_saving::decay(double factor) {
+	m_total *= factor;
+	for (auto &current : m_items) {
+		current.count *= factor;
+		current.error *= factor;
+		current.secondary *= factor;
+	}
+}
+
+void space_saving::clear() {
+	m_total = 0;
+	m_items.clear();
+	m_item_slots.clear();
+	std::fill(m_slots.begin(), m_slots.end(), empty_slot);
+}
+
+size_t space_saving::home_slot(const dnet_id &id) const {
+	// ids are hashes already, so their first bytes are mixed only with the group
+	uint64_t hash;
+	memcpy(&hash, id.id, sizeof(hash));
+	hash ^= id.group_id;
+	hash *= 0x9e3779b97f4a7c15ULL;
+	return (hash >> 32) & m_mask;
+}
+
+size_t space_saving::find_slot(const dnet_id &id) const {
+	size_t slot = home_slot(id);
+	while (m_slots[slot] != empty_slot && !id_equal(m_items[m_slots[slot]].id, id))
+		slot = (slot + 1) & m_mask;
+	return slot;
+}
+
+void space_saving::erase_slot(size_t slot) {
+	// backward shift deletion: move back keys whose probe sequence passes through the freed slot
+	size_t next = slot;
+	while (true) {
+		next = (next + 1) & m_mask;
+		if (m_slots[next] == empty_slot)
+			break;
+
+		const size_t home = home_slot(m_items[m_slots[next]].id);
+		const bool movable = (slot <= next) ? (home <= slot || home > next) : (home <= slot && home > next);
+		if (!movable)
+			continue;
+
+		m_slots[slot] = m_slots[next];
+		m_item_slots[m_slots[slot]] = slot;
+		slot = next;
+	}
+	m_slots[slot] = empty_slot;
+}
+
+void space_saving::swap_items(size_t lhs, size_t rhs) {
+	std::swap(m_items[lhs], m_items[rhs]);
+	std::swap(m_item_slots[lhs], m_item_slots[rhs]);
+	m_slots[m_item_slots[lhs]] = lhs;
+	m_slots[m_item_slots[rhs]] = rhs;
+}
+
+void space_saving::sift_up(size_t index) {
+	while (index > 0) {
+		const size_t parent = (index - 1) / 2;
+		if (m_items[parent].count <= m_items[index].count)
+			break;
+		swap_items(parent, index);
+		index = parent;
+	}
+}
+
+void space_saving::sift_down(size_t index) {
+	const size_t size = m_items.size();
+	while (true) {
+		size_t smallest = index;
+		const size_t left = index * 2 + 1;
+		const size_t right = left + 1;
+
+		if (left < size && m_items[left].count < m_items[smallest].count)
+			smallest = left;
+		if (right < size && m_items[right].count < m_items[smallest].count)
+			smallest = right;
+		if (smallest == index)
+			break;
+
+		swap_items(index, smallest);
+		index = smallest;
+	}
+}
+
+}} /* namespace ioremap::monitor */
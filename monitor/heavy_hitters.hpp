@@ -0,0 +1,97 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_HEAVY_HITTERS_HPP
+#define __DNET_MONITOR_HEAVY_HITTERS_HPP
+
+#include <ctime>
+#include <vector>
+
+#include "elliptics/packet.h"
+
+namespace ioremap { namespace monitor {
+
+/*
+ * Space-Saving summary of keys with the largest weights.
+ *
+ * At most capacity keys are tracked. A key which is not tracked replaces the key with the smallest
+ * count and inherits that count as its error, so count of any tracked key overestimates its real weight
+ * by at most error, and any key whose weight exceeds total() / capacity is tracked.
+ *
+ * Keys are kept in min-heap by count and are found by open addressing hash table of heap positions,
+ * both are allocated once in the constructor, so the summary never allocates memory afterwards.
+ * The summary is not synchronized.
+ */
+class space_saving {
+public:
+	struct item {
+		dnet_id		id;
+		/* estimated weight of the key, it is greater than the real one by at most error */
+		double		count;
+		double		error;
+		/* weight of another kind (e.g. number of operations for bytes) accounted while the key is tracked */
+		double		secondary;
+		time_t		last_access;
+	};
+
+	explicit space_saving(size_t capacity);
+
+	/* adds \a weight and \a secondary weight to \a id accessed at \a time */
+	void add(const dnet_id &id, double weight, double secondary, time_t time);
+
+	/* multiplies all counts, errors and total by \a factor, relative order of keys isn't changed */
+	void decay(double factor);
+
+	void clear();
+
+	size_t size() const { return m_items.size(); }
+	size_t capacity() const { return m_capacity; }
+	bool full() const { return m_items.size() == m_capacity; }
+	/* sum of all added weights */
+	double total() const { return m_total; }
+	/* the smallest count, any key which is not tracked has weight not greater than it */
+	double min_count() const { return m_items.empty() ? 0. : m_items.front().count; }
+	/* tracked keys in heap order */
+	const std::vector<item> &items() const { return m_items; }
+
+	/* approximate memory used by a single tracked key */
+	static size_t item_size();
+
+private:
+	/* returns slot of \a id or the empty slot where it should be placed */
+	size_t find_slot(const dnet_id &id) const;
+	size_t home_slot(const dnet_id &id) const;
+	void erase_slot(size_t slot);
+	void swap_items(size_t lhs, size_t rhs);
+	void sift_up(size_t index);
+	void sift_down(size_t index);
+
+	static const uint32_t empty_slot = ~0U;
+
+	const size_t		m_capacity;
+	const size_t		m_mask;
+	double			m_total;
+	std::vector<item>	m_items;
+	/* hash slot of every item in m_items */
+	std::vector<uint32_t>	m_item_slots;
+	/* index of item in m_items or empty_slot */
+	std::vector<uint32_t>	m_slots;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_HEAVY_HITTERS_HPP */
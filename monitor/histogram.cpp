@@ -0,0 +1,139 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ioremap { namespace monitor {
+
+const int latency_histogram::sub_bits;
+const int latency_histogram::max_bits;
+const size_t latency_histogram::sub_count;
+const size_t latency_histogram::buckets_count;
+
+latency_histogram::latency_histogram() {
+	clear();
+}
+
+void latency_histogram::clear() {
+	for (auto &bucket : m_buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_sum.store(0, std::memory_order_relaxed);
+}
+
+void latency_histogram::merge_to(histogram_snapshot &snapshot) const {
+	for (size_t i = 0; i < buckets_count; ++i) {
+		snapshot.m_buckets[i] += m_buckets[i].load(std::memory_order_relaxed);
+	}
+	snapshot.m_sum += m_sum.load(std::memory_order_relaxed);
+}
+
+size_t latency_histogram::bucket_index(uint64_t value) {
+	if (value < sub_count)
+		return value;
+
+	const int msb = 63 - __builtin_clzll(value);
+	if (msb >= max_bits)
+		return buckets_count - 1;
+
+	/* the power of two is selected by msb, the linear bucket within it - by the next sub_bits bits */
+	const size_t exponent = msb - sub_bits + 1;
+	const size_t sub = (value >> (msb - sub_bits)) - sub_count;
+	return exponent * sub_count + sub;
+}
+
+uint64_t latency_histogram::bucket_upper_bound(size_t index) {
+	if (index < sub_count)
+		return index;
+
+	const size_t exponent = index / sub_count;
+	const size_t sub = index % sub_count;
+	const size_t shift = exponent - 1;
+	return ((sub_count + sub) << shift) + (1ULL << shift) - 1;
+}
+
+histogram_snapshot::histogram_snapshot()
+: m_buckets(latency_histogram::buckets_count, 0)
+, m_sum(0) {
+}
+
+bool histogram_snapshot::empty() const {
+	return count() == 0;
+}
+
+uint64_t histogram_snapshot::count() const {
+	uint64_t res = 0;
+	for (const auto &bucket : m_buckets) {
+		res += bucket;
+	}
+	return res;
+}
+
+uint64_t histogram_snapshot::percentile(double quantile) const {
+	const uint64_t total = count();
+	if (!total)
+		return 0;
+
+	const uint64_t rank = std::max<uint64_t>(1, std::ceil(quantile * total));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < m_buckets.size(); ++i) {
+		seen += m_buckets[i];
+		if (seen >= rank)
+			return latency_histogram::bucket_upper_bound(i);
+	}
+	return latency_histogram::bucket_upper_bound(m_buckets.size() - 1);
+}
+
+void histogram_snapshot::to_json(json_writer &writer) const {
+	uint64_t total = 0;
+	uint64_t max = 0;
+	for (size_t i = 0; i < m_buckets.size(); ++i) {
+		if (!m_buckets[i])
+			continue;
+
+		total += m_buckets[i];
+		max = latency_histogram::bucket_upper_bound(i);
+	}
+
+	writer.StartObject();
+	write_member(writer, "count", total);
+	write_member(writer, "sum", m_sum);
+	write_member(writer, "max", max);
+	write_member(writer, "p50", percentile(0.5));
+	write_member(writer, "p90", percentile(0.9));
+	write_member(writer, "p99", percentile(0.99));
+	write_member(writer, "p999", percentile(0.999));
+
+	writer.String("buckets");
+	writer.StartArray();
+	for (size_t i = 0; i < m_buckets.size(); ++i) {
+		if (!m_buckets[i])
+			continue;
+
+		writer.StartArray();
+		writer.Uint64(latency_histogram::bucket_upper_bound(i));
+		writer.Uint64(m_buckets[i]);
+		writer.EndArray();
+	}
+	writer.EndArray();
+	writer.EndObject();
+}
+
+}} /* namespace ioremap::monitor */
@@ -0,0 +1,97 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_HISTOGRAM_HPP
+#define __DNET_MONITOR_HISTOGRAM_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "json_writer.hpp"
+
+namespace ioremap { namespace monitor {
+
+class histogram_snapshot;
+
+/*
+ * Log-linear histogram of latencies in usecs with fixed memory (HDR-like).
+ * Values below 2^sub_bits are counted exactly, every further power of two is split into 2^sub_bits
+ * linear buckets, so the width of a bucket never exceeds 1/2^sub_bits of its values.
+ * Values of 2^max_bits usecs and more are counted in the last bucket.
+ *
+ * Buckets are relaxed atomics, so histogram can be updated without locks, and snapshots
+ * of several histograms (e.g. per-thread ones) are merged by summing up their buckets.
+ */
+class latency_histogram {
+public:
+	static const int sub_bits = 4;
+	static const int max_bits = 36;
+	static const size_t sub_count = 1 << sub_bits;
+	static const size_t buckets_count = (max_bits - sub_bits + 1) * sub_count;
+
+	latency_histogram();
+
+	void add(uint64_t value) {
+		m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+		m_sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void clear();
+
+	/* adds buckets of the histogram to \a snapshot */
+	void merge_to(histogram_snapshot &snapshot) const;
+
+	static size_t bucket_index(uint64_t value);
+	/* returns the largest value counted by bucket \a index */
+	static uint64_t bucket_upper_bound(size_t index);
+
+private:
+	std::atomic<uint64_t> m_buckets[buckets_count];
+	std::atomic<uint64_t> m_sum;
+};
+
+/*
+ * Plain copy of latency_histogram buckets which is used for merging and reporting.
+ */
+class histogram_snapshot {
+public:
+	histogram_snapshot();
+
+	bool empty() const;
+	uint64_t count() const;
+	/* returns exact sum of all values */
+	uint64_t sum() const { return m_sum; }
+	const std::vector<uint64_t> &buckets() const { return m_buckets; }
+	/* returns upper bound of the bucket which contains \a quantile (0..1] of values, 0 if it is empty */
+	uint64_t percentile(double quantile) const;
+
+	/*
+	 * Writes object with count, sum, max, p50, p90, p99, p999 and non-empty buckets
+	 * as [upper bound, count] pairs to \a writer.
+	 */
+	void to_json(json_writer &writer) const;
+
+private:
+	friend class latency_histogram;
+
+	std::vector<uint64_t> m_buckets;
+	uint64_t m_sum;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_HISTOGRAM_HPP */
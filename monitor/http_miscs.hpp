@@ -40,6 +40,9 @@ const std::string list = R"(<html>
 		GET <a href='/stats'>/stats</a> - Retrieves in-process runtime statistics<br/>
 		GET <a href='/procfs'>/procfs</a> - Retrieves system statistics about process<br/>
 		GET <a href='/top'>/top</a> - Retrieves statistics of top keys ordered by generated traffic<br/>
+		GET <a href='/latency'>/latency</a> - Retrieves histograms of commands latencies<br/>
+		GET <a href='/samples'>/samples</a> - Retrieves timings of sampled requests split by stages<br/>
+		GET <a href='/metrics'>/metrics</a> - Retrieves statistics in Prometheus text format, can be filtered by ?category=commands,io<br/>
 	</body>
 </html>)";
 }
@@ -65,6 +68,21 @@ std::string make_reply(uint64_t categories, std::string content = "") {
 	return ret.str();
 }
 
+/*!
+ * Generates HTTP response with @content in Prometheus text format
+ */
+std::string make_metrics_reply(const std::string &content) {
+	std::ostringstream ret;
+
+	ret << status_strings::ok
+	    << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+	    << "Connection: close\r\n"
+	    << "Content-Length: " << content.size() << "\r\n\r\n"
+	    << content;
+
+	return ret.str();
+}
+
 }} /* namespace ioremap::monitor */
 
 #endif /* __DNET_MONITOR_HTTP_MISCS_H */
@@ -25,58 +25,189 @@
 
 namespace ioremap { namespace monitor {
 
-// fill @value with all states' statistics
-static rapidjson::Value & fill_states_stats(struct dnet_node *n,
-                                            rapidjson::Value &value,
-                                            rapidjson::Document::AllocatorType &allocator) {
+// returns number of threads of @place and updates their utilization, @place should be locked
+static int update_pool_utilization(struct dnet_work_pool_place &place) {
+	auto pool = place.pool;
+	if (!pool)
+		return 0;
+
+	const uint64_t now = dnet_thread_stats_now();
+	uint64_t time[__DNET_THREAD_STATE_MAX] = {0};
+	for (int i = 0; i < pool->num; ++i) {
+		dnet_thread_stats_sum(&pool->wio_list[i].stats, now, time);
+	}
+	dnet_thread_utilization_update(&pool->utilization, time, now);
+	return pool->num;
+}
+
+// returns utilization of net threads of @io, stats of threads are read without locks
+static dnet_thread_utilization update_net_utilization(struct dnet_io *io) {
+	const uint64_t now = dnet_thread_stats_now();
+	uint64_t time[__DNET_THREAD_STATE_MAX] = {0};
+	for (int i = 0; i < io->net_thread_num; ++i) {
+		dnet_thread_stats_sum(&io->net[i].stats, now, time);
+	}
+
+	pthread_mutex_lock(&io->net_utilization_lock);
+	dnet_thread_utilization_update(&io->net_utilization, time, now);
+	const auto utilization = io->net_utilization;
+	pthread_mutex_unlock(&io->net_utilization_lock);
+	return utilization;
+}
+
+// writes utilization members to the currently opened object
+static void dump_utilization(const dnet_thread_utilization &utilization, int threads, json_writer &writer) {
+	write_member(writer, "threads", threads);
+
+	writer.String("utilization");
+	writer.StartObject();
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		write_member(writer, dnet_thread_state_str(i), utilization.ratio[i]);
+	}
+	writer.EndObject();
+
+	writer.String("time");
+	writer.StartObject();
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		write_member(writer, dnet_thread_state_str(i), utilization.time[i] / 1000);
+	}
+	writer.EndObject();
+}
+
+static void dump_place_stats(struct dnet_work_pool_place &place, json_writer &writer) {
+	pthread_mutex_lock(&place.lock);
+	const size_t current_size = dnet_get_pool_queue_size(place.pool);
+
+	const int threads = update_pool_utilization(place);
+	dnet_thread_utilization utilization;
+	memset(&utilization, 0, sizeof(utilization));
+	if (place.pool)
+		utilization = place.pool->utilization;
+	pthread_mutex_unlock(&place.lock);
+
+	writer.StartObject();
+	write_member(writer, "current_size", current_size);
+	dump_utilization(utilization, threads, writer);
+	writer.EndObject();
+}
+
+static void write_place_metrics(struct dnet_work_pool_place &place, const metric_labels &labels,
+                                metrics_writer &writer) {
+	pthread_mutex_lock(&place.lock);
+	writer.gauge("elliptics_io_queue_size", "Number of requests in io queue", labels,
+	             dnet_get_pool_queue_size(place.pool));
+
+	update_pool_utilization(place);
+	dnet_thread_utilization utilization;
+	memset(&utilization, 0, sizeof(utilization));
+	if (place.pool)
+		utilization = place.pool->utilization;
+	pthread_mutex_unlock(&place.lock);
+
+	metric_labels state_labels(labels);
+	state_labels.push_back({"state", ""});
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		state_labels.back().value = dnet_thread_state_str(i);
+		writer.gauge("elliptics_io_thread_utilization", "Fraction of io threads' time spent in the state",
+		             state_labels, utilization.ratio[i]);
+	}
+}
+
+// write all states' statistics to @writer
+static void fill_states_stats(struct dnet_node *n, json_writer &writer) {
+	writer.StartObject();
 	pthread_mutex_lock(&n->state_lock);
 	struct dnet_net_state *st;
 	list_for_each_entry(st, &n->empty_state_list, node_entry) {
-		rapidjson::Value state(rapidjson::kObjectType);
-		state.AddMember("send_queue_size", atomic_read(&st->send_queue_size), allocator);
-		state.AddMember("la", st->la, allocator);
-		state.AddMember("free", (uint64_t)st->free, allocator);
-		state.AddMember("stall", st->stall, allocator);
-		state.AddMember("join_state", st->__join_state, allocator);
-		value.AddMember(dnet_addr_string(&st->addr), allocator, state, allocator);
+		writer.String(dnet_addr_string(&st->addr));
+		writer.StartObject();
+		write_member(writer, "send_queue_size", atomic_read(&st->send_queue_size));
+		write_member(writer, "send_queue_bytes", atomic_read(&st->send_queue_bytes));
+		write_member(writer, "la", st->la);
+		write_member(writer, "free", (uint64_t)st->free);
+		write_member(writer, "stall", st->stall);
+		write_member(writer, "join_state", st->__join_state);
+		writer.EndObject();
 	}
 	pthread_mutex_unlock(&n->state_lock);
+	writer.EndObject();
+}
+
+void io_stat_provider::write_statistics(const request &request, json_writer &writer) const {
+	if (!(request.categories & DNET_MONITOR_IO)) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+	dump_io_pool_stats(m_node->io->pool, writer);
 
-	return value;
+	writer.String("output");
+	writer.StartObject();
+	write_member(writer, "current_size", m_node->io->output_stats.list_size);
+	writer.EndObject();
+
+	writer.String("states");
+	fill_states_stats(m_node, writer);
+	write_member(writer, "blocked", m_node->io->blocked == 1);
+
+	const auto net_utilization = update_net_utilization(m_node->io);
+
+	writer.String("net");
+	writer.StartObject();
+	dump_utilization(net_utilization, m_node->io->net_thread_num, writer);
+	writer.EndObject();
+
+	writer.String("pools");
+	writer.StartObject();
+	dnet_io_pools_fill_stats(m_node, writer);
+	writer.EndObject();
+	writer.EndObject();
 }
 
-void io_stat_provider::statistics(const request &request,
-                                  rapidjson::Value &value,
-                                  rapidjson::Document::AllocatorType &allocator) const {
+void io_stat_provider::metrics(const request &request, metrics_writer &writer) const {
 	if (!(request.categories & DNET_MONITOR_IO))
 		return;
 
-	value.SetObject();
-	dump_io_pool_stats(m_node->io->pool, value, allocator);
+	write_io_pool_metrics(m_node->io->pool, metric_labels(), writer);
+	writer.gauge("elliptics_io_output_queue_size", "Number of requests in output queue", {},
+	             m_node->io->output_stats.list_size);
+	writer.gauge("elliptics_io_blocked", "Whether io is blocked", {}, m_node->io->blocked == 1);
 
-	rapidjson::Value output(rapidjson::kObjectType);
-	output.AddMember("current_size", m_node->io->output_stats.list_size, allocator);
-	value.AddMember("output", output, allocator);
+	const auto net_utilization = update_net_utilization(m_node->io);
 
-	rapidjson::Value states(rapidjson::kObjectType);
-	value.AddMember("states", fill_states_stats(m_node, states, allocator), allocator);
-	value.AddMember("blocked", m_node->io->blocked == 1, allocator);
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		writer.gauge("elliptics_net_thread_utilization", "Fraction of net threads' time spent in the state",
+		             {{"state", dnet_thread_state_str(i)}}, net_utilization.ratio[i]);
+	}
+
+	pthread_mutex_lock(&m_node->state_lock);
+	struct dnet_net_state *st;
+	list_for_each_entry(st, &m_node->empty_state_list, node_entry) {
+		const metric_labels labels = {{"addr", dnet_addr_string(&st->addr)}};
+		writer.gauge("elliptics_state_send_queue_size", "Number of replies in send queue of the state",
+		             labels, atomic_read(&st->send_queue_size));
+		writer.gauge("elliptics_state_send_queue_bytes", "Bytes of batched replies buffered in send queue of the state",
+		             labels, atomic_read(&st->send_queue_bytes));
+		writer.gauge("elliptics_state_la", "Load average of the state", labels, st->la);
+	}
+	pthread_mutex_unlock(&m_node->state_lock);
+}
 
-	rapidjson::Value pools(rapidjson::kObjectType);
-	dnet_io_pools_fill_stats(m_node, pools, allocator);
-	value.AddMember("pools", pools, allocator);
+void write_io_pool_metrics(struct dnet_io_pool &io_pool, const metric_labels &labels, metrics_writer &writer) {
+	metric_labels sample_labels(labels);
+	sample_labels.push_back({"pool", "blocking"});
+	write_place_metrics(io_pool.recv_pool, sample_labels, writer);
+	sample_labels.back().value = "nonblocking";
+	write_place_metrics(io_pool.recv_pool_nb, sample_labels, writer);
 }
 
-void dump_io_pool_stats(struct dnet_io_pool &io_pool,
-                        rapidjson::Value &value,
-                        rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value blocking(rapidjson::kObjectType);
-	blocking.AddMember("current_size", dnet_get_pool_queue_size(io_pool.recv_pool.pool), allocator);
-	value.AddMember("blocking", blocking, allocator);
+void dump_io_pool_stats(struct dnet_io_pool &io_pool, json_writer &writer) {
+	writer.String("blocking");
+	dump_place_stats(io_pool.recv_pool, writer);
 
-	rapidjson::Value nonblocking(rapidjson::kObjectType);
-	nonblocking.AddMember("current_size", dnet_get_pool_queue_size(io_pool.recv_pool_nb.pool), allocator);
-	value.AddMember("nonblocking", nonblocking, allocator);
+	writer.String("nonblocking");
+	dump_place_stats(io_pool.recv_pool_nb, writer);
 }
 
 }} /* namespace ioremap::monitor */
@@ -20,6 +20,7 @@
 #ifndef __DNET_MONITOR_IO_STAT_PROVIDER_HPP
 #define __DNET_MONITOR_IO_STAT_PROVIDER_HPP
 
+#include "metrics.hpp"
 #include "stat_provider.hpp"
 
 struct dnet_node;
@@ -31,17 +32,19 @@ class io_stat_provider: public stat_provider {
 public:
 	io_stat_provider(dnet_node *n): m_node(n) {}
 
-	void statistics(const request &request,
-	                rapidjson::Value &value,
-	                rapidjson::Document::AllocatorType &allocator) const override;
+	void write_statistics(const request &request, json_writer &writer) const override;
+
+	void metrics(const request &request, metrics_writer &writer) const override;
 
 private:
 	dnet_node *m_node;
 };
 
-void dump_io_pool_stats(struct dnet_io_pool &io_pool,
-                        rapidjson::Value &value,
-                        rapidjson::Document::AllocatorType &allocator);
+// writes statistics of @io_pool's blocking and nonblocking pools as members of the currently opened object
+void dump_io_pool_stats(struct dnet_io_pool &io_pool, json_writer &writer);
+
+// writes queue sizes of @io_pool to @writer, every sample gets @labels in addition to its own ones
+void write_io_pool_metrics(struct dnet_io_pool &io_pool, const metric_labels &labels, metrics_writer &writer);
 }} /* namespace ioremap::monitor */
 
 #endif /* __DNET_MONITOR_IO_STAT_PROVIDER_HPP */
@@ -0,0 +1,156 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_JSON_WRITER_HPP
+#define __DNET_MONITOR_JSON_WRITER_HPP
+
+#include <string>
+#include <type_traits>
+
+#include "rapidjson/reader.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "library/protocol.hpp"
+
+namespace ioremap { namespace monitor {
+
+/*
+ * Streaming writer of statistics.
+ *
+ * Values are formatted right into the output buffer, so generating statistics doesn't build
+ * any document and doesn't allocate memory for every counter. Members are written as a name
+ * followed by its value, objects and arrays are opened and closed explicitly.
+ */
+typedef rapidjson::Writer<rapidjson::StringBuffer> json_writer;
+
+inline void write_value(json_writer &writer, bool value) {
+	writer.Bool(value);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+write_value(json_writer &writer, T value) {
+	writer.Int64(value);
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value && !std::is_same<T, bool>::value>::type
+write_value(json_writer &writer, T value) {
+	writer.Uint64(value);
+}
+
+inline void write_value(json_writer &writer, double value) {
+	writer.Double(value);
+}
+
+inline void write_value(json_writer &writer, const char *value) {
+	writer.String(value);
+}
+
+inline void write_value(json_writer &writer, const std::string &value) {
+	writer.String(value.c_str(), value.size());
+}
+
+/*
+ * Writes member named @name with @value to the currently opened object
+ */
+template <typename T>
+void write_member(json_writer &writer, const char *name, const T &value) {
+	writer.String(name);
+	write_value(writer, value);
+}
+
+/*
+ * Writes zero-terminated json document @json of @size bytes to @handler (e.g. json_writer) event by event.
+ * @json is validated first by the scanner which is as strict as the reader, so nothing is written
+ * and false is returned if it isn't a json object.
+ */
+template <typename Handler>
+bool copy_json(const char *json, size_t size, Handler &handler) {
+	if (!json || !size)
+		return false;
+
+	try {
+		elliptics::validate_json(json, size);
+	} catch (const std::exception &) {
+		return false;
+	}
+
+	rapidjson::StringStream stream(json);
+	rapidjson::Reader reader;
+	return reader.Parse<0>(stream, handler);
+}
+
+/*
+ * Reader handler which writes members of the parsed json object to the object currently opened in @writer:
+ * braces of the outermost object are skipped, all other events are passed to @writer as is.
+ */
+class json_members_writer {
+public:
+	typedef char Ch;
+
+	explicit json_members_writer(json_writer &writer)
+	: m_writer(writer)
+	, m_depth(0) {}
+
+	void Null() { m_writer.Null(); }
+	void Bool(bool value) { m_writer.Bool(value); }
+	void Int(int value) { m_writer.Int(value); }
+	void Uint(unsigned value) { m_writer.Uint(value); }
+	void Int64(int64_t value) { m_writer.Int64(value); }
+	void Uint64(uint64_t value) { m_writer.Uint64(value); }
+	void Double(double value) { m_writer.Double(value); }
+	void String(const Ch *str, rapidjson::SizeType length, bool copy) { m_writer.String(str, length, copy); }
+
+	void StartObject() {
+		if (m_depth++)
+			m_writer.StartObject();
+	}
+
+	void EndObject(rapidjson::SizeType count) {
+		if (--m_depth)
+			m_writer.EndObject(count);
+	}
+
+	void StartArray() {
+		++m_depth;
+		m_writer.StartArray();
+	}
+
+	void EndArray(rapidjson::SizeType count) {
+		--m_depth;
+		m_writer.EndArray(count);
+	}
+
+private:
+	json_writer &m_writer;
+	size_t m_depth;
+};
+
+/*
+ * Writes members of zero-terminated json object @json of @size bytes to the object currently opened in @writer.
+ * Like copy_json() nothing is written and false is returned if @json isn't a json object.
+ */
+inline bool copy_json_members(const char *json, size_t size, json_writer &writer) {
+	json_members_writer handler(writer);
+	return copy_json(json, size, handler);
+}
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_JSON_WRITER_HPP */
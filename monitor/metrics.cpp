@@ -0,0 +1,161 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.hpp"
+
+#include <cstdio>
+
+#include "histogram.hpp"
+
+namespace ioremap { namespace monitor {
+
+static void append_escaped(std::string &out, const std::string &value) {
+	for (const char c : value) {
+		switch (c) {
+		case '\\':
+			out += "\\\\";
+			break;
+		case '"':
+			out += "\\\"";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		default:
+			out += c;
+		}
+	}
+}
+
+static void append_sample(std::string &out, const char *name, const char *suffix, const metric_labels &labels,
+                          const char *le = nullptr) {
+	out += name;
+	out += suffix;
+
+	if (labels.empty() && !le) {
+		out += ' ';
+		return;
+	}
+
+	out += '{';
+	bool first = true;
+	for (const auto &label : labels) {
+		if (!first)
+			out += ',';
+		first = false;
+
+		out += label.name;
+		out += "=\"";
+		append_escaped(out, label.value);
+		out += '"';
+	}
+	if (le) {
+		if (!first)
+			out += ',';
+		out += "le=\"";
+		out += le;
+		out += '"';
+	}
+	out += "} ";
+}
+
+static void append_value(std::string &out, uint64_t value) {
+	char buffer[32];
+	const int size = snprintf(buffer, sizeof(buffer), "%llu\n", (unsigned long long)value);
+	out.append(buffer, size);
+}
+
+static void append_value(std::string &out, double value) {
+	char buffer[32];
+	const int size = snprintf(buffer, sizeof(buffer), "%.17g\n", value);
+	out.append(buffer, size);
+}
+
+std::string &metrics_writer::family(const char *name, const char *type, const char *help) {
+	auto it = m_indexes.find(name);
+	if (it != m_indexes.end())
+		return m_families[it->second];
+
+	m_indexes.emplace(name, m_families.size());
+	m_families.emplace_back();
+
+	auto &text = m_families.back();
+	text += "# HELP ";
+	text += name;
+	text += ' ';
+	text += help;
+	text += "\n# TYPE ";
+	text += name;
+	text += ' ';
+	text += type;
+	text += '\n';
+	return text;
+}
+
+void metrics_writer::counter(const char *name, const char *help, const metric_labels &labels, uint64_t value) {
+	auto &text = family(name, "counter", help);
+	append_sample(text, name, "", labels);
+	append_value(text, value);
+}
+
+void metrics_writer::gauge(const char *name, const char *help, const metric_labels &labels, double value) {
+	auto &text = family(name, "gauge", help);
+	append_sample(text, name, "", labels);
+	append_value(text, value);
+}
+
+void metrics_writer::histogram(const char *name, const char *help, const metric_labels &labels,
+                               const histogram_snapshot &snapshot) {
+	auto &text = family(name, "histogram", help);
+	const auto &buckets = snapshot.buckets();
+
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i < buckets.size(); ++i) {
+		cumulative += buckets[i];
+
+		// the last bucket also counts all too large values, so it is covered by +Inf only
+		if ((i + 1) % latency_histogram::sub_count != 0 || i + 1 == buckets.size())
+			continue;
+
+		const auto le = std::to_string(latency_histogram::bucket_upper_bound(i));
+		append_sample(text, name, "_bucket", labels, le.c_str());
+		append_value(text, cumulative);
+	}
+
+	append_sample(text, name, "_bucket", labels, "+Inf");
+	append_value(text, cumulative);
+	append_sample(text, name, "_sum", labels);
+	append_value(text, snapshot.sum());
+	append_sample(text, name, "_count", labels);
+	append_value(text, cumulative);
+}
+
+std::string metrics_writer::str() const {
+	size_t size = 0;
+	for (const auto &text : m_families) {
+		size += text.size();
+	}
+
+	std::string ret;
+	ret.reserve(size);
+	for (const auto &text : m_families) {
+		ret += text;
+	}
+	return ret;
+}
+
+}} /* namespace ioremap::monitor */
@@ -0,0 +1,72 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_METRICS_HPP
+#define __DNET_MONITOR_METRICS_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ioremap { namespace monitor {
+
+class histogram_snapshot;
+
+/*
+ * Label of metric's sample: name="value"
+ */
+struct metric_label {
+	const char *name;
+	std::string value;
+};
+
+typedef std::vector<metric_label> metric_labels;
+
+/*
+ * Writer of statistics in Prometheus text exposition format (version 0.0.4).
+ *
+ * Samples are formatted directly into text without building any intermediate document.
+ * The format requires samples of the same metric to be contiguous, so the text is kept per metric
+ * and samples of different metrics can be written interleaved (e.g. backend by backend).
+ */
+class metrics_writer {
+public:
+	void counter(const char *name, const char *help, const metric_labels &labels, uint64_t value);
+	void gauge(const char *name, const char *help, const metric_labels &labels, double value);
+
+	/*
+	 * Writes cumulative buckets bounded by every power of two, _sum and _count of \a snapshot.
+	 * Bounds don't depend on the data, so series stay the same between scrapes.
+	 */
+	void histogram(const char *name, const char *help, const metric_labels &labels,
+	               const histogram_snapshot &snapshot);
+
+	/* returns text of all written metrics */
+	std::string str() const;
+
+private:
+	/* returns text of metric \a name writing its HELP and TYPE lines on the first use */
+	std::string &family(const char *name, const char *type, const char *help);
+
+	std::vector<std::string> m_families;
+	std::unordered_map<std::string, size_t> m_indexes;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_METRICS_HPP */
@@ -69,6 +69,19 @@ std::unique_ptr<monitor_config> monitor_config::parse(const kora::config_t &moni
 		cfg->has_top = (cfg->top_length > 0) && (cfg->events_size > 0) && (cfg->period_in_seconds > 0);
 	}
 
+	cfg->has_samples = monitor.has("samples");
+	if (cfg->has_samples) {
+		const auto samples = monitor["samples"];
+		cfg->samples_size = samples.at<size_t>("size", DNET_DEFAULT_MONITOR_SAMPLES_SIZE);
+		cfg->sample_rate = samples.at<unsigned int>("sample_rate", DNET_DEFAULT_MONITOR_SAMPLE_RATE);
+		cfg->slow_threshold = samples.at<uint64_t>("slow_threshold", DNET_DEFAULT_MONITOR_SLOW_THRESHOLD);
+		cfg->has_samples = (cfg->samples_size > 0) && (cfg->sample_rate > 0 || cfg->slow_threshold > 0);
+	}
+
+	cfg->snapshot_period_ms = monitor.at<unsigned int>("snapshot_period_ms",
+	                                                   DNET_DEFAULT_MONITOR_SNAPSHOT_PERIOD_MS);
+	cfg->snapshot_history = monitor.at<size_t>("snapshot_history", DNET_DEFAULT_MONITOR_SNAPSHOT_HISTORY);
+
 	if (monitor.has("handystats"))
 		cfg->handystats = kora::to_json(monitor.underlying_object());
 	return cfg;
@@ -178,6 +191,24 @@ static void init_top_provider(struct dnet_node *n) {
 	}
 }
 
+static void init_request_samples_provider(struct dnet_node *n) {
+	try {
+		const auto monitor = get_monitor(n);
+		auto samples = monitor ? monitor->get_statistics().get_request_samples() : nullptr;
+		if (!samples) {
+			DNET_LOG_INFO(n, "monitor: request samples provider is disabled");
+			return;
+		}
+
+		add_provider(n, new request_samples_provider(samples), "samples");
+		DNET_LOG_INFO(n, "monitor: request samples provider loaded: size: {}, sample rate: {}, "
+		                 "slow threshold: {} usecs",
+		              samples->size(), samples->sample_rate(), samples->slow_threshold());
+	} catch (const std::exception &e) {
+		DNET_LOG_ERROR(n, "monitor: failed to initialize request_samples_provider: {}", e.what());
+	}
+}
+
 }} /* namespace ioremap::monitor */
 
 int dnet_monitor_init(struct dnet_node *n, struct dnet_config *cfg) {
@@ -199,6 +230,7 @@ int dnet_monitor_init(struct dnet_node *n, struct dnet_config *cfg) {
 	ioremap::monitor::init_backends_stat_provider(n);
 	ioremap::monitor::init_procfs_provider(n);
 	ioremap::monitor::init_top_provider(n);
+	ioremap::monitor::init_request_samples_provider(n);
 
 	return 0;
 }
@@ -214,16 +246,25 @@ void dnet_monitor_exit(struct dnet_node *n) {
 void dnet_monitor_stats_update(struct dnet_node *n,
                                const struct dnet_cmd *cmd,
                                const int err,
-                               const int cache,
-                               const uint32_t size,
-                               const unsigned long time) {
+                               const struct dnet_cmd_stats *cmd_stats) {
+	using namespace ioremap::monitor;
+
 	try {
-		auto real_monitor = ioremap::monitor::get_monitor(n);
+		auto real_monitor = get_monitor(n);
 		if (real_monitor) {
-			real_monitor->get_statistics().command_counter(cmd->cmd, cmd->trans, err, cache, size, time);
-			auto top_stats = real_monitor->get_statistics().get_top_stats();
+			auto &stats = real_monitor->get_statistics();
+			const int cache = cmd_stats->handled_in_cache;
+			stats.command_counter(cmd->cmd, cmd->trans, err, cache, cmd_stats->size, cmd_stats->handle_time);
+			stats.latency_counter(cmd->cmd, cache, handle_latency, cmd_stats->handle_time);
+			stats.latency_counter(cmd->cmd, cache, queue_latency, cmd_stats->queue_time);
+			stats.latency_counter(cmd->cmd, cache, recv_latency, cmd_stats->recv_time);
+			auto top_stats = stats.get_top_stats();
 			if (top_stats) {
-				top_stats->update_stats(cmd, size);
+				top_stats->update_stats(cmd, cmd_stats->size);
+			}
+			auto request_samples = stats.get_request_samples();
+			if (request_samples) {
+				request_samples->command_handled(cmd, err, cmd_stats);
 			}
 		}
 	} catch (const std::exception &e) {
@@ -231,6 +272,24 @@ void dnet_monitor_stats_update(struct dnet_node *n,
 	}
 }
 
+void dnet_monitor_send_time_update(struct dnet_node *n, const struct dnet_cmd *cmd, unsigned long queue_time,
+                                   unsigned long time) {
+	try {
+		auto real_monitor = ioremap::monitor::get_monitor(n);
+		if (real_monitor) {
+			auto &stats = real_monitor->get_statistics();
+			stats.latency_counter(cmd->cmd, 0, ioremap::monitor::send_latency, time);
+
+			auto request_samples = stats.get_request_samples();
+			if (request_samples) {
+				request_samples->reply_sent(cmd, queue_time, time);
+			}
+		}
+	} catch (const std::exception &e) {
+		DNET_LOG_DEBUG(n, "monitor: failed to update send time: {}", e.what());
+	}
+}
+
 int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd, void *data) {
 	if (cmd->size < sizeof(dnet_monitor_stat_request)) {
 		DNET_LOG_DEBUG(orig->n, "monitor: {}: {}: process MONITOR_STAT, invalid size: {}, expected: >= {}",
@@ -257,6 +316,7 @@ int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd,
 	}
 	
 	ioremap::monitor::request request(req->categories);
+	request.since_version = req->since_version;
 	uint32_t *backeds_ids_buff = static_cast<uint32_t *>(data + sizeof(struct dnet_monitor_stat_request));
 	for (size_t i = 0; i < req->backends_number; ++i) {
 		request.backends_ids.insert(dnet_bswap32(backeds_ids_buff[i]));
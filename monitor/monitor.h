@@ -29,6 +29,8 @@ extern "C" {
 
 struct dnet_node;
 struct dnet_config;
+struct dnet_cmd;
+struct dnet_cmd_stats;
 
 /*!
  * \internal
@@ -51,16 +53,20 @@ void dnet_monitor_exit(struct dnet_node *n);
  * \internal
  *
  * Sends to \a monitor statistics some properties of executed command:
- * \a cmd - identifier of the command
- * \a trans - number of transaction
+ * \a cmd - the command
  * \a err - error code
- * \a cache - flag which shows was the command executed by cache
- * \a size - size of data that takes a part in command execution
- * \a time - time spended on command execution
+ * \a cmd_stats - statistics of the command handling: size, cache flag, handle, lock, queue and recv times
  */
 void dnet_monitor_stats_update(struct dnet_node *n, const struct dnet_cmd *cmd,
-                               const int err, const int cache,
-                               const uint32_t size, const unsigned long time);
+                               const int err, const struct dnet_cmd_stats *cmd_stats);
+
+/*!
+ * \internal
+ *
+ * Sends to \a monitor statistics \a time spent on sending reply \a cmd and \a queue_time it spent in send queue
+ */
+void dnet_monitor_send_time_update(struct dnet_node *n, const struct dnet_cmd *cmd, unsigned long queue_time,
+                                   unsigned long time);
 
 int dnet_monitor_process_cmd(struct dnet_net_state *orig, struct dnet_cmd *cmd, void *data);
 
@@ -37,7 +37,15 @@ struct monitor_config {
 	size_t		top_length;
 	size_t		events_size;
 	int		period_in_seconds;
+	bool		has_samples;
+	size_t		samples_size;
+	unsigned int	sample_rate;
+	uint64_t	slow_threshold;
 	std::string	handystats;
+	// reports built within this period are returned from the cache, 0 (default) disables caching
+	unsigned int	snapshot_period_ms;
+	// number of previous reports kept for building deltas
+	size_t		snapshot_history;
 
 	static std::unique_ptr<monitor_config> parse(const kora::config_t &monitor);
 };
@@ -26,10 +26,6 @@
 
 #include <blackhole/attribute.hpp>
 
-#include "rapidjson/document.h"
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
-
 #include "elliptics/interface.h"
 
 #include "library/logger.hpp"
@@ -196,145 +192,216 @@ procfs_provider::procfs_provider(struct dnet_node *node)
 : m_node(node)
 {}
 
-static void fill_vm(dnet_node *node,
-                    rapidjson::Value &stat_value,
-                    rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value vm_value(rapidjson::kObjectType);
+static void fill_vm(dnet_node *node, json_writer &writer) {
 	int err = 0;
 	dnet_vm_stat st;
 
 	err = dnet_get_vm_stat(node->log, &st);
-	vm_value.AddMember("error", err, allocator);
+
+	writer.String("vm");
+	writer.StartObject();
+	write_member(writer, "error", err);
 
 	if (!err) {
-		vm_value.AddMember("string_error", "", allocator);
-		rapidjson::Value la_value(rapidjson::kArrayType);
+		write_member(writer, "string_error", "");
+		writer.String("la");
+		writer.StartArray();
 		for (size_t i = 0; i < 3; ++i) {
-			la_value.PushBack(st.la[i], allocator);
+			write_value(writer, st.la[i]);
 		}
-		vm_value.AddMember("la", la_value, allocator);
-
-		vm_value.AddMember("total", st.vm_total, allocator);
-		vm_value.AddMember("active", st.vm_active, allocator);
-		vm_value.AddMember("inactive", st.vm_inactive, allocator);
-		vm_value.AddMember("free", st.vm_free, allocator);
-		vm_value.AddMember("cached", st.vm_cached, allocator);
-		vm_value.AddMember("buffers", st.vm_buffers, allocator);
+		writer.EndArray();
+
+		write_member(writer, "total", st.vm_total);
+		write_member(writer, "active", st.vm_active);
+		write_member(writer, "inactive", st.vm_inactive);
+		write_member(writer, "free", st.vm_free);
+		write_member(writer, "cached", st.vm_cached);
+		write_member(writer, "buffers", st.vm_buffers);
 	} else
-		vm_value.AddMember("string_error", strerror(-err), allocator);
+		write_member(writer, "string_error", strerror(-err));
 
-	stat_value.AddMember("vm", vm_value, allocator);
+	writer.EndObject();
 }
 
-static void fill_io(dnet_node *node,
-                    rapidjson::Value &stat_value,
-                    rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value io_stat(rapidjson::kObjectType);
+static void fill_io(dnet_node *node, json_writer &writer) {
 	int err = 0;
 	proc_io_stat st;
 
 	err = fill_proc_io_stat(node, st);
-	io_stat.AddMember("error", err, allocator);
+
+	writer.String("io");
+	writer.StartObject();
+	write_member(writer, "error", err);
 
 	if (!err) {
-		io_stat.AddMember("string_error", "", allocator);
-		io_stat.AddMember("rchar", st.rchar, allocator);
-		io_stat.AddMember("wchar", st.wchar, allocator);
-		io_stat.AddMember("syscr", st.syscr, allocator);
-		io_stat.AddMember("syscw", st.syscw, allocator);
-		io_stat.AddMember("read_bytes", st.read_bytes, allocator);
-		io_stat.AddMember("write_bytes", st.write_bytes, allocator);
-		io_stat.AddMember("cancelled_write_bytes", st.cancelled_write_bytes, allocator);
+		write_member(writer, "string_error", "");
+		write_member(writer, "rchar", st.rchar);
+		write_member(writer, "wchar", st.wchar);
+		write_member(writer, "syscr", st.syscr);
+		write_member(writer, "syscw", st.syscw);
+		write_member(writer, "read_bytes", st.read_bytes);
+		write_member(writer, "write_bytes", st.write_bytes);
+		write_member(writer, "cancelled_write_bytes", st.cancelled_write_bytes);
 	} else
-		io_stat.AddMember("string_error", strerror(-err), allocator);
+		write_member(writer, "string_error", strerror(-err));
 
-	stat_value.AddMember("io", io_stat, allocator);
+	writer.EndObject();
 }
 
-static void fill_stat(dnet_node *node,
-                      rapidjson::Value &stat_value,
-                      rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value stat_stat(rapidjson::kObjectType);
+static void fill_stat(dnet_node *node, json_writer &writer) {
 	int err = 0;
 	proc_stat st;
 
 	err = fill_proc_stat(node, st);
-	stat_stat.AddMember("error", err, allocator);
+
+	writer.String("stat");
+	writer.StartObject();
+	write_member(writer, "error", err);
 
 	if (!err) {
-		stat_stat.AddMember("string_error", "", allocator);
-		stat_stat.AddMember("threads_num", st.threads_num, allocator);
-		stat_stat.AddMember("rss", st.rss, allocator);
-		stat_stat.AddMember("vsize", st.vsize, allocator);
-		stat_stat.AddMember("rsslim", st.rsslim, allocator);
-		stat_stat.AddMember("msize", st.msize, allocator);
-		stat_stat.AddMember("mresident", st.mresident, allocator);
-		stat_stat.AddMember("mshare", st.mshare, allocator);
-		stat_stat.AddMember("mcode", st.mcode, allocator);
-		stat_stat.AddMember("mdata", st.mdata, allocator);
+		write_member(writer, "string_error", "");
+		write_member(writer, "threads_num", st.threads_num);
+		write_member(writer, "rss", st.rss);
+		write_member(writer, "vsize", st.vsize);
+		write_member(writer, "rsslim", st.rsslim);
+		write_member(writer, "msize", st.msize);
+		write_member(writer, "mresident", st.mresident);
+		write_member(writer, "mshare", st.mshare);
+		write_member(writer, "mcode", st.mcode);
+		write_member(writer, "mdata", st.mdata);
 	} else
-		stat_stat.AddMember("string_error", strerror(-err), allocator);
+		write_member(writer, "string_error", strerror(-err));
 
-	stat_value.AddMember("stat", stat_stat, allocator);
+	writer.EndObject();
 }
 
-static void fill_net_stat(const char *origin,
-			  const struct net_stat &ns,
-			  rapidjson::Value &stat_value,
-			  rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value stat(rapidjson::kObjectType);
-	stat.AddMember("bytes", ns.bytes, allocator);
-	stat.AddMember("packets", ns.packets, allocator);
-	stat.AddMember("errors", ns.errors, allocator);
-	stat_value.AddMember(origin, stat, allocator);
+static void fill_net_stat(const char *origin, const struct net_stat &ns, json_writer &writer) {
+	writer.String(origin);
+	writer.StartObject();
+	write_member(writer, "bytes", ns.bytes);
+	write_member(writer, "packets", ns.packets);
+	write_member(writer, "errors", ns.errors);
+	writer.EndObject();
 }
 
-static void fill_net(dnet_node *node,
-                     rapidjson::Value &stat_value,
-                     rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value net_stat(rapidjson::kObjectType);
+static void fill_net(dnet_node *node, json_writer &writer) {
 	int err = 0;
 	std::map<std::string, net_interface_stat> st;
 
 	err = fill_proc_net_stat(node, st);
-	net_stat.AddMember("error", err, allocator);
+
+	writer.String("net");
+	writer.StartObject();
+	write_member(writer, "error", err);
 
 	if (!err) {
-		rapidjson::Value dev_stat(rapidjson::kObjectType);
+		write_member(writer, "string_error", "");
+		writer.String("net_interfaces");
+		writer.StartObject();
 
 		for (auto it = st.cbegin(); it != st.cend(); ++it) {
-			rapidjson::Value stat(rapidjson::kObjectType);
-
 			const std::string &name = it->first;
 			const net_interface_stat &ns = it->second;
 
-			fill_net_stat("receive", ns.rx, stat, allocator);
-			fill_net_stat("transmit", ns.tx, stat, allocator);
+			writer.String(name.c_str(), name.size());
+			writer.StartObject();
+			fill_net_stat("receive", ns.rx, writer);
+			fill_net_stat("transmit", ns.tx, writer);
 
-			stat.AddMember("speed", ns.speed, allocator);
-
-			dev_stat.AddMember(name.c_str(), allocator, stat, allocator);
+			write_member(writer, "speed", ns.speed);
+			writer.EndObject();
 		}
 
-		net_stat.AddMember("string_error", "", allocator);
-		net_stat.AddMember("net_interfaces", dev_stat, allocator);
+		writer.EndObject();
 	} else
-		net_stat.AddMember("string_error", strerror(-err), allocator);
+		write_member(writer, "string_error", strerror(-err));
+
+	writer.EndObject();
+}
 
-	stat_value.AddMember("net", net_stat, allocator);
+void procfs_provider::write_statistics(const request &request, json_writer &writer) const {
+	if (!(request.categories & DNET_MONITOR_PROCFS)) {
+		writer.Null();
+		return;
+	}
+
+	writer.StartObject();
+	fill_vm(m_node, writer);
+	fill_io(m_node, writer);
+	fill_stat(m_node, writer);
+	fill_net(m_node, writer);
+	writer.EndObject();
 }
 
-void procfs_provider::statistics(const request &request,
-                                 rapidjson::Value &value,
-                                 rapidjson::Document::AllocatorType &allocator) const {
+void procfs_provider::metrics(const request &request, metrics_writer &writer) const {
 	if (!(request.categories & DNET_MONITOR_PROCFS))
-	    return;
+		return;
 
-	value.SetObject();
-	fill_vm(m_node, value, allocator);
-	fill_io(m_node, value, allocator);
-	fill_stat(m_node, value, allocator);
-	fill_net(m_node, value, allocator);
+	dnet_vm_stat vm;
+	if (!dnet_get_vm_stat(m_node->log, &vm)) {
+		static const char *periods[] = {"1m", "5m", "15m"};
+		for (size_t i = 0; i < 3; ++i) {
+			writer.gauge("elliptics_procfs_load_average", "System load average", {{"period", periods[i]}},
+			             vm.la[i]);
+		}
+
+		const char *help = "System memory from /proc/meminfo";
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "total"}}, vm.vm_total);
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "active"}}, vm.vm_active);
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "inactive"}}, vm.vm_inactive);
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "free"}}, vm.vm_free);
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "cached"}}, vm.vm_cached);
+		writer.gauge("elliptics_procfs_memory", help, {{"type", "buffers"}}, vm.vm_buffers);
+	}
+
+	proc_io_stat io;
+	if (!fill_proc_io_stat(m_node, io)) {
+		const char *help = "IO of the process from /proc/self/io";
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "rchar"}}, io.rchar);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "wchar"}}, io.wchar);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "syscr"}}, io.syscr);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "syscw"}}, io.syscw);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "read_bytes"}}, io.read_bytes);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "write_bytes"}}, io.write_bytes);
+		writer.counter("elliptics_procfs_io_total", help, {{"type", "cancelled_write_bytes"}},
+		               io.cancelled_write_bytes);
+	}
+
+	proc_stat stat;
+	if (!fill_proc_stat(m_node, stat)) {
+		const char *help = "Memory of the process from /proc/self/stat and /proc/self/statm";
+		writer.gauge("elliptics_procfs_threads", "Number of threads of the process", {}, stat.threads_num);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "rss"}}, stat.rss);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "vsize"}}, stat.vsize);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "rsslim"}}, stat.rsslim);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "msize"}}, stat.msize);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "mresident"}}, stat.mresident);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "mshare"}}, stat.mshare);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "mcode"}}, stat.mcode);
+		writer.gauge("elliptics_procfs_process_memory", help, {{"type", "mdata"}}, stat.mdata);
+	}
+
+	std::map<std::string, net_interface_stat> net;
+	if (!fill_proc_net_stat(m_node, net)) {
+		for (const auto &item : net) {
+			const auto &name = item.first;
+			const auto &ns = item.second;
+
+			const std::pair<const char *, const net_stat *> directions[] = {{"receive", &ns.rx},
+			                                                                {"transmit", &ns.tx}};
+			for (const auto &direction : directions) {
+				const metric_labels labels = {{"interface", name}, {"direction", direction.first}};
+				writer.counter("elliptics_procfs_net_bytes_total", "Traffic of network interface",
+				               labels, direction.second->bytes);
+				writer.counter("elliptics_procfs_net_packets_total", "Packets of network interface",
+				               labels, direction.second->packets);
+				writer.counter("elliptics_procfs_net_errors_total", "Errors of network interface",
+				               labels, direction.second->errors);
+			}
+			writer.gauge("elliptics_procfs_net_speed", "Speed of network interface in Mb/s",
+			             {{"interface", name}}, ns.speed);
+		}
+	}
 }
 
 
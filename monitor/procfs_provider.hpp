@@ -31,9 +31,9 @@ class procfs_provider : public stat_provider {
 public:
 	procfs_provider(struct dnet_node *node);
 
-	void statistics(const request &request,
-	                rapidjson::Value &value,
-	                rapidjson::Document::AllocatorType &allocator) const override;
+	void write_statistics(const request &request, json_writer &writer) const override;
+
+	void metrics(const request &request, metrics_writer &writer) const override;
 
 private:
 	struct dnet_node *m_node;
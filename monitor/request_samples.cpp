@@ -0,0 +1,344 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "request_samples.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include <sys/time.h>
+
+#include "library/elliptics.h"
+#include "elliptics/interface.h"
+
+namespace ioremap { namespace monitor {
+
+static_assert(sizeof(request_sample) % sizeof(uint64_t) == 0, "request_sample must consist of whole words");
+
+const size_t request_samples::search_window;
+
+request_samples::request_samples(size_t size, uint32_t sample_rate, uint64_t slow_threshold)
+: m_size(std::max<size_t>(size, 1))
+, m_sample_rate(sample_rate)
+, m_slow_threshold(slow_threshold)
+, m_slots(make_cache_aligned_array<slot>(m_size))
+, m_head(0)
+, m_awaiting(0) {
+	for (size_t i = 0; i < m_size; ++i) {
+		auto &current = m_slots[i];
+		current.sequence.store(0, std::memory_order_relaxed);
+		current.position.store(0, std::memory_order_relaxed);
+		current.awaiting.store(0, std::memory_order_relaxed);
+		for (auto &word : current.words)
+			word.store(0, std::memory_order_relaxed);
+	}
+}
+
+bool request_samples::sampled(uint64_t total_time) const {
+	if (m_slow_threshold && total_time >= m_slow_threshold)
+		return true;
+	if (!m_sample_rate)
+		return false;
+
+	thread_local uint64_t handled = 0;
+	return ++handled % m_sample_rate == 0;
+}
+
+void request_samples::command_handled(const struct dnet_cmd *cmd, int err, const struct dnet_cmd_stats *cmd_stats) {
+	const uint64_t total_time = cmd_stats->recv_time + cmd_stats->queue_time + cmd_stats->handle_time;
+	if (!sampled(total_time))
+		return;
+
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+
+	request_sample sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.timestamp = tv.tv_sec * 1000000ULL + tv.tv_usec;
+	sample.trans = cmd->trans;
+	memcpy(sample.id, cmd->id.id, DNET_ID_SIZE);
+	sample.group_id = cmd->id.group_id;
+	sample.backend_id = cmd->backend_id;
+	sample.cmd = cmd->cmd;
+	sample.status = err;
+	sample.flags = cmd->flags;
+	sample.size = cmd_stats->size;
+	sample.cache = cmd_stats->handled_in_cache;
+	sample.recv_time = cmd_stats->recv_time;
+	sample.queue_time = cmd_stats->queue_time;
+	sample.lock_time = cmd_stats->lock_time;
+	sample.handle_time = cmd_stats->handle_time;
+
+	// final acknowledgement is sent only if it is requested, sub-requests keep DNET_FLAGS_MORE in their replies
+	const bool await_reply = (cmd->flags & DNET_FLAGS_NEED_ACK) && !(cmd->flags & DNET_FLAGS_MORE);
+	add(sample, await_reply);
+}
+
+void request_samples::load(const slot &slot, request_sample &sample) {
+	uint64_t words[words_count];
+	for (size_t i = 0; i < words_count; ++i)
+		words[i] = slot.words[i].load(std::memory_order_relaxed);
+	memcpy(&sample, words, sizeof(sample));
+}
+
+void request_samples::store(slot &slot, const request_sample &sample) {
+	uint64_t words[words_count];
+	memcpy(words, &sample, sizeof(sample));
+	for (size_t i = 0; i < words_count; ++i)
+		slot.words[i].store(words[i], std::memory_order_relaxed);
+}
+
+void request_samples::add(const request_sample &sample, bool await_reply) {
+	const uint64_t position = m_head.fetch_add(1, std::memory_order_relaxed) + 1;
+	auto &current = m_slots[(position - 1) % m_size];
+
+	uint64_t sequence = current.sequence.load(std::memory_order_relaxed);
+	if ((sequence & 1) ||
+	    !current.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+		return;
+	std::atomic_thread_fence(std::memory_order_release);
+
+	// overwritten sample won't get its reply anymore
+	if (current.awaiting.load(std::memory_order_relaxed))
+		m_awaiting.fetch_sub(1, std::memory_order_relaxed);
+
+	store(current, sample);
+	current.position.store(position, std::memory_order_relaxed);
+	current.awaiting.store(await_reply, std::memory_order_relaxed);
+	if (await_reply)
+		m_awaiting.fetch_add(1, std::memory_order_relaxed);
+
+	current.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void request_samples::reply_sent(const struct dnet_cmd *cmd, uint64_t queue_time, uint64_t time) {
+	if (!m_awaiting.load(std::memory_order_relaxed))
+		return;
+
+	const uint64_t head = m_head.load(std::memory_order_acquire);
+	const uint64_t window = std::min<uint64_t>(head, std::min(m_size, search_window));
+
+	for (uint64_t i = 0; i < window; ++i) {
+		const uint64_t position = head - i;
+		auto &current = m_slots[(position - 1) % m_size];
+
+		uint64_t sequence = current.sequence.load(std::memory_order_acquire);
+		if ((sequence & 1) ||
+		    !current.awaiting.load(std::memory_order_relaxed) ||
+		    current.position.load(std::memory_order_relaxed) != position)
+			continue;
+
+		request_sample sample;
+		load(current, sample);
+		if (sample.trans != cmd->trans || sample.cmd != (int32_t)cmd->cmd || sample.group_id != cmd->id.group_id)
+			continue;
+
+		// if the slot has been changed since it was matched, its sample isn't ours anymore
+		if (!current.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+			return;
+		std::atomic_thread_fence(std::memory_order_release);
+
+		load(current, sample);
+		sample.send_queue_time += queue_time;
+		sample.send_time += time;
+		sample.replies += 1;
+		if (!(cmd->flags & DNET_FLAGS_MORE)) {
+			sample.replied = 1;
+			current.awaiting.store(0, std::memory_order_relaxed);
+			m_awaiting.fetch_sub(1, std::memory_order_relaxed);
+		}
+		store(current, sample);
+
+		current.sequence.store(sequence + 2, std::memory_order_release);
+		return;
+	}
+}
+
+std::vector<request_sample> request_samples::collect() const {
+	const uint64_t head = m_head.load(std::memory_order_acquire);
+	const uint64_t count = std::min<uint64_t>(head, m_size);
+
+	std::vector<request_sample> samples;
+	samples.reserve(count);
+
+	for (uint64_t i = 0; i < count; ++i) {
+		const uint64_t position = head - i;
+		const auto &current = m_slots[(position - 1) % m_size];
+
+		const uint64_t sequence = current.sequence.load(std::memory_order_acquire);
+		if ((sequence & 1) || current.position.load(std::memory_order_relaxed) != position)
+			continue;
+
+		request_sample sample;
+		load(current, sample);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (current.sequence.load(std::memory_order_relaxed) != sequence)
+			continue;
+
+		samples.push_back(sample);
+	}
+
+	return samples;
+}
+
+request_samples_provider::request_samples_provider(std::shared_ptr<request_samples> samples)
+: m_samples(samples)
+{
+}
+
+namespace {
+enum sample_stage {
+	recv_stage,
+	queue_stage,
+	lock_stage,
+	handle_stage,
+	send_queue_stage,
+	send_stage,
+	stages_count
+};
+
+const char *stage_names[stages_count] = {
+	"recv_time", "queue_time", "lock_time", "handle_time", "send_queue_time", "send_time"
+};
+
+struct stage_summary {
+	uint64_t total;
+	uint64_t max;
+};
+
+struct command_summary {
+	uint64_t	count;
+	uint64_t	failures;
+	stage_summary	stages[stages_count];
+};
+} /* namespace */
+
+static void sample_stages(const request_sample &sample, uint64_t (&stages)[stages_count]) {
+	stages[recv_stage] = sample.recv_time;
+	stages[queue_stage] = sample.queue_time;
+	stages[lock_stage] = sample.lock_time;
+	stages[handle_stage] = sample.handle_time;
+	stages[send_queue_stage] = sample.send_queue_time;
+	stages[send_stage] = sample.send_time;
+}
+
+static void fill_sample(const request_sample &sample, json_writer &writer) {
+	writer.StartObject();
+
+	write_member(writer, "timestamp", sample.timestamp);
+	write_member(writer, "trans", sample.trans);
+	write_member(writer, "cmd", dnet_cmd_string(sample.cmd));
+	write_member(writer, "group", sample.group_id);
+	write_member(writer, "id", dnet_dump_id_str_full(sample.id));
+	write_member(writer, "backend_id", sample.backend_id);
+	write_member(writer, "status", sample.status);
+	write_member(writer, "cache", static_cast<bool>(sample.cache));
+	write_member(writer, "size", sample.size);
+	write_member(writer, "replies", sample.replies);
+	write_member(writer, "replied", static_cast<bool>(sample.replied));
+
+	uint64_t stages[stages_count];
+	sample_stages(sample, stages);
+	for (int i = 0; i < stages_count; ++i) {
+		write_member(writer, stage_names[i], stages[i]);
+	}
+
+	writer.EndObject();
+}
+
+static void fill_summary(const std::vector<request_sample> &samples, json_writer &writer) {
+	std::map<int, std::map<int, command_summary>> summaries;
+
+	for (const auto &sample : samples) {
+		auto &summary = summaries[sample.backend_id][sample.cmd];
+		summary.count += 1;
+		summary.failures += (sample.status != 0);
+
+		uint64_t stages[stages_count];
+		sample_stages(sample, stages);
+		for (int i = 0; i < stages_count; ++i) {
+			summary.stages[i].total += stages[i];
+			summary.stages[i].max = std::max(summary.stages[i].max, stages[i]);
+		}
+	}
+
+	writer.StartObject();
+	for (const auto &backend : summaries) {
+		const std::string backend_id = std::to_string(backend.first);
+		writer.String(backend_id.c_str(), backend_id.size());
+		writer.StartObject();
+
+		for (const auto &command : backend.second) {
+			const auto &summary = command.second;
+
+			writer.String(dnet_cmd_string(command.first));
+			writer.StartObject();
+			write_member(writer, "count", summary.count);
+			write_member(writer, "failures", summary.failures);
+
+			for (int i = 0; i < stages_count; ++i) {
+				writer.String(stage_names[i]);
+				writer.StartObject();
+				write_member(writer, "avg", summary.stages[i].total / summary.count);
+				write_member(writer, "max", summary.stages[i].max);
+				writer.EndObject();
+			}
+
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+	}
+	writer.EndObject();
+}
+
+void request_samples_provider::write_statistics(const request &request, json_writer &writer) const {
+	if (!(request.categories & DNET_MONITOR_SAMPLES)) {
+		writer.Null();
+		return;
+	}
+
+	auto samples = m_samples->collect();
+	if (!request.backends_ids.empty()) {
+		samples.erase(std::remove_if(samples.begin(), samples.end(),
+			[&request] (const request_sample &sample) {
+				return !request.backends_ids.count(sample.backend_id);
+			}), samples.end());
+	}
+
+	writer.StartObject();
+	write_member(writer, "size", m_samples->size());
+	write_member(writer, "sample_rate", m_samples->sample_rate());
+	write_member(writer, "slow_threshold", m_samples->slow_threshold());
+	write_member(writer, "recorded", m_samples->recorded());
+
+	writer.String("summary");
+	fill_summary(samples, writer);
+
+	writer.String("requests");
+	writer.StartArray();
+	for (const auto &sample : samples) {
+		fill_sample(sample, writer);
+	}
+	writer.EndArray();
+	writer.EndObject();
+}
+
+}} /* namespace ioremap::monitor */
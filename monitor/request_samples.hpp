@@ -0,0 +1,166 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_REQUEST_SAMPLES_HPP
+#define __DNET_MONITOR_REQUEST_SAMPLES_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "elliptics/packet.h"
+
+#include "cache_aligned.hpp"
+#include "stat_provider.hpp"
+
+/*
+ * Default number of sampled requests kept in the ring
+ */
+#define DNET_DEFAULT_MONITOR_SAMPLES_SIZE 1024
+
+/*
+ * By default every 1000th request handled by a thread is sampled
+ */
+#define DNET_DEFAULT_MONITOR_SAMPLE_RATE 1000
+
+/*
+ * By default every request which took 100ms and more from receiving to the end of handling is sampled
+ */
+#define DNET_DEFAULT_MONITOR_SLOW_THRESHOLD 100000
+
+struct dnet_cmd_stats;
+
+namespace ioremap { namespace monitor {
+
+/*
+ * Timings of a single request split by stages, all times are in usecs
+ */
+struct request_sample {
+	uint64_t	timestamp;		// realtime when handling of the request was finished
+	uint64_t	trans;
+	uint8_t		id[DNET_ID_SIZE];
+	uint32_t	group_id;
+	int32_t		backend_id;
+	int32_t		cmd;
+	int32_t		status;
+	uint64_t	flags;
+	uint64_t	size;			// size of data read or written by the request
+	uint32_t	cache;			// whether the request was handled by cache
+	uint32_t	replies;		// number of replies accounted in send_queue_time and send_time
+	uint32_t	replied;		// whether the final reply was sent
+	uint32_t	reserved;
+	uint64_t	recv_time;		// time spent on receiving the request
+	uint64_t	queue_time;		// time the request spent in io queue
+	uint64_t	lock_time;		// time spent on waiting for locked keys while handling
+	uint64_t	handle_time;		// time spent on handling including lock_time
+	uint64_t	send_queue_time;	// time replies spent in send queue
+	uint64_t	send_time;		// time spent on sending replies
+};
+
+/*!
+ * \internal
+ *
+ * Ring of sampled requests.
+ *
+ * A request is sampled if it is every sample_rate-th request handled by the thread or if its receive, queue
+ * and handle times sum up to slow_threshold or more. Writers claim slots by atomic increment of the head and
+ * protect them by per-slot sequence counters (seqlock), so neither writers nor readers take any locks:
+ * a reader skips slots which are being written, a writer drops the sample if it meets a lagging writer
+ * of the same slot.
+ *
+ * Replies are sent by network threads after the request is handled, so their send times are added
+ * to the sample afterwards by reply_sent(). It looks up only a few latest samples and does nothing
+ * while no sample awaits its final reply.
+ */
+class request_samples {
+public:
+	request_samples(size_t size, uint32_t sample_rate, uint64_t slow_threshold);
+
+	/*!
+	 * Records handled command \a cmd with status \a err if it should be sampled
+	 */
+	void command_handled(const struct dnet_cmd *cmd, int err, const struct dnet_cmd_stats *cmd_stats);
+
+	/*!
+	 * Adds \a queue_time and \a time spent on sending reply \a cmd to its request's sample
+	 */
+	void reply_sent(const struct dnet_cmd *cmd, uint64_t queue_time, uint64_t time);
+
+	/*!
+	 * Returns whether request which took \a total_time should be sampled
+	 */
+	bool sampled(uint64_t total_time) const;
+
+	/*!
+	 * Puts \a sample into the ring, \a await_reply - whether its final reply will be sent afterwards
+	 */
+	void add(const request_sample &sample, bool await_reply);
+
+	/*!
+	 * Returns consistent copies of samples kept in the ring, the newest go first
+	 */
+	std::vector<request_sample> collect() const;
+
+	size_t size() const { return m_size; }
+	uint32_t sample_rate() const { return m_sample_rate; }
+	uint64_t slow_threshold() const { return m_slow_threshold; }
+	/* number of samples recorded since start */
+	uint64_t recorded() const { return m_head.load(std::memory_order_relaxed); }
+
+	/* number of the latest samples looked up by reply_sent() */
+	static const size_t search_window = 64;
+
+private:
+	static const size_t words_count = sizeof(request_sample) / sizeof(uint64_t);
+
+	struct alignas(cache_line_size) slot {
+		/* odd while the slot is being written */
+		std::atomic<uint64_t>	sequence;
+		/* 1-based number of the sample kept in the slot, 0 if the slot is empty */
+		std::atomic<uint64_t>	position;
+		std::atomic<uint64_t>	awaiting;
+		std::atomic<uint64_t>	words[words_count];
+	};
+
+	static void load(const slot &slot, request_sample &sample);
+	static void store(slot &slot, const request_sample &sample);
+
+	const size_t			m_size;
+	const uint32_t			m_sample_rate;
+	const uint64_t			m_slow_threshold;
+	cache_aligned_array<slot>	m_slots;
+	std::atomic<uint64_t>		m_head;
+	/* number of samples whose final reply wasn't sent yet */
+	std::atomic<uint64_t>		m_awaiting;
+};
+
+/*!
+ * Provider of sampled requests and their timings summarized by backends and commands
+ */
+class request_samples_provider : public stat_provider {
+public:
+	request_samples_provider(std::shared_ptr<request_samples> samples);
+
+	void write_statistics(const request &request, json_writer &writer) const override;
+
+private:
+	std::shared_ptr<request_samples> m_samples;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_REQUEST_SAMPLES_HPP */
@@ -144,6 +144,17 @@ void handler::async_read() {
 		if (m_http_request.ready()) {
 			m_recv_ts = std::chrono::system_clock::now();
 			const auto request = parse_request();
+			if (m_http_request.path() == "/metrics" && request.categories != 0) {
+				DNET_LOG_DEBUG(m_monitor.node(), "monitor: http-server: "
+				                                 "got metrics request for categories: {:x} from: {}",
+				               request.categories, m_remote);
+				m_response = make_metrics_reply(m_monitor.get_statistics().metrics(request));
+				m_collect_ts = std::chrono::system_clock::now();
+
+				async_write();
+				return;
+			}
+
 			m_response = make_reply(request.categories, [&]() {
 				if (request.categories == 0)
 					return std::string();
@@ -220,7 +231,9 @@ request handler::parse_request() {
 		{"/backend", DNET_MONITOR_BACKEND},
 		{"/stats", DNET_MONITOR_STATS},
 		{"/procfs", DNET_MONITOR_PROCFS},
-		{"/top", DNET_MONITOR_TOP}
+		{"/top", DNET_MONITOR_TOP},
+		{"/latency", DNET_MONITOR_LATENCY},
+		{"/samples", DNET_MONITOR_SAMPLES}
 	};
 
 	request req;
@@ -228,6 +241,26 @@ request handler::parse_request() {
 	auto it = handlers.find(m_http_request.path());
 	if (it != handlers.end()) {
 		req.categories = it->second;
+	} else if (m_http_request.path() == "/metrics") {
+		req.categories = DNET_MONITOR_ALL;
+
+		// metrics can be filtered by comma-separated names of categories: /metrics?category=commands,io
+		auto it = m_http_request.query().find("category");
+		if (it != m_http_request.query().end()) {
+			req.categories = 0;
+
+			std::istringstream names(it->second);
+			std::string name;
+			while (std::getline(names, name, ',')) {
+				auto category = handlers.find("/" + name);
+				if (category == handlers.end()) {
+					DNET_LOG_ERROR(m_monitor.node(), "monitor: http-server: Unknown category: {}",
+					               name);
+					return request();
+				}
+				req.categories |= category->second;
+			}
+		}
 	} else if (m_http_request.path() == "/") {
 		auto it = m_http_request.query().find("categories");
 		if (it != m_http_request.query().end()) {
@@ -245,6 +278,17 @@ request handler::parse_request() {
 		return request();
 	}
 
+	const auto since_item = m_http_request.query().find("since");
+	if (since_item != m_http_request.query().end()) {
+		try {
+			req.since_version = std::stoull(since_item->second);
+		} catch (...) {
+			DNET_LOG_ERROR(m_monitor.node(), "monitor: http-server: Can't parse since version: {}",
+			               since_item->second);
+			return request();
+		}
+	}
+
 	const auto backends_item = m_http_request.query().find("backends");
 	if (backends_item != m_http_request.query().end()) {
 		std::string id_list = backends_item->second;
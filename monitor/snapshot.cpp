@@ -0,0 +1,268 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "compress.hpp"
+
+namespace ioremap { namespace monitor {
+
+static const rapidjson::Value *find_member(const rapidjson::Value &object, const rapidjson::Value &name) {
+	for (auto it = object.MemberBegin(); it != object.MemberEnd(); ++it) {
+		if (it->name.GetStringLength() == name.GetStringLength() &&
+		    memcmp(it->name.GetString(), name.GetString(), name.GetStringLength()) == 0)
+			return &it->value;
+	}
+	return nullptr;
+}
+
+static bool json_equal(const rapidjson::Value &lhs, const rapidjson::Value &rhs) {
+	if (lhs.GetType() != rhs.GetType())
+		return false;
+
+	switch (lhs.GetType()) {
+	case rapidjson::kNullType:
+	case rapidjson::kFalseType:
+	case rapidjson::kTrueType:
+		return true;
+	case rapidjson::kNumberType:
+		if (lhs.IsUint64() && rhs.IsUint64())
+			return lhs.GetUint64() == rhs.GetUint64();
+		if (lhs.IsInt64() && rhs.IsInt64())
+			return lhs.GetInt64() == rhs.GetInt64();
+		return lhs.GetDouble() == rhs.GetDouble();
+	case rapidjson::kStringType:
+		return lhs.GetStringLength() == rhs.GetStringLength() &&
+		       memcmp(lhs.GetString(), rhs.GetString(), lhs.GetStringLength()) == 0;
+	case rapidjson::kArrayType:
+		if (lhs.Size() != rhs.Size())
+			return false;
+		for (rapidjson::SizeType i = 0; i < lhs.Size(); ++i) {
+			if (!json_equal(lhs[i], rhs[i]))
+				return false;
+		}
+		return true;
+	case rapidjson::kObjectType: {
+		size_t members = 0;
+		for (auto it = lhs.MemberBegin(); it != lhs.MemberEnd(); ++it, ++members) {
+			const auto *member = find_member(rhs, it->name);
+			if (!member || !json_equal(it->value, *member))
+				return false;
+		}
+		return members == static_cast<size_t>(rhs.MemberEnd() - rhs.MemberBegin());
+	}
+	}
+	return false;
+}
+
+static void json_copy(const rapidjson::Value &src, rapidjson::Value &dst,
+                      rapidjson::Document::AllocatorType &allocator) {
+	switch (src.GetType()) {
+	case rapidjson::kNullType:
+		dst.SetNull();
+		break;
+	case rapidjson::kFalseType:
+	case rapidjson::kTrueType:
+		dst.SetBool(src.GetBool());
+		break;
+	case rapidjson::kNumberType:
+		if (src.IsUint64())
+			dst.SetUint64(src.GetUint64());
+		else if (src.IsInt64())
+			dst.SetInt64(src.GetInt64());
+		else
+			dst.SetDouble(src.GetDouble());
+		break;
+	case rapidjson::kStringType:
+		dst.SetString(src.GetString(), src.GetStringLength(), allocator);
+		break;
+	case rapidjson::kArrayType:
+		dst.SetArray();
+		for (rapidjson::SizeType i = 0; i < src.Size(); ++i) {
+			rapidjson::Value value;
+			json_copy(src[i], value, allocator);
+			dst.PushBack(value, allocator);
+		}
+		break;
+	case rapidjson::kObjectType:
+		dst.SetObject();
+		for (auto it = src.MemberBegin(); it != src.MemberEnd(); ++it) {
+			rapidjson::Value name(it->name.GetString(), it->name.GetStringLength(), allocator);
+			rapidjson::Value value;
+			json_copy(it->value, value, allocator);
+			dst.AddMember(name, value, allocator);
+		}
+		break;
+	}
+}
+
+bool json_delta(const rapidjson::Value &previous, const rapidjson::Value &current, rapidjson::Value &delta,
+                rapidjson::Document::AllocatorType &allocator) {
+	if (!previous.IsObject() || !current.IsObject()) {
+		if (json_equal(previous, current))
+			return false;
+
+		json_copy(current, delta, allocator);
+		return true;
+	}
+
+	delta.SetObject();
+	bool changed = false;
+
+	for (auto it = current.MemberBegin(); it != current.MemberEnd(); ++it) {
+		const auto *member = find_member(previous, it->name);
+
+		rapidjson::Value value;
+		if (!member) {
+			json_copy(it->value, value, allocator);
+		} else if (!json_delta(*member, it->value, value, allocator)) {
+			continue;
+		}
+
+		rapidjson::Value name(it->name.GetString(), it->name.GetStringLength(), allocator);
+		delta.AddMember(name, value, allocator);
+		changed = true;
+	}
+
+	for (auto it = previous.MemberBegin(); it != previous.MemberEnd(); ++it) {
+		if (find_member(current, it->name))
+			continue;
+
+		rapidjson::Value name(it->name.GetString(), it->name.GetStringLength(), allocator);
+		rapidjson::Value value;
+		delta.AddMember(name, value, allocator);
+		changed = true;
+	}
+
+	return changed;
+}
+
+static std::string serialize(const rapidjson::Document &report) {
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	report.Accept(writer);
+	return buffer.GetString();
+}
+
+const size_t snapshot_cache::max_entries;
+
+/* random non-zero epoch, so the first version of the cache is never 0 which means "no since_version" */
+static uint32_t make_epoch() {
+	std::random_device device;
+	const uint32_t epoch = device() ^ std::chrono::steady_clock::now().time_since_epoch().count();
+	return epoch ? epoch : 1;
+}
+
+snapshot_cache::snapshot_cache(std::chrono::milliseconds period, size_t history)
+: m_period(period)
+, m_history(history)
+, m_epoch(make_epoch())
+, m_version(static_cast<uint64_t>(m_epoch) << 32) {
+}
+
+std::shared_ptr<snapshot_cache::entry> snapshot_cache::get_entry(const request &request) {
+	std::vector<uint32_t> backends(request.backends_ids.begin(), request.backends_ids.end());
+	std::sort(backends.begin(), backends.end());
+
+	std::string key = std::to_string(request.categories);
+	for (const auto backend_id : backends) {
+		key += ',';
+		key += std::to_string(backend_id);
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	auto &item = m_entries[key];
+	if (!item) {
+		item = std::make_shared<entry>();
+
+		if (m_entries.size() > max_entries) {
+			auto oldest = m_entries.end();
+			for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+				if (it->second == item)
+					continue;
+				if (oldest == m_entries.end() || it->second->last_access < oldest->second->last_access)
+					oldest = it;
+			}
+			m_entries.erase(oldest);
+		}
+	}
+	item->last_access = now;
+	return item;
+}
+
+std::string snapshot_cache::get(const request &request, const builder_t &build) {
+	auto cached = get_entry(request);
+
+	// builders of the same request are serialized, so concurrent readers wait for a single build
+	std::lock_guard<std::mutex> guard(cached->mutex);
+	auto &history = cached->history;
+
+	const auto now = std::chrono::steady_clock::now();
+	if (history.empty() || now - history.back().timestamp >= m_period) {
+		snapshot current;
+		current.version = ++m_version;
+		current.timestamp = now;
+		current.compressed = compress(build(current.version));
+
+		history.emplace_back(std::move(current));
+		while (history.size() > m_history + 1)
+			history.pop_front();
+	}
+
+	const auto &current = history.back();
+	// versions of other epochs belong to another cache, e.g. to the server before restart
+	if (request.since_version >> 32 == m_epoch && request.since_version <= current.version) {
+		for (const auto &previous : history) {
+			if (previous.version == request.since_version)
+				return make_delta(previous, current);
+		}
+	}
+
+	return current.compressed;
+}
+
+std::string snapshot_cache::make_delta(const snapshot &previous, const snapshot &current) const {
+	rapidjson::Document previous_report;
+	previous_report.Parse<0>(decompress(previous.compressed).c_str());
+
+	rapidjson::Document current_report;
+	current_report.Parse<0>(decompress(current.compressed).c_str());
+
+	rapidjson::Document delta;
+	auto &allocator = delta.GetAllocator();
+	if (!json_delta(previous_report, current_report, delta, allocator))
+		delta.SetObject();
+
+	if (!delta.HasMember("version"))
+		delta.AddMember("version", current.version, allocator);
+	delta.AddMember("since_version", previous.version, allocator);
+	delta.AddMember("delta", true, allocator);
+
+	return compress(serialize(delta));
+}
+
+}} /* namespace ioremap::monitor */
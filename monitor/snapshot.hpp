@@ -0,0 +1,122 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DNET_MONITOR_SNAPSHOT_HPP
+#define __DNET_MONITOR_SNAPSHOT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rapidjson/document.h"
+
+#include "stat_provider.hpp"
+
+/*
+ * Default period within which built report is returned from the cache. Caching is disabled by default,
+ * so every request gets fresh values, while deltas against kept previous reports are available anyway.
+ */
+#define DNET_DEFAULT_MONITOR_SNAPSHOT_PERIOD_MS 0
+
+/*
+ * Default number of previous snapshots kept for each request for building deltas
+ */
+#define DNET_DEFAULT_MONITOR_SNAPSHOT_HISTORY 4
+
+namespace ioremap { namespace monitor {
+
+/*!
+ * \internal
+ *
+ * Writes to \a delta members of \a current which differ from ones of \a previous, members removed since
+ * \a previous are written as null. Objects are compared member by member, any other values (including arrays)
+ * are written as a whole. Returns false if there is no difference.
+ */
+bool json_delta(const rapidjson::Value &previous, const rapidjson::Value &current, rapidjson::Value &delta,
+                rapidjson::Document::AllocatorType &allocator);
+
+/*!
+ * \internal
+ *
+ * Cache of statistics reports.
+ *
+ * Every built report gets monotonic version and is kept serialized and compressed, so requests for the same
+ * categories and backends within \a period get the cached blob without interviewing providers (and taking
+ * their locks) again. A few previous compressed reports are kept to answer "since version" requests
+ * with delta containing only changed values, they are parsed back only when delta is requested.
+ *
+ * Versions carry random epoch of the cache in their upper 32 bits, so versions received from another
+ * process (e.g. before the server's restart) never match and get the whole report instead of a delta.
+ */
+class snapshot_cache {
+public:
+	/* builds serialized report with "version" member set to the passed version */
+	typedef std::function<std::string(uint64_t version)> builder_t;
+
+	snapshot_cache(std::chrono::milliseconds period, size_t history);
+
+	/*!
+	 * Returns compressed json report for \a request, calls \a build if there is no cached report
+	 * younger than period. If \a request has since_version which is still kept in history,
+	 * returns delta against it.
+	 */
+	std::string get(const request &request, const builder_t &build);
+
+	/*!
+	 * Returns epoch of versions built by this cache
+	 */
+	uint32_t epoch() const {
+		return m_epoch;
+	}
+
+private:
+	struct snapshot {
+		uint64_t					version;
+		std::chrono::steady_clock::time_point		timestamp;
+		std::string					compressed;
+	};
+
+	struct entry {
+		std::mutex					mutex;
+		std::deque<snapshot>				history;
+		std::chrono::steady_clock::time_point		last_access;
+	};
+
+	/* max number of distinct requests whose reports are cached, the least recently used one is evicted */
+	static const size_t max_entries = 16;
+
+	std::shared_ptr<entry> get_entry(const request &request);
+	std::string make_delta(const snapshot &previous, const snapshot &current) const;
+
+	const std::chrono::milliseconds	m_period;
+	const size_t			m_history;
+	const uint32_t			m_epoch;
+
+	std::atomic<uint64_t>						m_version;
+
+	std::mutex							m_mutex;
+	std::unordered_map<std::string, std::shared_ptr<entry>>		m_entries;
+};
+
+}} /* namespace ioremap::monitor */
+
+#endif /* __DNET_MONITOR_SNAPSHOT_HPP */
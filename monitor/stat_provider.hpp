@@ -24,16 +24,23 @@
 
 #include "rapidjson/document.h"
 
+#include "json_writer.hpp"
+
 namespace ioremap { namespace monitor {
+
+class metrics_writer;
+
 /*!
  * Struct that stores statistics categories and ids of requested backends
  */
 struct request {
 	uint64_t categories;
 	std::unordered_set<uint32_t> backends_ids;
+	// if non-zero, only values changed since report of this version are requested
+	uint64_t since_version;
 
-	request(): categories(0) {}
-	request(uint64_t req_categories): categories(req_categories) {}
+	request(): categories(0), since_version(0) {}
+	request(uint64_t req_categories): categories(req_categories), since_version(0) {}
 };
 
 /*!
@@ -49,13 +56,43 @@ public:
 	/*!
 	 * \internal
 	 *
-	 * Returns json string of the real provider statistics
+	 * Fills \a value with the real provider statistics
 	 * \a request - struct that stores categories which statistics should be included to json
 	 * and ids of requested backends
+	 *
+	 * It is implemented via write_statistics() which every provider has to implement,
+	 * it is kept for callers which need statistics as rapidjson document.
 	 */
 	virtual void statistics(const request &request,
 	                        rapidjson::Value &value,
-	                        rapidjson::Document::AllocatorType &allocator) const = 0;
+	                        rapidjson::Document::AllocatorType &allocator) const {
+		rapidjson::StringBuffer buffer;
+		json_writer writer(buffer);
+		write_statistics(request, writer);
+
+		rapidjson::Document document(&allocator);
+		document.Parse<0>(buffer.GetString());
+		value = static_cast<rapidjson::Value &>(document);
+	}
+
+	/*!
+	 * \internal
+	 *
+	 * Writes statistics requested by \a request to \a writer as a single json value.
+	 * Providers which build rapidjson documents write them by document.Accept(writer).
+	 */
+	virtual void write_statistics(const request &request, json_writer &writer) const = 0;
+
+	/*!
+	 * \internal
+	 *
+	 * Writes statistics requested by \a request to \a writer in Prometheus text format.
+	 * Providers which don't support it write nothing.
+	 */
+	virtual void metrics(const request &request, metrics_writer &writer) const {
+		(void) request;
+		(void) writer;
+	}
 
 	/*!
 	 * \internal
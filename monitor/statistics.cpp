@@ -24,7 +24,6 @@
 #include "monitor.hpp"
 #include "cache/cache.hpp"
 #include "elliptics/backends.h"
-#include "monitor/compress.hpp"
 
 //FIXME: elliptics uses rather modified version of rapidjson
 // which is partially incompatible with a stock version used by
@@ -39,85 +38,77 @@
 
 namespace ioremap { namespace monitor {
 
-static void ext_stat_json(const ext_counter &ext_stat,
-                          rapidjson::Value &stat_value,
-                          rapidjson::Document::AllocatorType &allocator) {
-	stat_value.AddMember("successes", ext_stat.counter.successes, allocator);
-	stat_value.AddMember("failures", ext_stat.counter.failures, allocator);
-	stat_value.AddMember("size", ext_stat.size, allocator);
-	stat_value.AddMember("time", ext_stat.time, allocator);
+static void ext_stat_json(const ext_counter &ext_stat, json_writer &writer) {
+	writer.StartObject();
+	write_member(writer, "successes", ext_stat.counter.successes);
+	write_member(writer, "failures", ext_stat.counter.failures);
+	write_member(writer, "size", ext_stat.size);
+	write_member(writer, "time", ext_stat.time);
+	writer.EndObject();
 }
 
-static void source_stat_json(const source_counter &source_stat,
-                             rapidjson::Value &stat_value,
-                             rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value outside_stat(rapidjson::kObjectType);
-	ext_stat_json(source_stat.outside, outside_stat, allocator);
-	stat_value.AddMember("outside", outside_stat, allocator);
-
-	rapidjson::Value internal_stat(rapidjson::kObjectType);
-	ext_stat_json(source_stat.internal, internal_stat, allocator);
-	stat_value.AddMember("internal", internal_stat, allocator);
+static void source_stat_json(const source_counter &source_stat, json_writer &writer) {
+	writer.StartObject();
+	writer.String("outside");
+	ext_stat_json(source_stat.outside, writer);
+	writer.String("internal");
+	ext_stat_json(source_stat.internal, writer);
+	writer.EndObject();
 }
 
-static void dnet_stat_count_json(const dnet_stat_count &counter, rapidjson::Value &stat_value,
-		rapidjson::Document::AllocatorType &allocator) {
-	stat_value.AddMember("successes", counter.count, allocator);
-	stat_value.AddMember("failures", counter.err, allocator);
+static void dnet_stat_count_json(const dnet_stat_count &counter, json_writer &writer) {
+	writer.StartObject();
+	write_member(writer, "successes", counter.count);
+	write_member(writer, "failures", counter.err);
+	writer.EndObject();
 }
 
-static void node_stat_json(dnet_node *n, int cmd, rapidjson::Value &stat_value,
-		rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value storage_stat(rapidjson::kObjectType);
-	dnet_stat_count_json(n->counters[cmd], storage_stat, allocator);
-	stat_value.AddMember("storage", storage_stat, allocator);
-
-	rapidjson::Value proxy_stat(rapidjson::kObjectType);
-	dnet_stat_count_json(n->counters[cmd + __DNET_CMD_MAX], proxy_stat, allocator);
-	stat_value.AddMember("proxy", proxy_stat, allocator);
+static void node_stat_json(dnet_node *n, int cmd, json_writer &writer) {
+	writer.StartObject();
+	writer.String("storage");
+	dnet_stat_count_json(dnet_counter_get(n, cmd), writer);
+	writer.String("proxy");
+	dnet_stat_count_json(dnet_counter_get(n, cmd + __DNET_CMD_MAX), writer);
+	writer.EndObject();
 }
 
-static void cmd_stat_json(dnet_node *node, int cmd, const command_counters &cmd_stat,
-		rapidjson::Value &stat_value, rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value cache_stat(rapidjson::kObjectType);
-	source_stat_json(cmd_stat.cache, cache_stat, allocator);
-	stat_value.AddMember("cache", cache_stat, allocator);
-
-	rapidjson::Value disk_stat(rapidjson::kObjectType);
-	source_stat_json(cmd_stat.disk, disk_stat, allocator);
-	stat_value.AddMember("disk", disk_stat, allocator);
+static void cmd_stat_json(dnet_node *node, int cmd, const command_counters &cmd_stat, json_writer &writer) {
+	writer.StartObject();
+	writer.String("cache");
+	source_stat_json(cmd_stat.cache, writer);
+	writer.String("disk");
+	source_stat_json(cmd_stat.disk, writer);
 
 	/*
 	 * @node is only set for global counters
 	 */
 	if (node) {
-		rapidjson::Value total_stat(rapidjson::kObjectType);
-		node_stat_json(node, cmd, total_stat, allocator);
-		stat_value.AddMember("total", total_stat, allocator);
+		writer.String("total");
+		node_stat_json(node, cmd, writer);
 	}
+	writer.EndObject();
 }
 
-static void single_client_stat_json(dnet_net_state *st, rapidjson::Value &stat_value,
-		rapidjson::Document::AllocatorType &allocator) {
+static void single_client_stat_json(dnet_net_state *st, json_writer &writer) {
+	writer.StartObject();
 	for (int i = 1; i < __DNET_CMD_MAX; ++i) {
 		if (st->stat[i].count != 0 || st->stat[i].err != 0) {
-			rapidjson::Value cmd_stat(rapidjson::kObjectType);
-			dnet_stat_count_json(st->stat[i], cmd_stat, allocator);
-			stat_value.AddMember(dnet_cmd_string(i), allocator, cmd_stat, allocator);
+			writer.String(dnet_cmd_string(i));
+			dnet_stat_count_json(st->stat[i], writer);
 		}
 	}
+	writer.EndObject();
 }
 
-static void clients_stat_json(dnet_node *n, rapidjson::Value &stat_value,
-		rapidjson::Document::AllocatorType &allocator) {
+static void clients_stat_json(dnet_node *n, json_writer &writer) {
 	struct dnet_net_state *st;
 
+	writer.StartObject();
 	pthread_mutex_lock(&n->state_lock);
 	try {
 		list_for_each_entry(st, &n->empty_state_list, node_entry) {
-			rapidjson::Value client_stat(rapidjson::kObjectType);
-			single_client_stat_json(st, client_stat, allocator);
-			stat_value.AddMember(dnet_addr_string(&st->addr), allocator, client_stat, allocator);
+			writer.String(dnet_addr_string(&st->addr));
+			single_client_stat_json(st, writer);
 		}
 	} catch(std::exception &e) {
 		pthread_mutex_unlock(&n->state_lock);
@@ -129,14 +120,66 @@ static void clients_stat_json(dnet_node *n, rapidjson::Value &stat_value,
 		throw;
 	}
 	pthread_mutex_unlock(&n->state_lock);
+	writer.EndObject();
+}
+
+const size_t command_stats::max_shards;
+
+command_stats::command_stats() {
+	for (auto &shard : m_shards) {
+		shard.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+command_stats::~command_stats() {
+	for (auto &shard : m_shards) {
+		cache_aligned_deleter<command_stats::shard>()(shard.load(std::memory_order_relaxed));
+	}
+}
+
+command_stats::shard::~shard() {
+	for (auto &cmd : latencies)
+		for (auto &source : cmd)
+			for (auto &histogram : source)
+				delete histogram.load(std::memory_order_relaxed);
 }
 
-command_stats::command_stats()
-: m_cmd_stats(__DNET_CMD_MAX) {}
+command_stats::shard &command_stats::get_shard() {
+	static std::atomic<size_t> next_slot{0};
+	thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % max_shards;
+
+	auto &place = m_shards[slot];
+	shard *current = place.load(std::memory_order_acquire);
+	if (current)
+		return *current;
+
+	// value-initialization zeroes all counters
+	auto created = make_cache_aligned<shard>();
+	if (place.compare_exchange_strong(current, created.get(), std::memory_order_acq_rel))
+		return *created.release();
+	return *current;
+}
 
 void command_stats::clear() {
-	std::unique_lock<std::mutex> guard(m_cmd_stats_mutex);
-	memset(m_cmd_stats.data(), 0, sizeof(m_cmd_stats.front()) * m_cmd_stats.size());
+	for (auto &place : m_shards) {
+		shard *current = place.load(std::memory_order_acquire);
+		if (!current)
+			continue;
+
+		for (auto &cmd : current->values)
+			for (auto &source : cmd)
+				for (auto &counters : source)
+					for (auto &value : counters)
+						value.store(0, std::memory_order_relaxed);
+
+		for (auto &cmd : current->latencies)
+			for (auto &source : cmd)
+				for (auto &place : source) {
+					latency_histogram *histogram = place.load(std::memory_order_acquire);
+					if (histogram)
+						histogram->clear();
+				}
+	}
 }
 
 void command_stats::command_counter(const int orig_cmd,
@@ -151,28 +194,193 @@ void command_stats::command_counter(const int orig_cmd,
 	if (cmd >= __DNET_CMD_MAX || cmd <= 0)
 		cmd = DNET_CMD_UNKNOWN;
 
-	auto &place = cache ? m_cmd_stats[cmd].cache : m_cmd_stats[cmd].disk;
-	auto &source = trans ? place.outside : place.internal;
-	auto &counter = err ? source.counter.failures : source.counter.successes;
+	auto &counters = get_shard().values[cmd][cache ? 0 : 1][trans ? 0 : 1];
+	counters[err ? 1 : 0].fetch_add(1, std::memory_order_relaxed);
+	counters[2].fetch_add(size, std::memory_order_relaxed);
+	counters[3].fetch_add(time, std::memory_order_relaxed);
+}
 
-	std::unique_lock<std::mutex> guard(m_cmd_stats_mutex);
-	++counter;
-	source.size += size;
-	source.time += time;
+void command_stats::latency_counter(const int orig_cmd,
+                                   const int cache,
+                                   const latency_type type,
+                                   const uint64_t time)
+{
+	int cmd = orig_cmd;
+
+	if (cmd >= __DNET_CMD_MAX || cmd <= 0)
+		cmd = DNET_CMD_UNKNOWN;
+
+	// send latency is not split by cache/disk
+	auto &place = get_shard().latencies[cmd][(cache && type != send_latency) ? 0 : 1][type];
+	latency_histogram *histogram = place.load(std::memory_order_acquire);
+	if (!histogram) {
+		std::unique_ptr<latency_histogram> created(new latency_histogram());
+		if (place.compare_exchange_strong(histogram, created.get(), std::memory_order_acq_rel))
+			histogram = created.release();
+	}
+
+	histogram->add(time);
 }
 
-void command_stats::commands_report(dnet_node *node,
-                                    rapidjson::Value &stat_value,
-                                    rapidjson::Document::AllocatorType &allocator) const {
-	std::unique_lock<std::mutex> guard(m_cmd_stats_mutex);
-	auto tmp_stats = m_cmd_stats;
-	guard.unlock();
+histogram_snapshot command_stats::latency_snapshot(int cmd, int source, int type) const {
+	histogram_snapshot snapshot;
+	for (const auto &place : m_shards) {
+		const shard *current = place.load(std::memory_order_acquire);
+		if (!current)
+			continue;
+
+		const latency_histogram *histogram = current->latencies[cmd][source][type].load(std::memory_order_acquire);
+		if (histogram)
+			histogram->merge_to(snapshot);
+	}
+	return snapshot;
+}
+
+void command_stats::latency_report(json_writer &writer) const {
+	static const char *sources[] = {"cache", "disk"};
+	static const char *types[] = {"handle", "queue", "recv", "send"};
+
+	for (int cmd = 1; cmd < __DNET_CMD_MAX; ++cmd) {
+		// histograms are collected first, so commands and sources without any latency are skipped
+		histogram_snapshot snapshots[2][latency_types_count];
+		bool empty = true;
+		for (int source = 0; source < 2; ++source) {
+			for (int type = 0; type < latency_types_count; ++type) {
+				snapshots[source][type] = latency_snapshot(cmd, source, type);
+				empty = empty && snapshots[source][type].empty();
+			}
+		}
+		if (empty)
+			continue;
+
+		writer.String(dnet_cmd_string(cmd));
+		writer.StartObject();
+		for (int source = 0; source < 2; ++source) {
+			// send latency is not split by cache/disk and is written right to the command
+			const auto &send = snapshots[source][send_latency];
+			if (!send.empty()) {
+				writer.String(types[send_latency]);
+				send.to_json(writer);
+			}
+
+			bool source_empty = true;
+			for (int type = 0; type < latency_types_count; ++type) {
+				source_empty = source_empty && (type == send_latency || snapshots[source][type].empty());
+			}
+			if (source_empty)
+				continue;
+
+			writer.String(sources[source]);
+			writer.StartObject();
+			for (int type = 0; type < latency_types_count; ++type) {
+				if (type == send_latency || snapshots[source][type].empty())
+					continue;
+
+				writer.String(types[type]);
+				snapshots[source][type].to_json(writer);
+			}
+			writer.EndObject();
+		}
+		writer.EndObject();
+	}
+}
+
+std::vector<command_counters> command_stats::collect() const {
+	std::vector<command_counters> stats(__DNET_CMD_MAX);
+
+	auto add = [] (const std::atomic<uint64_t> (&counters)[4], ext_counter &ext) {
+		ext.counter.successes += counters[0].load(std::memory_order_relaxed);
+		ext.counter.failures += counters[1].load(std::memory_order_relaxed);
+		ext.size += counters[2].load(std::memory_order_relaxed);
+		ext.time += counters[3].load(std::memory_order_relaxed);
+	};
+
+	for (const auto &place : m_shards) {
+		const shard *current = place.load(std::memory_order_acquire);
+		if (!current)
+			continue;
+
+		for (int cmd = 0; cmd < __DNET_CMD_MAX; ++cmd) {
+			const auto &values = current->values[cmd];
+			add(values[0][0], stats[cmd].cache.outside);
+			add(values[0][1], stats[cmd].cache.internal);
+			add(values[1][0], stats[cmd].disk.outside);
+			add(values[1][1], stats[cmd].disk.internal);
+		}
+	}
+
+	return stats;
+}
+
+void command_stats::commands_report(dnet_node *node, json_writer &writer) const {
+	const auto tmp_stats = collect();
 
 	for (int i = 1; i < __DNET_CMD_MAX; ++i) {
 		if (tmp_stats[i].has_data()) {
-			rapidjson::Value cmd_stat(rapidjson::kObjectType);
-			cmd_stat_json(node, i, tmp_stats[i], cmd_stat, allocator);
-			stat_value.AddMember(dnet_cmd_string(i), allocator, cmd_stat, allocator);
+			writer.String(dnet_cmd_string(i));
+			cmd_stat_json(node, i, tmp_stats[i], writer);
+		}
+	}
+}
+
+void command_stats::metrics(uint64_t categories, const metric_labels &labels, metrics_writer &writer) const {
+	static const char *sources[] = {"cache", "disk"};
+	static const char *origins[] = {"outside", "internal"};
+	static const char *types[] = {"handle", "queue", "recv", "send"};
+
+	if (categories & DNET_MONITOR_COMMANDS) {
+		const auto stats = collect();
+
+		for (int cmd = 1; cmd < __DNET_CMD_MAX; ++cmd) {
+			if (!stats[cmd].has_data())
+				continue;
+
+			const source_counter *source_counters[] = {&stats[cmd].cache, &stats[cmd].disk};
+			for (int source = 0; source < 2; ++source) {
+				const ext_counter *counters[] = {&source_counters[source]->outside,
+				                                 &source_counters[source]->internal};
+				for (int origin = 0; origin < 2; ++origin) {
+					const auto &counter = *counters[origin];
+					if (!counter.has_data())
+						continue;
+
+					metric_labels sample_labels(labels);
+					sample_labels.push_back({"command", dnet_cmd_string(cmd)});
+					sample_labels.push_back({"source", sources[source]});
+					sample_labels.push_back({"origin", origins[origin]});
+
+					writer.counter("elliptics_command_size_bytes_total", "Size of data handled by commands",
+					               sample_labels, counter.size);
+					writer.counter("elliptics_command_time_microseconds_total",
+					               "Time spent on handling commands", sample_labels, counter.time);
+
+					sample_labels.push_back({"result", "success"});
+					writer.counter("elliptics_commands_total", "Number of handled commands",
+					               sample_labels, counter.counter.successes);
+					sample_labels.back().value = "failure";
+					writer.counter("elliptics_commands_total", "Number of handled commands",
+					               sample_labels, counter.counter.failures);
+				}
+			}
+		}
+	}
+
+	if (categories & DNET_MONITOR_LATENCY) {
+		for (int cmd = 1; cmd < __DNET_CMD_MAX; ++cmd) {
+			for (int source = 0; source < 2; ++source) {
+				for (int type = 0; type < latency_types_count; ++type) {
+					const auto snapshot = latency_snapshot(cmd, source, type);
+					if (snapshot.empty())
+						continue;
+
+					metric_labels sample_labels(labels);
+					sample_labels.push_back({"command", dnet_cmd_string(cmd)});
+					sample_labels.push_back({"source", type == send_latency ? "all" : sources[source]});
+					sample_labels.push_back({"stage", types[type]});
+					writer.histogram("elliptics_command_latency_microseconds",
+					                 "Latencies of commands by stages", sample_labels, snapshot);
+				}
+			}
 		}
 	}
 }
@@ -187,6 +395,14 @@ void statistics::command_counter(const int cmd,
 	m_command_stats.command_counter(cmd, trans, err, cache, size, time);
 }
 
+void statistics::latency_counter(const int cmd,
+                                 const int cache,
+                                 const latency_type type,
+                                 const uint64_t time)
+{
+	m_command_stats.latency_counter(cmd, cache, type, time);
+}
+
 statistics::statistics(monitor& mon, struct dnet_config *cfg) : m_monitor(mon)
 {
 	(void) cfg;
@@ -194,6 +410,14 @@ statistics::statistics(monitor& mon, struct dnet_config *cfg) : m_monitor(mon)
 	if (monitor_cfg && monitor_cfg->has_top) {
 		m_top_stats = std::make_shared<top_stats>(monitor_cfg->top_length, monitor_cfg->events_size, monitor_cfg->period_in_seconds);
 	}
+	if (monitor_cfg && monitor_cfg->has_samples) {
+		m_request_samples = std::make_shared<request_samples>(monitor_cfg->samples_size, monitor_cfg->sample_rate,
+		                                                      monitor_cfg->slow_threshold);
+	}
+
+	m_snapshots.reset(new snapshot_cache(
+		std::chrono::milliseconds(monitor_cfg ? monitor_cfg->snapshot_period_ms : 0),
+		monitor_cfg ? monitor_cfg->snapshot_history : DNET_DEFAULT_MONITOR_SNAPSHOT_HISTORY));
 }
 
 void statistics::add_provider(stat_provider *stat, const std::string &name)
@@ -202,51 +426,75 @@ void statistics::add_provider(stat_provider *stat, const std::string &name)
 	m_stat_providers.insert(make_pair(name, std::shared_ptr<stat_provider>(stat)));
 }
 
-inline std::string convert_report(const rapidjson::Document &report)
+std::string statistics::metrics(const request &request)
 {
-	rapidjson::StringBuffer buffer;
-	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-	report.Accept(writer);
-	return compress(buffer.GetString());
+	DNET_LOG_INFO(m_monitor.node(), "monitor: collecting metrics for categories: {:x}", request.categories);
+
+	metrics_writer writer;
+	m_command_stats.metrics(request.categories, metric_labels(), writer);
+
+	std::unique_lock<std::mutex> guard(m_provider_mutex);
+	for (auto &item : m_stat_providers) {
+		item.second->metrics(request, writer);
+	}
+	guard.unlock();
+
+	DNET_LOG_DEBUG(m_monitor.node(), "monitor: finished generating metrics for categories: {:x}",
+	               request.categories);
+	return writer.str();
 }
 
 std::string statistics::report(const request &request)
 {
-	rapidjson::Document report;
+	return m_snapshots->get(request, [&](uint64_t version) { return build_report(request, version); });
+}
+
+std::string statistics::build_report(const request &request, uint64_t version)
+{
 	DNET_LOG_INFO(m_monitor.node(), "monitor: collecting statistics for categories: {:x}", request.categories);
-	report.SetObject();
-	auto &allocator = report.GetAllocator();
+
+	rapidjson::StringBuffer buffer;
+	json_writer writer(buffer);
+	writer.StartObject();
 
 	dnet_time time;
 	dnet_current_time(&time);
 
-	rapidjson::Value timestamp(rapidjson::kObjectType);
-	timestamp.AddMember("tv_sec", time.tsec, allocator);
-	timestamp.AddMember("tv_usec", time.tnsec / 1000, allocator);
-	report.AddMember("timestamp", timestamp, allocator);
-	report.AddMember("string_timestamp", dnet_print_time(&time), allocator);
+	writer.String("timestamp");
+	writer.StartObject();
+	write_member(writer, "tv_sec", time.tsec);
+	write_member(writer, "tv_usec", time.tnsec / 1000);
+	writer.EndObject();
+	write_member(writer, "string_timestamp", dnet_print_time(&time));
 
-	report.AddMember("monitor_status", "enabled", allocator);
-	report.AddMember("categories", request.categories, allocator);
+	write_member(writer, "monitor_status", "enabled");
+	write_member(writer, "categories", request.categories);
 
 	if (request.categories & DNET_MONITOR_COMMANDS) {
-		rapidjson::Value commands_value(rapidjson::kObjectType);
-		m_command_stats.commands_report(m_monitor.node(), commands_value, allocator);
+		writer.String("commands");
+		writer.StartObject();
+		m_command_stats.commands_report(m_monitor.node(), writer);
 
-		rapidjson::Value clients_stat(rapidjson::kObjectType);
-		clients_stat_json(m_monitor.node(), clients_stat, allocator);
-		commands_value.AddMember("clients", clients_stat, allocator);
+		writer.String("clients");
+		clients_stat_json(m_monitor.node(), writer);
+		writer.EndObject();
+	}
 
-		report.AddMember("commands", commands_value, allocator);
+	if (request.categories & DNET_MONITOR_LATENCY) {
+		writer.String("latency");
+		writer.StartObject();
+		m_command_stats.latency_report(writer);
+		writer.EndObject();
 	}
 
 	if (request.categories & DNET_MONITOR_STATS) {
 #if defined(HAVE_HANDYSTATS) && !defined(HANDYSTATS_DISABLE)
-		rapidjson::Document stats(&allocator);
-		stats.Parse<0>(HANDY_JSON_DUMP().c_str());
-		report.AddMember("stats", static_cast<rapidjson::Value &>(stats), allocator);
+		const auto stats = HANDY_JSON_DUMP();
+		writer.String("stats");
+		if (!copy_json(stats.c_str(), stats.size(), writer))
+			writer.Null();
 #else
-		report.AddMember("__stats__", "stats subsystem disabled at compile time", allocator);
+		write_member(writer, "__stats__", "stats subsystem disabled at compile time");
 #endif
 	}
 
@@ -255,14 +503,17 @@ std::string statistics::report(const request &request)
 		const auto &provider_name = item.first;
 		const auto &provider = item.second;
 
-		rapidjson::Value value;
-		provider->statistics(request, value, allocator);
-		report.AddMember(provider_name.c_str(), allocator, value, allocator);
+		writer.String(provider_name.c_str(), provider_name.size());
+		provider->write_statistics(request, writer);
 	}
+	guard.unlock();
+
+	write_member(writer, "version", version);
+	writer.EndObject();
 
 	DNET_LOG_DEBUG(m_monitor.node(), "monitor: finished generating json statistics for categories: {:x}",
 	               request.categories);
-	return convert_report(report);
+	return std::string(buffer.GetString(), buffer.Size());
 }
 
 }} /* namespace ioremap::monitor */
@@ -21,16 +21,23 @@
 #define __DNET_MONITOR_STATISTICS_HPP
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
 #include <map>
+#include <vector>
 
-#include "rapidjson/document.h"
 
 #include "library/elliptics.h"
 
+#include "cache_aligned.hpp"
+#include "histogram.hpp"
+#include "json_writer.hpp"
+#include "metrics.hpp"
+#include "snapshot.hpp"
 #include "monitor.h"
+#include "request_samples.hpp"
 #include "stat_provider.hpp"
 #include "top.hpp"
 
@@ -85,6 +92,19 @@ struct command_counters {
 	}
 };
 
+/*!
+ * \internal
+ *
+ * Kinds of command latencies collected into histograms
+ */
+enum latency_type {
+	handle_latency = 0,	// time spent on the command handle
+	queue_latency,		// time the command spent in io queue
+	recv_latency,		// time spent on receiving the command
+	send_latency,		// time spent on sending a reply, it is not split by cache/disk
+	latency_types_count
+};
+
 /*!
  * \internal
  *
@@ -92,10 +112,16 @@ struct command_counters {
  * This structure can be embedded into each backend and also into @statistics class
  * to maintain global command counters.
  *
+ * Counters are sharded by threads: every thread updates only its own shard by relaxed atomic
+ * increments without any lock, shards are summed up only when report is requested.
  */
 class command_stats {
 public:
 	command_stats();
+	~command_stats();
+
+	command_stats(const command_stats &) = delete;
+	command_stats &operator =(const command_stats &) = delete;
 
 	void clear();
 
@@ -112,27 +138,73 @@ public:
 	                     const uint64_t size, const unsigned long time);
 
 	/*!
-	 * Fills \a a stat_value by commands statistics and returns it
-	 * \a allocator - document allocator that is required by rapidjson
+	 * Adds latency \a time of \a type of the command \a cmd to the corresponding histogram
 	 */
-	void commands_report(dnet_node *node,
-	                     rapidjson::Value &stat_value,
-	                     rapidjson::Document::AllocatorType &allocator) const;
+	void latency_counter(const int cmd, const int cache, const latency_type type, const uint64_t time);
+
+	/*!
+	 * Writes latency histograms of commands to \a writer as members of the currently opened object
+	 */
+	void latency_report(json_writer &writer) const;
+
+	/*!
+	 * Writes commands statistics and latencies requested by \a categories to \a writer,
+	 * every sample gets \a labels in addition to its own ones
+	 */
+	void metrics(uint64_t categories, const metric_labels &labels, metrics_writer &writer) const;
+
+	/*!
+	 * Writes commands statistics to \a writer as members of the currently opened object,
+	 * \a node is set only for global counters to add node's counters of storage and proxy
+	 */
+	void commands_report(dnet_node *node, json_writer &writer) const;
+
+	/*!
+	 * Returns commands statistics summed up over all shards
+	 */
+	std::vector<command_counters> collect() const;
+
+	/*!
+	 * Max number of shards, threads are spread over them round-robin
+	 */
+	static const size_t max_shards = 64;
 
 private:
 	/*!
 	 * \internal
 	 *
-	 * Lock for controlling access to commands statistics
+	 * Counters of a single shard: command x {cache, disk} x {outside, internal} x
+	 * {successes, failures, size, time}. Shards are allocated separately by make_cache_aligned()
+	 * and are padded to cache line size, so threads don't update the same cache lines.
 	 */
-	mutable std::mutex m_cmd_stats_mutex;
+	struct alignas(cache_line_size) shard {
+		~shard();
+
+		std::atomic<uint64_t> values[__DNET_CMD_MAX][2][2][4];
+		/* command x {cache, disk} x latency type, histograms are allocated on the first use */
+		std::atomic<latency_histogram *> latencies[__DNET_CMD_MAX][2][latency_types_count];
+	};
 
 	/*!
 	 * \internal
 	 *
-	 * Commands statistics
+	 * Returns shard of the calling thread allocating it on the first use
 	 */
-	std::vector<command_counters> m_cmd_stats;
+	shard &get_shard();
+
+	/*!
+	 * \internal
+	 *
+	 * Returns histogram of \a type latencies of \a cmd from \a source merged over all shards
+	 */
+	histogram_snapshot latency_snapshot(int cmd, int source, int type) const;
+
+	/*!
+	 * \internal
+	 *
+	 * Commands statistics shards, nullptr until some thread uses the shard
+	 */
+	std::atomic<shard *> m_shards[max_shards];
 };
 
 /*!
@@ -155,12 +227,23 @@ public:
 	/*!
 	 * \internal
 	 *
-	 * Generates and returns json statistics for @request
-	 * For that statistics will interview all external statistics provider
-	 * which supports this @request
+	 * Returns compressed json statistics for @request
+	 * The report is taken from the cache if it was built recently enough,
+	 * otherwise statistics will interview all external statistics provider
+	 * which supports this @request. If @request has since_version,
+	 * only values changed since that version may be returned.
 	 */
 	std::string report(const request &request);
 
+	/*!
+	 * \internal
+	 *
+	 * Generates and returns statistics for @request in Prometheus text format
+	 * For that statistics will interview all external statistics provider
+	 * which supports this @request and metrics
+	 */
+	std::string metrics(const request &request);
+
 	/*!
 	 * \internal
 	 *
@@ -175,6 +258,13 @@ public:
 	void command_counter(const int cmd, const uint64_t trans, const int err, const int cache,
 	                     const uint64_t size, const unsigned long time);
 
+	/*!
+	 * \internal
+	 *
+	 * Adds latency \a time of \a type of the command \a cmd to node-level histograms
+	 */
+	void latency_counter(const int cmd, const int cache, const latency_type type, const uint64_t time);
+
 	/*!
 	 * \internal
 	 *
@@ -185,7 +275,18 @@ public:
 
 	typedef std::shared_ptr<top_stats> top_stats_ptr;
 	top_stats_ptr get_top_stats() const { return m_top_stats; }
+
+	typedef std::shared_ptr<request_samples> request_samples_ptr;
+	request_samples_ptr get_request_samples() const { return m_request_samples; }
 private:
+	/*!
+	 * \internal
+	 *
+	 * Builds json statistics for @request interviewing all external statistics provider,
+	 * @version is written to "version" member of the report
+	 */
+	std::string build_report(const request &request, uint64_t version);
+
 	/*!
 	 * \internal
 	 *
@@ -217,6 +318,15 @@ private:
 	std::map<std::string, std::shared_ptr<stat_provider>> m_stat_providers;
 
 	top_stats_ptr m_top_stats;
+
+	request_samples_ptr m_request_samples;
+
+	/*!
+	 * \internal
+	 *
+	 * Cache of built reports
+	 */
+	std::unique_ptr<snapshot_cache> m_snapshots;
 };
 
 }} /* namespace ioremap::monitor */
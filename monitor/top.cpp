@@ -19,67 +19,200 @@
 
 #include "top.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
 #include "elliptics/interface.h"
 
 namespace ioremap { namespace monitor {
 
+const size_t top_stats::max_shards;
+
+top_stats::shard::shard(size_t capacity, time_t time)
+: last_decay(time)
+, by_size(capacity)
+, by_frequency(capacity) {}
+
 top_stats::top_stats(size_t top_length, size_t events_size, int period_in_seconds)
-: m_stats(events_size, period_in_seconds)
-, m_top_length(top_length)
-, m_period_in_seconds(period_in_seconds) {}
+: m_top_length(top_length)
+, m_period_in_seconds(period_in_seconds)
+, m_capacity(std::max(top_length, events_size / (max_shards * 2 * space_saving::item_size()))) {
+	for (auto &shard : m_shards) {
+		shard.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+top_stats::~top_stats() {
+	for (auto &shard : m_shards) {
+		cache_aligned_deleter<top_stats::shard>()(shard.load(std::memory_order_relaxed));
+	}
+}
+
+top_stats::shard &top_stats::get_shard(time_t time) {
+	static std::atomic<size_t> next_slot{0};
+	thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % max_shards;
+
+	auto &place = m_shards[slot];
+	shard *current = place.load(std::memory_order_acquire);
+	if (current)
+		return *current;
+
+	auto created = make_cache_aligned<shard>(m_capacity, time);
+	if (place.compare_exchange_strong(current, created.get(), std::memory_order_acq_rel))
+		return *created.release();
+	return *current;
+}
+
+void top_stats::decay(shard &shard, time_t time) const {
+	if (time <= shard.last_decay)
+		return;
+
+	const double factor = std::exp(-static_cast<double>(time - shard.last_decay) / m_period_in_seconds);
+	shard.by_size.decay(factor);
+	shard.by_frequency.decay(factor);
+	shard.last_decay = time;
+}
 
 void top_stats::update_stats(const struct dnet_cmd *cmd, uint64_t size)
 {
 	const bool is_read = (cmd->cmd == DNET_CMD_READ) || (cmd->cmd == DNET_CMD_READ_NEW);
 	if (size > 0 && is_read) {
-		key_stat_event event(cmd->id, size, 1., time(nullptr));
-		m_stats.add_event(event, event.get_time());
+		add(cmd->id, size, time(nullptr));
 	}
 }
 
+void top_stats::add(const struct dnet_id &id, uint64_t size, time_t time) {
+	auto &current = get_shard(time);
+
+	std::lock_guard<std::mutex> guard(current.lock);
+	decay(current, time);
+	current.by_size.add(id, size, 1., time);
+	current.by_frequency.add(id, 1., size, time);
+}
+
+namespace {
+struct id_less {
+	bool operator()(const dnet_id &lhs, const dnet_id &rhs) const {
+		return dnet_id_cmp(&lhs, &rhs) < 0;
+	}
+};
+
+struct merged_item {
+	space_saving::item item;
+	/* sum of min counts of full shards which track the key */
+	double tracked_min;
+};
+} /* namespace */
+
+std::vector<space_saving::item> top_stats::get_top(top_order order, size_t k, time_t time) {
+	std::map<dnet_id, merged_item, id_less> merged;
+	/* sum of min counts of all full shards, key which isn't tracked by a full shard could get up to its min there */
+	double full_min = 0;
+
+	for (auto &place : m_shards) {
+		shard *current = place.load(std::memory_order_acquire);
+		if (!current)
+			continue;
+
+		std::lock_guard<std::mutex> guard(current->lock);
+		decay(*current, time);
+
+		const auto &summary = (order == by_size) ? current->by_size : current->by_frequency;
+		const double min = summary.full() ? summary.min_count() : 0.;
+		full_min += min;
+
+		for (const auto &item : summary.items()) {
+			auto it = merged.find(item.id);
+			if (it == merged.end()) {
+				merged.emplace(item.id, merged_item{item, min});
+				continue;
+			}
+
+			auto &result = it->second;
+			result.item.count += item.count;
+			result.item.error += item.error;
+			result.item.secondary += item.secondary;
+			result.item.last_access = std::max(result.item.last_access, item.last_access);
+			result.tracked_min += min;
+		}
+	}
+
+	std::vector<space_saving::item> top;
+	top.reserve(merged.size());
+	for (const auto &it : merged) {
+		auto item = it.second.item;
+		if (time - item.last_access > m_period_in_seconds)
+			continue;
+
+		const double untracked = full_min - it.second.tracked_min;
+		item.count += untracked;
+		item.error += untracked;
+		top.push_back(item);
+	}
+
+	k = std::min(top.size(), k);
+	std::partial_sort(top.begin(), top.begin() + k, top.end(),
+		[] (const space_saving::item &lhs, const space_saving::item &rhs) {
+			return lhs.count > rhs.count;
+		});
+	top.resize(k);
+	return top;
+}
+
 top_provider::top_provider(std::shared_ptr<top_stats> top_stats)
 : m_top_stats(top_stats)
 {
 }
 
-static void fill_top_stat(const key_stat_event &key_event,
-                          rapidjson::Value &stat_array,
-                          rapidjson::Document::AllocatorType &allocator) {
-	rapidjson::Value key_stat(rapidjson::kObjectType);
+static void fill_top_stat(const space_saving::item &item, top_stats::top_order order, json_writer &writer) {
+	writer.StartObject();
 
-	key_stat.AddMember("group", key_event.get_key()->group_id, allocator);
-	rapidjson::Value id;
-	id.SetString(dnet_dump_id_str_full(key_event.get_key()->id), allocator);
-	key_stat.AddMember("id", id, allocator);
-	key_stat.AddMember("size", key_event.get_weight(), allocator);
-	key_stat.AddMember("frequency", static_cast<uint64_t>(key_event.get_frequency()), allocator);
+	write_member(writer, "group", item.id.group_id);
+	write_member(writer, "id", dnet_dump_id_str_full(item.id.id));
 
-	stat_array.PushBack(key_stat, allocator);
+	if (order == top_stats::by_size) {
+		write_member(writer, "size", static_cast<uint64_t>(std::llround(item.count)));
+		write_member(writer, "size_error", static_cast<uint64_t>(std::llround(item.error)));
+		write_member(writer, "frequency", item.secondary);
+	} else {
+		write_member(writer, "size", static_cast<uint64_t>(std::llround(item.secondary)));
+		write_member(writer, "frequency", item.count);
+		write_member(writer, "frequency_error", item.error);
+	}
+
+	writer.EndObject();
 }
 
-void top_provider::statistics(const request &request,
-                              rapidjson::Value &value,
-                              rapidjson::Document::AllocatorType &allocator) const {
-	if (!(request.categories & DNET_MONITOR_TOP))
-		return;
+static void fill_top(top_stats &stats, top_stats::top_order order, time_t time, json_writer &writer) {
+	const auto top = stats.get_top(order, stats.get_top_length(), time);
+
+	writer.StartArray();
+	for (const auto &item : top) {
+		fill_top_stat(item, order, writer);
+	}
+	writer.EndArray();
+}
 
-	value.SetObject();
+void top_provider::write_statistics(const request &request, json_writer &writer) const {
+	if (!(request.categories & DNET_MONITOR_TOP)) {
+		writer.Null();
+		return;
+	}
 
-	std::vector<key_stat_event> top_size_keys;
-	auto& event_stats = m_top_stats->get_stats();
-	event_stats.get_top(m_top_stats->get_top_length(), time(nullptr), top_size_keys);
+	const time_t now = time(nullptr);
 
-	rapidjson::Value stat_array(rapidjson::kArrayType);
-	stat_array.Reserve(top_size_keys.size(), allocator);
+	writer.StartObject();
+	write_member(writer, "top_result_limit", m_top_stats->get_top_length());
+	write_member(writer, "period_in_seconds", m_top_stats->get_period());
+	write_member(writer, "sketch_capacity", m_top_stats->get_capacity());
 
-	for (auto it = top_size_keys.cbegin(); it != top_size_keys.cend(); ++it) {
-		const auto &key_stat = *it;
-		fill_top_stat(key_stat, stat_array, allocator);
-	}
+	writer.String("top_by_size");
+	fill_top(*m_top_stats, top_stats::by_size, now, writer);
 
-	value.AddMember("top_result_limit", m_top_stats->get_top_length(), allocator);
-	value.AddMember("period_in_seconds", m_top_stats->get_period(), allocator);
-	value.AddMember("top_by_size", stat_array, allocator);
+	writer.String("top_by_frequency");
+	fill_top(*m_top_stats, top_stats::by_frequency, now, writer);
+	writer.EndObject();
 }
 
 }} /* namespace ioremap::monitor */
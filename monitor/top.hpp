@@ -20,8 +20,13 @@
 #ifndef __DNET_MONITOR_TOP_HPP
 #define __DNET_MONITOR_TOP_HPP
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "cache_aligned.hpp"
 #include "stat_provider.hpp"
-#include "event_stats.hpp"
+#include "heavy_hitters.hpp"
 #include "library/elliptics.h"
 
 /*
@@ -31,7 +36,8 @@
 
 /*
  * Default limit of memory for collecting information about events, in bytes.
- * Event approximate size is 100 bytes, so default size should be enough for storing ~10000 events
+ * Tracked key takes ~130 bytes and is tracked by two summaries of up to top_stats::max_shards shards,
+ * so default size is enough for ~240 keys in every summary
  */
 #define DNET_DEFAULT_MONITOR_TOP_EVENTS_SIZE 1000000
 
@@ -42,85 +48,87 @@
 
 namespace ioremap { namespace monitor {
 
-class key_stat_event;
-
-}}  /* namespace ioremap::monitor */
-
-namespace ioremap { namespace cache {
-
-template<>
-struct treap_node_traits<ioremap::monitor::key_stat_event>
-{
-	typedef const struct dnet_id* key_type;
-	typedef size_t priority_type;
-};
-
-}}  /* namespace ioremap::cache */
-
-namespace ioremap { namespace monitor {
-
-class key_stat_event : public ioremap::cache::treap_node_t<key_stat_event> {
-public:
-	key_stat_event() = default;
-	key_stat_event(const struct dnet_id &id, uint64_t size, double frequency, time_t last_access)
-	: m_id(id), m_size(size), m_frequency(frequency), m_last_access(last_access)
-	{}
-
-	uint64_t get_weight() const { return m_size; }
-	void set_weight(uint64_t weight) { m_size = weight; }
-
-	double get_frequency() const { return m_frequency; }
-	void set_frequency(double freq) { m_frequency = freq; }
-
-	time_t get_time() const {return m_last_access; }
-	void set_time(time_t time) { m_last_access = time; }
-
-	// treap_node_t
-	typedef ioremap::cache::treap_node_traits<key_stat_event>::key_type key_type;
-	typedef ioremap::cache::treap_node_traits<key_stat_event>::priority_type priority_type;
-
-	key_type get_key() const { return &m_id; }
-	priority_type get_priority() const { return m_last_access; }
-
-	inline static int key_compare(const key_type &lhs, const key_type &rhs) {
-		return dnet_id_cmp(lhs, rhs);
-	}
-
-	inline static int priority_compare(const priority_type &lhs, const priority_type &rhs) {
-		if (lhs < rhs) {
-			return 1;
-		}
-
-		if (lhs > rhs) {
-			return -1;
-		}
-
-		return 0;
-	}
-
-private:
-	struct dnet_id	m_id;
-	uint64_t	m_size;
-	double		m_frequency;
-	time_t		m_last_access;
-};
-
+/*!
+ * \internal
+ *
+ * Top keys by read traffic and by number of reads.
+ *
+ * Keys are counted by Space-Saving summaries (see space_saving) with exponentially decayed weights:
+ * every second weights are multiplied by exp(-1 / period_in_seconds), so under steady load weight of a key
+ * approximates its traffic during the last period_in_seconds.
+ *
+ * Summaries are sharded by threads like command_stats: every thread updates only its own shard
+ * under its own lock which is taken by anyone else only when the report is built.
+ * Shards are merged on request, so reported counts keep Space-Saving error bounds.
+ */
 class top_stats {
 public:
+	enum top_order {
+		by_size,
+		by_frequency
+	};
+
+	/*!
+	 * \a top_length - max number of reported keys, \a events_size - memory limit of all shards in bytes,
+	 * \a period_in_seconds - decay period
+	 */
 	top_stats(size_t top_length, size_t events_size, int period_in_seconds);
+	~top_stats();
+
+	top_stats(const top_stats &) = delete;
+	top_stats &operator =(const top_stats &) = delete;
 
 	void update_stats(const struct dnet_cmd *cmd, uint64_t size);
 
+	/*!
+	 * Accounts access to \a id with \a size bytes at \a time
+	 */
+	void add(const struct dnet_id &id, uint64_t size, time_t time);
+
+	/*!
+	 * Returns up to \a k keys with the largest weights of \a order which were accessed
+	 * within the period before \a time, the heaviest keys go first
+	 */
+	std::vector<space_saving::item> get_top(top_order order, size_t k, time_t time);
+
 	size_t get_top_length() const { return m_top_length; }
 	int get_period() const { return m_period_in_seconds; }
+	/* max number of keys tracked by every shard */
+	size_t get_capacity() const { return m_capacity; }
 
-	typedef event_stats<key_stat_event> event_stats_t;
-	event_stats_t& get_stats() { return m_stats; }
+	/*!
+	 * Max number of shards, threads are spread over them round-robin
+	 */
+	static const size_t max_shards = 16;
 
 private:
-	event_stats_t m_stats;
+	struct alignas(cache_line_size) shard {
+		shard(size_t capacity, time_t time);
+
+		std::mutex	lock;
+		time_t		last_decay;
+		space_saving	by_size;
+		space_saving	by_frequency;
+	};
+
+	/*!
+	 * \internal
+	 *
+	 * Returns shard of the calling thread allocating it on the first use
+	 */
+	shard &get_shard(time_t time);
+
+	/*!
+	 * \internal
+	 *
+	 * Decays weights of \a shard by time elapsed since its last decay, shard's lock must be held
+	 */
+	void decay(shard &shard, time_t time) const;
+
 	const size_t m_top_length;
 	const int m_period_in_seconds;
+	const size_t m_capacity;
+	std::atomic<shard *> m_shards[max_shards];
 };
 
 /*!
@@ -130,9 +138,7 @@ class top_provider : public stat_provider {
 public:
 	top_provider(std::shared_ptr<top_stats> top_stats);
 
-	void statistics(const request &request,
-	                rapidjson::Value &value,
-	                rapidjson::Document::AllocatorType &allocator) const override;
+	void write_statistics(const request &request, json_writer &writer) const override;
 
 private:
 	std::shared_ptr<top_stats> m_top_stats;
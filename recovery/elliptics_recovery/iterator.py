@@ -217,11 +217,12 @@ class Iterator(object):
     Wrapper on top of elliptics new iterator and it's result container
     """
 
-    def __init__(self, node, group, separately=False, trace_id=0):
+    def __init__(self, node, group, separately=False, trace_id=0, parallelism=0):
         self.session = elliptics.newapi.Session(node)
         self.session.groups = [group]
         self.session.trace_id = trace_id
         self.separately = separately
+        self.parallelism = parallelism
 
     def _get_key_range_id(self, key):
         if not self.separately:
@@ -362,7 +363,8 @@ class Iterator(object):
                                            backend_id=backend_id,
                                            flags=flags,
                                            key_ranges=ranges,
-                                           time_range=timestamp_range)
+                                           time_range=timestamp_range,
+                                           parallelism=self.parallelism)
 
     def _on_key_response(self, results, record, address, backend_id):
         if record.status == 0:
@@ -62,7 +62,8 @@ def iterate_node(arg):
             flags |= elliptics.iterator_flags.ts_range
 
         log.debug("Running iterator on node: {0}/{1}".format(address, backend_id))
-        iterator = Iterator(node, node_id.group_id, separately=True, trace_id=ctx.trace_id)
+        iterator = Iterator(node, node_id.group_id, separately=True, trace_id=ctx.trace_id,
+                            parallelism=ctx.iteration_parallelism)
         results, results_len = iterator.iterate_with_stats(
             eid=node_id,
             timestamp_range=timestamp_range,
@@ -0,0 +1,119 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark of per-request access logs: every request creates access context, fills it the way
+ * the server does for READ_NEW, accounts a number of replies and releases it. Prints time per request
+ * paid by the releasing thread when the record is printed synchronously and when it is handed over
+ * to the background access writer, for requests with inline and with overflowed replies.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "elliptics/session.hpp"
+#include "library/access_context.h"
+#include "library/elliptics.h"
+#include "library/logger.hpp"
+
+using namespace ioremap::elliptics;
+
+namespace {
+
+double run(dnet_node *node, size_t requests, size_t replies) {
+	typedef std::chrono::steady_clock clock;
+
+	dnet_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.cmd = DNET_CMD_READ_NEW;
+
+	dnet_addr addr;
+	memset(&addr, 0, sizeof(addr));
+
+	const auto start = clock::now();
+	for (size_t i = 0; i < requests; ++i) {
+		cmd.trans = i;
+		cmd.id.id[0] = i;
+
+		auto context = dnet_access_context_create(node);
+		dnet_access_context_set_request(context, &cmd, &addr, sizeof(cmd), 10, 20);
+		dnet_access_context_set_access(context, DNET_ACCESS_SERVER, nullptr);
+		context->set_id(cmd.id);
+		dnet_access_context_add_uint(context, "backend_id", 1);
+		dnet_access_context_add_uint(context, "size", 4096);
+		for (size_t reply = 0; reply < replies; ++reply) {
+			dnet_access_context_add_reply(context, 30, 40, 4096);
+		}
+		dnet_access_context_set_status(context, 0);
+		dnet_access_access_put(context);
+	}
+
+	return std::chrono::duration<double, std::nano>(clock::now() - start).count() / requests;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	size_t requests;
+	std::string log_file;
+
+	bpo::options_description description("Options");
+	description.add_options()
+		("help", "this help message")
+		("requests", bpo::value<size_t>(&requests)->default_value(1000000), "number of requests")
+		("log-file", bpo::value<std::string>(&log_file)->default_value("/dev/null"), "access log file")
+		;
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl << description << std::endl;
+		return 1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	node n(make_file_logger(log_file, DNET_LOG_INFO));
+	dnet_node *native = n.get_native();
+
+	/* replies which fit into the record and ones which overflow it */
+	const std::vector<size_t> replies{1, dnet_access_record::max_replies, 4 * dnet_access_record::max_replies};
+
+	for (const size_t count : replies) {
+		const double sync = run(native, requests, count);
+		std::cout << "access log: replies: " << count << ", synchronous: " << sync << " ns" << std::endl;
+	}
+
+	/* the node frees the writer with itself */
+	native->access_writer = dnet_access_writer_create(native);
+	for (const size_t count : replies) {
+		const double staged = run(native, requests, count);
+		std::cout << "access log: replies: " << count << ", staged: " << staged << " ns" << std::endl;
+	}
+
+	return 0;
+}
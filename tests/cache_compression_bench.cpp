@@ -0,0 +1,202 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark of cache compression: starts two server nodes whose SLRU caches have the same size,
+ * one without compression and one compressing with zlib, and replays the same zipf-distributed
+ * cache-only reads of json-like objects against both of them. A missed object is written to the cache.
+ * Prints hit rate, time per request and how many objects and bytes the cache keeps at the end.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "test_base.hpp"
+#include "cache/cache.hpp"
+#include "library/backend.h"
+
+using namespace ioremap::elliptics;
+
+namespace {
+
+struct options {
+	size_t cache_size;
+	size_t objects;
+	size_t object_size;
+	size_t requests;
+	double zipf;
+	size_t threshold;
+	unsigned ratio;
+	std::string path;
+};
+
+struct result {
+	size_t hits;
+	double elapsed_ms;
+	ioremap::cache::cache_stats stats;
+};
+
+std::string generate_object(std::mt19937 &gen, size_t size) {
+	static const char *words[] = {"\"id\"", "\"name\"", "\"timestamp\"", "\"size\"", "\"status\"", "\"ok\"",
+	                              "\"error\"", "\"group\"", "\"backend\"", "\"value\""};
+	std::uniform_int_distribution<size_t> word(0, sizeof(words) / sizeof(words[0]) - 1);
+	std::uniform_int_distribution<size_t> number(0, 100000);
+
+	std::string object = "{";
+	while (object.size() < size) {
+		object += words[word(gen)];
+		object += ":";
+		object += std::to_string(number(gen));
+		object += ",";
+	}
+	object.resize(size);
+	return object;
+}
+
+tests::server_config make_server_config(const options &opts, int group, const std::string &compression) {
+	return tests::server_config::default_value().apply_options(tests::config_data()
+		("group", group)
+		("cache_size", std::to_string(opts.cache_size))
+		("cache_shards", 1)
+		("cache_compression", compression)
+		("cache_compression_threshold", static_cast<int64_t>(opts.threshold))
+		("cache_compression_ratio", static_cast<int64_t>(opts.ratio))
+	);
+}
+
+result run(const tests::nodes_data &setup, size_t node_index, int group, const std::vector<std::string> &objects,
+           const std::vector<size_t> &requests) {
+	typedef std::chrono::steady_clock clock;
+
+	session sess(*setup.node);
+	sess.set_groups({group});
+	sess.set_ioflags(DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY);
+	sess.set_exceptions_policy(session::no_exceptions);
+
+	result res{0, 0, ioremap::cache::cache_stats()};
+
+	const auto start = clock::now();
+	for (size_t index : requests) {
+		const key k("cache compression bench object " + std::to_string(index));
+
+		auto read_result = sess.read_data(k, 0, 0);
+		read_result.wait();
+		if (!read_result.error()) {
+			++res.hits;
+			continue;
+		}
+
+		auto write_result = sess.write_data(k, objects[index], 0);
+		write_result.wait();
+		if (write_result.error()) {
+			throw std::runtime_error("failed to write object to cache: " + write_result.error().message());
+		}
+	}
+	res.elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+	dnet_node *node = setup.nodes[node_index].get_native();
+	res.stats = node->io->backends_manager->get(0)->cache()->get_total_cache_stats();
+	return res;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	options opts;
+
+	bpo::options_description description("Options");
+	description.add_options()
+		("help", "this help message")
+		("cache-size", bpo::value<size_t>(&opts.cache_size)->default_value(64 << 20), "cache size in bytes")
+		("objects", bpo::value<size_t>(&opts.objects)->default_value(20000), "number of distinct objects")
+		("object-size", bpo::value<size_t>(&opts.object_size)->default_value(8192), "size of an object")
+		("requests", bpo::value<size_t>(&opts.requests)->default_value(200000), "number of reads")
+		("zipf", bpo::value<double>(&opts.zipf)->default_value(0.9), "zipf exponent of key popularity")
+		("threshold", bpo::value<size_t>(&opts.threshold)->default_value(DNET_DEFAULT_CACHE_COMPRESSION_THRESHOLD),
+		 "min size of compressed object")
+		("ratio", bpo::value<unsigned>(&opts.ratio)->default_value(DNET_DEFAULT_CACHE_COMPRESSION_RATIO),
+		 "max size of compressed object in percents of raw size")
+		("path", bpo::value<std::string>(&opts.path)->default_value("cache_compression_bench"),
+		 "where to store servers' files")
+		;
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl << description << std::endl;
+		return 1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	std::mt19937 gen(0);
+
+	std::vector<std::string> objects;
+	objects.reserve(opts.objects);
+	for (size_t i = 0; i < opts.objects; ++i) {
+		objects.emplace_back(generate_object(gen, opts.object_size));
+	}
+
+	std::vector<double> weights(opts.objects);
+	for (size_t i = 0; i < opts.objects; ++i) {
+		weights[i] = 1. / std::pow(i + 1, opts.zipf);
+	}
+	std::discrete_distribution<size_t> popularity(weights.begin(), weights.end());
+
+	std::vector<size_t> requests(opts.requests);
+	for (auto &index : requests) {
+		index = popularity(gen);
+	}
+
+	const std::vector<std::string> compressions{"none", "zlib"};
+
+	std::ostringstream servers_log;
+	tests::start_nodes_config start_config(servers_log, std::vector<tests::server_config>({
+		make_server_config(opts, 1, compressions[0]),
+		make_server_config(opts, 2, compressions[1])
+	}), opts.path);
+	start_config.monitor = false;
+
+	auto setup = tests::start_nodes(start_config);
+
+	for (size_t i = 0; i < compressions.size(); ++i) {
+		const auto res = run(*setup, i, i + 1, objects, requests);
+
+		std::cout << "compression: " << compressions[i]
+		          << ", hit rate: " << 100. * res.hits / opts.requests << "%"
+		          << ", time per request: " << 1000. * res.elapsed_ms / opts.requests << " us"
+		          << ", cached objects: " << res.stats.number_of_objects
+		          << ", cached bytes: " << res.stats.size_of_objects
+		          << ", compressed objects: " << res.stats.number_of_compressed_objects
+		          << std::endl;
+	}
+
+	return 0;
+}
@@ -16,12 +16,19 @@
 
 #include "test_base.hpp"
 #include "cache/cache.hpp"
+#include "cache/negative_cache.hpp"
+#include "cache/snapshot.hpp"
+#include "example/config.hpp"
 #include "library/backend.h"
 
 #include "library/backend.h"
 
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <list>
 #include <stdexcept>
+#include <thread>
 
 #define BOOST_TEST_NO_MAIN
 #define BOOST_TEST_ALTERNATIVE_INIT_API
@@ -34,13 +41,64 @@ using namespace boost::unit_test;
 
 namespace tests {
 
+static int cache_sync_timeout = 1;
+
+/*
+ * Group 5 is served by a node with default cache settings and is used by most of the tests.
+ * Node serving group 6 flushes dirty records quickly in small batches by several threads,
+ * it is used only by test_cache_batched_sync.
+ * Node serving group 7 has negative cache enabled, it is used only by test_negative_cache_write.
+ * Node serving group 8 compresses cached data, it is used only by test_cache_compression.
+ * Node serving group 9 writes cache snapshot with data into @snapshot_dir when its backend is disabled
+ * and loads it back when the backend is enabled, it is used only by snapshot tests.
+ */
+static const int batched_sync_group = 6;
+static const int negative_cache_group = 7;
+static const int compression_group = 8;
+static const int snapshot_group = 9;
+
+static std::string snapshot_dir;
+
 static nodes_data::ptr configure_test_setup(const std::string &path)
 {
+	snapshot_dir = (path.empty() ? std::string(".") : path) + "/cache_snapshot";
+	create_directory(snapshot_dir);
+
 	start_nodes_config start_config(results_reporter::get_stream(), std::vector<server_config>({
 		server_config::default_value().apply_options(config_data()
 			("group", 5)
 			("cache_size", "100K")
 			("cache_shards", 1)
+		),
+		server_config::default_value().apply_options(config_data()
+			("group", batched_sync_group)
+			("cache_size", "100K")
+			("cache_shards", 1)
+			("cache_sync_timeout", cache_sync_timeout)
+			("cache_sync_batch_size", 4)
+			("cache_sync_threads", 2)
+		),
+		server_config::default_value().apply_options(config_data()
+			("group", negative_cache_group)
+			("negative_cache", config_data()
+				("size", 1000)
+				("ttl", 60000)
+			)
+		),
+		server_config::default_value().apply_options(config_data()
+			("group", compression_group)
+			("cache_size", "100K")
+			("cache_shards", 1)
+			("cache_sync_timeout", cache_sync_timeout)
+			("cache_compression", "zlib")
+			("cache_compression_threshold", 1024)
+		),
+		server_config::default_value().apply_options(config_data()
+			("group", snapshot_group)
+			("cache_size", "100K")
+			("cache_shards", 1)
+			("cache_snapshot_dir", snapshot_dir)
+			("cache_snapshot_data", true)
 		)
 	}), path);
 
@@ -143,6 +201,385 @@ static void test_cache_overflow(session &sess, const nodes_data *setup)
 	}
 }
 
+/*
+ * Dirty records are flushed to the backend by the cache life-check thread in batches sorted by key.
+ * Following test writes more records than fits into a single batch, waits until they are synced and
+ * checks that all of them reached the backend and flush progress is reported as completed.
+ */
+static void test_cache_batched_sync(session &sess, const nodes_data *setup)
+{
+	dnet_node *node = setup->nodes[1].get_native();
+	auto cache = node->io->backends_manager->get(0)->cache();
+
+	const size_t records_number = 20;
+	auto record_key = [] (size_t id) {
+		return key("batched sync test key " + std::to_string(id));
+	};
+	auto record_data = [] (size_t id) {
+		return "batched sync test data " + std::to_string(id);
+	};
+
+	for (size_t id = 0; id < records_number; ++id) {
+		ELLIPTICS_REQUIRE(write_result, sess.write_data(record_key(id), record_data(id), 0));
+	}
+
+	session disk_sess = sess.clone();
+	disk_sess.set_ioflags(DNET_IO_FLAGS_NOCACHE);
+	disk_sess.set_exceptions_policy(session::no_exceptions);
+
+	// records are flushed when all of them are read from the backend and no flush is in progress
+	auto flushed = [&] () {
+		for (size_t id = 0; id < records_number; ++id) {
+			auto result = disk_sess.read_data(record_key(id), 0, 0);
+			result.wait();
+			if (result.error() || result.get_one().file().to_string() != record_data(id))
+				return false;
+		}
+
+		auto stats = cache->get_total_cache_stats();
+		return stats.number_of_objects_to_sync == 0 && stats.sync_lag == 0;
+	};
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(cache_sync_timeout + 30);
+	while (!flushed() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	BOOST_REQUIRE(flushed());
+}
+
+static void test_cache_compression(session &sess, const nodes_data *setup)
+{
+	dnet_node *node = setup->nodes[3].get_native();
+	auto cache = node->io->backends_manager->get(0)->cache();
+
+	std::string data;
+	while (data.size() < 16 * 1024) {
+		data += "compressible cache data " + std::to_string(data.size()) + " ";
+	}
+
+	key k("compression test key");
+
+	cache->clear();
+	ELLIPTICS_REQUIRE(write_result, sess.write_data(k, data, 0));
+
+	auto stats = cache->get_total_cache_stats();
+	BOOST_REQUIRE_EQUAL(stats.number_of_compressed_objects, 1);
+	BOOST_REQUIRE_EQUAL(stats.raw_size_of_compressed_objects, data.size());
+	BOOST_REQUIRE_LT(stats.size_of_compressed_objects, data.size());
+	BOOST_REQUIRE_LT(stats.size_of_objects, data.size());
+
+	ELLIPTICS_COMPARE_REQUIRE(read_result, sess.read_data(k, 0, 0), data);
+	ELLIPTICS_COMPARE_REQUIRE(read_result_with_offset, sess.read_data(k, 100, 200), data.substr(100, 200));
+
+	// append rebuilds compressed data
+	const std::string tail = "appended compressed cache data";
+	data += tail;
+	session append_sess = sess.clone();
+	append_sess.set_ioflags(sess.get_ioflags() | DNET_IO_FLAGS_APPEND);
+	ELLIPTICS_REQUIRE(append_result, append_sess.write_data(k, tail, 0));
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_compressed_objects, 1);
+	ELLIPTICS_COMPARE_REQUIRE(appended_read_result, sess.read_data(k, 0, 0), data);
+
+	sleep(cache_sync_timeout + 2);
+
+	session disk_sess = sess.clone();
+	disk_sess.set_ioflags(DNET_IO_FLAGS_NOCACHE);
+	ELLIPTICS_COMPARE_REQUIRE(disk_read_result, disk_sess.read_data(k, 0, 0), data);
+}
+
+static ioremap::cache::snapshot_record make_snapshot_record(size_t index)
+{
+	ioremap::cache::snapshot_record record;
+	memset(&record.id, 0, sizeof(record.id));
+	record.id.id[0] = index;
+	dnet_current_time(&record.timestamp);
+	record.json_timestamp = record.timestamp;
+	record.user_flags = index;
+	record.lifetime = 0;
+	record.page_number = index % 2;
+	record.has_data = true;
+	record.json = "{\"index\": " + std::to_string(index) + "}";
+	record.data = "snapshot record data " + std::to_string(index);
+	return record;
+}
+
+/*
+ * Records written to cache snapshot are read back in the same order with the same contents.
+ * Snapshot whose record header claims more bytes than the file contains is rejected as corrupted
+ * before anything is allocated for the record.
+ */
+static void test_cache_snapshot_round_trip()
+{
+	using namespace ioremap::cache;
+
+	const std::string path = "cache_test.snapshot";
+	const size_t records_number = 10;
+
+	{
+		snapshot_writer writer(path, true);
+		BOOST_REQUIRE_EQUAL(writer.open(), 0);
+		for (size_t i = 0; i < records_number; ++i) {
+			BOOST_REQUIRE_EQUAL(writer.write(make_snapshot_record(i)), 0);
+		}
+		BOOST_REQUIRE_EQUAL(writer.commit(), 0);
+		BOOST_REQUIRE_EQUAL(writer.records(), records_number);
+	}
+
+	{
+		snapshot_reader reader(path);
+		BOOST_REQUIRE_EQUAL(reader.open(), 0);
+		BOOST_REQUIRE(reader.with_data());
+		BOOST_REQUIRE_EQUAL(reader.validate(), 0);
+
+		snapshot_record record;
+		for (size_t i = 0; i < records_number; ++i) {
+			const auto expected = make_snapshot_record(i);
+			BOOST_REQUIRE_EQUAL(reader.next(record), 1);
+			BOOST_REQUIRE_EQUAL(dnet_id_cmp_str(record.id.id, expected.id.id), 0);
+			BOOST_REQUIRE_EQUAL(record.user_flags, expected.user_flags);
+			BOOST_REQUIRE_EQUAL(record.page_number, expected.page_number);
+			BOOST_REQUIRE_EQUAL(record.json, expected.json);
+			BOOST_REQUIRE_EQUAL(record.data, expected.data);
+		}
+		BOOST_REQUIRE_EQUAL(reader.next(record), 0);
+	}
+
+	{
+		// corrupt data_size of the first record
+		FILE *file = fopen(path.c_str(), "r+");
+		BOOST_REQUIRE(file);
+		const uint64_t data_size = 1ULL << 60;
+		fseek(file, sizeof(snapshot_header) + offsetof(snapshot_record_header, data_size), SEEK_SET);
+		BOOST_REQUIRE_EQUAL(fwrite(&data_size, sizeof(data_size), 1, file), 1);
+		fclose(file);
+
+		snapshot_reader reader(path);
+		BOOST_REQUIRE_EQUAL(reader.open(), 0);
+
+		snapshot_record record;
+		BOOST_REQUIRE_EQUAL(reader.next(record), -EILSEQ);
+		BOOST_REQUIRE(record.data.empty());
+	}
+
+	unlink(path.c_str());
+}
+
+static const size_t snapshot_records_number = 10;
+
+static key snapshot_record_key(size_t index)
+{
+	return key("snapshot restore test key " + std::to_string(index));
+}
+
+static std::string snapshot_record_data(size_t index)
+{
+	return "snapshot restore test data " + std::to_string(index);
+}
+
+static std::string read_snapshot_file()
+{
+	std::ifstream file(snapshot_dir + "/cache.0.snapshot", std::ios::binary);
+	BOOST_REQUIRE(file);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_snapshot_file(const std::string &content)
+{
+	std::ofstream file(snapshot_dir + "/cache.0.snapshot", std::ios::binary | std::ios::trunc);
+	BOOST_REQUIRE(file.write(content.data(), content.size()));
+}
+
+static void wait_snapshot_loaded(ioremap::cache::cache_manager *cache)
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (!cache->snapshot_loaded() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	BOOST_REQUIRE(cache->snapshot_loaded());
+}
+
+/*
+ * Disables and enables back the backend of the node serving snapshot_group, @on_disabled is called in between.
+ * Returns cache of the enabled backend once loading of the snapshot is finished.
+ */
+static ioremap::cache::cache_manager *restart_snapshot_backend(session &sess, const nodes_data *setup,
+                                                            const std::function<void ()> &on_disabled)
+{
+	const server_node &node = setup->nodes[4];
+
+	ELLIPTICS_REQUIRE(disable_result, sess.disable_backend(node.remote(), 0));
+	on_disabled();
+	ELLIPTICS_REQUIRE(enable_result, sess.enable_backend(node.remote(), 0));
+
+	auto cache = node.get_native()->io->backends_manager->get(0)->cache();
+	BOOST_REQUIRE(cache);
+
+	wait_snapshot_loaded(cache);
+	return cache;
+}
+
+/*
+ * Cache is written into the snapshot when the backend is disabled and restored from it when the backend is enabled,
+ * restored records are served from the cache.
+ */
+static void test_cache_snapshot_restore(session &sess, const nodes_data *setup)
+{
+	auto cache = setup->nodes[4].get_native()->io->backends_manager->get(0)->cache();
+	// snapshot is written on disable only after the one left by previous run is loaded
+	wait_snapshot_loaded(cache);
+	cache->clear();
+
+	for (size_t i = 0; i < snapshot_records_number; ++i) {
+		ELLIPTICS_REQUIRE(write_result, sess.write_data(snapshot_record_key(i), snapshot_record_data(i), 0));
+	}
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_objects, snapshot_records_number);
+
+	cache = restart_snapshot_backend(sess, setup, [] () {});
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_objects, snapshot_records_number);
+
+	// route to the enabled backend is not known yet by the session
+	usleep(100 * 1000);
+
+	session cache_sess = sess.clone();
+	cache_sess.set_ioflags(DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY);
+	for (size_t i = 0; i < snapshot_records_number; ++i) {
+		ELLIPTICS_COMPARE_REQUIRE(read_result, cache_sess.read_data(snapshot_record_key(i), 0, 0),
+		                          snapshot_record_data(i));
+	}
+}
+
+/*
+ * Nothing is restored from the snapshot whose tail is truncated or whose record is corrupted.
+ */
+static void test_cache_snapshot_rejected(session &sess, const nodes_data *setup)
+{
+	using namespace ioremap::cache;
+
+	auto cache = setup->nodes[4].get_native()->io->backends_manager->get(0)->cache();
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_objects, snapshot_records_number);
+
+	std::string snapshot;
+	cache = restart_snapshot_backend(sess, setup, [&] () {
+		snapshot = read_snapshot_file();
+		BOOST_REQUIRE_GT(snapshot.size(), sizeof(snapshot_header) + sizeof(snapshot_footer));
+
+		// all records are intact, only the footer is lost
+		write_snapshot_file(snapshot.substr(0, snapshot.size() - sizeof(snapshot_footer)));
+	});
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_objects, 0);
+
+	cache = restart_snapshot_backend(sess, setup, [&] () {
+		// flip a byte of the last record's data
+		std::string corrupted = snapshot;
+		corrupted[corrupted.size() - sizeof(snapshot_footer) - 1] ^= 0xff;
+		write_snapshot_file(corrupted);
+	});
+	BOOST_REQUIRE_EQUAL(cache->get_total_cache_stats().number_of_objects, 0);
+}
+
+static dnet_raw_id make_raw_id(unsigned char first_byte)
+{
+	dnet_raw_id id;
+	memset(&id, 0, sizeof(id));
+	id.id[0] = first_byte;
+	return id;
+}
+
+/*
+ * Key inserted into negative cache is reported as missing, other keys are not.
+ */
+static void test_negative_cache_lookup()
+{
+	ioremap::cache::negative_cache cache(ioremap::cache::negative_cache_config{/*size*/ 64, /*ttl*/ 60000});
+
+	const auto missing = make_raw_id(1);
+	const auto other = make_raw_id(2);
+
+	BOOST_REQUIRE(!cache.check(missing.id));
+
+	cache.insert(missing.id, cache.generation(missing.id));
+	BOOST_REQUIRE(cache.check(missing.id));
+	BOOST_REQUIRE(!cache.check(other.id));
+}
+
+/*
+ * Write invalidates the key. Key which was written while the backend was looking for it
+ * (it was invalidated after its generation was taken) is not inserted, while writes of other keys
+ * of the same shard don't prevent the insertion until their tombstones are forgotten.
+ */
+static void test_negative_cache_invalidation()
+{
+	ioremap::cache::negative_cache cache(ioremap::cache::negative_cache_config{/*size*/ 64, /*ttl*/ 60000});
+
+	const auto id = make_raw_id(1);
+
+	cache.insert(id.id, cache.generation(id.id));
+	BOOST_REQUIRE(cache.check(id.id));
+
+	cache.invalidate(id.id);
+	BOOST_REQUIRE(!cache.check(id.id));
+
+	auto generation = cache.generation(id.id);
+	cache.invalidate(id.id);
+	cache.insert(id.id, generation);
+	BOOST_REQUIRE(!cache.check(id.id));
+
+	// keys whose first bytes differ by 16 fall into the same shard
+	generation = cache.generation(id.id);
+	cache.invalidate(make_raw_id(17).id);
+	BOOST_REQUIRE_NE(cache.generation(id.id), generation);
+	cache.insert(id.id, generation);
+	BOOST_REQUIRE(cache.check(id.id));
+
+	// shard keeps as many tombstones as entries (64 / 16 shards), older ones are forgotten
+	cache.invalidate(id.id);
+	generation = cache.generation(id.id);
+	for (unsigned char i = 1; i <= 5; ++i) {
+		cache.invalidate(make_raw_id(1 + 16 * i).id);
+	}
+	cache.insert(id.id, generation);
+	BOOST_REQUIRE(!cache.check(id.id));
+}
+
+/*
+ * Entries are forgotten after ttl.
+ */
+static void test_negative_cache_expiration()
+{
+	ioremap::cache::negative_cache cache(ioremap::cache::negative_cache_config{/*size*/ 64, /*ttl*/ 100});
+
+	const auto id = make_raw_id(1);
+
+	cache.insert(id.id, cache.generation(id.id));
+	BOOST_REQUIRE(cache.check(id.id));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	BOOST_REQUIRE(!cache.check(id.id));
+}
+
+/*
+ * Server remembers missing key after the first read and stops remembering it after the key is written.
+ */
+static void test_negative_cache_write(session &sess, const nodes_data *setup)
+{
+	dnet_node *node = setup->nodes[2].get_native();
+	auto negative_cache = node->io->backends_manager->get(0)->negative_cache();
+	BOOST_REQUIRE(negative_cache);
+
+	key k("negative cache test key");
+	sess.transform(k);
+	const std::string data = "negative cache test data";
+
+	ELLIPTICS_REQUIRE_ERROR(read_missing, sess.read_data(k, 0, 0), -ENOENT);
+	BOOST_REQUIRE(negative_cache->check(k.raw_id().id));
+	ELLIPTICS_REQUIRE_ERROR(read_cached_missing, sess.read_data(k, 0, 0), -ENOENT);
+
+	ELLIPTICS_REQUIRE(write_result, sess.write_data(k, data, 0));
+	BOOST_REQUIRE(!negative_cache->check(k.raw_id().id));
+	ELLIPTICS_COMPARE_REQUIRE(read_result, sess.read_data(k, 0, 0), data);
+}
+
 /*!
  * \defgroup test_cache_lru_eviction Test cache lru eviction
  * This test assures that cache uses lru eviction scheme.
@@ -307,6 +744,15 @@ bool register_tests(const nodes_data *setup)
 	ELLIPTICS_TEST_CASE(test_cache_overflow, use_session(n, {5}, 0, DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY),
 	                    setup);
 	ELLIPTICS_TEST_CASE(test_cache_overflow, use_session(n, {5}, 0, DNET_IO_FLAGS_CACHE), setup);
+	ELLIPTICS_TEST_CASE(test_cache_batched_sync, use_session(n, {batched_sync_group}, 0, DNET_IO_FLAGS_CACHE), setup);
+	ELLIPTICS_TEST_CASE(test_cache_compression, use_session(n, {compression_group}, 0, DNET_IO_FLAGS_CACHE), setup);
+	ELLIPTICS_TEST_CASE_NOARGS(test_cache_snapshot_round_trip);
+	ELLIPTICS_TEST_CASE(test_cache_snapshot_restore, use_session(n, {snapshot_group}, 0, DNET_IO_FLAGS_CACHE), setup);
+	ELLIPTICS_TEST_CASE(test_cache_snapshot_rejected, use_session(n, {snapshot_group}, 0, DNET_IO_FLAGS_CACHE), setup);
+	ELLIPTICS_TEST_CASE_NOARGS(test_negative_cache_lookup);
+	ELLIPTICS_TEST_CASE_NOARGS(test_negative_cache_invalidation);
+	ELLIPTICS_TEST_CASE_NOARGS(test_negative_cache_expiration);
+	ELLIPTICS_TEST_CASE(test_negative_cache_write, use_session(n, {negative_cache_group}), setup);
 	ELLIPTICS_TEST_CASE(test_cache_lru_eviction,
 	                    use_session(n, {5}, 0, DNET_IO_FLAGS_CACHE | DNET_IO_FLAGS_CACHE_ONLY), setup);
 
@@ -0,0 +1,158 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark of command statistics: every thread accounts commands as io threads do
+ * (node-level and backend-level counters) while a reporter periodically collects them.
+ * Prints throughput of sharded counters and of counters protected by a single mutex
+ * for growing number of threads.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "monitor/statistics.hpp"
+
+using namespace ioremap::monitor;
+
+namespace {
+
+struct options {
+	size_t max_threads;
+	size_t commands;
+	size_t report_period;
+};
+
+/* the way counters were kept before sharding: a single array protected by a mutex */
+class locked_command_stats {
+public:
+	locked_command_stats() : m_cmd_stats(__DNET_CMD_MAX) {}
+
+	void command_counter(const int cmd, const uint64_t trans, const int err, const int cache,
+	                     const uint64_t size, const unsigned long time) {
+		auto &place = cache ? m_cmd_stats[cmd].cache : m_cmd_stats[cmd].disk;
+		auto &source = trans ? place.outside : place.internal;
+		auto &counter = err ? source.counter.failures : source.counter.successes;
+
+		std::unique_lock<std::mutex> guard(m_mutex);
+		++counter;
+		source.size += size;
+		source.time += time;
+	}
+
+	std::vector<command_counters> collect() const {
+		std::unique_lock<std::mutex> guard(m_mutex);
+		return m_cmd_stats;
+	}
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<command_counters> m_cmd_stats;
+};
+
+template <typename Stats>
+double run(const options &opts, size_t threads_num) {
+	typedef std::chrono::steady_clock clock;
+
+	/* node-level and backend-level counters, every command is accounted in both */
+	Stats node_stats, backend_stats;
+	std::atomic<bool> stop{false};
+	uint64_t collected = 0;
+
+	std::thread reporter([&] () {
+		while (!stop) {
+			collected += node_stats.collect()[DNET_CMD_READ_NEW].disk.outside.counter.successes;
+			std::this_thread::sleep_for(std::chrono::milliseconds(opts.report_period));
+		}
+	});
+
+	auto worker = [&] (size_t index) {
+		static const int commands[] = {DNET_CMD_LOOKUP_NEW, DNET_CMD_READ_NEW, DNET_CMD_WRITE_NEW, DNET_CMD_DEL_NEW};
+		for (size_t i = 0; i < opts.commands; ++i) {
+			const int cmd = commands[(i + index) % (sizeof(commands) / sizeof(commands[0]))];
+			node_stats.command_counter(cmd, i + 1, 0, i & 1, 4096, 100);
+			backend_stats.command_counter(cmd, i + 1, 0, i & 1, 4096, 100);
+		}
+	};
+
+	const auto start = clock::now();
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < threads_num; ++i) {
+		threads.emplace_back(worker, i);
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+	stop = true;
+	reporter.join();
+	(void)collected;
+
+	return threads_num * opts.commands / seconds;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	options opts;
+
+	bpo::options_description description("Options");
+	description.add_options()
+		("help", "this help message")
+		("max-threads", bpo::value<size_t>(&opts.max_threads)->default_value(64), "max number of io threads")
+		("commands", bpo::value<size_t>(&opts.commands)->default_value(1000000), "commands per thread")
+		("report-period", bpo::value<size_t>(&opts.report_period)->default_value(100),
+		 "period of statistics collection in milliseconds")
+		;
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl << description << std::endl;
+		return 1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	for (size_t threads = 1; threads <= opts.max_threads; threads *= 2) {
+		const double locked = run<locked_command_stats>(opts, threads);
+		const double sharded = run<command_stats>(opts, threads);
+
+		std::cout << "threads: " << threads
+		          << ", locked: " << static_cast<uint64_t>(locked) << " cmd/s"
+		          << ", sharded: " << static_cast<uint64_t>(sharded) << " cmd/s"
+		          << ", speedup: " << sharded / locked
+		          << std::endl;
+	}
+
+	return 0;
+}
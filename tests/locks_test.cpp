@@ -15,7 +15,11 @@
 
 #include "test_base.hpp"
 #include "library/elliptics.h"
+#include "library/request_queue.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #define BOOST_TEST_NO_MAIN
 #define BOOST_TEST_ALTERNATIVE_INIT_API
@@ -165,6 +169,67 @@ static void test_oplock(session &sess)
 	ELLIPTICS_COMPARE_REQUIRE(read_result, sess.read_data(id, 0, 0), result_data);
 }
 
+/*
+ * Batch of keys locked by dnet_request_queue::lock_keys() must be taken even if its keys are
+ * constantly relocked by lockers of single keys and, once taken, must exclude these lockers.
+ *
+ * Following test runs a thread per key of the batch which locks and unlocks its key in a loop
+ * so that some key of the batch is locked almost all the time, locks the batch several times
+ * and checks that no single key has been locked while the batch was held.
+ */
+static void test_lock_keys()
+{
+	static const size_t num_keys = 8;
+	static const size_t num_batches = 20;
+
+	dnet_request_queue queue(false);
+
+	std::vector<dnet_id> ids(num_keys);
+	for (size_t i = 0; i < num_keys; ++i) {
+		memset(&ids[i], 0, sizeof(ids[i]));
+		ids[i].id[0] = i;
+		ids[i].group_id = 1;
+	}
+
+	std::atomic_bool stop{false};
+	std::atomic_bool batch_locked{false};
+	std::atomic_size_t violations{0};
+
+	std::vector<std::thread> lockers;
+	for (size_t i = 0; i < num_keys; ++i) {
+		lockers.emplace_back([&, i] () {
+			while (!stop) {
+				queue.lock_key(&ids[i]);
+				if (batch_locked)
+					++violations;
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				queue.unlock_key(&ids[i]);
+			}
+		});
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < num_batches; ++i) {
+		/* keys are passed in reverse order and with a duplicate */
+		std::vector<dnet_id> batch(ids.rbegin(), ids.rend());
+		batch.push_back(ids.front());
+
+		queue.lock_keys(batch.data(), batch.size());
+		batch_locked = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		batch_locked = false;
+		queue.unlock_keys(batch.data(), batch.size());
+	}
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	stop = true;
+	for (auto &locker : lockers) {
+		locker.join();
+	}
+
+	BOOST_REQUIRE_EQUAL(violations.load(), 0);
+	BOOST_REQUIRE_LT(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count(), 10);
+}
 
 bool register_tests(const nodes_data *setup)
 {
@@ -172,6 +237,7 @@ bool register_tests(const nodes_data *setup)
 
 	ELLIPTICS_TEST_CASE(test_write_order_execution, use_session(n, { 1 }, 0, 0));
 	ELLIPTICS_TEST_CASE(test_oplock, use_session(n, { 1 }, 0, 0));
+	ELLIPTICS_TEST_CASE_NOARGS(test_lock_keys);
 
 	return true;
 }
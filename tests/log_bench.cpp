@@ -0,0 +1,103 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark of log calls filtered out by level: a per-request INFO line with dumps of id and flags
+ * and a vector of groups is written to a logger with ERROR level. Prints time per call when arguments
+ * are evaluated before filtering (as DNET_LOG did before) and when DNET_LOG checks verbosity first.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "elliptics/interface.h"
+#include "library/logger.hpp"
+
+using namespace ioremap::elliptics;
+
+namespace {
+
+template <typename Log>
+double run(size_t calls, const Log &log) {
+	typedef std::chrono::steady_clock clock;
+
+	dnet_id id;
+	memset(&id, 0, sizeof(id));
+	const std::vector<int> groups{1, 2, 3};
+
+	const auto start = clock::now();
+	for (size_t i = 0; i < calls; ++i) {
+		id.id[0] = i;
+		log(id, groups, i);
+	}
+
+	return std::chrono::duration<double, std::nano>(clock::now() - start).count() / calls;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	size_t calls;
+	std::string log_file;
+
+	bpo::options_description description("Options");
+	description.add_options()
+		("help", "this help message")
+		("calls", bpo::value<size_t>(&calls)->default_value(10000000), "number of log calls")
+		("log-file", bpo::value<std::string>(&log_file)->default_value("/dev/null"), "log file")
+		;
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl << description << std::endl;
+		return 1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	auto logger = make_file_logger(log_file, DNET_LOG_ERROR);
+
+	const double eager = run(calls, [&] (const dnet_id &id, const std::vector<int> &groups, uint64_t flags) {
+		make_facade(logger).log(DNET_LOG_INFO, "{}: {}: started: groups: {}, ioflags: {}",
+		                        dnet_dump_id_str(id.id), dnet_cmd_string(DNET_CMD_READ_NEW),
+		                        groups, dnet_flags_dump_ioflags(flags));
+	});
+
+	const double lazy = run(calls, [&] (const dnet_id &id, const std::vector<int> &groups, uint64_t flags) {
+		DNET_LOG_INFO(logger, "{}: {}: started: groups: {}, ioflags: {}",
+		              dnet_dump_id_str(id.id), dnet_cmd_string(DNET_CMD_READ_NEW),
+		              groups, dnet_flags_dump_ioflags(flags));
+	});
+
+	std::cout << "filtered log call: eager: " << eager << " ns"
+	          << ", lazy: " << lazy << " ns"
+	          << ", speedup: " << eager / lazy
+	          << std::endl;
+
+	return 0;
+}
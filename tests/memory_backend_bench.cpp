@@ -0,0 +1,179 @@
+/*
+ * This file is part of Elliptics.
+ *
+ * Elliptics is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Elliptics is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Elliptics.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Server-side throughput benchmark of the in-memory backend: starts two server nodes, one with eblob backend
+ * and one with memory backend, and runs the same writes and then reads of random objects against both of them
+ * keeping a fixed number of requests in flight. Prints requests and bytes per second of every phase,
+ * so memory backend's numbers are the baseline of the network and queue layers without disk.
+ */
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "test_base.hpp"
+#include "elliptics/newapi/session.hpp"
+
+using namespace ioremap::elliptics;
+
+namespace {
+
+struct options {
+	size_t objects;
+	size_t object_size;
+	size_t requests;
+	size_t inflight;
+	std::string path;
+};
+
+struct result {
+	size_t errors;
+	double elapsed_ms;
+};
+
+/* Calls @request for every index of @indexes keeping up to @inflight requests in flight */
+template <typename Request>
+result run(const std::vector<size_t> &indexes, size_t inflight, Request request) {
+	typedef std::chrono::steady_clock clock;
+	typedef decltype(request(0)) async_type;
+
+	result res{0, 0};
+	std::deque<async_type> queue;
+
+	auto complete = [&] () {
+		queue.front().wait();
+		if (queue.front().error())
+			++res.errors;
+		queue.pop_front();
+	};
+
+	const auto start = clock::now();
+	for (const size_t index : indexes) {
+		if (queue.size() >= inflight)
+			complete();
+		queue.emplace_back(request(index));
+	}
+	while (!queue.empty())
+		complete();
+	res.elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	return res;
+}
+
+void print(const std::string &backend, const std::string &phase, const options &opts, size_t requests,
+           const result &res) {
+	const double seconds = res.elapsed_ms / 1000.;
+	std::cout << "backend: " << backend
+	          << ", " << phase
+	          << ": requests: " << requests
+	          << ", errors: " << res.errors
+	          << ", rps: " << requests / seconds
+	          << ", MB/s: " << requests * opts.object_size / seconds / (1 << 20)
+	          << ", time per request: " << 1000. * res.elapsed_ms / requests << " us"
+	          << std::endl;
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	options opts;
+
+	bpo::options_description description("Options");
+	description.add_options()
+		("help", "this help message")
+		("objects", bpo::value<size_t>(&opts.objects)->default_value(20000), "number of distinct objects")
+		("object-size", bpo::value<size_t>(&opts.object_size)->default_value(4096), "size of an object")
+		("requests", bpo::value<size_t>(&opts.requests)->default_value(200000), "number of reads")
+		("inflight", bpo::value<size_t>(&opts.inflight)->default_value(64), "number of requests in flight")
+		("path", bpo::value<std::string>(&opts.path)->default_value("memory_backend_bench"),
+		 "where to store servers' files")
+		;
+
+	bpo::variables_map vm;
+	try {
+		bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+		bpo::notify(vm);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl << description << std::endl;
+		return 1;
+	}
+
+	if (vm.count("help")) {
+		std::cout << description << std::endl;
+		return 0;
+	}
+
+	std::mt19937 gen(0);
+
+	const std::string object(opts.object_size, 'x');
+
+	std::vector<size_t> writes(opts.objects);
+	for (size_t i = 0; i < opts.objects; ++i) {
+		writes[i] = i;
+	}
+
+	std::uniform_int_distribution<size_t> index(0, opts.objects - 1);
+	std::vector<size_t> reads(opts.requests);
+	for (auto &i : reads) {
+		i = index(gen);
+	}
+
+	auto memory_config = tests::server_config::default_value();
+	memory_config.backends[0] = tests::config_data()
+		("type", "memory")
+		("group", 2);
+
+	const std::vector<std::string> backends{"blob", "memory"};
+
+	std::ostringstream servers_log;
+	tests::start_nodes_config start_config(servers_log, std::vector<tests::server_config>({
+		tests::server_config::default_value().apply_options(tests::config_data()("group", 1)),
+		memory_config
+	}), opts.path);
+	start_config.monitor = false;
+
+	auto setup = tests::start_nodes(start_config);
+
+	for (size_t i = 0; i < backends.size(); ++i) {
+		newapi::session sess(*setup->node);
+		sess.set_groups({static_cast<int>(i + 1)});
+		sess.set_exceptions_policy(session::no_exceptions);
+
+		auto make_key = [] (size_t index) {
+			return "memory backend bench object " + std::to_string(index);
+		};
+
+		const auto written = run(writes, opts.inflight, [&] (size_t index) {
+			return sess.write(make_key(index), "", 0, object, 0);
+		});
+		print(backends[i], "write", opts, writes.size(), written);
+
+		const auto read = run(reads, opts.inflight, [&] (size_t index) {
+			return sess.read_data(make_key(index), 0, 0);
+		});
+		print(backends[i], "read", opts, reads.size(), read);
+	}
+
+	return 0;
+}
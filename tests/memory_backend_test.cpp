@@ -0,0 +1,359 @@
+#include <boost/program_options.hpp>
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include <kora/dynamic.hpp>
+
+#include "elliptics/newapi/session.hpp"
+
+#include "test_base.hpp"
+
+namespace {
+
+tests::nodes_data* get_setup();
+
+namespace constants {
+	static constexpr int group = 1;
+	static constexpr uint64_t user_flags = 0x7a6f3;
+	static constexpr uint64_t size_limit = 256 * 1024 * 1024;
+} /* namespace constants */
+
+}
+
+namespace tests {
+
+namespace bu = boost::unit_test;
+
+/* Single node whose only backend is the in-memory one */
+nodes_data::ptr configure_test_setup(const std::string &path) {
+	auto config = server_config::default_value();
+	config.backends[0] = config_data()
+		("type", "memory")
+		("group", constants::group)
+		("shards", 4)
+		("size_limit", static_cast<int64_t>(constants::size_limit));
+
+	tests::start_nodes_config start_config(bu::results_reporter::get_stream(), {config}, path);
+	start_config.fork = true;
+
+	return tests::start_nodes(start_config);
+}
+
+}
+
+namespace {
+
+using namespace tests;
+
+void check_record(ioremap::elliptics::newapi::session &s, const std::string &key, const std::string &json,
+                  uint64_t json_capacity, const std::string &data) {
+	ELLIPTICS_REQUIRE(lookup, s.lookup(key));
+	BOOST_REQUIRE_EQUAL(lookup.get().size(), 1);
+
+	auto record_info = lookup.get().front().record_info();
+	BOOST_REQUIRE_EQUAL(record_info.user_flags, constants::user_flags);
+	BOOST_REQUIRE_EQUAL(record_info.json_size, json.size());
+	BOOST_REQUIRE_EQUAL(record_info.json_capacity, json_capacity);
+	BOOST_REQUIRE_EQUAL(record_info.data_size, data.size());
+
+	ELLIPTICS_REQUIRE(read, s.read(key, 0, 0));
+	BOOST_REQUIRE_EQUAL(read.get().size(), 1);
+
+	auto result = read.get().front();
+	BOOST_REQUIRE_EQUAL(result.json().to_string(), json);
+	BOOST_REQUIRE_EQUAL(result.data().to_string(), data);
+}
+
+void test_write_read(ioremap::elliptics::newapi::session &s) {
+	static const std::string key = "memory_backend_test::write_read";
+	static const std::string json = R"json({"key":"memory_backend_test::write_read"})json";
+	static const std::string data = "memory_backend_test::write_read data";
+
+	s.set_user_flags(constants::user_flags);
+
+	ELLIPTICS_REQUIRE(write, s.write(key, json, 100, data, 0));
+	BOOST_REQUIRE_EQUAL(write.get().size(), 1);
+	BOOST_REQUIRE_EQUAL(write.get().front().record_info().data_size, data.size());
+
+	check_record(s, key, json, 100, data);
+
+	ELLIPTICS_REQUIRE(part, s.read_data(key, 5, 10));
+	BOOST_REQUIRE_EQUAL(part.get().front().data().to_string(), data.substr(5, 10));
+
+	ELLIPTICS_REQUIRE_ERROR(offset, s.read_data(key, data.size(), 0), -E2BIG);
+}
+
+/* overwrites move a record to larger and back to smaller payload slots of the arena */
+void test_overwrite(ioremap::elliptics::newapi::session &s) {
+	static const std::string key = "memory_backend_test::overwrite";
+
+	s.set_user_flags(constants::user_flags);
+
+	for (const size_t size : {10, 1000, 100000, 10 * 1024 * 1024, 100}) {
+		const std::string json = "{\"size\":" + std::to_string(size) + "}";
+		const std::string data(size, 'a' + size % 26);
+
+		ELLIPTICS_REQUIRE(write, s.write(key, json, json.size(), data, 0));
+		check_record(s, key, json, json.size(), data);
+	}
+}
+
+void test_chunked_write(ioremap::elliptics::newapi::session &s) {
+	static const std::string key = "memory_backend_test::chunked_write";
+	static const std::string json = R"json({"chunked":true})json";
+	static const std::string data = "first chunk|second chunk|last chunk";
+
+	s.set_user_flags(constants::user_flags);
+
+	ELLIPTICS_REQUIRE(prepare, s.write_prepare(key, json, 50, data.substr(0, 12), 0, data.size()));
+
+	/* uncommitted record is not available for lookup and read */
+	ELLIPTICS_REQUIRE_ERROR(lookup, s.lookup(key), -ENOENT);
+
+	ELLIPTICS_REQUIRE(plain, s.write_plain(key, "", data.substr(12, 13), 12));
+	ELLIPTICS_REQUIRE(commit, s.write_commit(key, "", data.substr(25), 25, data.size()));
+
+	check_record(s, key, json, 50, data);
+
+	/* committed record can not be continued by plain write */
+	ELLIPTICS_REQUIRE_ERROR(plain_committed, s.write_plain(key, "", data, 0), -EPERM);
+}
+
+void test_iterate(ioremap::elliptics::newapi::session &s) {
+	static const size_t records = 100;
+
+	s.set_user_flags(constants::user_flags);
+
+	std::map<dnet_raw_id, std::string> written;
+	for (size_t i = 0; i < records; ++i) {
+		ioremap::elliptics::key id{"memory_backend_test::iterate::" + std::to_string(i)};
+		s.transform(id);
+
+		const std::string data = "iterate data " + std::to_string(i);
+		ELLIPTICS_REQUIRE(write, s.write(id, "", 0, data, 0));
+		written.emplace(id.raw_id(), data);
+	}
+
+	const std::tuple<dnet_time, dnet_time> time_range{dnet_time{0, 0}, dnet_time{0, 0}};
+	auto async = s.start_iterator(get_setup()->nodes[0].remote(), 0, DNET_IFLAGS_DATA, {}, time_range);
+
+	size_t found = 0;
+	uint64_t iterated_keys = 0;
+	for (const auto &result : async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), ++iterated_keys);
+
+		auto it = written.find(result.key());
+		if (it == written.end())
+			continue;
+
+		BOOST_REQUIRE_EQUAL(result.record_info().user_flags, constants::user_flags);
+		BOOST_REQUIRE_EQUAL(result.data().to_string(), it->second);
+		++found;
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE_EQUAL(found, records);
+}
+
+void test_remove(ioremap::elliptics::newapi::session &s) {
+	static const std::string key = "memory_backend_test::remove";
+
+	ELLIPTICS_REQUIRE(write, s.write(key, "", 0, "data to be removed", 0));
+	ELLIPTICS_REQUIRE(remove, s.remove(key));
+
+	ELLIPTICS_REQUIRE_ERROR(lookup, s.lookup(key), -ENOENT);
+	ELLIPTICS_REQUIRE_ERROR(read, s.read(key, 0, 0), -ENOENT);
+	ELLIPTICS_REQUIRE_ERROR(remove_again, s.remove(key), -ENOENT);
+
+	/* the key can be written again after removal */
+	s.set_user_flags(constants::user_flags);
+	ELLIPTICS_REQUIRE(rewrite, s.write(key, "", 0, "new data", 0));
+	check_record(s, key, "", 0, "new data");
+}
+
+/* returns access log line of @cmd with @trace_id printed by the node, waits until the line is written */
+std::string find_access_log(const std::string &cmd, uint64_t trace_id) {
+	char trace[17];
+	snprintf(trace, sizeof(trace), "%016llx", static_cast<unsigned long long>(trace_id));
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	do {
+		std::ifstream log(get_setup()->nodes[0].config().access_path);
+		std::string line;
+		while (std::getline(log, line)) {
+			if (line.find("\tcmd=" + cmd + "\t") != std::string::npos &&
+			    line.find("\ttrace_id=" + std::string(trace) + "\t") != std::string::npos)
+				return line + "\t";
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	} while (std::chrono::steady_clock::now() < deadline);
+
+	return std::string();
+}
+
+size_t count_attribute(const std::string &line, const std::string &name) {
+	size_t count = 0;
+	for (size_t pos = line.find("\t" + name + "="); pos != std::string::npos;
+	     pos = line.find("\t" + name + "=", pos + 1)) {
+		++count;
+	}
+	return count;
+}
+
+/* access logs are printed by the server's access writer in background in the same format as before */
+void test_access_log(ioremap::elliptics::newapi::session &s) {
+	static const std::string key = "memory_backend_test::access_log";
+	static const std::string data = "memory_backend_test::access_log data";
+	const uint64_t trace_id = 0x616363657373ULL + rand();
+
+	s.set_trace_id(trace_id);
+
+	ELLIPTICS_REQUIRE(write, s.write(key, "", 0, data, 0));
+	ELLIPTICS_REQUIRE(read, s.read_data(key, 0, 0));
+
+	ioremap::elliptics::key id{key};
+	s.transform(id);
+	dnet_id raw_id = id.id();
+	raw_id.group_id = constants::group;
+	const std::string dump_id = dnet_dump_id(&raw_id);
+
+	const auto line = find_access_log("READ_NEW", trace_id);
+	BOOST_REQUIRE_MESSAGE(!line.empty(), "access log of READ_NEW with trace_id " << trace_id << " is not found");
+
+	BOOST_REQUIRE(line.find("\taccess=server\t") != std::string::npos);
+	BOOST_REQUIRE(line.find("\tid=" + dump_id + "\t") != std::string::npos);
+	BOOST_REQUIRE(line.find("\tstatus=0\t") != std::string::npos);
+	BOOST_REQUIRE_EQUAL(count_attribute(line, "total_time"), 1);
+
+	/* every reply is logged by its own attributes */
+	const size_t replies = count_attribute(line, "response_size");
+	BOOST_REQUIRE_GE(replies, 1);
+	BOOST_REQUIRE_EQUAL(count_attribute(line, "send_time"), replies);
+	BOOST_REQUIRE_EQUAL(count_attribute(line, "send_queue_time"), replies);
+	BOOST_REQUIRE_EQUAL(count_attribute(line, "replies"), 0);
+}
+
+/* storage_free follows memory taken by arenas instead of being fixed at backend's initialization */
+void test_storage_free(ioremap::elliptics::newapi::session &s, const nodes_data *setup) {
+	static const std::string key = "memory_backend_test::storage_free";
+	/* payload bigger than arena's chunk gets a dedicated allocation */
+	static const std::string data(5 * 1024 * 1024, 'f');
+
+	auto &server = setup->nodes.front();
+	const auto backend_id = server.config().backends[0].string_value("backend_id");
+
+	auto backend_stats = [&] () {
+		ELLIPTICS_REQUIRE(result, s.monitor_stat(server.remote(), DNET_MONITOR_BACKEND));
+		BOOST_REQUIRE_EQUAL(result.get().size(), 1);
+
+		std::istringstream stream(result.get().front().statistics());
+		auto monitor_statistics = kora::dynamic::read_json(stream);
+		return monitor_statistics.as_object()["backends"]
+			.as_object()[backend_id]
+			.as_object()["backend"].as_object();
+	};
+
+	auto before = backend_stats();
+	BOOST_REQUIRE_EQUAL(before["storage_free"].as_uint() + before["arena_size"].as_uint(), constants::size_limit);
+
+	ELLIPTICS_REQUIRE(write, s.write(key, "", 0, data, 0));
+
+	auto after = backend_stats();
+	BOOST_REQUIRE_EQUAL(after["storage_free"].as_uint() + after["arena_size"].as_uint(), constants::size_limit);
+	BOOST_REQUIRE_LE(after["storage_free"].as_uint() + data.size(), before["storage_free"].as_uint());
+
+	ELLIPTICS_REQUIRE(remove, s.remove(key));
+}
+
+bool register_tests(const nodes_data *setup) {
+	auto n = setup->node->get_native();
+
+	ELLIPTICS_TEST_CASE(test_write_read, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_overwrite, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_chunked_write, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_iterate, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_remove, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_access_log, use_session(n, {constants::group}));
+	ELLIPTICS_TEST_CASE(test_storage_free, use_session(n, {constants::group}), setup);
+
+	return true;
+}
+
+} /* namespace */
+
+
+tests::nodes_data::ptr configure_test_setup_from_args(int argc, char *argv[]) {
+	namespace bpo = boost::program_options;
+
+	bpo::variables_map vm;
+	bpo::options_description generic("Test options");
+
+	std::string path;
+
+	generic.add_options()
+		("help", "This help message")
+		("path", bpo::value(&path), "Path where to store everything")
+		;
+
+	bpo::store(bpo::parse_command_line(argc, argv, generic), vm);
+	bpo::notify(vm);
+
+	if (vm.count("help")) {
+		std::cerr << generic;
+		return nullptr;
+	}
+
+	return tests::configure_test_setup(path);
+}
+
+
+/*
+ * Common test initialization routine.
+ */
+using namespace tests;
+using namespace boost::unit_test;
+
+/*FIXME: forced to use global variable and plain function wrapper
+ * because of the way how init_test_main works in boost.test,
+ * introducing a global fixture would be a proper way to handle
+ * global test setup
+ */
+namespace {
+
+std::shared_ptr<nodes_data> setup;
+
+nodes_data* get_setup()
+{
+	return setup.get();
+}
+
+bool init_func()
+{
+	return register_tests(setup.get());
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	srand(time(nullptr));
+
+	// we own our test setup
+	setup = configure_test_setup_from_args(argc, argv);
+
+	int result = unit_test_main(init_func, argc, argv);
+
+	// disassemble setup explicitly, to be sure about where its lifetime ends
+	setup.reset();
+
+	return result;
+}
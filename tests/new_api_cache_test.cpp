@@ -10,10 +10,14 @@ namespace tests {
 namespace bu = boost::unit_test;
 
 const uint32_t test_group = 1;
+// group served by a node which caches metadata of json-only reads and lookups
+const uint32_t metadata_group = 2;
 
 nodes_data::ptr configure_test_setup(const std::string &path) {
-	auto server_config = [](const std::vector<int> &groups) {
+	auto server_config = [](const std::vector<int> &groups, bool cache_metadata) {
 		auto ret = server_config::default_value();
+		if (cache_metadata)
+			ret.options("cache_metadata", true);
 		ret.backends.resize(groups.size(), ret.backends.front());
 		for (size_t i = 0; i < groups.size(); ++i) {
 			ret.backends[i]("group", groups[i]);
@@ -24,7 +28,8 @@ nodes_data::ptr configure_test_setup(const std::string &path) {
 	/* Create 3 server nodes each containing two groups.
 	 * Groups 1, 2, 3 are used in all tests, while 4, 5, 6 are bulk_read-specific.
 	 */
-	auto configs = {server_config({test_group})};
+	auto configs = {server_config({test_group}, /*cache_metadata*/ false),
+	                server_config({metadata_group}, /*cache_metadata*/ true)};
 
 	start_nodes_config config(bu::results_reporter::get_stream(), configs, path);
 	config.fork = true;
@@ -107,6 +112,66 @@ static void test_write_via_cache(ioremap::elliptics::newapi::session &session,
 	BOOST_REQUIRE_EQUAL(result.data().to_string(), data);
 }
 
+static void test_read_json_via_metadata_cache(ioremap::elliptics::newapi::session &session,
+                                              std::string &&key,
+                                              std::string &&json,
+                                              std::string &&data) {
+	session.set_namespace("test_read_json_via_metadata_cache" + key);
+	session.set_exceptions_policy(ioremap::elliptics::session::exceptions_policy::default_exceptions);
+	session.set_ioflags(0);
+	session.set_cflags(DNET_FLAGS_NOCACHE);
+	session.write(key, json, 0, data, 0).wait();
+
+	session.set_ioflags(DNET_IO_FLAGS_CACHE);
+	session.set_cflags(0);
+
+	/* json-only read caches the object without data */
+	for (size_t i = 0; i < 2; ++i) {
+		auto results = session.read_json(key).get();
+		BOOST_REQUIRE_EQUAL(results.size(), 1);
+
+		const auto &result = results[0];
+		BOOST_REQUIRE_EQUAL(result.json().to_string(), json);
+		BOOST_REQUIRE_EQUAL(result.record_info().data_size, data.size());
+	}
+
+	{
+		auto results = session.lookup(key).get();
+		BOOST_REQUIRE_EQUAL(results.size(), 1);
+		BOOST_REQUIRE_EQUAL(results[0].record_info().json_size, json.size());
+		BOOST_REQUIRE_EQUAL(results[0].record_info().data_size, data.size());
+	}
+
+	/* json is served by the cache after the object is removed from the backend only */
+	session.set_ioflags(0);
+	session.set_cflags(DNET_FLAGS_NOCACHE);
+	session.remove(key).wait();
+
+	session.set_ioflags(DNET_IO_FLAGS_CACHE);
+	session.set_cflags(0);
+	{
+		auto results = session.read_json(key).get();
+		BOOST_REQUIRE_EQUAL(results.size(), 1);
+		BOOST_REQUIRE_EQUAL(results[0].json().to_string(), json);
+	}
+
+	/* bring the object back to the backend, so its data can be read */
+	session.set_ioflags(0);
+	session.set_cflags(DNET_FLAGS_NOCACHE);
+	session.write(key, json, 0, data, 0).wait();
+
+	session.set_ioflags(DNET_IO_FLAGS_CACHE);
+	session.set_cflags(0);
+
+	/* read of data replaces object cached without data by the full one */
+	auto results = session.read(key, 0, 0).get();
+	BOOST_REQUIRE_EQUAL(results.size(), 1);
+
+	const auto &result = results[0];
+	BOOST_REQUIRE_EQUAL(result.json().to_string(), json);
+	BOOST_REQUIRE_EQUAL(result.data().to_string(), data);
+}
+
 bool register_tests(const nodes_data *setup) {
 	auto n = setup->node->get_native();
 
@@ -147,6 +212,11 @@ bool register_tests(const nodes_data *setup) {
 	                    /*json*/ "{\"key\":\"value\"}",
 	                    /*data*/ "data");
 
+	ELLIPTICS_TEST_CASE(test_read_json_via_metadata_cache, use_session(n, {metadata_group}),
+	                    /*key*/ "key_with_json&data",
+	                    /*json*/ "{\"key\":\"value\"}",
+	                    /*data*/ "data which isn't cached by json-only read");
+
 	return true;
 }
 
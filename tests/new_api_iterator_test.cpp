@@ -4,7 +4,14 @@
 #define BOOST_TEST_ALTERNATIVE_INIT_API
 #include <boost/test/included/unit_test.hpp>
 
+#include <map>
+#include <memory>
+#include <set>
+
+#include <kora/dynamic.hpp>
+
 #include "elliptics/newapi/session.hpp"
+#include "elliptics/newapi/result_entry.hpp"
 
 #include "test_base.hpp"
 
@@ -519,6 +526,221 @@ void test_iterator_no_meta(const ioremap::elliptics::newapi::session &session) {
 	BOOST_REQUIRE_EQUAL(index, constants::numberof::all);
 }
 
+/* Iterates all keys with \a parallelism threads either within key range which covers whole key space
+ * or without key ranges at all and checks that every key is returned exactly once.
+ */
+void test_iterator_parallel(const ioremap::elliptics::newapi::session &session, bool with_key_ranges) {
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({constants::src_group});
+
+	std::vector<dnet_iterator_range> key_ranges;
+	if (with_key_ranges) {
+		dnet_iterator_range whole;
+		memset(whole.key_begin.id, 0, DNET_ID_SIZE);
+		memset(whole.key_end.id, 0xff, DNET_ID_SIZE);
+		key_ranges.push_back(whole);
+	}
+
+	static const uint32_t parallelism = 4;
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(get_setup()->nodes[0].remote(), 0, 0, key_ranges, time_range, parallelism);
+
+	std::map<dnet_raw_id, size_t> indexes;
+	for (size_t index = 0; index < constants::numberof::all; ++index) {
+		indexes.emplace(record{s, index}.raw_key(), index);
+	}
+
+	std::set<uint64_t> iterated_keys;
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+
+		const auto it = indexes.find(result.key());
+		BOOST_REQUIRE(it != indexes.end());
+		const record record{s, it->second};
+		indexes.erase(it);
+
+		const auto record_info = result.record_info();
+		BOOST_REQUIRE_BITWISE_EQUAL(record_info.record_flags, record.flags());
+		BOOST_REQUIRE_EQUAL(record_info.data_timestamp, record.data_ts());
+
+		BOOST_REQUIRE(iterated_keys.insert(result.iterated_keys()).second);
+		BOOST_REQUIRE_EQUAL(result.total_keys(), constants::numberof::all);
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE(indexes.empty());
+	BOOST_REQUIRE_EQUAL(iterated_keys.size(), constants::numberof::all);
+	BOOST_REQUIRE_EQUAL(*iterated_keys.rbegin(), constants::numberof::all);
+}
+
+void test_disk_iterator(const ioremap::elliptics::newapi::session &session) {
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({constants::src_group});
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_disk_iterator(get_setup()->nodes[0].remote(), 0, 0, {}, time_range);
+
+	std::unique_ptr<FILE, int (*)(FILE *)> file(tmpfile(), &fclose);
+	BOOST_REQUIRE(file);
+	ioremap::elliptics::newapi::iterator_result_container container(fileno(file.get()));
+
+	size_t replies = 0;
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		BOOST_REQUIRE_EQUAL(result.iterated_keys(), constants::numberof::all);
+		BOOST_REQUIRE_EQUAL(result.total_keys(), constants::numberof::all);
+		BOOST_REQUIRE_EQUAL(result.json().size(), 0);
+		BOOST_REQUIRE_EQUAL(result.data().size(),
+		                    constants::numberof::all * sizeof(::dnet_iterator_response));
+
+		container.append_container(result);
+		++replies;
+	}
+
+	// whole container is sent by the single reply
+	BOOST_REQUIRE_EQUAL(replies, 1);
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE_EQUAL(container.m_count, constants::numberof::all);
+
+	std::map<dnet_raw_id, size_t> indexes;
+	for (size_t index = 0; index < constants::numberof::all; ++index) {
+		indexes.emplace(record{s, index}.raw_key(), index);
+	}
+
+	container.sort();
+	for (size_t i = 0; i < container.m_count; ++i) {
+		const auto item = container[i];
+
+		const auto it = indexes.find(item.key);
+		BOOST_REQUIRE(it != indexes.end());
+		const record record{s, it->second};
+		indexes.erase(it);
+
+		BOOST_REQUIRE_EQUAL(item.status, 0);
+		BOOST_REQUIRE_BITWISE_EQUAL(item.user_flags, constants::user_flags);
+		BOOST_REQUIRE_BITWISE_EQUAL(item.record_flags, record.flags());
+		BOOST_REQUIRE_EQUAL(item.data_timestamp, record.data_ts());
+		BOOST_REQUIRE_EQUAL(item.data_size, record.is_committed() ? record.data().size() : 0);
+
+		if (i > 0) {
+			// container is sorted by key
+			BOOST_REQUIRE_LT(dnet_id_cmp_str(container[i - 1].key.id, item.key.id), 0);
+		}
+	}
+
+	BOOST_REQUIRE(indexes.empty());
+}
+
+/* Iterates data of records large enough to fill iterator's batches by one or two records
+ * and checks that every record is returned intact and that the server has unaccounted all bytes
+ * of the batches from its send queue by the time the iterator is completed.
+ */
+void test_iterator_large_records(const ioremap::elliptics::newapi::session &session) {
+	static const int group = 2;
+	static const size_t records = 40;
+
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({group});
+
+	auto make_key = [] (size_t index) {
+		return "new_api_iterator_test large record " + std::to_string(index);
+	};
+	/* from 256 KiB to 2 MiB, the latter is the largest record read by default readahead window */
+	auto make_data = [] (size_t index) {
+		return std::string(((index % 8) + 1) * 256 * 1024, 'a' + index % 26);
+	};
+
+	std::map<dnet_raw_id, size_t> indexes;
+	for (size_t index = 0; index < records; ++index) {
+		ELLIPTICS_REQUIRE(async, s.write(make_key(index), "", 0, make_data(index), 0));
+
+		dnet_raw_id id;
+		s.transform(make_key(index), id);
+		indexes.emplace(id, index);
+	}
+
+	const auto &server = get_setup()->nodes[group - 1];
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(server.remote(), 0, DNET_IFLAGS_DATA, {}, time_range);
+
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+
+		const auto it = indexes.find(result.key());
+		BOOST_REQUIRE(it != indexes.end());
+		BOOST_REQUIRE_EQUAL(result.data().to_string(), make_data(it->second));
+		indexes.erase(it);
+	}
+
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+	BOOST_REQUIRE(indexes.empty());
+
+	ELLIPTICS_REQUIRE(stat, s.monitor_stat(server.remote(), DNET_MONITOR_IO));
+	BOOST_REQUIRE_EQUAL(stat.get().size(), 1);
+
+	std::istringstream stream(stat.get().front().statistics());
+	auto states = kora::dynamic::read_json(stream).as_object()["io"].as_object()["states"].as_object();
+	for (const auto &state : states) {
+		BOOST_REQUIRE_EQUAL(state.second.as_object().at("send_queue_bytes").as_uint(), 0);
+	}
+}
+
+/* Reads records with plain replies while the server sends batches of small records iterated in the same state:
+ * plain replies may drain send queue's counter of replies accounted by the batches, but all bytes of the batches
+ * must be unaccounted anyway by the time the iterator and the reads are completed.
+ */
+void test_iterator_interleaved_replies(const ioremap::elliptics::newapi::session &session) {
+	static const int group = 2;
+	static const size_t records = 200;
+
+	auto s = session.clone();
+	s.set_trace_id(rand());
+	s.set_groups({group});
+
+	auto make_key = [] (size_t index) {
+		return "new_api_iterator_test interleaved record " + std::to_string(index);
+	};
+	auto make_data = [] (size_t index) {
+		return std::string(1024 + index, 'a' + index % 26);
+	};
+
+	for (size_t index = 0; index < records; ++index) {
+		ELLIPTICS_REQUIRE(async, s.write(make_key(index), "", 0, make_data(index), 0));
+	}
+
+	const auto &server = get_setup()->nodes[group - 1];
+
+	static const auto time_range = std::make_tuple(dnet_time{0, 0}, dnet_time{0, 0});
+	auto async = s.start_iterator(server.remote(), 0, DNET_IFLAGS_DATA, {}, time_range);
+
+	std::vector<ioremap::elliptics::newapi::async_read_result> reads;
+	size_t index = 0;
+	for (const auto &result: async) {
+		BOOST_REQUIRE_EQUAL(result.status(), 0);
+		reads.emplace_back(s.read_data(make_key(index % records), 0, 0));
+		++index;
+	}
+	BOOST_REQUIRE_EQUAL(async.error().code(), 0);
+
+	for (size_t i = 0; i < reads.size(); ++i) {
+		reads[i].wait();
+		BOOST_REQUIRE_EQUAL(reads[i].error().code(), 0);
+		BOOST_REQUIRE_EQUAL(reads[i].get().front().data().to_string(), make_data(i % records));
+	}
+
+	ELLIPTICS_REQUIRE(stat, s.monitor_stat(server.remote(), DNET_MONITOR_IO));
+	BOOST_REQUIRE_EQUAL(stat.get().size(), 1);
+
+	std::istringstream stream(stat.get().front().statistics());
+	auto states = kora::dynamic::read_json(stream).as_object()["io"].as_object()["states"].as_object();
+	for (const auto &state : states) {
+		BOOST_REQUIRE_EQUAL(state.second.as_object().at("send_queue_bytes").as_uint(), 0);
+	}
+}
 
 bool register_tests(const tests::nodes_data *setup) {
 	using namespace tests;
@@ -547,6 +769,11 @@ bool register_tests(const tests::nodes_data *setup) {
 	}
 
 	ELLIPTICS_TEST_CASE(test_iterator_no_meta, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_parallel, use_session(n), false);
+	ELLIPTICS_TEST_CASE(test_iterator_parallel, use_session(n), true);
+	ELLIPTICS_TEST_CASE(test_disk_iterator, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_large_records, use_session(n));
+	ELLIPTICS_TEST_CASE(test_iterator_interleaved_replies, use_session(n));
 
 	/* TODO:
 	 * * iterate with time range and json
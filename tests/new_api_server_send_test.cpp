@@ -9,6 +9,7 @@
 
 #include "elliptics/newapi/session.hpp"
 #include "example/eblob_backend.h"
+#include "example/congestion_control_monitor.hpp"
 
 #include "test_base.hpp"
 
@@ -1655,9 +1656,97 @@ void test_send_0_ENOSPC(ioremap::elliptics::newapi::session &session,
 	}
 }
 
+/* Checks that writes queued to a slow destination group don't delay writes to a fast one
+ * and that every group's window is driven only by its own acks.
+ */
+void test_congestion_control_independent_groups() {
+	static const int slow_group = 2;
+	static const int fast_group = 3;
+	static const uint64_t bytes = congestion_control_monitor::MINIMAL_WINDOW_SIZE;
+	static const size_t writes = 100;
+
+	congestion_control_monitor monitor{"test", 0, {slow_group, fast_group}};
+
+	size_t slow_started = 0;
+	size_t fast_started = 0;
+
+	// the first write fills the slow group's window and isn't acked for a long time
+	monitor.add_bytes(slow_group, bytes, [&] { ++slow_started; });
+	BOOST_REQUIRE_EQUAL(slow_started, 1);
+
+	for (size_t i = 0; i < writes; ++i) {
+		monitor.add_bytes(slow_group, bytes, [&] { ++slow_started; });
+
+		monitor.add_bytes(fast_group, bytes, [&] { ++fast_started; });
+		BOOST_REQUIRE_EQUAL(fast_started, i + 1);
+		monitor.remove_bytes(fast_group, bytes, 1000 /*rtt_us*/, 0);
+	}
+
+	// writes to the slow group are queued behind its full window, the fast group has sent everything
+	BOOST_REQUIRE_EQUAL(slow_started, 1);
+	BOOST_REQUIRE_EQUAL(fast_started, writes);
+	BOOST_REQUIRE_EQUAL(monitor.window_size(slow_group), congestion_control_monitor::MINIMAL_WINDOW_SIZE);
+	BOOST_REQUIRE_GT(monitor.window_size(fast_group), writes * bytes);
+
+	// queued writes are below the backlog limit, so the iteration isn't blocked
+	monitor.wait_backlog();
+
+	// too slow ack of the slow group doesn't touch the fast group's window and starts the next queued write
+	const uint64_t fast_window = monitor.window_size(fast_group);
+	monitor.remove_bytes(slow_group, bytes, 2 * congestion_control_monitor::LATENCY_TARGET_MSEC * 1000, 0);
+	BOOST_REQUIRE_EQUAL(slow_started, 2);
+	BOOST_REQUIRE_EQUAL(monitor.window_size(fast_group), fast_window);
+
+	for (size_t i = 0; i < writes; ++i) {
+		monitor.remove_bytes(slow_group, bytes, 1000 /*rtt_us*/, 0);
+	}
+	BOOST_REQUIRE_EQUAL(slow_started, writes + 1);
+
+	monitor.wait_completion();
+}
+
+/*
+ * Throughput follows the recent delivery rate of the group: it is measured over intervals
+ * and drops after the group stops delivering, while the total amount delivered stays the same.
+ */
+void test_congestion_control_throughput() {
+	static const int group = 2;
+	static const uint64_t bytes = congestion_control_monitor::MINIMAL_WINDOW_SIZE;
+	static const auto interval = std::chrono::milliseconds(congestion_control_monitor::THROUGHPUT_INTERVAL_MSEC);
+
+	congestion_control_monitor monitor{"test", 0, {group}};
+
+	auto deliver = [&] (size_t writes) {
+		for (size_t i = 0; i < writes; ++i) {
+			monitor.add_bytes(group, bytes, [] {});
+			monitor.remove_bytes(group, bytes, 1000 /*rtt_us*/, 0);
+		}
+	};
+
+	// the first interval isn't finished yet
+	deliver(8);
+	BOOST_REQUIRE_EQUAL(monitor.throughput(group), 0);
+
+	std::this_thread::sleep_for(interval);
+	deliver(1);
+	const uint64_t busy_throughput = monitor.throughput(group);
+	BOOST_REQUIRE_GT(busy_throughput, 0);
+	BOOST_REQUIRE_LE(busy_throughput, 9 * bytes * 1000 / congestion_control_monitor::THROUGHPUT_INTERVAL_MSEC);
+
+	// a nearly idle interval pulls the estimation down
+	std::this_thread::sleep_for(interval);
+	monitor.remove_bytes(group, 0, 1000 /*rtt_us*/, 0);
+	BOOST_REQUIRE_LT(monitor.throughput(group), busy_throughput);
+
+	monitor.wait_completion();
+}
+
 bool register_tests(const nodes_data *setup) {
 	auto n = setup->node->get_native();
 
+	ELLIPTICS_TEST_CASE_NOARGS(test_congestion_control_independent_groups);
+	ELLIPTICS_TEST_CASE_NOARGS(test_congestion_control_throughput);
+
 	// test_dataset testset{session, 2};
 	ELLIPTICS_TEST_CASE(test_simple_server_send, use_session(n)/*, testset*/);
 
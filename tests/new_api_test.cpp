@@ -11,6 +11,7 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <eblob/blob.h>
+#include <kora/dynamic.hpp>
 #include "library/common.hpp"
 #include "elliptics/newapi/session.hpp"
 #include "elliptics/result_entry.hpp"
@@ -36,8 +37,12 @@ nodes_data::ptr configure_test_setup(const std::string &path) {
 
 	/* Create 3 server nodes each containing two groups.
 	 * Groups 1, 2, 3 are used in all tests, while 4, 5, 6 are bulk_read-specific.
+	 * Group 7 is served by the first node's backend with group commit.
 	 */
-	auto configs = {server_config({1, 4}),
+	auto first_config = server_config({1, 4, 7});
+	first_config.backends[2]("group_commit_time", 100000)("group_commit_records", 16);
+
+	auto configs = {first_config,
 	                server_config({2, 5}),
 	                server_config({3, 6})};
 
@@ -1381,6 +1386,82 @@ void test_remove(const ioremap::elliptics::newapi::session &session, const dnet_
 	BOOST_REQUIRE_EQUAL(count, groups.size());
 }
 
+/* Lookups cache headers of records, so every following lookup must see updates and removals of the record */
+void test_lookup_after_update(const ioremap::elliptics::newapi::session &session) {
+	static const auto group = groups[0];
+	static const std::string key{"test_lookup_after_update key"};
+
+	auto s = session.clone();
+	s.set_groups({group});
+	s.set_exceptions_policy(ioremap::elliptics::session::no_exceptions);
+
+	auto check_lookup = [&] (const std::string &json, const dnet_time &json_timestamp, const std::string &data,
+	                         const dnet_time &timestamp) {
+		/* the second lookup is served from the header cache */
+		for (int i = 0; i < 2; ++i) {
+			auto async = s.lookup(key);
+			BOOST_REQUIRE_EQUAL(async.get().size(), 1);
+
+			auto result = async.get().front();
+			BOOST_REQUIRE_EQUAL(result.status(), 0);
+
+			auto record_info = result.record_info();
+			BOOST_REQUIRE_EQUAL(record_info.json_size, json.size());
+			BOOST_REQUIRE_EQUAL(record_info.json_capacity, 100);
+			BOOST_REQUIRE_EQUAL(dnet_time_cmp(&record_info.json_timestamp, &json_timestamp), 0);
+			BOOST_REQUIRE_EQUAL(record_info.data_size, data.size());
+			BOOST_REQUIRE_EQUAL(dnet_time_cmp(&record_info.data_timestamp, &timestamp), 0);
+		}
+	};
+
+	dnet_time timestamp{100, 1};
+	s.set_timestamp(timestamp);
+	s.set_json_timestamp(timestamp);
+	{
+		auto async = s.write(key, R"json({"version":1})json", 100, "data 1", 100);
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), 0);
+	}
+	check_lookup(R"json({"version":1})json", timestamp, "data 1", timestamp);
+
+	/* update_json rewrites json header in place */
+	dnet_time json_timestamp{100, 2};
+	s.set_json_timestamp(json_timestamp);
+	{
+		auto async = s.update_json(key, R"json({"version":22})json");
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), 0);
+	}
+	check_lookup(R"json({"version":22})json", json_timestamp, "data 1", timestamp);
+
+	/* overwrite of the same size reuses the record's place */
+	timestamp = dnet_time{100, 3};
+	s.set_timestamp(timestamp);
+	s.set_json_timestamp(timestamp);
+	{
+		auto async = s.write(key, R"json({"version":333})json", 100, "data 3", 100);
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), 0);
+	}
+	check_lookup(R"json({"version":333})json", timestamp, "data 3", timestamp);
+
+	{
+		auto async = s.remove(key);
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), 0);
+	}
+	{
+		auto async = s.lookup(key);
+		BOOST_REQUIRE_EQUAL(async.get().size(), 1);
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), -ENOENT);
+	}
+
+	timestamp = dnet_time{100, 4};
+	s.set_timestamp(timestamp);
+	s.set_json_timestamp(timestamp);
+	{
+		auto async = s.write(key, R"json({"version":4444})json", 100, "data 4", 100);
+		BOOST_REQUIRE_EQUAL(async.get().front().status(), 0);
+	}
+	check_lookup(R"json({"version":4444})json", timestamp, "data 4", timestamp);
+}
+
 void test_remove_corrupted(const ioremap::elliptics::newapi::session &session) {
 	static const auto group = groups[0];
 
@@ -1798,6 +1879,67 @@ void test_bulk_remove_timeout(const ioremap::elliptics::newapi::session &sess, c
 	check_remove_result_all(async, -ENOENT, delayed_ids.size());
 }
 
+/* Removes more keys than a single status frame carries, so statuses of keys are expanded from several
+ * frames, and checks that every key gets its own status and the backend which has handled it.
+ */
+void test_bulk_remove_many_keys(const ioremap::elliptics::newapi::session &sess) {
+	auto s = sess.clone();
+	bulk_remove_tests::prepare_session(s);
+	const int group = bulk_remove_tests::good_groups.front();
+	s.set_groups({group});
+
+	static const size_t num_keys = 2500;
+
+	auto make_id = [&] (const std::string &name) {
+		key id(name);
+		id.transform(s);
+		id.set_group_id(group);
+		return id.id();
+	};
+
+	std::vector<std::pair<dnet_id, newapi::async_write_result>> writes;
+	std::vector<dnet_id> requested_ids;
+	std::set<dnet_id> not_ids;
+	for (size_t i = 0; i < num_keys; ++i) {
+		const auto id = make_id("br_many_keys_" + std::to_string(i));
+		writes.emplace_back(id, s.write(key(id), "", 0, "bulk_data_" + std::to_string(i), 0));
+		requested_ids.push_back(id);
+
+		const auto not_id = make_id("br_many_keys_absent_" + std::to_string(i));
+		not_ids.emplace(not_id);
+		requested_ids.push_back(not_id);
+	}
+
+	std::map<dnet_id, int> backends; // written key -> backend which has stored it
+	for (auto &write : writes) {
+		write.second.wait();
+		BOOST_REQUIRE_EQUAL(write.second.error().code(), 0);
+		const int backend_id = write.second.get().front().command()->backend_id;
+		backends.emplace(write.first, backend_id);
+	}
+
+	auto async = s.bulk_remove(add_ts(requested_ids, bulk_remove_tests::rec_tmpl.timestamp));
+	for (const auto &result : async) {
+		const auto cmd = result.command();
+		const int backend_id = cmd->backend_id;
+		BOOST_REQUIRE_GE(backend_id, 0);
+
+		auto it = backends.find(cmd->id);
+		if (it != backends.end()) {
+			check_remove_result(result, 0);
+			BOOST_REQUIRE_EQUAL(backend_id, it->second);
+			backends.erase(it);
+		} else if (not_ids.erase(cmd->id)) {
+			check_remove_result(result, -ENOENT);
+		} else {
+			BOOST_FAIL("Unexpected Id");
+		}
+	}
+
+	BOOST_REQUIRE(backends.empty());
+	BOOST_REQUIRE(not_ids.empty());
+}
+
 // -----------------------------------------------------------------------------------------
 
 void test_bulk_read(const ioremap::elliptics::newapi::session &session) {
@@ -2219,6 +2361,7 @@ bool register_tests(const nodes_data *setup) {
 			ELLIPTICS_TEST_CASE(test_bulk_remove_readonly, use_session(n, {}, 0, ioflags), setup);
 			ELLIPTICS_TEST_CASE(test_bulk_remove_direct_backend, use_session(n, {}, 0, ioflags));
 			ELLIPTICS_TEST_CASE(test_bulk_remove_timeout, use_session(n, {}, 0, ioflags), setup);
+			ELLIPTICS_TEST_CASE(test_bulk_remove_many_keys, use_session(n, {}, 0, ioflags));
 		}
 		record.json = R"json({
 			"record": {
@@ -2268,6 +2411,7 @@ bool register_tests(const nodes_data *setup) {
 		if (!in_cache) {
 			ELLIPTICS_TEST_CASE(test_write_plain_into_nonexistent_key, use_session(n, {}, 0, ioflags));
 			ELLIPTICS_TEST_CASE(test_write_plain_into_committed_key, use_session(n, {}, 0, ioflags));
+			ELLIPTICS_TEST_CASE(test_lookup_after_update, use_session(n, {}, 0, ioflags));
 		}
 
 		ELLIPTICS_TEST_CASE(test_write_cas, use_session(n, {}, 0, ioflags));
@@ -2408,6 +2552,77 @@ bool register_tests(const nodes_data *setup) {
 
 } /* namespace test_all_with_ack_filter */
 
+namespace group_commit {
+
+using namespace tests;
+
+/* Writes to group commit backend are acked only after their batch is synced,
+ * but concurrent writes must not wait for each other's batches: all of them should be synced
+ * by much less batches than writes.
+ */
+void test_group_commit(const ioremap::elliptics::newapi::session &session, const nodes_data *setup) {
+	static const int group = 7;
+	static const size_t writes = 64;
+
+	auto &server = setup->nodes.front();
+	const auto backend_id = server.config().backends[2].string_value("backend_id");
+
+	auto s = session.clone();
+	s.set_groups({group});
+
+	auto make_key = [] (size_t i) {
+		return "test_group_commit::key::" + std::to_string(i);
+	};
+
+	std::vector<ioremap::elliptics::newapi::async_write_result> results;
+	for (size_t i = 0; i < writes; ++i) {
+		results.emplace_back(s.write(make_key(i), "", 0, "data of " + make_key(i), 0));
+	}
+
+	for (auto &async : results) {
+		size_t count = 0;
+		for (const auto &result : async) {
+			BOOST_REQUIRE_EQUAL(result.status(), 0);
+			BOOST_REQUIRE_EQUAL(result.command()->cmd, DNET_CMD_WRITE_NEW);
+			BOOST_REQUIRE(!result.path().empty());
+			++count;
+		}
+		BOOST_REQUIRE_EQUAL(count, 1);
+	}
+
+	for (size_t i = 0; i < writes; ++i) {
+		ELLIPTICS_REQUIRE(async, s.read_data(make_key(i), 0, 0));
+		BOOST_REQUIRE_EQUAL(async.get().size(), 1);
+		BOOST_REQUIRE_EQUAL(async.get().front().data().to_string(), "data of " + make_key(i));
+	}
+
+	ELLIPTICS_REQUIRE(result, s.monitor_stat(server.remote(), DNET_MONITOR_BACKEND));
+	BOOST_REQUIRE_EQUAL(result.get().size(), 1);
+
+	auto stats = [&] () {
+		std::istringstream stream(result.get().front().statistics());
+		auto monitor_statistics = kora::dynamic::read_json(stream);
+		return monitor_statistics.as_object()["backends"]
+			.as_object()[backend_id]
+			.as_object()["backend"]
+			.as_object()["group_commit"].as_object();
+	} ();
+
+	BOOST_REQUIRE_EQUAL(stats["records"].as_uint(), writes);
+	BOOST_REQUIRE(stats["batches"].as_uint() > 0);
+	BOOST_REQUIRE(stats["batches"].as_uint() < writes);
+}
+
+bool register_tests(const nodes_data *setup) {
+	auto n = setup->node->get_native();
+
+	ELLIPTICS_TEST_CASE(test_group_commit, use_session(n), setup);
+
+	return true;
+}
+
+} /* namespace group_commit */
+
 tests::nodes_data::ptr configure_test_setup_from_args(int argc, char *argv[]) {
 	namespace bpo = boost::program_options;
 
@@ -2452,6 +2667,7 @@ bool init_func()
 {
 	return all::register_tests(setup.get())
 		&& all_with_ack_filter::register_tests(setup.get())
+		&& group_commit::register_tests(setup.get())
 		;
 }
 
@@ -30,7 +30,9 @@ class MonitorStatsChecker:
             elliptics.core.monitor_stat_categories.io               : self.__check_io_stat,
             elliptics.core.monitor_stat_categories.commands         : self.__check_commands_stat,
             elliptics.core.monitor_stat_categories.backend          : self.__check_backend_stat,
-            elliptics.core.monitor_stat_categories.procfs           : self.__check_procfs_stat}
+            elliptics.core.monitor_stat_categories.procfs           : self.__check_procfs_stat,
+            elliptics.core.monitor_stat_categories.latency          : self.__check_latency_stat,
+            elliptics.core.monitor_stat_categories.samples          : self.__check_samples_stat}
         self.json_stat = json_statistics
         self.categories = categories
         self.start_time = time_period[0]
@@ -128,15 +130,26 @@ class MonitorStatsChecker:
         def check_queue(queue_json):
             '''checks queue statistics'''
             assert queue_json['current_size'] >= 0
+        def check_utilization(threads_json):
+            '''checks utilization of threads'''
+            assert threads_json['threads'] >= 0
+            utilization = threads_json['utilization']
+            assert all(0 <= ratio <= 1 for ratio in utilization.values())
+            assert sum(utilization.values()) <= 1.001
+            assert all(time >= 0 for time in threads_json['time'].values())
         io = self.json_stat['io']
         check_queue(io['blocking'])
+        check_utilization(io['blocking'])
         check_queue(io['nonblocking'])
+        check_utilization(io['nonblocking'])
         check_queue(io['output'])
+        check_utilization(io['net'])
         assert io['blocked'] == False
 
         for state in io['states']:
             state_io = io['states'][state]
             assert state_io['send_queue_size'] >= 0
+            assert state_io['send_queue_bytes'] >= 0
             assert state_io['la'] >= 0
             assert state_io['free'] >= 0
             assert state_io['stall'] >= 0
@@ -297,6 +310,42 @@ class MonitorStatsChecker:
             assert stat['mcode'] >= 0
             assert stat['mdata'] >= 0
 
+    def __check_latency_stat(self):
+        def check_histogram(json):
+            assert json['count'] == sum(count for _, count in json['buckets'])
+            assert 0 <= json['p50'] <= json['p90'] <= json['p99'] <= json['p999'] <= json['max']
+            bounds = [bound for bound, _ in json['buckets']]
+            assert bounds == sorted(bounds)
+
+        for command, command_json in self.json_stat['latency'].items():
+            for source in ('cache', 'disk'):
+                for histogram in command_json.get(source, {}).values():
+                    check_histogram(histogram)
+            if 'send' in command_json:
+                check_histogram(command_json['send'])
+
+    def __check_samples_stat(self):
+        stages = ('recv_time', 'queue_time', 'lock_time', 'handle_time', 'send_queue_time', 'send_time')
+        samples = self.json_stat['samples']
+        requests = samples['requests']
+        assert len(requests) <= min(samples['size'], samples['recorded'])
+        assert [r['timestamp'] for r in requests] == sorted((r['timestamp'] for r in requests), reverse=True)
+
+        counts = {}
+        for request in requests:
+            assert request['cmd']
+            assert request['lock_time'] <= request['handle_time']
+            assert request['replies'] or not request['replied']
+            key = (str(request['backend_id']), request['cmd'])
+            counts[key] = counts.get(key, 0) + 1
+            for stage in stages:
+                assert request[stage] >= 0
+
+        for backend_id, commands in samples['summary'].items():
+            for command, summary in commands.items():
+                assert summary['count'] == counts[(backend_id, command)]
+                for stage in stages:
+                    assert 0 <= summary[stage]['avg'] <= summary[stage]['max']
 def categories_combination():
     '''generates different combination of elliptics.monitor_stat_categories for future use'''
     import itertools
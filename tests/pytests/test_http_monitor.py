@@ -35,6 +35,8 @@ PATH_CATEGORIES = {"/cache": elliptics.core.monitor_stat_categories.cache,
                    "/stats": elliptics.core.monitor_stat_categories.stats,
                    "/procfs": elliptics.core.monitor_stat_categories.procfs,
                    "/top": elliptics.core.monitor_stat_categories.top,
+                   "/latency": elliptics.core.monitor_stat_categories.latency,
+                   "/samples": elliptics.core.monitor_stat_categories.samples,
                    "/all": elliptics.core.monitor_stat_categories.all}
 
 # this response must be equal to the content_string::list from /monitor/http_miscs.hpp
@@ -50,6 +52,12 @@ HTTP_DEFAULT_RESPONSE = "<html>\n" \
                         "\t\tGET <a href='/procfs'>/procfs</a> - Retrieves system statistics about process<br/>\n" \
                         "\t\tGET <a href='/top'>/top</a> - " \
                         "Retrieves statistics of top keys ordered by generated traffic<br/>\n" \
+                        "\t\tGET <a href='/latency'>/latency</a> - " \
+                        "Retrieves histograms of commands latencies<br/>\n" \
+                        "\t\tGET <a href='/samples'>/samples</a> - " \
+                        "Retrieves timings of sampled requests split by stages<br/>\n" \
+                        "\t\tGET <a href='/metrics'>/metrics</a> - " \
+                        "Retrieves statistics in Prometheus text format, can be filtered by ?category=commands,io<br/>\n" \
                         "\t</body>\n" \
                         "</html>";
 
@@ -140,6 +148,35 @@ class TestHttpMonitor:
                                       backends_combination=backends_combination)
         checker.check_json_stat()
 
+    @pytest.mark.usefixtures("servers")
+    def test_http_metrics(self, address):
+        '''Requests metrics in Prometheus text format and checks its syntax and filtering by categories'''
+
+        def get_metrics(query=''):
+            response = urllib_req.urlopen('http://{}/metrics{}'.format(address[1], query))
+            assert response.info().get('Content-Type').startswith('text/plain')
+            families = {}
+            for line in response.read().splitlines():
+                if line.startswith('# TYPE '):
+                    _, _, name, metric_type = line.split(' ')
+                    assert name not in families, 'samples of metric {} must be contiguous'.format(name)
+                    families[name] = metric_type
+                elif line and not line.startswith('#'):
+                    name, value = line.rsplit(' ', 1)
+                    float(value)
+            return families
+
+        families = get_metrics()
+        assert families['elliptics_commands_total'] == 'counter'
+        assert families['elliptics_io_queue_size'] == 'gauge'
+        assert families['elliptics_backend_state'] == 'gauge'
+
+        families = get_metrics('?category=procfs')
+        assert all(name.startswith('elliptics_procfs_') for name in families)
+
+        assert urllib_req.urlopen('http://{}/metrics?category=unknown'.format(address[1])).read() == \
+            HTTP_DEFAULT_RESPONSE
+
     def __get_statistics_by_path(self, address, path, backends=None):
         url = 'http://{}{}'.format(address, path)
         if backends is not None:
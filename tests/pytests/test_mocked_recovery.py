@@ -428,3 +428,36 @@ def test_specific_case_with_readonly_groups(cluster):
 
     # only the two calls above should be made
     assert mocked_server_send.call_count == 2
+
+
+@pytest.mark.parametrize('cluster', [Cluster([
+    Backend(address='121.0.0.1:1', backend_id=1, group_id=1, records=[
+        DummyRecord(key='the only alive record')
+    ]),
+    Backend(address='121.0.0.2:2', backend_id=2, group_id=2),
+])])
+@pytest.mark.usefixtures('mock_route_list', 'mock_iterator', 'mock_pool')
+def test_iteration_parallelism(cluster):
+    """Test that --iteration-parallelism is passed to iterators of all backends.
+
+    Expect: every backend is iterated with requested parallelism.
+    """
+    elliptics.newapi.Session.return_value.server_send.return_value = [mock.MagicMock()]
+    mocked_start_iterator = elliptics.newapi.Session.return_value.start_iterator
+
+    recovery(one_node=False,
+             remotes=cluster.remotes,
+             backend_id=None,
+             address=None,
+             groups=cluster.groups,
+             rtype=RECOVERY.DC,
+             log_file='recovery.log',
+             tmp_dir='test_iteration_parallelism',
+             no_meta=True,
+             no_server_send=False,
+             expected_ret_code=0,
+             iteration_parallelism=4)
+
+    assert mocked_start_iterator.call_count == len(cluster.backends)
+    for call in mocked_start_iterator.call_args_list:
+        assert call[1]['parallelism'] == 4
@@ -53,6 +53,7 @@ def check_response_fields(response, config_params):
     # top object must contain top_result_limit, period_in_seconds fields conformed with server config values
     assert response['top']['top_result_limit'] == config_params['top_length']
     assert response['top']['period_in_seconds'] == config_params['top_period']
+    assert response['top']['sketch_capacity'] >= config_params['top_length']
 
 class TestMonitorTop:
     '''
@@ -88,6 +89,9 @@ class TestMonitorTop:
         assert has_key(test_key, top_keys)
         # check that all top keys items contains all required fields
         check_key_fields(top_keys)
+        # check that the key also appears among keys ordered by number of reads
+        assert has_key(test_key, response['top']['top_by_frequency'])
+        check_key_fields(response['top']['top_by_frequency'])
 
         self.__check_key_existance_using_session_monitor(session, servers.config_params, test_key)
 
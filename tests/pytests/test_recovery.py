@@ -169,7 +169,8 @@ def corrupt_key(session, key):
 
 def recovery(one_node, remotes, backend_id, address, groups,
              rtype, log_file, tmp_dir, no_server_send=False, dump_file=None, no_meta=False,
-             user_flags_set=(), expected_ret_code=0, chunk_size=1024, ro_groups=set(), safe=False):
+             user_flags_set=(), expected_ret_code=0, chunk_size=1024, ro_groups=set(), safe=False,
+             iteration_parallelism=None):
     '''
     Imports dnet_recovery tools and executes merge recovery. Checks result of merge.
     '''
@@ -212,6 +213,8 @@ def recovery(one_node, remotes, backend_id, address, groups,
         args += ['--ro-groups', ','.join(map(str, ro_groups))]
     if safe:
         args += ['-S']
+    if iteration_parallelism is not None:
+        args += ['--iteration-parallelism', iteration_parallelism]
 
     assert elliptics_recovery.recovery.run(args) == expected_ret_code
 
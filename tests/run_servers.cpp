@@ -310,6 +310,9 @@ static int run_servers(const rapidjson::Value &doc)
 				("events_size", top_events_size)
 				("period_in_seconds", top_period);
 			config("monitor_top", top_params);
+
+			// sample every request, so tests could check timings of their own requests
+			config("monitor_samples", tests::config_data()("sample_rate", 1));
 		}
 
 		configs[i].apply_options(config);
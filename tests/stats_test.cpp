@@ -15,7 +15,16 @@
 
 #include "test_base.hpp"
 #include "monitor/event_stats.hpp"
+#include "monitor/heavy_hitters.hpp"
+#include "monitor/top.hpp"
+#include "monitor/request_samples.hpp"
+#include "monitor/histogram.hpp"
+#include "monitor/metrics.hpp"
+#include "monitor/snapshot.hpp"
+#include "monitor/compress.hpp"
+#include "monitor/json_writer.hpp"
 #include "monitor/monitor.hpp"
+#include "library/elliptics.h"
 
 #define BOOST_TEST_NO_MAIN
 #define BOOST_TEST_ALTERNATIVE_INIT_API
@@ -23,6 +32,10 @@
 
 #include <boost/program_options.hpp>
 
+#include <cmath>
+#include <map>
+#include <thread>
+
 using namespace ioremap::elliptics;
 using namespace boost::unit_test;
 
@@ -426,6 +439,508 @@ static void test_frequent_access()
 			      "then keys with more frequent access must be in top");
 }
 
+/**********************
+ Test latency_histogram
+ **********************/
+using ioremap::monitor::latency_histogram;
+using ioremap::monitor::histogram_snapshot;
+
+static void test_histogram_bucket_bounds()
+{
+	// every value must be counted by the first bucket whose upper bound is not less than the value
+	for (uint64_t value = 0; value < (1 << 20); ++value) {
+		const size_t index = latency_histogram::bucket_index(value);
+		BOOST_REQUIRE_LE(value, latency_histogram::bucket_upper_bound(index));
+		if (index > 0)
+			BOOST_REQUIRE_GT(value, latency_histogram::bucket_upper_bound(index - 1));
+	}
+
+	BOOST_REQUIRE_EQUAL(latency_histogram::bucket_index(UINT64_MAX), latency_histogram::buckets_count - 1);
+}
+
+static void test_histogram_percentiles()
+{
+	latency_histogram first, second;
+	for (uint64_t value = 1; value <= 1000; ++value) {
+		(value % 2 ? first : second).add(value);
+	}
+
+	histogram_snapshot snapshot;
+	BOOST_REQUIRE(snapshot.empty());
+	BOOST_REQUIRE_EQUAL(snapshot.percentile(0.5), 0);
+
+	first.merge_to(snapshot);
+	second.merge_to(snapshot);
+	BOOST_REQUIRE_EQUAL(snapshot.count(), 1000);
+
+	// relative error of a bucket is bounded by 1/sub_count
+	const double error = 1. / latency_histogram::sub_count;
+	for (double quantile : {0.5, 0.9, 0.99}) {
+		const double expected = quantile * 1000;
+		const uint64_t value = snapshot.percentile(quantile);
+		BOOST_CHECK_GE(value, expected);
+		BOOST_CHECK_LE(value, expected * (1 + error) + 1);
+	}
+
+	first.clear();
+	second.clear();
+	histogram_snapshot cleared;
+	first.merge_to(cleared);
+	second.merge_to(cleared);
+	BOOST_REQUIRE(cleared.empty());
+}
+
+/*******************
+ Test metrics_writer
+ *******************/
+using ioremap::monitor::metrics_writer;
+
+static void test_metrics_writer_format()
+{
+	metrics_writer writer;
+	writer.counter("test_total", "Test counter", {{"backend_id", "1"}}, 10);
+	writer.gauge("test_gauge", "Test gauge", {}, 0.5);
+	// samples of the same metric must be grouped even if they were written interleaved
+	writer.counter("test_total", "Test counter", {{"backend_id", "2"}, {"key", "a\"b\\c"}}, 20);
+
+	BOOST_REQUIRE_EQUAL(writer.str(),
+		"# HELP test_total Test counter\n"
+		"# TYPE test_total counter\n"
+		"test_total{backend_id=\"1\"} 10\n"
+		"test_total{backend_id=\"2\",key=\"a\\\"b\\\\c\"} 20\n"
+		"# HELP test_gauge Test gauge\n"
+		"# TYPE test_gauge gauge\n"
+		"test_gauge 0.5\n");
+}
+
+static void test_metrics_writer_histogram()
+{
+	latency_histogram histogram;
+	histogram.add(10);
+	histogram.add(100);
+	histogram.add(1000);
+
+	histogram_snapshot snapshot;
+	histogram.merge_to(snapshot);
+
+	metrics_writer writer;
+	writer.histogram("test_latency", "Test histogram", {{"stage", "handle"}}, snapshot);
+	const auto text = writer.str();
+
+	BOOST_CHECK(text.find("# TYPE test_latency histogram\n") != std::string::npos);
+	BOOST_CHECK(text.find("test_latency_bucket{stage=\"handle\",le=\"15\"} 1\n") != std::string::npos);
+	BOOST_CHECK(text.find("test_latency_bucket{stage=\"handle\",le=\"127\"} 2\n") != std::string::npos);
+	BOOST_CHECK(text.find("test_latency_bucket{stage=\"handle\",le=\"+Inf\"} 3\n") != std::string::npos);
+	BOOST_CHECK(text.find("test_latency_sum{stage=\"handle\"} 1110\n") != std::string::npos);
+	BOOST_CHECK(text.find("test_latency_count{stage=\"handle\"} 3\n") != std::string::npos);
+}
+
+/*******************
+ Test space_saving
+ *******************/
+using ioremap::monitor::space_saving;
+using ioremap::monitor::top_stats;
+
+static dnet_id make_test_id(uint64_t number)
+{
+	dnet_id id;
+	memset(&id, 0, sizeof(id));
+	memcpy(id.id, &number, sizeof(number));
+	id.group_id = 1;
+	return id;
+}
+
+static uint64_t test_id_number(const dnet_id &id)
+{
+	uint64_t number;
+	memcpy(&number, id.id, sizeof(number));
+	return number;
+}
+
+static void test_space_saving_exact_counts()
+{
+	const time_t now = time(nullptr);
+	space_saving summary(64);
+
+	// while number of keys doesn't exceed capacity, counts are exact
+	for (uint64_t i = 1; i <= 64; ++i) {
+		for (uint64_t j = 0; j < i; ++j)
+			summary.add(make_test_id(i), 10, 1, now);
+	}
+
+	BOOST_REQUIRE_EQUAL(summary.size(), 64);
+	BOOST_REQUIRE(summary.full());
+	BOOST_REQUIRE_EQUAL(summary.min_count(), 10);
+	for (const auto &item : summary.items()) {
+		const uint64_t number = test_id_number(item.id);
+		BOOST_REQUIRE_EQUAL(item.count, number * 10);
+		BOOST_REQUIRE_EQUAL(item.secondary, number);
+		BOOST_REQUIRE_EQUAL(item.error, 0);
+	}
+}
+
+static void test_space_saving_error_bounds()
+{
+	const time_t now = time(nullptr);
+	const size_t capacity = 32;
+	space_saving summary(capacity);
+	std::map<uint64_t, double> weights;
+
+	// a few heavy keys are hidden among many light ones
+	srand(0);
+	for (int i = 0; i < 100000; ++i) {
+		const uint64_t number = (i % 4 == 0) ? (i % 20) / 4 : 1000 + rand() % 10000;
+		summary.add(make_test_id(number), 1, 0, now);
+		weights[number] += 1;
+	}
+
+	BOOST_REQUIRE_EQUAL(summary.size(), capacity);
+	BOOST_REQUIRE_EQUAL(summary.total(), 100000);
+
+	size_t heavy = 0;
+	for (const auto &item : summary.items()) {
+		const double weight = weights[test_id_number(item.id)];
+		BOOST_REQUIRE_GE(item.count, weight);
+		BOOST_REQUIRE_LE(item.count - item.error, weight);
+		BOOST_REQUIRE_LE(item.error, summary.total() / capacity);
+		heavy += test_id_number(item.id) < 5;
+	}
+	BOOST_REQUIRE_MESSAGE(heavy == 5, "all keys heavier than total / capacity must be tracked");
+}
+
+static void test_top_stats_merge_and_decay()
+{
+	const time_t now = time(nullptr);
+	top_stats stats(TOP_LENGTH, EVENTS_SIZE, PERIOD_IN_SECONDS);
+
+	// the same key read from different threads is merged from their shards
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&stats, now, i] () {
+			for (int j = 0; j < 100; ++j) {
+				stats.add(make_test_id(1), 100, now);
+				stats.add(make_test_id(2 + i), 10, now);
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	auto top = stats.get_top(top_stats::by_size, TOP_LENGTH, now);
+	BOOST_REQUIRE_EQUAL(top.size(), 5);
+	BOOST_REQUIRE_EQUAL(test_id_number(top.front().id), 1);
+	BOOST_REQUIRE_EQUAL(top.front().count, 4 * 100 * 100);
+	BOOST_REQUIRE_EQUAL(top.front().secondary, 4 * 100);
+
+	top = stats.get_top(top_stats::by_frequency, 1, now);
+	BOOST_REQUIRE_EQUAL(top.size(), 1);
+	BOOST_REQUIRE_EQUAL(top.front().count, 4 * 100);
+
+	// weights decay exponentially with period as time constant
+	top = stats.get_top(top_stats::by_size, 1, now + PERIOD_IN_SECONDS);
+	BOOST_REQUIRE_CLOSE(top.front().count, 4 * 100 * 100 * std::exp(-1.), 1e-6);
+
+	// keys which were not accessed during the period are not reported
+	top = stats.get_top(top_stats::by_size, TOP_LENGTH, now + PERIOD_IN_SECONDS + 1);
+	BOOST_REQUIRE(top.empty());
+}
+
+/**********************
+ Test request_samples
+ **********************/
+using ioremap::monitor::request_sample;
+using ioremap::monitor::request_samples;
+
+static request_sample make_test_sample(uint64_t trans)
+{
+	request_sample sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.trans = trans;
+	sample.cmd = DNET_CMD_READ;
+	sample.group_id = 1;
+	sample.handle_time = trans;
+	return sample;
+}
+
+static void test_request_samples_ring()
+{
+	request_samples samples(16, 1, 0);
+
+	BOOST_REQUIRE(samples.collect().empty());
+
+	// the ring keeps only the latest samples, they are returned from the newest one
+	for (uint64_t trans = 1; trans <= 40; ++trans) {
+		samples.add(make_test_sample(trans), false);
+	}
+
+	const auto collected = samples.collect();
+	BOOST_REQUIRE_EQUAL(samples.recorded(), 40);
+	BOOST_REQUIRE_EQUAL(collected.size(), 16);
+	for (size_t i = 0; i < collected.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(collected[i].trans, 40 - i);
+		BOOST_REQUIRE_EQUAL(collected[i].handle_time, 40 - i);
+	}
+}
+
+static void test_request_samples_sampling()
+{
+	request_samples samples(16, 4, 1000);
+
+	size_t sampled = 0;
+	for (int i = 0; i < 8; ++i) {
+		sampled += samples.sampled(10);
+	}
+	BOOST_REQUIRE_EQUAL(sampled, 2);
+
+	// slow requests are always sampled
+	for (int i = 0; i < 8; ++i) {
+		BOOST_REQUIRE(samples.sampled(1000));
+	}
+
+	request_samples slow_only(16, 0, 1000);
+	BOOST_REQUIRE(!slow_only.sampled(999));
+	BOOST_REQUIRE(slow_only.sampled(1000));
+}
+
+static void test_request_samples_replies()
+{
+	request_samples samples(16, 1, 0);
+	samples.add(make_test_sample(1), true);
+	samples.add(make_test_sample(2), false);
+
+	dnet_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.trans = 1;
+	cmd.cmd = DNET_CMD_READ;
+	cmd.id.group_id = 1;
+
+	// data reply goes first, then the final acknowledgement
+	cmd.flags = DNET_FLAGS_REPLY | DNET_FLAGS_MORE;
+	samples.reply_sent(&cmd, 10, 100);
+	cmd.flags = DNET_FLAGS_REPLY;
+	samples.reply_sent(&cmd, 20, 200);
+	// nothing awaits replies anymore
+	samples.reply_sent(&cmd, 40, 400);
+
+	// replies of the sample which doesn't await them are ignored
+	cmd.trans = 2;
+	samples.reply_sent(&cmd, 40, 400);
+
+	const auto collected = samples.collect();
+	BOOST_REQUIRE_EQUAL(collected.size(), 2);
+	BOOST_REQUIRE_EQUAL(collected[0].replies, 0);
+	BOOST_REQUIRE_EQUAL(collected[1].trans, 1);
+	BOOST_REQUIRE_EQUAL(collected[1].replies, 2);
+	BOOST_REQUIRE_EQUAL(collected[1].replied, 1);
+	BOOST_REQUIRE_EQUAL(collected[1].send_queue_time, 30);
+	BOOST_REQUIRE_EQUAL(collected[1].send_time, 300);
+}
+
+/*******************
+ Test snapshot_cache
+ *******************/
+using ioremap::monitor::snapshot_cache;
+
+static std::shared_ptr<rapidjson::Document> parse_json(const std::string &json)
+{
+	auto document = std::make_shared<rapidjson::Document>();
+	document->Parse<0>(json.c_str());
+	return document;
+}
+
+static void test_snapshot_json_delta()
+{
+	auto previous = parse_json(R"({"a": 1, "b": {"c": 2, "d": [1, 2]}, "e": "x", "f": true})");
+	auto current = parse_json(R"({"a": 1, "b": {"c": 3, "d": [1, 2]}, "e": "x", "g": -1})");
+
+	rapidjson::Document delta;
+	BOOST_REQUIRE(ioremap::monitor::json_delta(*previous, *current, delta, delta.GetAllocator()));
+
+	// unchanged values are skipped, changed nested values are kept, removed ones are null
+	BOOST_REQUIRE(!delta.HasMember("a"));
+	BOOST_REQUIRE(!delta.HasMember("e"));
+	BOOST_REQUIRE(!delta["b"].HasMember("d"));
+	BOOST_REQUIRE_EQUAL(delta["b"]["c"].GetInt(), 3);
+	BOOST_REQUIRE(delta["f"].IsNull());
+	BOOST_REQUIRE_EQUAL(delta["g"].GetInt(), -1);
+
+	rapidjson::Document empty;
+	BOOST_REQUIRE(!ioremap::monitor::json_delta(*current, *current, empty, empty.GetAllocator()));
+}
+
+static void test_snapshot_cache()
+{
+	using ioremap::monitor::decompress;
+
+	size_t builds = 0;
+	auto build = [&](uint64_t version) {
+		++builds;
+		return R"({"builds": )" + std::to_string(builds) + R"(, "same": 1, "version": )" +
+		       std::to_string(version) + "}";
+	};
+
+	ioremap::monitor::request request(DNET_MONITOR_COMMANDS);
+
+	// with long period the report is built once and then returned from the cache
+	snapshot_cache cached(std::chrono::hours(1), 4);
+	const auto first = cached.get(request, build);
+	BOOST_REQUIRE_EQUAL(cached.get(request, build), first);
+	BOOST_REQUIRE_EQUAL(builds, 1);
+
+	// different requests are cached separately
+	request.backends_ids.insert(1);
+	cached.get(request, build);
+	BOOST_REQUIRE_EQUAL(builds, 2);
+
+	// without caching every report is built and gets new version, deltas contain only changed values
+	snapshot_cache uncached(std::chrono::milliseconds(0), 1);
+	const auto version = parse_json(decompress(uncached.get(request, build)))->operator[]("version").GetUint64();
+
+	request.since_version = version;
+	auto delta = parse_json(decompress(uncached.get(request, build)));
+	BOOST_REQUIRE((*delta)["delta"].GetBool());
+	BOOST_REQUIRE_EQUAL((*delta)["since_version"].GetUint64(), version);
+	BOOST_REQUIRE_EQUAL((*delta)["version"].GetUint64(), version + 1);
+	BOOST_REQUIRE_EQUAL((*delta)["builds"].GetUint64(), builds);
+	BOOST_REQUIRE(!delta->HasMember("same"));
+
+	// versions which are not kept anymore get the whole report
+	auto full = parse_json(decompress(uncached.get(request, build)));
+	BOOST_REQUIRE(!full->HasMember("delta"));
+	BOOST_REQUIRE(full->HasMember("same"));
+
+	// versions of another cache (e.g. of the server before restart) get the whole report too
+	snapshot_cache restarted(std::chrono::milliseconds(0), 4);
+	request.since_version = (*full)["version"].GetUint64();
+	BOOST_REQUIRE_NE(restarted.epoch(), uncached.epoch());
+	// the restarted cache reaches the same counter of versions
+	restarted.get(request, build);
+	restarted.get(request, build);
+	full = parse_json(decompress(restarted.get(request, build)));
+	BOOST_REQUIRE(!full->HasMember("delta"));
+	BOOST_REQUIRE_EQUAL((*full)["version"].GetUint64() >> 32, restarted.epoch());
+}
+
+static void test_json_writer_copy()
+{
+	using ioremap::monitor::json_writer;
+	using ioremap::elliptics::validate_json;
+
+	validate_json(std::string());
+	validate_json(std::string(R"({"a": [1, -2.5e3, "x\u0041", true, null], "b": {}})"));
+	validate_json(std::string(R"({"a": ["\uD83D\uDE00", 1e308, 1e-324, 18446744073709551616]})"));
+	for (const auto &invalid : {"[]", "{", R"({"a": 01})", R"({"a": "\x"})", R"({"a": 1,})", "{} {}",
+	                            R"({"a": "\uD800"})", R"({"a": "\uD800\u0041"})", R"({"a": 1e400})"}) {
+		BOOST_REQUIRE_THROW(validate_json(std::string(invalid)), std::runtime_error);
+	}
+	BOOST_REQUIRE_THROW(validate_json(R"({"a": )" + std::string(2000, '[')), std::runtime_error);
+
+	// size of zero-terminated string may include its terminator, but only a single one
+	const char terminated[] = R"({"a": 1})";
+	validate_json(terminated, sizeof(terminated));
+	BOOST_REQUIRE_THROW(validate_json(std::string(terminated, sizeof(terminated)) + '\0'), std::runtime_error);
+
+	// members of copied document are streamed into the opened object, broken document writes nothing
+	rapidjson::StringBuffer buffer;
+	json_writer writer(buffer);
+	writer.StartObject();
+	ioremap::monitor::write_member(writer, "size", 10ul);
+	ioremap::monitor::write_member(writer, "name", std::string("x"));
+	writer.String("copy");
+	const std::string json = R"({"a": [1, 2], "b": null})";
+	BOOST_REQUIRE(ioremap::monitor::copy_json(json.c_str(), json.size(), writer));
+	const std::string broken = R"({"a": )";
+	BOOST_REQUIRE(!ioremap::monitor::copy_json(broken.c_str(), broken.size(), writer));
+	// documents which are rejected by the reader in the middle are rejected before anything is written
+	for (const std::string rejected : {R"({"b": 1, "a": "\uD800"})", R"({"b": 1, "a": 1e400})"}) {
+		BOOST_REQUIRE(!ioremap::monitor::copy_json(rejected.c_str(), rejected.size(), writer));
+	}
+	writer.EndObject();
+
+	BOOST_REQUIRE_EQUAL(std::string(buffer.GetString(), buffer.Size()),
+	                    R"({"size":10,"name":"x","copy":{"a":[1,2],"b":null}})");
+}
+
+static void test_thread_state_switch()
+{
+	static const uint64_t msec = 1000000;
+
+	// thread which doesn't account its time isn't switched
+	BOOST_REQUIRE_EQUAL(dnet_thread_state_switch(DNET_THREAD_STATE_BACKEND), -1);
+
+	dnet_thread_stats stats;
+	dnet_thread_stats_attach(&stats, DNET_THREAD_STATE_RUNNING);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	BOOST_REQUIRE_EQUAL(dnet_thread_state_switch(DNET_THREAD_STATE_BACKEND), DNET_THREAD_STATE_RUNNING);
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	BOOST_REQUIRE_EQUAL(dnet_thread_state_switch(DNET_THREAD_STATE_WAIT_QUEUE), DNET_THREAD_STATE_BACKEND);
+	BOOST_REQUIRE_EQUAL(dnet_thread_state_switch(DNET_THREAD_STATE_WAIT_QUEUE), DNET_THREAD_STATE_WAIT_QUEUE);
+	dnet_thread_stats_detach();
+	BOOST_REQUIRE_EQUAL(dnet_thread_state_switch(DNET_THREAD_STATE_RUNNING), -1);
+
+	// time of the current state is summed up to now
+	const uint64_t now = dnet_thread_stats_now();
+	uint64_t time[__DNET_THREAD_STATE_MAX] = {0};
+	dnet_thread_stats_sum(&stats, now, time);
+	BOOST_REQUIRE_GE(time[DNET_THREAD_STATE_RUNNING], 10 * msec);
+	BOOST_REQUIRE_GE(time[DNET_THREAD_STATE_BACKEND], 30 * msec);
+	BOOST_REQUIRE_EQUAL(time[DNET_THREAD_STATE_WAIT_QUEUE], now - stats.state_start);
+	BOOST_REQUIRE_EQUAL(time[DNET_THREAD_STATE_WAIT_LOCK], 0);
+	BOOST_REQUIRE_EQUAL(time[DNET_THREAD_STATE_SEND], 0);
+	BOOST_REQUIRE_EQUAL(time[DNET_THREAD_STATE_BLOCKED], 0);
+
+	dnet_thread_utilization utilization;
+	memset(&utilization, 0, sizeof(utilization));
+	dnet_thread_utilization_update(&utilization, time, now);
+
+	uint64_t total = 0;
+	double ratios = 0;
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		total += time[i];
+		ratios += utilization.ratio[i];
+	}
+	for (int i = 0; i < __DNET_THREAD_STATE_MAX; ++i) {
+		BOOST_REQUIRE_SMALL(utilization.ratio[i] - static_cast<double>(time[i]) / total, 1e-9);
+	}
+	BOOST_REQUIRE_SMALL(ratios - 1, 1e-9);
+}
+
+static void test_thread_utilization_update()
+{
+	static const uint64_t sec = 1000000000ULL;
+
+	dnet_thread_utilization utilization;
+	memset(&utilization, 0, sizeof(utilization));
+
+	uint64_t time[__DNET_THREAD_STATE_MAX] = {0};
+	time[DNET_THREAD_STATE_RUNNING] = 1000;
+	time[DNET_THREAD_STATE_BACKEND] = 3000;
+	dnet_thread_utilization_update(&utilization, time, 5 * sec);
+	BOOST_REQUIRE_EQUAL(utilization.timestamp, 5 * sec);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_RUNNING] - 0.25, 1e-9);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_BACKEND] - 0.75, 1e-9);
+
+	// utilization is kept for a second
+	time[DNET_THREAD_STATE_RUNNING] += 3000;
+	time[DNET_THREAD_STATE_WAIT_QUEUE] += 1000;
+	dnet_thread_utilization_update(&utilization, time, 5 * sec + sec / 2);
+	BOOST_REQUIRE_EQUAL(utilization.timestamp, 5 * sec);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_RUNNING] - 0.25, 1e-9);
+
+	// then it is recalculated only from time accounted since the previous recalculation
+	dnet_thread_utilization_update(&utilization, time, 6 * sec);
+	BOOST_REQUIRE_EQUAL(utilization.timestamp, 6 * sec);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_RUNNING] - 0.75, 1e-9);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_WAIT_QUEUE] - 0.25, 1e-9);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_BACKEND], 1e-9);
+
+	// interval without accounted time doesn't reset it
+	dnet_thread_utilization_update(&utilization, time, 8 * sec);
+	BOOST_REQUIRE_EQUAL(utilization.timestamp, 6 * sec);
+	BOOST_REQUIRE_SMALL(utilization.ratio[DNET_THREAD_STATE_RUNNING] - 0.75, 1e-9);
+}
+
 bool register_tests(const nodes_data *setup)
 {
 	ELLIPTICS_TEST_CASE(test_top_statistics_existence, setup);
@@ -441,6 +956,21 @@ bool register_tests(const nodes_data *setup)
 	ELLIPTICS_TEST_CASE_NOARGS(test_event_weight_attenuation);
 	ELLIPTICS_TEST_CASE_NOARGS(test_frequent_access_among_heavy_keys);
 	ELLIPTICS_TEST_CASE_NOARGS(test_frequent_access);
+	ELLIPTICS_TEST_CASE_NOARGS(test_histogram_bucket_bounds);
+	ELLIPTICS_TEST_CASE_NOARGS(test_histogram_percentiles);
+	ELLIPTICS_TEST_CASE_NOARGS(test_metrics_writer_format);
+	ELLIPTICS_TEST_CASE_NOARGS(test_metrics_writer_histogram);
+	ELLIPTICS_TEST_CASE_NOARGS(test_snapshot_json_delta);
+	ELLIPTICS_TEST_CASE_NOARGS(test_snapshot_cache);
+	ELLIPTICS_TEST_CASE_NOARGS(test_json_writer_copy);
+	ELLIPTICS_TEST_CASE_NOARGS(test_space_saving_exact_counts);
+	ELLIPTICS_TEST_CASE_NOARGS(test_space_saving_error_bounds);
+	ELLIPTICS_TEST_CASE_NOARGS(test_top_stats_merge_and_decay);
+	ELLIPTICS_TEST_CASE_NOARGS(test_request_samples_ring);
+	ELLIPTICS_TEST_CASE_NOARGS(test_request_samples_sampling);
+	ELLIPTICS_TEST_CASE_NOARGS(test_request_samples_replies);
+	ELLIPTICS_TEST_CASE_NOARGS(test_thread_state_switch);
+	ELLIPTICS_TEST_CASE_NOARGS(test_thread_utilization_update);
 
 	return true;
 }